@@ -1,11 +1,17 @@
 #define timestamping true
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "hardware/adc.h"
 #include "hardware/pwm.h" // PWM-Header hinzufügen
     #include "pico/time.h" // Zeitfunktionen hinzufügen
+    #include "adc_capture.h" // DMA-Erfassung mit fester Abtastrate
+#include "adc_multi.h" // Round-Robin-Kanäle mit Boxcar/CIC/FIR-Dezimierung
+#include "telemetry.h" // Binär-Frames
+#include "pwm_timing.h" // Teiler und wrap aus dem Systemtakt
 
     #define NUM_SAMPLES 400
     #define THRESHOLD 400 // Schwellwert für Flankenerkennung 4096 enspricht 3.3V
@@ -18,6 +24,160 @@
 // #define PWM_LEVEL 1606  // Duty Cycle (100/255)
 #define PWM_LEVEL 1606  // Duty Cycle (100/255)
 
+// Dezimierter Datenstrom, optional mit weiteren Eingängen reihum (Round-Robin):
+// "box <R>", "cic <N> <R>", "fir <taps> <R>"  Filter für ADC0
+// "kanal <1..4> <R>" | "kanal <1..4> aus"     weiteren Eingang mitwandeln (Boxcar)
+// "bin" | "csv"                                Ausgabeformat, "aus" beendet den Strom
+#define DEC_BLOCK_LEN 256
+#define DEC_BLOCKS 8
+#define TEMP_INPUT ADC_TEMPERATURE_CHANNEL_NUM
+
+static uint16_t capture_buffer[DEC_BLOCK_LEN * DEC_BLOCKS];
+static adc_capture_config_t capture_cfg = {
+    .input = 0,
+    .clkdiv = 0.0f,
+    .buffer = capture_buffer,
+    .block_len = DEC_BLOCK_LEN,
+    .block_count = DEC_BLOCKS,
+};
+
+static decimator_config_t dec_cfg[ADC_MULTI_MAX_CHANNELS] = {
+    [0] = { .type = DECIMATOR_BOXCAR, .ratio = 1 },
+};
+static int16_t fir_coef[DECIMATOR_MAX_TAPS];
+static uint8_t dec_mask = 1u << 0;  // gewandelte Eingänge
+static uint16_t dec_out[ADC_MULTI_MAX_CHANNELS][DEC_BLOCK_LEN + 1];
+static uint16_t *const dec_out_ptr[ADC_MULTI_MAX_CHANNELS] = {
+    dec_out[0], dec_out[1], dec_out[2], dec_out[3], dec_out[4],
+};
+static adc_multi_t multi;
+static bool decimating = false;
+static uint32_t next_block;         // erwartete Blocknummer
+
+static telemetry_mode_t telemetry_mode = TELEMETRY_CSV;
+static telemetry_batch_t batches[ADC_MULTI_MAX_CHANNELS];  // je Kanal (Position in der Runde)
+
+// Abtastperiode eines Kanals nach der Dezimierung in ps (0, wenn sie nicht
+// in das 32-Bit-Feld der Telemetrie passt: dann ein Frame pro Sample)
+static uint32_t channel_period_ps(const adc_multi_channel_t *ch) {
+    uint64_t ps = (uint64_t)adc_capture_sample_period_ps() * ch->stride;
+    return ps > UINT32_MAX ? 0 : (uint32_t)ps;
+}
+
+// Strom mit den aktuellen Einstellungen (neu) starten
+static void decimator_start(void) {
+    adc_capture_stop();
+
+    // Round-Robin beginnt beim niedrigsten Eingang
+    unsigned first = 0;
+    while (!(dec_mask & (1u << first)))
+        first++;
+    if (!adc_multi_init(&multi, first, dec_mask, dec_cfg, dec_out_ptr)) {
+        printf("Ungültige Dezimierung (CIC: 12 + N * log2(R) <= 32, FIR: max. %d taps)\n",
+               DECIMATOR_MAX_TAPS);
+        decimating = false;
+        return;
+    }
+
+    capture_cfg.input = first;
+    capture_cfg.round_robin = multi.count > 1 ? dec_mask : 0;
+    adc_capture_init(&capture_cfg);
+    adc_capture_start();
+    decimating = true;
+    next_block = 0;
+
+    for (uint32_t p = 0; p < multi.count; p++) {
+        const adc_multi_channel_t *ch = &multi.ch[p];
+        telemetry_batch_init(&batches[p], TELEMETRY_FRAME_CHANNEL, channel_period_ps(ch));
+        batches[p].aux = (uint16_t)ch->input;
+        printf("ADC%u: %.3f Hz, Versatz %lu ns\n", ch->input,
+               1e12 / adc_capture_sample_period_ps() / (double)ch->stride,
+               (unsigned long)(p * adc_capture_sample_period_ps() / 1000u));
+    }
+}
+
+// Befehl auswerten; startet bzw. stoppt den dezimierten Strom
+static void decimator_command(const char *cmd) {
+    unsigned a = 0, b = 0;
+    char word[8] = "";
+
+    if (strcmp(cmd, "aus") == 0) {
+        adc_capture_stop();
+        decimating = false;
+        for (uint32_t p = 0; p < multi.count; p++)
+            telemetry_batch_flush(&batches[p]);
+        // Pulsanalyse wieder nur auf ADC0
+        capture_cfg.input = 0;
+        capture_cfg.round_robin = 0;
+        adc_capture_init(&capture_cfg);
+        printf("Dezimierung aus\n");
+        return;
+    } else if (strcmp(cmd, "bin") == 0 || strcmp(cmd, "csv") == 0) {
+        telemetry_mode = cmd[0] == 'b' ? TELEMETRY_BINARY : TELEMETRY_CSV;
+        return;
+    } else if (sscanf(cmd, "box %u", &a) == 1) {
+        dec_cfg[0] = (decimator_config_t){ .type = DECIMATOR_BOXCAR, .ratio = (uint32_t)a };
+    } else if (sscanf(cmd, "cic %u %u", &a, &b) == 2) {
+        dec_cfg[0] = (decimator_config_t){ .type = DECIMATOR_CIC, .order = (uint8_t)a, .ratio = (uint32_t)b };
+    } else if (sscanf(cmd, "fir %u %u", &a, &b) == 2 && a <= DECIMATOR_MAX_TAPS && b >= 2) {
+        decimator_fir_design(fir_coef, (uint8_t)a, (uint32_t)b);
+        dec_cfg[0] = (decimator_config_t){ .type = DECIMATOR_FIR, .taps = (uint8_t)a, .ratio = (uint32_t)b,
+                                           .coef = fir_coef };
+    } else if (sscanf(cmd, "kanal %u %7s", &a, word) == 2 && a >= 1 && a < ADC_MULTI_MAX_CHANNELS) {
+        if (strcmp(word, "aus") == 0) {
+            dec_mask &= (uint8_t)~(1u << a);
+        } else {
+            dec_cfg[a] = (decimator_config_t){ .type = DECIMATOR_BOXCAR, .ratio = (uint32_t)atoi(word) };
+            dec_mask |= (uint8_t)(1u << a);
+            // ADC1..3 liegen auf GPIO27..29, ADC4 ist der Temperatursensor
+            if (a != TEMP_INPUT)
+                adc_gpio_init(26 + a);
+        }
+    } else {
+        printf("Aufruf: box <R> | cic <N> <R> | fir <taps> <R> | kanal <1..4> <R>|aus | bin | csv | aus\n");
+        return;
+    }
+    decimator_start();
+}
+
+// Kanal ausgeben: CSV "Eingang, Zeit (us, 1 ns Auflösung), Spannung (mV)"
+// oder Telemetrie-Frames (Zusatzwert = Eingang, 12 Bit)
+static void channel_output(const adc_multi_channel_t *ch, telemetry_batch_t *batch) {
+    for (uint32_t j = 0; j < ch->count; j++) {
+        uint64_t t_ns = adc_capture_sample_time_ns(ch->first_index + j * ch->stride);
+        if (telemetry_mode == TELEMETRY_BINARY) {
+            uint16_t v = (uint16_t)((ch->out[j] + (1u << (DECIMATOR_OUT_SHIFT - 1))) >> DECIMATOR_OUT_SHIFT);
+            telemetry_batch_add_block(batch, t_ns, &v, 1);
+            if (batch->sample_period_ps == 0)
+                telemetry_batch_flush(batch);
+        } else {
+            printf("%u, %llu.%03u, %.3f\n", ch->input, (unsigned long long)(t_ns / 1000u),
+                   (unsigned)(t_ns % 1000u), ch->out[j] * (VperDev / (1 << DECIMATOR_OUT_SHIFT)));
+        }
+    }
+}
+
+// Fertige DMA-Blöcke aufteilen, dezimieren und ausgeben
+static void decimator_poll(void) {
+    capture_ring_t *ring = adc_capture_ring();
+    const uint16_t *block;
+    uint32_t seq;
+
+    while ((block = capture_ring_peek(ring, &seq)) != NULL) {
+        if (seq != next_block) {
+            // Blöcke verloren (Ausgabe zu langsam): Filter neu anlaufen lassen
+            printf("Dezimierung: %lu Blöcke verloren\n", (unsigned long)(seq - next_block));
+            adc_multi_restart(&multi, (uint64_t)seq * DEC_BLOCK_LEN);
+        }
+        adc_multi_process(&multi, block, DEC_BLOCK_LEN);
+        next_block = seq + 1;
+        if (!capture_ring_release(ring, seq))
+            continue;   // während der Verarbeitung überschrieben
+
+        for (uint32_t p = 0; p < multi.count; p++)
+            channel_output(&multi.ch[p], &batches[p]);
+    }
+}
 
 int main(void) {
     stdio_init_all();
@@ -25,6 +185,10 @@ int main(void) {
     adc_gpio_init(26); // GPIO26 = ADC0
     adc_select_input(0);
 
+    // ADC im Free-Running-Modus per DMA auslesen (volle Rate, 500 kS/s);
+    // die Zeit eines Samples folgt aus seinem Index
+    adc_capture_init(&capture_cfg);
+
     // PWM initialisieren
     gpio_set_function(PWM_GPIO, GPIO_FUNC_PWM);
     uint slice_num = pwm_gpio_to_slice_num(PWM_GPIO);
@@ -33,21 +197,16 @@ int main(void) {
     //pwm_set_enabled(slice_num, true);
 
     // PWM konfigurieren neu
-    // Systemtakt normalerweise 125 MHz
-    const float sys_clk = 125000000;
     // Gewünschte Frequenz (z.B. 1 kHz)
     float freq = 4000.0f;
     const float pwm = 0.15;
 
-    // Clock divider (CLKDIV)
-    // Wir wählen z.B. CLKDIV = 125, um Zählerfrequenz 1 MHz zu erhalten
-    float clkdiv = 125.0f;
+    // Teiler und wrap aus dem tatsächlichen Systemtakt, feinste Auflösung
+    pwm_timing_t timing = { 0 };
+    pwm_timing_status_t timing_status = pwm_timing_for_freq(freq, 100, 0, &timing);
+    uint16_t wrap = timing.wrap;
 
-    // Wrap Wert berechnen: Wrap = (PWM_Takt / freq) - 1
-    uint16_t wrap = (uint16_t)((sys_clk / clkdiv) / freq) - 1;
-
-    pwm_set_clkdiv(slice_num, clkdiv);
-    pwm_set_wrap(slice_num, wrap);
+    pwm_timing_apply(slice_num, &timing);
 
     // Duty Cycle einstellen (50%)
     pwm_set_gpio_level(PWM_GPIO, wrap * pwm);
@@ -55,21 +214,35 @@ int main(void) {
 
 
     sleep_ms(1000); // Warten bis USB-Serial bereit
+    pwm_timing_report(freq, timing_status, &timing);
+    printf("Abtastung: %.3f Hz (Periode %lu ps)\n",
+           1e12 / adc_capture_sample_period_ps(), adc_capture_sample_period_ps());
 
     uint16_t samples[NUM_SAMPLES];
-#if timestamping
-    uint32_t timestamps[NUM_SAMPLES];
-#endif
+    char input_buffer[32];
+    int input_index = 0;
 
     while (1) {
-        // 100 Messungen durchführen
-        for (int i = 0; i < NUM_SAMPLES; i++) {
-#if timestamping
-            timestamps[i] = time_us_32();
-#endif
-            samples[i] = adc_read();
+        // Eingabe verarbeiten (nicht-blockierend)
+        int c = getchar_timeout_us(0);
+        if (c == '\r' || c == '\n') {
+            input_buffer[input_index] = '\0';
+            if (input_index > 0)
+                decimator_command(input_buffer);
+            input_index = 0;
+        } else if (c != PICO_ERROR_TIMEOUT && c >= ' ' && input_index < (int)sizeof(input_buffer) - 1) {
+            input_buffer[input_index++] = (char)c;
+        }
+
+        // Dezimierter Strom statt Pulsanalyse
+        if (decimating) {
+            decimator_poll();
+            continue;
         }
 
+        // Messungen per DMA durchführen (feste Abtastrate)
+        adc_capture_oneshot(samples, NUM_SAMPLES);
+
         // PWM-Analyse: Puls suchen
         int pulse_start = -1, pulse_end = -1;
         uint16_t min_val = 4095, max_val = 0;
@@ -93,8 +266,9 @@ int main(void) {
         // Average im Pulsbereich bestimmen
         if (pulse_start != -1 && pulse_end != -1) {
 #if timestamping
-            // Zeitmessung: Pulsdauer in Mikrosekunden
-            uint32_t pulse_time_us = timestamps[pulse_end] - timestamps[pulse_start];
+            // Zeitmessung: Pulsdauer aus dem Sample-Index und der exakten Abtastperiode
+            float pulse_time_us = (adc_capture_sample_time_ns(pulse_end)
+                                   - adc_capture_sample_time_ns(pulse_start)) / 1000.0f;
 #endif
 
             // Durchschnitt im Pulse_an Bereich (High-Phase)
@@ -114,7 +288,7 @@ int main(void) {
             float avg_aus = count_aus > 0 ? (float)sum_aus / count_aus * VperDev : 0.0f;
 
 #if timestamping
-            printf("%d, %d, %d, %.2f, %.2f, %lu\n",
+            printf("%d, %d, %d, %.2f, %.2f, %.3f\n",
                 pulse_start, pulse_end, pulse_end - pulse_start, avg_an, avg_aus, pulse_time_us);
 #else
             printf("%d, %d, %d, %.2f, %.2f\n",
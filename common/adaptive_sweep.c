@@ -0,0 +1,145 @@
+// adaptive_sweep.c
+// Adaptiver Kalibrier-Sweep (siehe adaptive_sweep.h).
+
+#include <stdlib.h>
+#include "adaptive_sweep.h"
+
+static q16_t abs_q16(q16_t v) {
+    return v < 0 ? -v : v;
+}
+
+// Einen Punkt anfahren und bis zum Einschwingen messen. `*duty` wird auf
+// den tatsächlich eingestellten Tastgrad gesetzt.
+static q16_t measure_point(const adaptive_sweep_config_t *cfg, adaptive_table_t *table, q16_t *duty) {
+    // Die letzten settle_blocks + 1 Blockmittel
+    q16_t recent[ADAPTIVE_SWEEP_MAX_SETTLE];
+    int len = cfg->settle_blocks + 1;
+    int stable = 0;
+    q16_t prev = 0;
+
+    *duty = cfg->set_duty(*duty, cfg->ctx);
+    for (int n = 0; n < cfg->max_blocks; n++) {
+        q16_t m = cfg->measure_block(cfg->ctx);
+        table->blocks++;
+        if (n > 0)
+            stable = abs_q16(m - prev) <= cfg->settle_tol_mv ? stable + 1 : 0;
+        recent[n % len] = m;
+        prev = m;
+
+        if (stable >= cfg->settle_blocks) {
+            int64_t sum = 0;
+            for (int i = 0; i < len; i++)
+                sum += recent[i];
+            return (q16_t)(sum / len);
+        }
+    }
+
+    // Nicht eingeschwungen: letzten Block verwenden
+    table->unsettled++;
+    return prev;
+}
+
+static void insert_point(adaptive_table_t *table, int pos, q16_t duty, q16_t mv) {
+    for (int i = table->count; i > pos; i--) {
+        table->duty[i] = table->duty[i - 1];
+        table->mv[i] = table->mv[i - 1];
+    }
+    table->duty[pos] = duty;
+    table->mv[pos] = mv;
+    table->count++;
+}
+
+// Steigung von Intervall i in mV pro vollem Tastgrad
+static int64_t slope(const adaptive_table_t *table, int i) {
+    int64_t dv = (int64_t)table->mv[i + 1] - table->mv[i];
+    int64_t dx = (int64_t)table->duty[i + 1] - table->duty[i];
+    return dv * Q16_ONE / dx;
+}
+
+// Geschätzter Fehler der linearen Interpolation in Intervall i: Änderung
+// der Steigung zu den Nachbarintervallen mal Intervallbreite / 4
+static q16_t curvature_error(const adaptive_table_t *table, int i) {
+    int64_t s = slope(table, i);
+    int64_t ds = 0;
+    if (i > 0) {
+        int64_t d = llabs(s - slope(table, i - 1));
+        if (d > ds)
+            ds = d;
+    }
+    if (i + 2 < table->count) {
+        int64_t d = llabs(slope(table, i + 1) - s);
+        if (d > ds)
+            ds = d;
+    }
+    int64_t h = (int64_t)table->duty[i + 1] - table->duty[i];
+    return (q16_t)((ds * h / Q16_ONE) / 4);
+}
+
+bool adaptive_sweep_run(const adaptive_sweep_config_t *cfg, adaptive_table_t *table) {
+    if (cfg->coarse_points < 2 || cfg->coarse_points > ADAPTIVE_SWEEP_MAX_POINTS
+        || cfg->duty_max <= cfg->duty_min || cfg->min_step <= 0
+        || cfg->settle_blocks < 1 || cfg->settle_blocks >= ADAPTIVE_SWEEP_MAX_SETTLE
+        || cfg->max_blocks <= cfg->settle_blocks)
+        return false;
+
+    table->count = 0;
+    table->blocks = 0;
+    table->unsettled = 0;
+
+    // Grobes Raster, aufsteigend
+    q16_t span = cfg->duty_max - cfg->duty_min;
+    for (int i = 0; i < cfg->coarse_points; i++) {
+        q16_t duty = cfg->duty_min
+                   + (q16_t)((int64_t)span * i / (cfg->coarse_points - 1));
+        table->mv[i] = measure_point(cfg, table, &duty);
+        table->duty[i] = duty;
+        table->count++;
+    }
+
+    // Verfeinern, bis kein Intervall mehr die Kriterien erfüllt
+    bool changed = true;
+    while (changed && table->count < ADAPTIVE_SWEEP_MAX_POINTS) {
+        changed = false;
+        for (int i = 0; i + 1 < table->count && table->count < ADAPTIVE_SWEEP_MAX_POINTS; i++) {
+            q16_t h = table->duty[i + 1] - table->duty[i];
+            if (h < 2 * cfg->min_step)
+                continue;
+            bool steep = abs_q16(table->mv[i + 1] - table->mv[i]) > cfg->max_delta_mv;
+            if (!steep && curvature_error(table, i) <= cfg->refine_tol_mv)
+                continue;
+
+            q16_t mid = table->duty[i] + h / 2;
+            q16_t mv = measure_point(cfg, table, &mid);
+            if (mid <= table->duty[i] || mid >= table->duty[i + 1])
+                continue;   // PWM-Auflösung erreicht
+            insert_point(table, i + 1, mid, mv);
+            changed = true;
+            i++;    // rechte Hälfte erst im nächsten Durchlauf prüfen
+        }
+    }
+    return true;
+}
+
+q16_t adaptive_table_lookup(const adaptive_table_t *table, q16_t duty) {
+    if (table->count == 0)
+        return 0;
+    if (duty <= table->duty[0])
+        return table->mv[0];
+    if (duty >= table->duty[table->count - 1])
+        return table->mv[table->count - 1];
+
+    // Intervall mit duty[lo] <= duty < duty[lo + 1] (binäre Suche)
+    int lo = 0;
+    int hi = table->count - 1;
+    while (hi - lo > 1) {
+        int mid = (lo + hi) / 2;
+        if (table->duty[mid] <= duty)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    int64_t dx = (int64_t)table->duty[hi] - table->duty[lo];
+    int64_t dv = (int64_t)table->mv[hi] - table->mv[lo];
+    return table->mv[lo] + (q16_t)(dv * (duty - table->duty[lo]) / dx);
+}
@@ -0,0 +1,62 @@
+// adaptive_sweep.h
+// Adaptiver Kalibrier-Sweep: Einschwing-Erkennung statt fester Wartezeit
+// und nicht-äquidistante Stützstellen.
+//
+// Jeder Punkt wird blockweise gemessen (ein Block = ganze PWM-Perioden).
+// Sobald sich die Blockmittelwerte `settle_blocks` mal hintereinander um
+// höchstens `settle_tol_mv` ändern, gilt der Punkt als eingeschwungen; der
+// Messwert ist der Mittelwert dieser letzten Blöcke.
+//
+// Zuerst wird ein grobes Raster gemessen. Danach werden Intervalle halbiert,
+// solange die Kennlinie dort steil ist (Spannungssprung > max_delta_mv) oder
+// die aus den Nachbarsteigungen geschätzte Abweichung der linearen
+// Interpolation refine_tol_mv übersteigt. Flache, gerade Abschnitte
+// bleiben grob.
+//
+// Die Hardware wird über Rückrufe angesprochen; das Modul selbst ist reines
+// C und baut auch auf dem Host.
+
+#ifndef ADAPTIVE_SWEEP_H
+#define ADAPTIVE_SWEEP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "fixed_point.h"
+
+#define ADAPTIVE_SWEEP_MAX_POINTS 128
+#define ADAPTIVE_SWEEP_MAX_SETTLE 8
+
+typedef struct {
+    q16_t duty_min;             // Bereich des Tastgrads (Q16, 0..1)
+    q16_t duty_max;
+    uint16_t coarse_points;     // Startraster inkl. beider Enden, >= 2
+    q16_t min_step;             // kleinster Abstand zweier Stützstellen
+    q16_t settle_tol_mv;        // erlaubte Änderung zwischen zwei Blockmitteln
+    uint8_t settle_blocks;      // so viele Änderungen innerhalb der Toleranz (1..ADAPTIVE_SWEEP_MAX_SETTLE-1)
+    uint8_t max_blocks;         // Höchstzahl Blöcke pro Punkt
+    q16_t refine_tol_mv;        // geschätzter Interpolationsfehler für Verfeinerung
+    q16_t max_delta_mv;         // größter Spannungssprung zwischen Nachbarpunkten
+
+    // Tastgrad einstellen; Rückgabe: tatsächlich eingestellter Tastgrad
+    // (nach Rundung auf die PWM-Auflösung), der in die Tabelle eingeht
+    q16_t (*set_duty)(q16_t duty, void *ctx);
+    q16_t (*measure_block)(void *ctx);      // Mittelwert eines Blocks in mV
+    void *ctx;
+} adaptive_sweep_config_t;
+
+typedef struct {
+    uint16_t count;
+    q16_t duty[ADAPTIVE_SWEEP_MAX_POINTS];  // aufsteigend
+    q16_t mv[ADAPTIVE_SWEEP_MAX_POINTS];
+    uint32_t blocks;                        // insgesamt gemessene Blöcke
+    uint16_t unsettled;                     // Punkte, die max_blocks erreicht haben
+} adaptive_table_t;
+
+// Sweep ausführen. Gibt false bei ungültiger Konfiguration zurück.
+bool adaptive_sweep_run(const adaptive_sweep_config_t *cfg, adaptive_table_t *table);
+
+// Linear interpolierter Wert der Tabelle beim Tastgrad `duty`
+// (außerhalb des Bereichs: Randwert).
+q16_t adaptive_table_lookup(const adaptive_table_t *table, q16_t duty);
+
+#endif // ADAPTIVE_SWEEP_H
@@ -0,0 +1,185 @@
+// adc_capture.c
+// DMA-gestützte ADC-Erfassung im Free-Running-Modus (siehe adc_capture.h).
+
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "adc_capture.h"
+
+static capture_ring_t ring;
+static adc_capture_config_t config;
+static int dma_chan[2] = { -1, -1 };
+static bool streaming = false;
+static bool ring_ready = false;
+static uint32_t oneshot_len = 0;
+static uint64_t start_us = 0;           // Start des ADC (Zeitbasis der Samples)
+
+// -------------------------
+//  DMA-IRQ: Block fertig
+// -------------------------
+static void adc_capture_dma_irq(void) {
+    for (int i = 0; i < 2; i++) {
+        uint ch = (uint)dma_chan[i];
+        if (!dma_channel_get_irq0_status(ch))
+            continue;
+        dma_channel_acknowledge_irq0(ch);
+        // Der andere Kanal läuft bereits (Chaining), diesen neu ausrichten
+        uint16_t *next = capture_ring_commit(&ring);
+        dma_channel_set_write_addr(ch, next, false);
+    }
+}
+
+static dma_channel_config channel_config(uint ch, uint chain_to) {
+    dma_channel_config c = dma_channel_get_default_config(ch);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, DREQ_ADC);
+    channel_config_set_chain_to(&c, chain_to);
+    return c;
+}
+
+// Chaining lösen, bevor abgebrochen wird, sonst startet der Abbruch
+// eines Kanals den jeweils anderen.
+static void stop_dma(void) {
+    for (int i = 0; i < 2; i++) {
+        uint ch = (uint)dma_chan[i];
+        dma_channel_set_irq0_enabled(ch, false);
+        dma_channel_config c = channel_config(ch, ch);
+        dma_channel_set_config(ch, &c, false);
+    }
+    for (int i = 0; i < 2; i++) {
+        uint ch = (uint)dma_chan[i];
+        dma_channel_abort(ch);
+        dma_channel_acknowledge_irq0(ch);
+    }
+}
+
+static void stop_adc(void) {
+    adc_run(false);
+    adc_fifo_drain();
+}
+
+// Eingang bzw. Round-Robin-Folge vor jedem Start neu setzen, der ADC steht
+// nach dem Anhalten auf irgendeinem Eingang der Folge
+static void select_inputs(void) {
+    adc_set_round_robin(config.round_robin);
+    adc_select_input(config.input);
+}
+
+bool adc_capture_init(const adc_capture_config_t *cfg) {
+    config = *cfg;
+
+    ring_ready = false;
+    if (cfg->buffer != NULL) {
+        if (!capture_ring_init(&ring, cfg->buffer, cfg->block_len, cfg->block_count))
+            return false;
+        ring_ready = true;
+    }
+
+    if (dma_chan[0] < 0) {
+        dma_chan[0] = dma_claim_unused_channel(true);
+        dma_chan[1] = dma_claim_unused_channel(true);
+        irq_add_shared_handler(DMA_IRQ_0, adc_capture_dma_irq,
+                               PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+    }
+
+    // Temperatursensor (Eingang 4) braucht seine Vorspannung
+    uint mask = cfg->round_robin | (1u << cfg->input);
+    if (mask & (1u << ADC_TEMPERATURE_CHANNEL_NUM))
+        adc_set_temp_sensor_enabled(true);
+    select_inputs();
+    // FIFO an, DREQ an, DREQ ab 1 Sample, keine Fehlerbits, keine Byte-Verschiebung
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_set_clkdiv(cfg->clkdiv);
+    return true;
+}
+
+uint32_t adc_capture_sample_rate_hz(void) {
+    return adc_clock_rate_hz(adc_capture_sample_period_ps());
+}
+
+uint32_t adc_capture_sample_period_ps(void) {
+    return adc_clock_period_ps(config.clkdiv);
+}
+
+uint64_t adc_capture_sample_time_ns(uint64_t index) {
+    return adc_clock_sample_time_ns(start_us, index, adc_capture_sample_period_ps());
+}
+
+// -------------------------
+//  STREAM-MODUS
+// -------------------------
+void adc_capture_start(void) {
+    if (!ring_ready || streaming)
+        return;
+
+    capture_ring_reset(&ring);
+    for (int i = 0; i < 2; i++) {
+        uint ch = (uint)dma_chan[i];
+        uint other = (uint)dma_chan[1 - i];
+        dma_channel_config c = channel_config(ch, other);
+        dma_channel_configure(ch, &c, capture_ring_block(&ring, (uint32_t)i),
+                              &adc_hw->fifo, ring.block_len, false);
+        dma_channel_acknowledge_irq0(ch);
+        dma_channel_set_irq0_enabled(ch, true);
+    }
+
+    select_inputs();
+    adc_fifo_drain();
+    dma_channel_start((uint)dma_chan[0]);
+    start_us = time_us_64();
+    adc_run(true);
+    streaming = true;
+}
+
+void adc_capture_stop(void) {
+    if (!streaming)
+        return;
+    stop_adc();
+    stop_dma();
+    streaming = false;
+}
+
+bool adc_capture_running(void) {
+    return streaming;
+}
+
+capture_ring_t *adc_capture_ring(void) {
+    return &ring;
+}
+
+// -------------------------
+//  EINZELERFASSUNG
+// -------------------------
+void adc_capture_oneshot_start(uint16_t *dst, uint32_t n) {
+    adc_capture_stop();
+
+    uint ch = (uint)dma_chan[0];
+    dma_channel_config c = channel_config(ch, ch);
+    dma_channel_set_irq0_enabled(ch, false);
+    oneshot_len = n;
+    dma_channel_configure(ch, &c, dst, &adc_hw->fifo, n, true);
+
+    select_inputs();
+    adc_fifo_drain();
+    start_us = time_us_64();
+    adc_run(true);
+}
+
+uint32_t adc_capture_oneshot_position(void) {
+    // transfer_count zählt die noch ausstehenden Transfers herunter
+    return oneshot_len - dma_channel_hw_addr((uint)dma_chan[0])->transfer_count;
+}
+
+void adc_capture_oneshot_wait(void) {
+    dma_channel_wait_for_finish_blocking((uint)dma_chan[0]);
+    stop_adc();
+}
+
+void adc_capture_oneshot(uint16_t *dst, uint32_t n) {
+    adc_capture_oneshot_start(dst, n);
+    adc_capture_oneshot_wait();
+}
@@ -0,0 +1,72 @@
+// adc_capture.h
+// DMA-gestützte ADC-Erfassung im Free-Running-Modus.
+//
+// Der ADC läuft mit fester, per adc_set_clkdiv eingestellter Rate und
+// schreibt über seinen FIFO. Zwei verkettete DMA-Kanäle füllen abwechselnd
+// die Blöcke eines capture_ring_t (Ping-Pong), die CPU wird nur einmal pro
+// fertigem Block per IRQ unterbrochen. Für Messungen fester Länge gibt es
+// zusätzlich eine Einzelerfassung in einen beliebigen Puffer.
+//
+// Es gibt genau eine Erfassung im System (der ADC existiert nur einmal);
+// Stream- und Einzelerfassung schließen sich gegenseitig aus.
+//
+// Zeitstempel pro Sample gibt es nicht: beim Start wird einmal die 64-Bit-
+// Zeit festgehalten, die Zeit eines Samples folgt aus seinem Index und der
+// exakten Abtastperiode (adc_clock.h).
+//
+// Mit `round_robin` wandelt der ADC reihum mehrere Eingänge, beginnend bei
+// `input` in aufsteigender Reihenfolge; die Samples liegen verschachtelt im
+// Puffer (Aufteilen: adc_multi.h). Die Abtastperiode gilt dann pro Wandlung,
+// jeder Eingang wird mit der Periode mal Anzahl der Eingänge abgetastet.
+
+#ifndef ADC_CAPTURE_H
+#define ADC_CAPTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adc_clock.h"
+#include "capture_ring.h"
+
+typedef struct {
+    unsigned input;         // ADC-Eingang 0..4 (bei Round-Robin der erste)
+    uint8_t round_robin;    // Maske der reihum gewandelten Eingänge, 0 = nur `input`
+    float clkdiv;           // adc_set_clkdiv-Wert, 0 = volle Rate (500 kS/s)
+    uint16_t *buffer;       // block_count * block_len Samples (nur Stream-Modus)
+    uint32_t block_len;     // Samples pro Block
+    uint32_t block_count;   // Zweierpotenz >= 4
+} adc_capture_config_t;
+
+// ADC, FIFO und DMA-Kanäle einrichten. Muss nach adc_init() aufgerufen werden.
+// Ohne Puffer (buffer == NULL) steht nur die Einzelerfassung zur Verfügung.
+bool adc_capture_init(const adc_capture_config_t *cfg);
+
+// Effektive Abtastrate in Hz (gerundet) für den eingestellten Teiler.
+uint32_t adc_capture_sample_rate_hz(void);
+
+// Exakte Abtastperiode in ps für den eingestellten Teiler.
+uint32_t adc_capture_sample_period_ps(void);
+
+// Zeitpunkt in ns, zu dem Sample `index` der laufenden bzw. letzten
+// Erfassung fertig war. Stream: Index seit adc_capture_start() (Block `seq`
+// beginnt bei seq * block_len); Einzelerfassung: Index im Zielpuffer.
+uint64_t adc_capture_sample_time_ns(uint64_t index);
+
+// --- Stream-Modus ---
+void adc_capture_start(void);
+void adc_capture_stop(void);
+bool adc_capture_running(void);
+
+// Ringpuffer der laufenden Erfassung (für peek/release/skip_to_latest)
+capture_ring_t *adc_capture_ring(void);
+
+// --- Einzelerfassung ---
+// Startet die Erfassung von `n` Samples nach `dst` und kehrt sofort zurück.
+void adc_capture_oneshot_start(uint16_t *dst, uint32_t n);
+// Anzahl bereits geschriebener Samples der laufenden Einzelerfassung.
+uint32_t adc_capture_oneshot_position(void);
+// Wartet auf das Ende der Einzelerfassung und stoppt den ADC.
+void adc_capture_oneshot_wait(void);
+// Blockierende Einzelerfassung (start + wait).
+void adc_capture_oneshot(uint16_t *dst, uint32_t n);
+
+#endif // ADC_CAPTURE_H
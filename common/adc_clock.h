@@ -0,0 +1,38 @@
+// adc_clock.h
+// Zeitbasis des frei laufenden ADC: die Zeit eines Samples ergibt sich aus
+// seinem Index, statt vor jeder Wandlung time_us_32() zu lesen.
+//
+// Der ADC wandelt alle (1 + clkdiv) Takte seines 48-MHz-Takts, höchstens
+// aber alle 96 Takte (500 kS/s). adc_set_clkdiv übernimmt den Teiler mit
+// 8 Nachkommabits, die Periode wird deshalb exakt in 1/256 Takten gerechnet
+// und in Pikosekunden angegeben. Pro Lauf genügt ein 64-Bit-Zeitstempel t0
+// (Start des ADC); Sample k ist nach k + 1 Perioden fertig.
+
+#ifndef ADC_CLOCK_H
+#define ADC_CLOCK_H
+
+#include <stdint.h>
+
+#define ADC_CLOCK_HZ 48000000u
+#define ADC_CLOCK_MIN_CYCLES 96u
+
+// Abtastperiode in ps für den adc_set_clkdiv-Wert `clkdiv` (0 = volle Rate)
+static inline uint32_t adc_clock_period_ps(float clkdiv) {
+    uint32_t cycles_q8 = 256u + (uint32_t)(clkdiv * 256.0f);
+    if (cycles_q8 < ADC_CLOCK_MIN_CYCLES * 256u)
+        cycles_q8 = ADC_CLOCK_MIN_CYCLES * 256u;
+    // 1e12 ps / (48 MHz * 256) = 15625 / 192 ps pro 1/256 Takt
+    return (uint32_t)(((uint64_t)cycles_q8 * 15625u + 96u) / 192u);
+}
+
+// Abtastrate in Hz (gerundet) zur Periode `period_ps`
+static inline uint32_t adc_clock_rate_hz(uint32_t period_ps) {
+    return (uint32_t)((1000000000000ull + period_ps / 2) / period_ps);
+}
+
+// Zeitpunkt in ns, zu dem Sample `k` eines ab `t0_us` laufenden ADC fertig ist
+static inline uint64_t adc_clock_sample_time_ns(uint64_t t0_us, uint64_t k, uint32_t period_ps) {
+    return t0_us * 1000u + ((k + 1) * period_ps + 500u) / 1000u;
+}
+
+#endif // ADC_CLOCK_H
@@ -0,0 +1,64 @@
+// adc_multi.c
+// Round-Robin-Strom auf Kanäle aufteilen (siehe adc_multi.h).
+
+#include <stddef.h>
+#include "adc_multi.h"
+
+// Samples pro Kanal, die auf einmal gesammelt und dezimiert werden
+#define GATHER_LEN 64
+
+bool adc_multi_init(adc_multi_t *m, unsigned first, uint8_t mask,
+                    const decimator_config_t *cfg, uint16_t *const *out) {
+    if (first >= ADC_MULTI_MAX_CHANNELS || !(mask & (1u << first)))
+        return false;
+
+    m->count = 0;
+    for (unsigned i = 0; i < ADC_MULTI_MAX_CHANNELS; i++) {
+        unsigned input = (first + i) % ADC_MULTI_MAX_CHANNELS;
+        if (!(mask & (1u << input)))
+            continue;
+        adc_multi_channel_t *ch = &m->ch[m->count++];
+        if (out[input] == NULL || !decimator_init(&ch->dec, &cfg[input]))
+            return false;
+        ch->input = input;
+        ch->out = out[input];
+    }
+    for (uint32_t p = 0; p < m->count; p++)
+        m->ch[p].stride = (uint64_t)m->ch[p].dec.cfg.ratio * m->count;
+
+    adc_multi_restart(m, 0);
+    return true;
+}
+
+void adc_multi_restart(adc_multi_t *m, uint64_t index) {
+    m->pos = (uint32_t)(index % m->count);
+    for (uint32_t p = 0; p < m->count; p++) {
+        adc_multi_channel_t *ch = &m->ch[p];
+        decimator_reset(&ch->dec);
+        ch->count = 0;
+        // erstes eigenes Sample ab `index`, Ausgabe nach `ratio` davon
+        uint64_t own = index + (p + m->count - m->pos) % m->count;
+        ch->next_index = own + ch->stride - m->count;
+    }
+}
+
+void adc_multi_process(adc_multi_t *m, const uint16_t *samples, uint32_t n) {
+    uint16_t gather[GATHER_LEN];
+
+    for (uint32_t p = 0; p < m->count; p++) {
+        adc_multi_channel_t *ch = &m->ch[p];
+        ch->count = 0;
+        ch->first_index = ch->next_index;
+
+        // Samples dieses Kanals liegen ab Offset (p - pos) mod count im Abstand count
+        uint32_t k = (p + m->count - m->pos) % m->count;
+        while (k < n) {
+            uint32_t len = 0;
+            for (; k < n && len < GATHER_LEN; k += m->count)
+                gather[len++] = samples[k];
+            ch->count += decimator_process(&ch->dec, gather, len, ch->out + ch->count);
+        }
+        ch->next_index += (uint64_t)ch->count * ch->stride;
+    }
+    m->pos = (uint32_t)((m->pos + n) % m->count);
+}
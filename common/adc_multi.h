@@ -0,0 +1,59 @@
+// adc_multi.h
+// Aufteilen eines Round-Robin-ADC-Stroms auf Kanäle, je Kanal dezimiert.
+//
+// Der ADC wandelt reihum die Eingänge der Maske, beginnend beim ersten
+// Eingang in aufsteigender Reihenfolge (adc_capture_config_t.round_robin).
+// Sample k des verschachtelten Stroms gehört zum Kanal an Position
+// k mod count; Kanal p ist also um p Wandlungen gegen Position 0 versetzt
+// und wird mit count Wandlungsperioden abgetastet. Jeder Kanal hat eine
+// eigene Dezimierungsstufe (decimator.h), z.B. volle Rate für ADC0 und
+// wenige Hz für den Temperatursensor.
+//
+// Nach adc_multi_process() liegen die neuen Ausgangssamples je Kanal im
+// Puffer des Kanals; `first_index` ist der Index des zugehörigen Samples im
+// verschachtelten Strom (Zeit über adc_capture_sample_time_ns), der Abstand
+// aufeinanderfolgender Ausgangssamples ist `stride` Indizes.
+//
+// Reines C, baut auch auf dem Host.
+
+#ifndef ADC_MULTI_H
+#define ADC_MULTI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "decimator.h"
+
+#define ADC_MULTI_MAX_CHANNELS 5
+
+typedef struct {
+    unsigned input;         // ADC-Eingang 0..4
+    decimator_t dec;
+    uint16_t *out;          // Ausgangssamples (mit DECIMATOR_OUT_SHIFT Nachkommabits)
+    uint32_t count;         // im letzten adc_multi_process() geschrieben
+    uint64_t first_index;   // Strom-Index des ersten davon
+    uint64_t next_index;    // Strom-Index des nächsten Ausgangssamples
+    uint64_t stride;        // ratio * Kanalanzahl
+} adc_multi_channel_t;
+
+typedef struct {
+    adc_multi_channel_t ch[ADC_MULTI_MAX_CHANNELS];   // in Wandlungsreihenfolge
+    uint32_t count;         // Kanäle pro Runde
+    uint32_t pos;           // Position des nächsten Eingangssamples in der Runde
+} adc_multi_t;
+
+// Einrichten für die Eingänge in `mask`, beginnend bei `first` (muss in der
+// Maske liegen). `cfg[i]` ist die Dezimierung für Eingang i, `out[i]` sein
+// Ausgabepuffer; für Eingänge außerhalb der Maske werden sie nicht gelesen.
+// False bei ungültiger Konfiguration.
+bool adc_multi_init(adc_multi_t *m, unsigned first, uint8_t mask,
+                    const decimator_config_t *cfg, uint16_t *const *out);
+
+// Neu beginnen: nächstes Sample ist Strom-Index `index` (z.B. nach verlorenen
+// Blöcken); Filterzustände werden gelöscht.
+void adc_multi_restart(adc_multi_t *m, uint64_t index);
+
+// `n` Samples des verschachtelten Stroms aufteilen und dezimieren. Jeder
+// Ausgabepuffer muss mindestens n / (count * ratio) + 1 Einträge fassen.
+void adc_multi_process(adc_multi_t *m, const uint16_t *samples, uint32_t n);
+
+#endif // ADC_MULTI_H
@@ -0,0 +1,38 @@
+// baseline.c
+// Nachgeführter Dunkelpegel (siehe baseline.h).
+
+#include "baseline.h"
+
+// Blockmittel in ADC-Schritten (Q16), Quotient und Rest getrennt
+static q16_t block_mean_q16(uint32_t sum, uint32_t count) {
+    uint32_t q = sum / count;
+    uint32_t r = sum % count;
+    return (q16_t)((q << Q16_SHIFT) + (uint32_t)(((uint64_t)r << Q16_SHIFT) / count));
+}
+
+void baseline_init(baseline_t *b, uint8_t shift) {
+    b->level = 0;
+    b->shift = shift;
+    b->valid = false;
+}
+
+void baseline_update(baseline_t *b, uint32_t sum, uint32_t count) {
+    if (count == 0)
+        return;
+    q16_t mean = block_mean_q16(sum, count);
+    if (!b->valid) {
+        b->level = mean;
+        b->valid = true;
+        return;
+    }
+    b->level += (mean - b->level) >> b->shift;
+}
+
+bool baseline_matches(const baseline_t *b, uint32_t sum, uint32_t count, uint16_t tol) {
+    if (!b->valid || count == 0)
+        return false;
+    q16_t d = block_mean_q16(sum, count) - b->level;
+    if (d < 0)
+        d = -d;
+    return d <= q16_from_int(tol);
+}
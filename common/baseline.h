@@ -0,0 +1,39 @@
+// baseline.h
+// Nachgeführter Dunkelpegel (Basislinie) aus Samples bei ausgeschaltetem Laser.
+//
+// Exponentieller Mittelwert über Blockmittel: jeder neue Block geht mit dem
+// Gewicht 2^-shift ein, der erste Block setzt den Startwert. So folgt die
+// Basislinie langsamer Drift (Umgebungslicht, Temperatur), ohne dass jedes
+// Mal eine eigene Dunkelmessung nötig ist. Die Flankenschwelle wird relativ
+// dazu gesetzt.
+//
+// Reines C in Festkomma, baut auch auf dem Host.
+
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "fixed_point.h"
+
+typedef struct {
+    q16_t level;            // Dunkelpegel in ADC-Schritten (Q16)
+    uint8_t shift;          // Glättung, 0 = nur letzter Block
+    bool valid;             // mindestens ein Block eingerechnet
+} baseline_t;
+
+void baseline_init(baseline_t *b, uint8_t shift);
+
+// Block von Dunkel-Samples (Summe und Anzahl der Rohwerte) einrechnen.
+void baseline_update(baseline_t *b, uint32_t sum, uint32_t count);
+
+// Liegt das Blockmittel höchstens `tol` ADC-Schritte neben der Basislinie?
+// (ohne gültige Basislinie: false)
+bool baseline_matches(const baseline_t *b, uint32_t sum, uint32_t count, uint16_t tol);
+
+// Basislinie in ganzen ADC-Schritten
+static inline uint16_t baseline_counts(const baseline_t *b) {
+    return (uint16_t)q16_round(b->level);
+}
+
+#endif // BASELINE_H
@@ -0,0 +1,104 @@
+// cal_store.c
+// Serialisierung der Kalibrierdatensätze (siehe cal_store.h).
+
+#include "crc.h"
+#include "cal_store.h"
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+// CRC über Kopf ohne CRC-Feld und Messwerte
+static uint32_t record_crc(const uint8_t *rec, uint16_t points) {
+    uint32_t crc = crc32_update(CRC32_INIT, rec, CAL_HEADER_LEN - 4);
+    crc = crc32_update(crc, rec + CAL_HEADER_LEN, 2u * points);
+    return crc32_final(crc);
+}
+
+size_t cal_serialize(uint8_t *out, size_t out_len, const cal_header_t *hdr,
+                     const uint16_t *values) {
+    if (hdr->points > CAL_MAX_POINTS)
+        return 0;
+    size_t len = CAL_RECORD_LEN((size_t)hdr->points);
+    if (out_len < len)
+        return 0;
+
+    put_u32(out, CAL_MAGIC);
+    put_u16(out + 4, CAL_VERSION);
+    put_u16(out + 6, CAL_HEADER_LEN);
+    put_u32(out + 8, hdr->seq);
+    put_u64(out + 12, hdr->timestamp_us);
+    put_u16(out + 20, hdr->points);
+    put_u16(out + 22, hdr->duty_max);
+    put_u32(out + 24, hdr->pwm_freq_hz);
+    put_u16(out + 28, hdr->pwm_wrap);
+    put_u16(out + 30, hdr->samples_per_step);
+    put_u16(out + 32, hdr->settle_ms);
+    put_u16(out + 34, 0);
+    for (uint16_t i = 0; i < hdr->points; i++)
+        put_u16(out + CAL_HEADER_LEN + 2 * i, values[i]);
+
+    put_u32(out + 36, record_crc(out, hdr->points));
+    return len;
+}
+
+cal_status_t cal_deserialize(const uint8_t *in, size_t in_len, cal_header_t *hdr,
+                             uint16_t *values, size_t max_values) {
+    if (in_len < CAL_HEADER_LEN)
+        return CAL_ERR_SHORT;
+    if (get_u32(in) != CAL_MAGIC)
+        return CAL_ERR_MAGIC;
+    if (get_u16(in + 4) != CAL_VERSION || get_u16(in + 6) != CAL_HEADER_LEN)
+        return CAL_ERR_VERSION;
+
+    uint16_t points = get_u16(in + 20);
+    if (points > CAL_MAX_POINTS || (values != NULL && points > max_values))
+        return CAL_ERR_POINTS;
+    if (in_len < CAL_RECORD_LEN((size_t)points))
+        return CAL_ERR_SHORT;
+    if (get_u32(in + 36) != record_crc(in, points))
+        return CAL_ERR_CRC;
+
+    hdr->seq = get_u32(in + 8);
+    hdr->timestamp_us = get_u64(in + 12);
+    hdr->points = points;
+    hdr->duty_max = get_u16(in + 22);
+    hdr->pwm_freq_hz = get_u32(in + 24);
+    hdr->pwm_wrap = get_u16(in + 28);
+    hdr->samples_per_step = get_u16(in + 30);
+    hdr->settle_ms = get_u16(in + 32);
+    if (values != NULL) {
+        for (uint16_t i = 0; i < points; i++)
+            values[i] = get_u16(in + CAL_HEADER_LEN + 2 * i);
+    }
+    return CAL_OK;
+}
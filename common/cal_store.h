@@ -0,0 +1,76 @@
+// cal_store.h
+// Kalibrierdaten (Reaktionstabelle eines PWM-Sweeps) im Flash.
+//
+// Ein Datensatz besteht aus Kopf und Messwerten, Little Endian:
+//
+//     u32 magic "PCAL", u16 version, u16 kopflänge, u32 seq,
+//     u64 zeitstempel_us, u16 punkte, u16 duty_max, u32 pwm_freq_hz,
+//     u16 pwm_wrap, u16 samples_per_step, u16 settle_ms, u16 reserviert,
+//     u32 crc32, danach `punkte` x u16 Messwerte in 1/16 mV
+//
+// Stützstelle i gehört zum Tastgrad i / duty_max. Die CRC-32 läuft über den
+// Kopf ohne das CRC-Feld und über die Messwerte. Der Zeitstempel ist die
+// Zeit seit dem Start beim Schreiben (der Pico hat keine Echtzeituhr);
+// die Reihenfolge der Datensätze ergibt sich aus `seq`.
+//
+// Gespeichert wird abwechselnd in zwei Sektoren am Ende des Flash (A/B):
+// geschrieben wird immer der Sektor, der nicht den neuesten gültigen
+// Datensatz enthält. Ein Stromausfall beim Schreiben zerstört damit
+// höchstens den neuen Datensatz, der alte bleibt lesbar.
+//
+// cal_serialize()/cal_deserialize() sind reines C und bauen auch auf dem
+// Host; nur cal_store_load()/cal_store_save() benutzen den Flash.
+
+#ifndef CAL_STORE_H
+#define CAL_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CAL_MAGIC 0x4c414350u          // "PCAL"
+#define CAL_VERSION 1
+#define CAL_HEADER_LEN 40
+#define CAL_MAX_POINTS 1024
+#define CAL_RECORD_LEN(points) (CAL_HEADER_LEN + 2 * (points))
+
+// Messwerte in 1/16 mV (0..4095 mV)
+#define CAL_MV_SCALE 16
+
+typedef struct {
+    uint32_t seq;               // wird von cal_store_save() gesetzt
+    uint64_t timestamp_us;
+    uint16_t points;
+    uint16_t duty_max;
+    uint32_t pwm_freq_hz;
+    uint16_t pwm_wrap;
+    uint16_t samples_per_step;
+    uint16_t settle_ms;
+} cal_header_t;
+
+typedef enum {
+    CAL_OK = 0,
+    CAL_ERR_SHORT,          // Puffer kleiner als der Datensatz
+    CAL_ERR_MAGIC,          // kein Datensatz (z.B. gelöschter Flash)
+    CAL_ERR_VERSION,
+    CAL_ERR_POINTS,         // mehr Punkte als CAL_MAX_POINTS bzw. Zielpuffer
+    CAL_ERR_CRC,
+} cal_status_t;
+
+// Datensatz nach `out` schreiben. Rückgabe: Länge in Bytes, 0 wenn zu klein.
+size_t cal_serialize(uint8_t *out, size_t out_len, const cal_header_t *hdr,
+                     const uint16_t *values);
+
+// Datensatz prüfen und lesen. `values` darf NULL sein (nur prüfen).
+cal_status_t cal_deserialize(const uint8_t *in, size_t in_len, cal_header_t *hdr,
+                             uint16_t *values, size_t max_values);
+
+// Neuesten gültigen Datensatz aus dem Flash lesen.
+bool cal_store_load(cal_header_t *hdr, uint16_t *values, size_t max_values);
+
+// Datensatz in den älteren der beiden Sektoren schreiben; `hdr->seq`
+// wird auf den Nachfolger des neuesten Datensatzes gesetzt.
+// Sperrt während Löschen/Programmieren die Interrupts (etwa 50 ms).
+bool cal_store_save(cal_header_t *hdr, const uint16_t *values);
+
+#endif // CAL_STORE_H
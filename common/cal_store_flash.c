@@ -0,0 +1,70 @@
+// cal_store_flash.c
+// Ablage der Kalibrierdatensätze in zwei Flash-Sektoren (siehe cal_store.h).
+
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "cal_store.h"
+
+// Die beiden letzten Sektoren des Flash
+#define CAL_SLOT_COUNT 2
+#define CAL_SLOT_OFFSET(slot) (PICO_FLASH_SIZE_BYTES - (CAL_SLOT_COUNT - (slot)) * FLASH_SECTOR_SIZE)
+
+_Static_assert(CAL_RECORD_LEN(CAL_MAX_POINTS) <= FLASH_SECTOR_SIZE,
+               "Kalibrierdatensatz passt nicht in einen Sektor");
+
+static const uint8_t *slot_ptr(int slot) {
+    return (const uint8_t *)(XIP_BASE + CAL_SLOT_OFFSET(slot));
+}
+
+// Neuester gültiger Sektor, -1 wenn keiner
+static int newest_slot(cal_header_t *hdr) {
+    int best = -1;
+    for (int slot = 0; slot < CAL_SLOT_COUNT; slot++) {
+        cal_header_t h;
+        if (cal_deserialize(slot_ptr(slot), FLASH_SECTOR_SIZE, &h, NULL, 0) != CAL_OK)
+            continue;
+        // Vergleich mit Überlauf: seq zählt fortlaufend weiter
+        if (best < 0 || (int32_t)(h.seq - hdr->seq) > 0) {
+            best = slot;
+            *hdr = h;
+        }
+    }
+    return best;
+}
+
+bool cal_store_load(cal_header_t *hdr, uint16_t *values, size_t max_values) {
+    cal_header_t h;
+    int slot = newest_slot(&h);
+    if (slot < 0)
+        return false;
+    return cal_deserialize(slot_ptr(slot), FLASH_SECTOR_SIZE, hdr, values, max_values) == CAL_OK;
+}
+
+bool cal_store_save(cal_header_t *hdr, const uint16_t *values) {
+    // Seitenweise programmieren, Rest mit 0xff (gelöschter Zustand) auffüllen
+    static uint8_t buf[FLASH_SECTOR_SIZE];
+
+    cal_header_t newest;
+    int slot = newest_slot(&newest);
+    hdr->seq = slot < 0 ? 1 : newest.seq + 1;
+    int target = slot < 0 ? 0 : (slot + 1) % CAL_SLOT_COUNT;
+
+    memset(buf, 0xff, sizeof(buf));
+    size_t len = cal_serialize(buf, sizeof(buf), hdr, values);
+    if (len == 0)
+        return false;
+    size_t prog_len = (len + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE;
+
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_erase(CAL_SLOT_OFFSET(target), FLASH_SECTOR_SIZE);
+    flash_range_program(CAL_SLOT_OFFSET(target), buf, prog_len);
+    restore_interrupts(ints);
+
+    // Zurücklesen
+    cal_header_t check;
+    return cal_deserialize(slot_ptr(target), FLASH_SECTOR_SIZE, &check, NULL, 0) == CAL_OK
+           && check.seq == hdr->seq;
+}
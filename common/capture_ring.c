@@ -0,0 +1,69 @@
+// capture_ring.c
+// Block-Ringpuffer für die DMA-gestützte ADC-Erfassung (siehe capture_ring.h).
+
+#include <stddef.h>
+#include "capture_ring.h"
+
+bool capture_ring_init(capture_ring_t *ring, uint16_t *storage,
+                       uint32_t block_len, uint32_t block_count) {
+    if (block_count < CAPTURE_RING_IN_FLIGHT + 1 || block_len == 0 || storage == NULL)
+        return false;
+    if ((block_count & (block_count - 1)) != 0)
+        return false;
+
+    ring->storage = storage;
+    ring->block_len = block_len;
+    ring->block_count = block_count;
+    capture_ring_reset(ring);
+    return true;
+}
+
+void capture_ring_reset(capture_ring_t *ring) {
+    ring->head = 0;
+    ring->tail = 0;
+    ring->overruns = 0;
+}
+
+uint16_t *capture_ring_commit(capture_ring_t *ring) {
+    uint32_t head = ring->head + 1;
+    ring->head = head;
+    // Block `head` wird gerade vom anderen Kanal beschrieben,
+    // der freigewordene Kanal übernimmt den übernächsten.
+    return capture_ring_block(ring, head + 1);
+}
+
+const uint16_t *capture_ring_peek(capture_ring_t *ring, uint32_t *seq) {
+    uint32_t head = ring->head;
+    uint32_t cap = capture_ring_capacity(ring);
+
+    // Ungelesene Blöcke, die inzwischen wieder beschrieben werden, verwerfen
+    if (head - ring->tail > cap) {
+        ring->overruns += (head - ring->tail) - cap;
+        ring->tail = head - cap;
+    }
+    if (head == ring->tail)
+        return NULL;
+
+    if (seq)
+        *seq = ring->tail;
+    return capture_ring_block(ring, ring->tail);
+}
+
+uint32_t capture_ring_skip_to_latest(capture_ring_t *ring) {
+    uint32_t head = ring->head;
+    if (head - ring->tail <= 1)
+        return 0;
+
+    uint32_t skipped = head - 1 - ring->tail;
+    ring->tail = head - 1;
+    return skipped;
+}
+
+bool capture_ring_release(capture_ring_t *ring, uint32_t seq) {
+    // Nur gültig, wenn der Block nicht schon wieder der DMA übergeben wurde
+    bool valid = (ring->head - seq) <= capture_ring_capacity(ring);
+    ring->tail = seq + 1;
+    if (!valid)
+        ring->overruns++;
+    return valid;
+}
@@ -0,0 +1,72 @@
+// capture_ring.h
+// Block-Ringpuffer für die DMA-gestützte ADC-Erfassung.
+//
+// Der Produzent (DMA-IRQ) schreibt immer in die zwei Blöcke hinter `head`
+// (Ping-Pong der beiden verketteten DMA-Kanäle) und meldet jeden fertigen
+// Block mit capture_ring_commit(). Der Konsument liest fertige Blöcke ab
+// `tail`. `head` schreibt nur der Produzent, `tail` und `overruns` nur der
+// Konsument, daher kommt der Ring ohne Sperren aus. Die Buchhaltung ist
+// reines C ohne SDK-Abhängigkeiten und baut daher auch auf dem Host.
+
+#ifndef CAPTURE_RING_H
+#define CAPTURE_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Anzahl gleichzeitig von der DMA beschriebener Blöcke (Ping + Pong)
+#define CAPTURE_RING_IN_FLIGHT 2
+
+typedef struct {
+    uint16_t *storage;          // block_count * block_len Samples
+    uint32_t block_len;         // Samples pro Block
+    uint32_t block_count;       // Zweierpotenz >= CAPTURE_RING_IN_FLIGHT + 1
+    volatile uint32_t head;     // Anzahl fertiger Blöcke (monoton, läuft über)
+    volatile uint32_t tail;     // Anzahl gelesener/verworfener Blöcke
+    uint32_t overruns;          // Blöcke, die ungelesen überschrieben wurden
+} capture_ring_t;
+
+// Initialisiert den Ring. Gibt false zurück, wenn block_count zu klein oder
+// keine Zweierpotenz ist (sonst springt der Index beim Überlauf von `head`).
+bool capture_ring_init(capture_ring_t *ring, uint16_t *storage,
+                       uint32_t block_len, uint32_t block_count);
+
+// Setzt Zähler zurück, Speicher bleibt zugeordnet.
+void capture_ring_reset(capture_ring_t *ring);
+
+// Speicheradresse des Blocks mit fortlaufender Nummer `seq`.
+static inline uint16_t *capture_ring_block(const capture_ring_t *ring, uint32_t seq) {
+    return ring->storage + (seq & (ring->block_count - 1)) * ring->block_len;
+}
+
+// Produzent: Block `head` ist fertig. Ist der Ring voll, überschreibt die
+// DMA den ältesten ungelesenen Block; der Konsument zählt das beim nächsten
+// capture_ring_peek() als Overrun.
+// Rückgabe: Block, in den der soeben freigewordene DMA-Kanal als nächstes schreibt.
+uint16_t *capture_ring_commit(capture_ring_t *ring);
+
+// Blöcke, die maximal ungelesen im Ring liegen können.
+static inline uint32_t capture_ring_capacity(const capture_ring_t *ring) {
+    return ring->block_count - CAPTURE_RING_IN_FLIGHT;
+}
+
+// Anzahl fertiger, noch nicht gelesener Blöcke.
+static inline uint32_t capture_ring_available(const capture_ring_t *ring) {
+    uint32_t n = ring->head - ring->tail;
+    uint32_t cap = capture_ring_capacity(ring);
+    return n > cap ? cap : n;
+}
+
+// Konsument: ältesten fertigen Block holen (NULL, wenn keiner bereit ist).
+// `seq` erhält optional die fortlaufende Blocknummer.
+const uint16_t *capture_ring_peek(capture_ring_t *ring, uint32_t *seq);
+
+// Konsument: alle Blöcke bis auf den neuesten verwerfen (zählt nicht als Overrun).
+// Rückgabe: Anzahl übersprungener Blöcke.
+uint32_t capture_ring_skip_to_latest(capture_ring_t *ring);
+
+// Konsument: Block `seq` freigeben. Gibt false zurück, wenn der Block
+// während des Lesens bereits vom Produzenten überschrieben wurde.
+bool capture_ring_release(capture_ring_t *ring, uint32_t seq);
+
+#endif // CAPTURE_RING_H
@@ -0,0 +1,200 @@
+# Gemeinsame Module für alle Pico-Projekte in diesem Repository.
+#
+# Einbinden nach pico_sdk_init():
+#     include(${CMAKE_CURRENT_LIST_DIR}/../common/common.cmake)
+# und die benötigten Bibliotheken per target_link_libraries() hinzufügen.
+
+set(PPS_COMMON_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+# Die Host-Simulation (host_sim/) ersetzt die DMA-Erfassung und den
+# PIO-Pulssequenzer durch eigene Implementierungen
+if (NOT DEFINED PPS_ADC_CAPTURE_IMPL)
+    set(PPS_ADC_CAPTURE_IMPL ${PPS_COMMON_DIR}/adc_capture.c)
+endif()
+if (NOT DEFINED PPS_PULSE_SEQ_IMPL)
+    set(PPS_PULSE_SEQ_IMPL ${PPS_COMMON_DIR}/pulse_seq_pio.c)
+    set(PPS_PULSE_SEQ_PIO ON)
+endif()
+
+# DMA-gestützte ADC-Erfassung (Ringpuffer + Free-Running-ADC)
+if (NOT TARGET pps_capture)
+    add_library(pps_capture INTERFACE)
+    target_sources(pps_capture INTERFACE
+            ${PPS_COMMON_DIR}/capture_ring.c
+            ${PPS_ADC_CAPTURE_IMPL}
+            )
+    target_include_directories(pps_capture INTERFACE ${PPS_COMMON_DIR})
+    target_link_libraries(pps_capture INTERFACE
+            hardware_adc
+            hardware_dma
+            hardware_irq)
+endif()
+
+# Prüfsummen (CRC-16, CRC-32)
+if (NOT TARGET pps_crc)
+    add_library(pps_crc INTERFACE)
+    target_sources(pps_crc INTERFACE ${PPS_COMMON_DIR}/crc.c)
+    target_include_directories(pps_crc INTERFACE ${PPS_COMMON_DIR})
+endif()
+
+# Binäre Telemetrie-Frames
+if (NOT TARGET pps_telemetry)
+    add_library(pps_telemetry INTERFACE)
+    target_sources(pps_telemetry INTERFACE ${PPS_COMMON_DIR}/telemetry.c)
+    target_include_directories(pps_telemetry INTERFACE ${PPS_COMMON_DIR})
+    target_link_libraries(pps_telemetry INTERFACE pico_stdlib pps_crc)
+endif()
+
+# Kalibrierdatensätze im Flash (A/B-Sektoren)
+if (NOT TARGET pps_cal_store)
+    add_library(pps_cal_store INTERFACE)
+    target_sources(pps_cal_store INTERFACE
+            ${PPS_COMMON_DIR}/cal_store.c
+            ${PPS_COMMON_DIR}/cal_store_flash.c
+            )
+    target_include_directories(pps_cal_store INTERFACE ${PPS_COMMON_DIR})
+    target_link_libraries(pps_cal_store INTERFACE
+            pico_stdlib
+            hardware_flash
+            hardware_sync
+            pps_crc)
+endif()
+
+# Q16.16-Festkomma (nur Header)
+if (NOT TARGET pps_fixed)
+    add_library(pps_fixed INTERFACE)
+    target_include_directories(pps_fixed INTERFACE ${PPS_COMMON_DIR})
+endif()
+
+# PID-Regler in Festkomma
+if (NOT TARGET pps_pid)
+    add_library(pps_pid INTERFACE)
+    target_sources(pps_pid INTERFACE ${PPS_COMMON_DIR}/pid.c)
+    target_include_directories(pps_pid INTERFACE ${PPS_COMMON_DIR})
+endif()
+
+# Adaptiver Kalibrier-Sweep (Einschwing-Erkennung, nicht-äquidistante Tabelle)
+if (NOT TARGET pps_adaptive_sweep)
+    add_library(pps_adaptive_sweep INTERFACE)
+    target_sources(pps_adaptive_sweep INTERFACE ${PPS_COMMON_DIR}/adaptive_sweep.c)
+    target_include_directories(pps_adaptive_sweep INTERFACE ${PPS_COMMON_DIR})
+    target_link_libraries(pps_adaptive_sweep INTERFACE pps_fixed)
+endif()
+
+# Sperrfreier SPSC-Ringpuffer (z.B. Core1 -> Core0)
+if (NOT TARGET pps_spsc_ring)
+    add_library(pps_spsc_ring INTERFACE)
+    target_sources(pps_spsc_ring INTERFACE ${PPS_COMMON_DIR}/spsc_ring.c)
+    target_include_directories(pps_spsc_ring INTERFACE ${PPS_COMMON_DIR})
+endif()
+
+# Pulsfolgen per PIO + DMA (Tabellen-Encoder ist reines C)
+if (NOT TARGET pps_pulse_seq)
+    add_library(pps_pulse_seq INTERFACE)
+    target_sources(pps_pulse_seq INTERFACE
+            ${PPS_COMMON_DIR}/pulse_seq.c
+            ${PPS_PULSE_SEQ_IMPL}
+            )
+    target_include_directories(pps_pulse_seq INTERFACE ${PPS_COMMON_DIR})
+    if (PPS_PULSE_SEQ_PIO)
+        pico_generate_pio_header(pps_pulse_seq ${PPS_COMMON_DIR}/pulse_seq.pio)
+    endif()
+    target_link_libraries(pps_pulse_seq INTERFACE
+            hardware_pio
+            hardware_dma
+            hardware_clocks)
+endif()
+
+# Trigger mit Vorgeschichte (Oszilloskop-Modus)
+if (NOT TARGET pps_trigger)
+    add_library(pps_trigger INTERFACE)
+    target_sources(pps_trigger INTERFACE ${PPS_COMMON_DIR}/trigger.c)
+    target_include_directories(pps_trigger INTERFACE ${PPS_COMMON_DIR})
+endif()
+
+# Flanken- und Pulsanalyse in einem Durchlauf
+if (NOT TARGET pps_edge_analyzer)
+    add_library(pps_edge_analyzer INTERFACE)
+    target_sources(pps_edge_analyzer INTERFACE ${PPS_COMMON_DIR}/edge_analyzer.c)
+    target_include_directories(pps_edge_analyzer INTERFACE ${PPS_COMMON_DIR})
+endif()
+
+# Nachgeführter Dunkelpegel
+if (NOT TARGET pps_baseline)
+    add_library(pps_baseline INTERFACE)
+    target_sources(pps_baseline INTERFACE ${PPS_COMMON_DIR}/baseline.c)
+    target_include_directories(pps_baseline INTERFACE ${PPS_COMMON_DIR})
+endif()
+
+# Log-lineares Latenz-Histogramm
+if (NOT TARGET pps_latency_hist)
+    add_library(pps_latency_hist INTERFACE)
+    target_sources(pps_latency_hist INTERFACE ${PPS_COMMON_DIR}/latency_hist.c)
+    target_include_directories(pps_latency_hist INTERFACE ${PPS_COMMON_DIR})
+endif()
+
+# Segmentierter Messspeicher (trigger-ausgerichtete Fenster ohne Totzeit)
+if (NOT TARGET pps_segment_store)
+    add_library(pps_segment_store INTERFACE)
+    target_sources(pps_segment_store INTERFACE ${PPS_COMMON_DIR}/segment_store.c)
+    target_include_directories(pps_segment_store INTERFACE ${PPS_COMMON_DIR})
+    target_link_libraries(pps_segment_store INTERFACE pps_trigger)
+endif()
+
+# Kohärente Mittelung wiederholter Pulsantworten
+if (NOT TARGET pps_ensemble)
+    add_library(pps_ensemble INTERFACE)
+    target_sources(pps_ensemble INTERFACE ${PPS_COMMON_DIR}/ensemble.c)
+    target_include_directories(pps_ensemble INTERFACE ${PPS_COMMON_DIR})
+endif()
+
+# Dezimierung (Boxcar, CIC, FIR) auf den DMA-Blöcken
+if (NOT TARGET pps_decimator)
+    add_library(pps_decimator INTERFACE)
+    target_sources(pps_decimator INTERFACE ${PPS_COMMON_DIR}/decimator.c)
+    target_include_directories(pps_decimator INTERFACE ${PPS_COMMON_DIR})
+endif()
+
+# Round-Robin-Strom auf Kanäle aufteilen, je Kanal dezimiert
+if (NOT TARGET pps_adc_multi)
+    add_library(pps_adc_multi INTERFACE)
+    target_sources(pps_adc_multi INTERFACE ${PPS_COMMON_DIR}/adc_multi.c)
+    target_include_directories(pps_adc_multi INTERFACE ${PPS_COMMON_DIR})
+    target_link_libraries(pps_adc_multi INTERFACE pps_decimator)
+endif()
+
+# Reaktionstabelle über Tastgrad und Temperatur (bilinear, lernt im Betrieb)
+if (NOT TARGET pps_reaction_map)
+    add_library(pps_reaction_map INTERFACE)
+    target_sources(pps_reaction_map INTERFACE ${PPS_COMMON_DIR}/reaction_map.c)
+    target_include_directories(pps_reaction_map INTERFACE ${PPS_COMMON_DIR})
+    target_link_libraries(pps_reaction_map INTERFACE pps_fixed)
+endif()
+
+# Lock-in-Demodulation (I/Q mit Sinus-Tabelle, kohärente Abtastung)
+if (NOT TARGET pps_lockin)
+    add_library(pps_lockin INTERFACE)
+    target_sources(pps_lockin INTERFACE ${PPS_COMMON_DIR}/lockin.c)
+    target_include_directories(pps_lockin INTERFACE ${PPS_COMMON_DIR})
+    target_link_libraries(pps_lockin INTERFACE pps_fixed)
+endif()
+
+# Goertzel-Filter (eine DFT-Linie pro Block, Festkomma)
+if (NOT TARGET pps_goertzel)
+    add_library(pps_goertzel INTERFACE)
+    target_sources(pps_goertzel INTERFACE ${PPS_COMMON_DIR}/goertzel.c)
+    target_include_directories(pps_goertzel INTERFACE ${PPS_COMMON_DIR})
+endif()
+
+# PWM-Teiler und wrap aus dem Systemtakt (feinste Auflösung je Frequenz)
+if (NOT TARGET pps_pwm_timing)
+    add_library(pps_pwm_timing INTERFACE)
+    target_sources(pps_pwm_timing INTERFACE
+            ${PPS_COMMON_DIR}/pwm_timing.c
+            ${PPS_COMMON_DIR}/pwm_timing_pico.c
+            )
+    target_include_directories(pps_pwm_timing INTERFACE ${PPS_COMMON_DIR})
+    target_link_libraries(pps_pwm_timing INTERFACE
+            hardware_clocks
+            hardware_pwm)
+endif()
@@ -0,0 +1,25 @@
+// crc.h
+// Prüfsummen für Telemetrie-Frames und Flash-Datensätze.
+
+#ifndef CRC_H
+#define CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CRC16_INIT 0xFFFFu
+#define CRC32_INIT 0xFFFFFFFFu
+
+// CRC-16/CCITT-FALSE (Polynom 0x1021, Start 0xFFFF, ohne Reflexion).
+// Für fortgesetzte Berechnung das Ergebnis als `crc` wieder übergeben.
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, size_t len);
+
+// CRC-32 (IEEE 802.3, reflektiert, wie zlib). Start mit CRC32_INIT, das
+// Endergebnis mit 0xFFFFFFFF verknüpfen (crc32_final).
+uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len);
+
+static inline uint32_t crc32_final(uint32_t crc) {
+    return crc ^ 0xFFFFFFFFu;
+}
+
+#endif // CRC_H
@@ -0,0 +1,175 @@
+// decimator.c
+// Ganzzahlige Dezimierung (siehe decimator.h).
+
+#include <math.h>
+#include <stddef.h>
+#include "decimator.h"
+
+#define ADC_BITS 12
+
+// Kleinstes b mit 2^b >= v
+static uint32_t ceil_log2(uint32_t v) {
+    uint32_t b = 0;
+    while ((1u << b) < v)
+        b++;
+    return b;
+}
+
+bool decimator_init(decimator_t *d, const decimator_config_t *cfg) {
+    if (cfg->ratio == 0 || cfg->ratio > DECIMATOR_MAX_RATIO)
+        return false;
+
+    d->cfg = *cfg;
+    uint64_t gain = 1;
+
+    switch (cfg->type) {
+    case DECIMATOR_BOXCAR:
+        gain = cfg->ratio;
+        break;
+    case DECIMATOR_CIC:
+        if (cfg->order == 0 || cfg->order > DECIMATOR_MAX_ORDER
+            || ADC_BITS + cfg->order * ceil_log2(cfg->ratio) > 32)
+            return false;
+        for (uint8_t i = 0; i < cfg->order; i++)
+            gain *= cfg->ratio;
+        break;
+    case DECIMATOR_FIR:
+        if (cfg->taps == 0 || cfg->taps > DECIMATOR_MAX_TAPS || cfg->coef == NULL)
+            return false;
+        for (uint8_t i = 0; i < cfg->taps; i++)
+            d->coef[i] = cfg->coef[i];
+        d->cfg.coef = d->coef;
+        break;
+    default:
+        return false;
+    }
+
+    // Kehrwert der Verstärkung inkl. Nachkommabits; Summe * scale bleibt
+    // unter 2^12 * 2^OUT_SHIFT * 2^32 und passt in 64 Bit
+    d->scale = (((uint64_t)1 << (32 + DECIMATOR_OUT_SHIFT)) + gain / 2) / gain;
+    decimator_reset(d);
+    return true;
+}
+
+void decimator_reset(decimator_t *d) {
+    d->phase = 0;
+    d->acc = 0;
+    for (int i = 0; i < DECIMATOR_MAX_ORDER; i++) {
+        d->integ[i] = 0;
+        d->comb[i] = 0;
+    }
+    for (int i = 0; i < DECIMATOR_MAX_TAPS; i++)
+        d->history[i] = 0;
+    d->history_pos = 0;
+}
+
+static uint16_t scale_out(const decimator_t *d, uint32_t sum) {
+    uint64_t v = ((uint64_t)sum * d->scale + (1u << 31)) >> 32;
+    return v > UINT16_MAX ? UINT16_MAX : (uint16_t)v;
+}
+
+static uint32_t process_boxcar(decimator_t *d, const uint16_t *in, uint32_t n, uint16_t *out) {
+    const uint32_t ratio = d->cfg.ratio;
+    uint32_t phase = d->phase, acc = d->acc, m = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        acc += in[i];
+        if (++phase == ratio) {
+            out[m++] = scale_out(d, acc);
+            acc = 0;
+            phase = 0;
+        }
+    }
+    d->phase = phase;
+    d->acc = acc;
+    return m;
+}
+
+static uint32_t process_cic(decimator_t *d, const uint16_t *in, uint32_t n, uint16_t *out) {
+    const uint32_t ratio = d->cfg.ratio;
+    const uint8_t order = d->cfg.order;
+    uint32_t phase = d->phase, m = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        // Integratoren mit voller Rate (Überlauf ist gewollt)
+        uint32_t v = in[i];
+        for (uint8_t k = 0; k < order; k++) {
+            d->integ[k] += v;
+            v = d->integ[k];
+        }
+        if (++phase < ratio)
+            continue;
+        phase = 0;
+
+        // Kammstufen mit der Ausgangsrate
+        for (uint8_t k = 0; k < order; k++) {
+            uint32_t prev = d->comb[k];
+            d->comb[k] = v;
+            v -= prev;
+        }
+        out[m++] = scale_out(d, v);
+    }
+    d->phase = phase;
+    return m;
+}
+
+static uint32_t process_fir(decimator_t *d, const uint16_t *in, uint32_t n, uint16_t *out) {
+    const uint32_t ratio = d->cfg.ratio;
+    const uint8_t taps = d->cfg.taps;
+    uint32_t phase = d->phase, m = 0;
+    uint8_t pos = d->history_pos;
+
+    for (uint32_t i = 0; i < n; i++) {
+        d->history[pos] = in[i];
+        pos = pos + 1 == taps ? 0 : pos + 1;
+        if (++phase < ratio)
+            continue;
+        phase = 0;
+
+        // Faltung über den Ring, ältester Sample zuerst
+        int32_t acc = 0;
+        uint8_t j = pos;
+        for (uint8_t k = 0; k < taps; k++) {
+            acc += (int32_t)d->coef[k] * d->history[j];
+            j = j + 1 == taps ? 0 : j + 1;
+        }
+        int32_t v = (acc + (1 << (14 - DECIMATOR_OUT_SHIFT))) >> (15 - DECIMATOR_OUT_SHIFT);
+        out[m++] = v < 0 ? 0 : v > UINT16_MAX ? UINT16_MAX : (uint16_t)v;
+    }
+    d->phase = phase;
+    d->history_pos = pos;
+    return m;
+}
+
+uint32_t decimator_process(decimator_t *d, const uint16_t *in, uint32_t n, uint16_t *out) {
+    switch (d->cfg.type) {
+    case DECIMATOR_BOXCAR: return process_boxcar(d, in, n, out);
+    case DECIMATOR_CIC:    return process_cic(d, in, n, out);
+    case DECIMATOR_FIR:    return process_fir(d, in, n, out);
+    default:               return 0;
+    }
+}
+
+void decimator_fir_design(int16_t *coef, uint8_t taps, uint32_t ratio) {
+    const float pi = 3.14159265f;
+    const float fc = 0.5f / (float)ratio;       // Grenzfrequenz relativ zu fs
+    const float mid = (taps - 1) / 2.0f;
+    float h[DECIMATOR_MAX_TAPS];
+    float sum = 0.0f;
+
+    for (uint8_t k = 0; k < taps; k++) {
+        float x = k - mid;
+        float sinc = x == 0.0f ? 2.0f * fc : sinf(2.0f * pi * fc * x) / (pi * x);
+        float window = taps > 1 ? 0.54f - 0.46f * cosf(2.0f * pi * k / (taps - 1)) : 1.0f;
+        h[k] = sinc * window;
+        sum += h[k];
+    }
+
+    // Auf Verstärkung 1 normieren, Rundungsrest in den mittleren Koeffizienten
+    int32_t total = 0;
+    for (uint8_t k = 0; k < taps; k++) {
+        coef[k] = (int16_t)lroundf(h[k] / sum * 32768.0f);
+        total += coef[k];
+    }
+    coef[taps / 2] += (int16_t)(32768 - total);
+}
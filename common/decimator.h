@@ -0,0 +1,75 @@
+// decimator.h
+// Ganzzahlige Dezimierung eines 12-Bit-Sample-Stroms: Boxcar, CIC oder
+// kurzes FIR, Faktor zur Laufzeit einstellbar.
+//
+// Die Stufe arbeitet direkt auf den DMA-Blöcken und behält ihren Zustand
+// über Blockgrenzen hinweg. Aus `ratio` Eingangssamples wird ein Ausgangs-
+// sample; Ausgang j gehört zum Eingangsindex (j + 1) * ratio - 1. Der
+// Ausgang hat DECIMATOR_OUT_SHIFT Nachkommabits (1/16 ADC-Schritt), damit
+// der Auflösungsgewinn durch die Mittelung nicht verloren geht.
+//
+// - Boxcar: Mittelwert über je `ratio` Samples (Nullstellen bei fs/ratio).
+// - CIC der Ordnung N: N Integratoren mit voller Rate, N Kammstufen mit der
+//   Ausgangsrate, Modulo-2^32-Arithmetik. Verstärkung ratio^N, daher muss
+//   12 + N * ceil(log2(ratio)) <= 32 gelten. Stärkere Sperrdämpfung als
+//   Boxcar, ohne Multiplikation pro Eingangssample.
+// - FIR: bis DECIMATOR_MAX_TAPS Koeffizienten in Q15, nur jedes `ratio`-te
+//   Ausgangssample wird berechnet. decimator_fir_design() liefert einen
+//   gefensterten Tiefpass mit Grenzfrequenz fs / (2 * ratio).
+//
+// Die Ausgabe wird mit einem vorberechneten Kehrwert skaliert, es gibt
+// keine Division pro Sample. Reines C, baut auch auf dem Host.
+
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DECIMATOR_OUT_SHIFT 4
+#define DECIMATOR_MAX_ORDER 4
+#define DECIMATOR_MAX_TAPS 32
+#define DECIMATOR_MAX_RATIO (1u << 20)     // Boxcar-Summe: 12 + 20 Bit
+
+typedef enum {
+    DECIMATOR_BOXCAR = 0,
+    DECIMATOR_CIC,
+    DECIMATOR_FIR,
+} decimator_type_t;
+
+typedef struct {
+    decimator_type_t type;
+    uint32_t ratio;         // Dezimierungsfaktor >= 1
+    uint8_t order;          // CIC: 1..DECIMATOR_MAX_ORDER
+    uint8_t taps;           // FIR: 1..DECIMATOR_MAX_TAPS
+    const int16_t *coef;    // FIR: Koeffizienten in Q15 (Summe 32768), wird kopiert
+} decimator_config_t;
+
+typedef struct {
+    decimator_config_t cfg;
+    uint32_t phase;                         // Eingangssamples seit der letzten Ausgabe
+    uint32_t acc;                           // Boxcar-Summe
+    uint32_t integ[DECIMATOR_MAX_ORDER];    // CIC-Integratoren
+    uint32_t comb[DECIMATOR_MAX_ORDER];     // CIC-Kammstufen (vorheriger Wert)
+    uint64_t scale;                         // Ausgabe = Summe * scale >> 32
+    int16_t coef[DECIMATOR_MAX_TAPS];
+    uint16_t history[DECIMATOR_MAX_TAPS];   // FIR: letzte Eingangssamples (Ring)
+    uint8_t history_pos;
+} decimator_t;
+
+// Einrichten; false bei ungültiger Konfiguration (Faktor, Ordnung,
+// Bitbreite des CIC, Anzahl Koeffizienten).
+bool decimator_init(decimator_t *d, const decimator_config_t *cfg);
+
+// Zustand löschen (nächstes Ausgangssample nach `ratio` neuen Samples).
+void decimator_reset(decimator_t *d);
+
+// `n` Eingangssamples verarbeiten, Ausgangssamples nach `out` schreiben
+// (höchstens n / ratio + 1). Rückgabe: Anzahl geschriebener Samples.
+uint32_t decimator_process(decimator_t *d, const uint16_t *in, uint32_t n, uint16_t *out);
+
+// Gefensterter Tiefpass (Hamming) mit `taps` Koeffizienten für `ratio` >= 2,
+// Summe genau 32768. Rechnet in float, nur zur Konfiguration gedacht.
+void decimator_fir_design(int16_t *coef, uint8_t taps, uint32_t ratio);
+
+#endif // DECIMATOR_H
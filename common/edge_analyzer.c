@@ -0,0 +1,97 @@
+// edge_analyzer.c
+// Flanken- und Pulsanalyse in einem Durchlauf (siehe edge_analyzer.h).
+
+#include <stddef.h>
+#include "edge_analyzer.h"
+
+static void phase_reset(edge_phase_t *p) {
+    p->count = 0;
+    p->sum = 0;
+    p->min = UINT16_MAX;
+    p->max = 0;
+}
+
+static inline void phase_add(edge_phase_t *p, uint16_t v) {
+    p->count++;
+    p->sum += v;
+    if (v < p->min)
+        p->min = v;
+    if (v > p->max)
+        p->max = v;
+}
+
+void edge_analyzer_init(edge_analyzer_t *ea, const edge_analyzer_config_t *cfg,
+                        edge_pulse_t *pulses, uint16_t max_pulses) {
+    ea->cfg = *cfg;
+    ea->pulses = pulses;
+    ea->max_pulses = max_pulses;
+    edge_analyzer_reset(ea);
+}
+
+void edge_analyzer_reset(edge_analyzer_t *ea) {
+    ea->count = 0;
+    ea->dropped = 0;
+    phase_reset(&ea->baseline);
+    ea->phase = &ea->baseline;
+    ea->index = 0;
+    ea->started = false;
+}
+
+static void rising_edge(edge_analyzer_t *ea) {
+    if (ea->count >= ea->max_pulses) {
+        ea->dropped++;
+        ea->phase = NULL;
+        return;
+    }
+    edge_pulse_t *p = &ea->pulses[ea->count++];
+    p->rise_q16 = ea->cross_q16;
+    p->fall_q16 = -1;
+    phase_reset(&p->on);
+    phase_reset(&p->off);
+    ea->phase = &p->on;
+}
+
+static void falling_edge(edge_analyzer_t *ea) {
+    // Nur Pulse mit gesehener steigender Flanke abschließen; war das Signal
+    // schon zu Beginn high, bleibt es bei der Grundlinie
+    if (ea->count == 0 || ea->phase != &ea->pulses[ea->count - 1].on)
+        return;
+    edge_pulse_t *p = &ea->pulses[ea->count - 1];
+    p->fall_q16 = ea->cross_q16;
+    ea->phase = &p->off;
+}
+
+void edge_analyzer_feed(edge_analyzer_t *ea, const uint16_t *samples, uint32_t n) {
+    const int32_t level = ea->cfg.level;
+    const int32_t hi = level + ea->cfg.hysteresis;
+    const int32_t lo = level - ea->cfg.hysteresis;
+
+    for (uint32_t i = 0; i < n; i++) {
+        int32_t v = samples[i];
+        uint32_t idx = ea->index++;
+
+        if (!ea->started) {
+            ea->started = true;
+            ea->high = v >= level;
+            ea->cross_q16 = (int64_t)idx << 16;
+        } else {
+            int32_t prev = ea->prev;
+            // Durchgang durch die Schwelle merken, linear interpoliert
+            if ((prev < level) != (v < level))
+                ea->cross_q16 = ((int64_t)(idx - 1) << 16)
+                              + ((int64_t)(level - prev) << 16) / (v - prev);
+
+            if (!ea->high && v >= hi) {
+                ea->high = true;
+                rising_edge(ea);
+            } else if (ea->high && v <= lo) {
+                ea->high = false;
+                falling_edge(ea);
+            }
+        }
+
+        if (ea->phase != NULL)
+            phase_add(ea->phase, (uint16_t)v);
+        ea->prev = (uint16_t)v;
+    }
+}
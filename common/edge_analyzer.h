@@ -0,0 +1,81 @@
+// edge_analyzer.h
+// Flanken- und Pulsanalyse in einem Durchlauf über den Sample-Strom.
+//
+// Jeder Sample wird genau einmal angefasst. Flanken werden mit Hysterese
+// erkannt (Schmitt-Trigger): high gilt ab `level + hysteresis`, low ab
+// `level - hysteresis`; Rauschen um die Schwelle erzeugt keine Scheinflanken.
+// Der Flankenzeitpunkt ist der letzte Durchgang durch `level` vor der
+// Bestätigung, linear zwischen den beiden Nachbarsamples interpoliert
+// (Sample-Index in Q16, d.h. 1/65536 Sample Auflösung).
+//
+// Nebenbei werden pro Puls Summe, Anzahl, Minimum und Maximum der High-Phase
+// und der anschließenden Low-Phase (bis zur nächsten steigenden Flanke bzw.
+// bis zum Ende der Daten) gesammelt. Samples vor der ersten steigenden
+// Flanke landen in `baseline`. Mehrere Pulse pro Puffer werden unterstützt.
+//
+// Reines C ohne SDK-Abhängigkeiten, baut auch auf dem Host.
+
+#ifndef EDGE_ANALYZER_H
+#define EDGE_ANALYZER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    uint32_t count;
+    uint32_t sum;
+    uint16_t min;
+    uint16_t max;
+} edge_phase_t;
+
+typedef struct {
+    int64_t rise_q16;       // steigende Flanke, Sample-Index in Q16
+    int64_t fall_q16;       // fallende Flanke (-1 solange der Puls läuft)
+    edge_phase_t on;        // High-Phase
+    edge_phase_t off;       // Low-Phase nach dem Puls
+} edge_pulse_t;
+
+typedef struct {
+    uint16_t level;         // Schwelle in ADC-Schritten
+    uint16_t hysteresis;    // halbe Breite des Hysteresebands
+} edge_analyzer_config_t;
+
+typedef struct {
+    edge_analyzer_config_t cfg;
+    edge_pulse_t *pulses;
+    uint16_t max_pulses;
+    uint16_t count;         // begonnene Pulse in `pulses`
+    uint32_t dropped;       // Pulse, die nicht mehr in `pulses` gepasst haben
+    edge_phase_t baseline;  // Samples vor der ersten steigenden Flanke
+    edge_phase_t *phase;    // aktuell gesammelte Phase (NULL bei Überlauf)
+
+    uint32_t index;         // Index des nächsten Samples
+    uint16_t prev;
+    bool high;
+    bool started;           // mindestens ein Sample gesehen
+    int64_t cross_q16;      // letzter Durchgang durch `level`
+} edge_analyzer_t;
+
+// Einrichten; `pulses` nimmt bis zu `max_pulses` Pulse auf.
+void edge_analyzer_init(edge_analyzer_t *ea, const edge_analyzer_config_t *cfg,
+                        edge_pulse_t *pulses, uint16_t max_pulses);
+
+// Neuen Puffer beginnen (Index 0, Ergebnisse verwerfen).
+void edge_analyzer_reset(edge_analyzer_t *ea);
+
+// `n` Samples anhängen (Index läuft über mehrere Aufrufe weiter).
+void edge_analyzer_feed(edge_analyzer_t *ea, const uint16_t *samples, uint32_t n);
+
+// Vollständige Pulse (mit fallender Flanke)
+static inline uint16_t edge_analyzer_complete(const edge_analyzer_t *ea) {
+    if (ea->count > 0 && ea->pulses[ea->count - 1].fall_q16 < 0)
+        return ea->count - 1;
+    return ea->count;
+}
+
+// Mittelwert einer Phase in ADC-Schritten (0 bei leerer Phase)
+static inline float edge_phase_mean(const edge_phase_t *p) {
+    return p->count > 0 ? (float)p->sum / (float)p->count : 0.0f;
+}
+
+#endif // EDGE_ANALYZER_H
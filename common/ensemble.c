@@ -0,0 +1,39 @@
+// ensemble.c
+// Kohärente Mittelung (siehe ensemble.h).
+
+#include "ensemble.h"
+
+void ensemble_init(ensemble_t *e, uint32_t *sum, uint64_t *sum_sq, uint32_t len) {
+    e->sum = sum;
+    e->sum_sq = sum_sq;
+    e->len = len;
+    ensemble_reset(e);
+}
+
+void ensemble_reset(ensemble_t *e) {
+    for (uint32_t k = 0; k < e->len; k++) {
+        e->sum[k] = 0;
+        e->sum_sq[k] = 0;
+    }
+    e->count = 0;
+}
+
+bool ensemble_add(ensemble_t *e, const uint16_t *samples) {
+    if (e->count >= ENSEMBLE_MAX_COUNT)
+        return false;
+    for (uint32_t k = 0; k < e->len; k++) {
+        uint32_t v = samples[k];
+        e->sum[k] += v;
+        e->sum_sq[k] += v * v;
+    }
+    e->count++;
+    return true;
+}
+
+float ensemble_variance(const ensemble_t *e, uint32_t k) {
+    if (e->count < 2)
+        return 0.0f;
+    double mean = (double)e->sum[k] / e->count;
+    double var = (double)e->sum_sq[k] / e->count - mean * mean;
+    return var > 0.0 ? (float)var : 0.0f;
+}
@@ -0,0 +1,47 @@
+// ensemble.h
+// Kohärente Mittelung (Ensemble-Mittel) wiederholter Pulsantworten.
+//
+// Jede Aufnahme ist auf die kommandierte Flanke ausgerichtet und wird
+// Sample für Sample aufsummiert: Summe in 32 Bit, Quadratsumme in 64 Bit.
+// Das Rauschen sinkt mit 1/sqrt(M), die Zeitauflösung bleibt voll erhalten;
+// ausgegeben werden nur Mittelwert und Varianz je Sample.
+//
+// 32 Bit reichen für ENSEMBLE_MAX_COUNT (gut eine Million) 12-Bit-
+// Aufnahmen; ensemble_add() nimmt darüber nichts mehr an.
+//
+// Reines C, baut auch auf dem Host.
+
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Höchstzahl Aufnahmen, bevor die 32-Bit-Summe eines 12-Bit-Samples überläuft
+#define ENSEMBLE_MAX_COUNT (UINT32_MAX / 4095u)
+
+typedef struct {
+    uint32_t *sum;          // len Einträge
+    uint64_t *sum_sq;       // len Einträge
+    uint32_t len;
+    uint32_t count;         // aufsummierte Aufnahmen
+} ensemble_t;
+
+void ensemble_init(ensemble_t *e, uint32_t *sum, uint64_t *sum_sq, uint32_t len);
+
+// Summen löschen.
+void ensemble_reset(ensemble_t *e);
+
+// Eine ausgerichtete Aufnahme von `len` Samples aufsummieren.
+// Gibt false zurück (ohne zu summieren), wenn ENSEMBLE_MAX_COUNT erreicht ist.
+bool ensemble_add(ensemble_t *e, const uint16_t *samples);
+
+// Mittelwert von Sample `k` in ADC-Schritten (0 ohne Aufnahmen)
+static inline float ensemble_mean(const ensemble_t *e, uint32_t k) {
+    return e->count > 0 ? (float)e->sum[k] / (float)e->count : 0.0f;
+}
+
+// Varianz von Sample `k` über die Aufnahmen in ADC-Schritten^2
+float ensemble_variance(const ensemble_t *e, uint32_t k);
+
+#endif // ENSEMBLE_H
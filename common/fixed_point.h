@@ -0,0 +1,60 @@
+// fixed_point.h
+// Q16.16-Festkomma für Mess- und Regelpfade ohne FPU.
+//
+// Der Cortex-M0+ des RP2040 hat keine FPU; jede float-Operation ist ein
+// Aufruf der Soft-Float-Bibliothek. Ganzzahl-Divisionen laufen dagegen über
+// den Hardware-Dividierer im SIO (8 Takte), 32x32->64-Multiplikationen
+// kosten nur wenige Befehle. Alle Funktionen hier sind reines C und bauen
+// daher auch auf dem Host.
+
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+typedef int32_t q16_t;
+
+#define Q16_SHIFT 16
+#define Q16_ONE ((q16_t)1 << Q16_SHIFT)
+#define Q16_HALF ((q16_t)1 << (Q16_SHIFT - 1))
+
+// Nur für Konstanten (wird vom Compiler ausgewertet, kein Soft-Float zur Laufzeit)
+#define Q16_CONST(x) ((q16_t)((x) * 65536.0 + ((x) >= 0 ? 0.5 : -0.5)))
+
+// Auflösung des ADC: 3,3 V / 4096 = 0,806 mV pro Digit
+#define ADC_MV_PER_COUNT_Q16 Q16_CONST(0.806)
+
+static inline q16_t q16_from_int(int32_t v) {
+    return (q16_t)(v * Q16_ONE);
+}
+
+// Auf ganze Zahl runden (für nicht-negative und negative Werte)
+static inline int32_t q16_round(q16_t v) {
+    return (v + Q16_HALF) >> Q16_SHIFT;
+}
+
+static inline q16_t q16_mul(q16_t a, q16_t b) {
+    return (q16_t)(((int64_t)a * b) >> Q16_SHIFT);
+}
+
+// a * n für ganzzahliges n, abgeschnitten wie ein Cast von float
+// (z.B. Tastgrad * wrap -> PWM-Level)
+static inline int32_t q16_mul_int(q16_t a, int32_t n) {
+    return (int32_t)(((int64_t)a * n) >> Q16_SHIFT);
+}
+
+// a * n für ganzzahliges n, gerundet auf eine ganze Zahl
+static inline int32_t q16_mul_int_round(q16_t a, int32_t n) {
+    return (int32_t)(((int64_t)a * n + Q16_HALF) >> Q16_SHIFT);
+}
+
+// Mittelwert einer ADC-Summe über n Samples in mV (Q16).
+// Quotient und Rest getrennt, damit nichts überläuft (n < 65536).
+static inline q16_t adc_sum_to_mv_q16(uint32_t sum, uint32_t n) {
+    uint32_t q = sum / n;
+    uint32_t r = sum % n;
+    uint32_t avg_q16 = (q << Q16_SHIFT) + (r << Q16_SHIFT) / n;
+    return (q16_t)(((uint64_t)avg_q16 * (uint32_t)ADC_MV_PER_COUNT_Q16) >> Q16_SHIFT);
+}
+
+#endif // FIXED_POINT_H
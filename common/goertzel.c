@@ -0,0 +1,74 @@
+// goertzel.c
+// Goertzel-Filter in Festkomma, siehe goertzel.h.
+
+#include <math.h>
+#include <stdint.h>
+
+#include "goertzel.h"
+
+#define ADC_MID 2048
+
+// (c * s) >> 30 für |s| < 2^47 ohne 64x64-Bit-Produkt
+static inline int64_t mul_q30(int32_t c, int64_t s) {
+    int64_t hi = s >> 16;
+    uint32_t lo = (uint32_t)s & 0xffffu;
+    return (((int64_t)c * hi + (1 << 13)) >> 14) + (((int64_t)c * lo + (1 << 29)) >> 30);
+}
+
+bool goertzel_init(goertzel_t *g, uint32_t k, uint32_t n) {
+    if (n == 0 || n > GOERTZEL_MAX_N || k == 0 || 2 * k > n
+        || (uint64_t)n > (uint64_t)k * GOERTZEL_MAX_PERIOD)
+        return false;
+    double w = 2.0 * M_PI * k / n;
+    g->cos_w = cos(w);
+    g->sin_w = sin(w);
+    // |2 cos(w)| < 2 außer bei w = pi (-2 passt gerade noch in int32)
+    double c = 2.0 * g->cos_w * (1u << 30);
+    g->coeff_q30 = c >= 2147483647.0 ? INT32_MAX : (int32_t)llround(c);
+    g->offset = ADC_MID << GOERTZEL_FRAC_BITS;
+    g->n = n;
+    goertzel_reset(g);
+    return true;
+}
+
+void goertzel_reset(goertzel_t *g) {
+    g->s1 = 0;
+    g->s2 = 0;
+    g->count = 0;
+}
+
+void goertzel_set_offset(goertzel_t *g, uint64_t sum, uint32_t count) {
+    if (count > 0)
+        g->offset = (int32_t)(((sum << GOERTZEL_FRAC_BITS) + count / 2) / count);
+}
+
+void goertzel_feed(goertzel_t *g, const uint16_t *samples, uint32_t n, uint32_t stride) {
+    int64_t s1 = g->s1, s2 = g->s2;
+    const int32_t coeff = g->coeff_q30;
+    const int32_t offset = g->offset;
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < n; i += stride) {
+        int32_t x = (int32_t)samples[i] * (1 << GOERTZEL_FRAC_BITS) - offset;
+        int64_t s0 = x + mul_q30(coeff, s1) - s2;
+        s2 = s1;
+        s1 = s0;
+        used++;
+    }
+    g->s1 = s1;
+    g->s2 = s2;
+    g->count += used;
+}
+
+goertzel_result_t goertzel_result(const goertzel_t *g) {
+    // Ein Schritt mit x = 0 hinter dem Block: bei ganzzahliger Linie ist
+    // dann X = s[N] - e^(-jw) s[N-1] genau die DFT-Linie
+    double s1 = ldexp((double)g->s1, -GOERTZEL_FRAC_BITS);
+    double s2 = ldexp((double)g->s2, -GOERTZEL_FRAC_BITS);
+    double s0 = 2.0 * g->cos_w * s1 - s2;
+    double re = s0 - g->cos_w * s1;
+    double im = g->sin_w * s1;
+    goertzel_result_t r;
+    r.amplitude = (float)(2.0 * sqrt(re * re + im * im) / g->n);
+    r.phase = (float)atan2(im, re);
+    return r;
+}
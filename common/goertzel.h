@@ -0,0 +1,66 @@
+// goertzel.h
+// Goertzel-Filter: eine DFT-Linie eines Sample-Blocks in Festkomma.
+//
+// Für Block mit N Samples und Linie k (ganze Zahl Perioden im Block) läuft
+// pro Sample ein Resonator zweiter Ordnung
+//
+//     s[n] = (x[n] - offset) * 2^8 + 2 cos(w) * s[n-1] - s[n-2],   w = 2 pi k / N
+//
+// mit 2 cos(w) in Q30 und Zustand in int64; das Produkt wird aus zwei
+// 32x32->64-Bit-Multiplikationen zusammengesetzt. Die 8 Nachkommabits
+// verhindern, dass sich Rundungsfehler bei tiefen Frequenzen (Pole nahe
+// z = 1) aufsummieren. Abgezogen wird vorab ein Gleichanteil `offset`
+// (Standard: ADC-Mitte 2048): Durch die Rundung des Koeffizienten liegt
+// die Linie minimal neben k, bei tiefen Frequenzen sickert ein großer
+// Gleichanteil dann sichtbar ein. Für genaue Werte dort vorher den
+// Blockmittelwert mit goertzel_set_offset() eintragen.
+//
+// Grenzen für 12-Bit-Samples: N <= GOERTZEL_MAX_N und höchstens
+// GOERTZEL_MAX_PERIOD Samples pro Periode.
+//
+// Betrag und Phase werden erst am Blockende einmal in Gleitkomma aus dem
+// Zustand berechnet. Reines C, baut auch auf dem Host.
+
+#ifndef GOERTZEL_H
+#define GOERTZEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GOERTZEL_MAX_N 4096
+#define GOERTZEL_MAX_PERIOD 2048
+#define GOERTZEL_FRAC_BITS 8
+
+typedef struct {
+    int32_t coeff_q30;      // 2 cos(w)
+    int32_t offset;         // abgezogener Gleichanteil, ADC-Schritte * 2^GOERTZEL_FRAC_BITS
+    double cos_w;
+    double sin_w;
+    uint32_t n;             // Blocklänge N
+    uint32_t count;         // eingerechnete Samples
+    int64_t s1;             // s[n-1]
+    int64_t s2;             // s[n-2]
+} goertzel_t;
+
+typedef struct {
+    float amplitude;        // Spitzenwert der Linie in ADC-Schritten
+    float phase;            // Phase (Kosinus) in rad bezogen auf Sample 0
+} goertzel_result_t;
+
+// Linie `k` eines Blocks aus `n` Samples. false bei ungültigen Grenzen.
+bool goertzel_init(goertzel_t *g, uint32_t k, uint32_t n);
+
+// Zustand leeren (neuer Block); der Gleichanteil bleibt.
+void goertzel_reset(goertzel_t *g);
+
+// Gleichanteil aus Summe und Anzahl der Samples setzen (z.B. Blockmittel).
+void goertzel_set_offset(goertzel_t *g, uint64_t sum, uint32_t count);
+
+// `n` Samples einrechnen, dabei jedes `stride`-te Sample ab samples[0]
+// verwenden (Round-Robin-Blöcke).
+void goertzel_feed(goertzel_t *g, const uint16_t *samples, uint32_t n, uint32_t stride);
+
+// Ergebnis nach genau N Samples: x[n] = A cos(w n + phi) liefert A und phi.
+goertzel_result_t goertzel_result(const goertzel_t *g);
+
+#endif // GOERTZEL_H
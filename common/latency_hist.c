@@ -0,0 +1,93 @@
+// latency_hist.c
+// Log-lineares Latenz-Histogramm (siehe latency_hist.h).
+
+#include <math.h>
+#include "latency_hist.h"
+
+#define SUB_COUNT (1u << LATENCY_HIST_SUB_BITS)
+
+static int msb_index(uint32_t v) {
+    return 31 - __builtin_clz(v);
+}
+
+static uint32_t bucket_of(uint32_t v) {
+    if (v < SUB_COUNT)
+        return v;
+    uint32_t shift = (uint32_t)msb_index(v) - LATENCY_HIST_SUB_BITS;
+    return ((shift + 1) << LATENCY_HIST_SUB_BITS) + (v >> shift) - SUB_COUNT;
+}
+
+// Untere Grenze und Breite von Fach `b`
+static void bucket_range(uint32_t b, uint32_t *low, uint32_t *width) {
+    if (b < SUB_COUNT) {
+        *low = b;
+        *width = 1;
+        return;
+    }
+    uint32_t shift = (b >> LATENCY_HIST_SUB_BITS) - 1;
+    *low = ((b & (SUB_COUNT - 1)) + SUB_COUNT) << shift;
+    *width = 1u << shift;
+}
+
+void latency_hist_reset(latency_hist_t *h) {
+    for (uint32_t i = 0; i < LATENCY_HIST_BUCKETS; i++)
+        h->buckets[i] = 0;
+    h->count = 0;
+    h->overflow = 0;
+    h->min = UINT32_MAX;
+    h->max = 0;
+    h->sum = 0;
+    h->sum_sq = 0;
+}
+
+void latency_hist_add(latency_hist_t *h, uint32_t ns) {
+    h->count++;
+    if (ns < h->min)
+        h->min = ns;
+    if (ns > h->max)
+        h->max = ns;
+    h->sum += ns;
+    h->sum_sq += (uint64_t)ns * ns;
+
+    if (ns >> LATENCY_HIST_MAX_BITS)
+        h->overflow++;
+    else
+        h->buckets[bucket_of(ns)]++;
+}
+
+uint32_t latency_hist_percentile(const latency_hist_t *h, uint32_t permille) {
+    if (h->count == 0)
+        return 0;
+    // Rang des gesuchten Werts (1-basiert, aufgerundet)
+    uint64_t rank = ((uint64_t)h->count * permille + 999) / 1000;
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < LATENCY_HIST_BUCKETS; b++) {
+        seen += h->buckets[b];
+        if (seen >= rank) {
+            uint32_t low, width;
+            bucket_range(b, &low, &width);
+            uint32_t v = low + width / 2;
+            if (v < h->min)
+                v = h->min;
+            if (v > h->max)
+                v = h->max;
+            return v;
+        }
+    }
+    return h->max;  // im Überlauf
+}
+
+float latency_hist_mean(const latency_hist_t *h) {
+    return h->count > 0 ? (float)h->sum / (float)h->count : 0.0f;
+}
+
+float latency_hist_stddev(const latency_hist_t *h) {
+    if (h->count < 2)
+        return 0.0f;
+    double mean = (double)h->sum / h->count;
+    double var = (double)h->sum_sq / h->count - mean * mean;
+    return var > 0.0 ? (float)sqrt(var) : 0.0f;
+}
@@ -0,0 +1,43 @@
+// latency_hist.h
+// Log-lineares Histogramm fester Größe für Latenzen in ns.
+//
+// Werte unter 2^SUB_BITS landen exakt in einem eigenen Fach, darüber teilt
+// jede Zweierpotenz sich in 2^SUB_BITS gleich breite Fächer. Der relative
+// Fehler eines Perzentils ist damit höchstens 2^-SUB_BITS (1,6 %), der
+// Speicher fest (~5 KB), unabhängig von der Anzahl der Messungen.
+// Minimum, Maximum, Mittelwert und Streuung werden exakt mitgeführt.
+//
+// Reines C, baut auch auf dem Host.
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+
+#define LATENCY_HIST_SUB_BITS 6
+#define LATENCY_HIST_MAX_BITS 24    // Werte ab 2^24 ns (16,7 ms) zählen als Überlauf
+#define LATENCY_HIST_BUCKETS \
+    ((LATENCY_HIST_MAX_BITS - LATENCY_HIST_SUB_BITS + 1) << LATENCY_HIST_SUB_BITS)
+
+typedef struct {
+    uint32_t buckets[LATENCY_HIST_BUCKETS];
+    uint32_t count;             // inkl. Überlauf
+    uint32_t overflow;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint64_t sum_sq;
+} latency_hist_t;
+
+void latency_hist_reset(latency_hist_t *h);
+void latency_hist_add(latency_hist_t *h, uint32_t ns);
+
+// Perzentil in Promille (500 = Median). Liefert die Mitte des Fachs,
+// begrenzt auf [min, max]; 0 bei leerem Histogramm.
+uint32_t latency_hist_percentile(const latency_hist_t *h, uint32_t permille);
+
+// Mittelwert und Standardabweichung (Jitter) in ns
+float latency_hist_mean(const latency_hist_t *h);
+float latency_hist_stddev(const latency_hist_t *h);
+
+#endif // LATENCY_HIST_H
@@ -0,0 +1,113 @@
+// lockin.c
+// Lock-in-Demodulation, siehe lockin.h.
+
+#include <math.h>
+#include <stddef.h>
+
+#include "lockin.h"
+
+#define LUT_ONE 32767
+
+bool lockin_init(lockin_t *li, int16_t *lut, uint16_t period) {
+    if (lut == NULL || period < 3 || period > LOCKIN_MAX_PERIOD)
+        return false;
+    li->cos_q15 = lut;
+    li->sin_q15 = lut + period;
+    li->period = period;
+    for (uint16_t k = 0; k < period; k++) {
+        double a = 2.0 * M_PI * k / period;
+        li->cos_q15[k] = (int16_t)lround(cos(a) * LUT_ONE);
+        li->sin_q15[k] = (int16_t)lround(sin(a) * LUT_ONE);
+    }
+    li->phase = 0;
+    lockin_reset(li);
+    return true;
+}
+
+void lockin_reset(lockin_t *li) {
+    li->i_acc = 0;
+    li->q_acc = 0;
+    li->count = 0;
+}
+
+void lockin_feed(lockin_t *li, const uint16_t *samples, uint32_t n, uint32_t stride) {
+    // 32-Bit-Teilsummen: 4095 * 32767 passt 16-mal in int32
+    int64_t i_acc = li->i_acc, q_acc = li->q_acc;
+    uint32_t phase = li->phase;
+    uint32_t used = 0;
+    for (uint32_t k = 0; k < n; ) {
+        int32_t i_part = 0, q_part = 0;
+        for (int j = 0; j < 16 && k < n; j++, k += stride) {
+            int32_t x = samples[k];
+            i_part += x * li->cos_q15[phase];
+            q_part += x * li->sin_q15[phase];
+            if (++phase == li->period)
+                phase = 0;
+            used++;
+        }
+        i_acc += i_part;
+        q_acc += q_part;
+    }
+    li->i_acc = i_acc;
+    li->q_acc = q_acc;
+    li->phase = (uint16_t)phase;
+    li->count += used;
+}
+
+static uint32_t isqrt64(uint64_t v) {
+    uint64_t res = 0;
+    uint64_t bit = 1ull << 62;
+    while (bit > v)
+        bit >>= 2;
+    while (bit != 0) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)res;
+}
+
+q16_t lockin_amplitude(const lockin_t *li) {
+    if (li->count == 0)
+        return 0;
+
+    // Summen so weit kürzen, dass die Quadratsumme in 64 Bit passt
+    uint64_t i_abs = li->i_acc < 0 ? -(uint64_t)li->i_acc : (uint64_t)li->i_acc;
+    uint64_t q_abs = li->q_acc < 0 ? -(uint64_t)li->q_acc : (uint64_t)li->q_acc;
+    int shift = 0;
+    while ((i_abs >> shift) >= (1u << 31) || (q_abs >> shift) >= (1u << 31))
+        shift++;
+    uint64_t i_s = i_abs >> shift, q_s = q_abs >> shift;
+    uint64_t mag = isqrt64(i_s * i_s + q_s * q_s);
+
+    // Spitzenwert = 2 * |I + jQ| / (count * LUT_ONE)
+    uint64_t num = mag << (Q16_SHIFT + 1);
+    while (shift > 0 && num < (1ull << 62)) {
+        num <<= 1;
+        shift--;
+    }
+    return (q16_t)((num / ((uint64_t)LUT_ONE * li->count)) << shift);
+}
+
+q16_t lockin_square_mean(const lockin_t *li, q16_t amplitude, q16_t duty) {
+    // sin(pi * duty) aus der Tabelle: Index duty * period / 2, linear interpoliert
+    int64_t x = (int64_t)duty * li->period / 2;
+    uint32_t idx = (uint32_t)(x >> Q16_SHIFT) % li->period;
+    int32_t frac = (int32_t)(x & (Q16_ONE - 1));
+    int32_t s0 = li->sin_q15[idx];
+    int32_t s1 = li->sin_q15[(idx + 1) % li->period];
+    int32_t s = s0 + (int32_t)(((int64_t)(s1 - s0) * frac) >> Q16_SHIFT);
+    if (duty <= 0)
+        return amplitude / 2;   // Grenzwert pi * d / (2 sin(pi * d)) -> 1/2
+    if (s < LUT_ONE / 256)
+        return 0;               // Tastgrad nahe 1: Grundwelle trägt keine Information
+
+    // amplitude * pi * duty / (2 * sin(pi * duty))
+    q16_t pi_duty = q16_mul(Q16_CONST(3.14159265), duty);
+    int64_t ratio = ((int64_t)pi_duty * LUT_ONE) / (2 * s);
+    return (q16_t)(((int64_t)amplitude * ratio) >> Q16_SHIFT);
+}
@@ -0,0 +1,59 @@
+// lockin.h
+// Lock-in-Demodulation (synchrone Gleichrichtung) eines Sample-Stroms.
+//
+// Voraussetzung ist kohärente Abtastung: genau `period` Samples pro Periode
+// der Referenz (z.B. der Laser-PWM). Jedes Sample wird mit Kosinus und
+// Sinus der Referenzphase aus einer Tabelle (Q15) multipliziert und
+// aufsummiert (I und Q). Über ganze Perioden fallen Gleichanteil
+// (Umgebungslicht, Dunkelsignal) und alle Frequenzen außer den Vielfachen
+// der Referenz exakt heraus; übrig bleibt die Grundwelle des Signals mit
+// Betrag und Phase, unabhängig von der Lage der Referenz zum ersten Sample.
+//
+// Die Phase läuft über Aufrufe weiter, Blöcke dürfen also kürzer oder
+// länger als eine Periode sein; für volle Unterdrückung des Gleichanteils
+// sollte zwischen zwei lockin_reset() eine ganze Zahl Perioden liegen.
+//
+// Ganzzahlig bis auf den Aufbau der Tabelle in lockin_init(). Reines C,
+// baut auch auf dem Host.
+
+#ifndef LOCKIN_H
+#define LOCKIN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "fixed_point.h"
+
+#define LOCKIN_MAX_PERIOD 4096
+
+typedef struct {
+    int16_t *cos_q15;       // period Werte
+    int16_t *sin_q15;       // period Werte
+    uint16_t period;        // Samples pro Referenzperiode
+    uint16_t phase;         // Tabellenindex des nächsten Samples
+    int64_t i_acc;          // Summe x * cos (x in ADC-Schritten, Tabelle Q15)
+    int64_t q_acc;          // Summe x * sin
+    uint32_t count;         // eingerechnete Samples
+} lockin_t;
+
+// Einrichten; `lut` muss 2 * period Werte fassen. Phase 0 gehört zum
+// ersten Sample nach dem Einrichten.
+bool lockin_init(lockin_t *li, int16_t *lut, uint16_t period);
+
+// Summen leeren; die Phase läuft weiter.
+void lockin_reset(lockin_t *li);
+
+// `n` Samples einrechnen, dabei jedes `stride`-te Sample ab samples[0]
+// verwenden (Round-Robin-Blöcke); jedes verwendete Sample rückt die Phase
+// um eins weiter.
+void lockin_feed(lockin_t *li, const uint16_t *samples, uint32_t n, uint32_t stride);
+
+// Spitzenwert der Grundwelle in ADC-Schritten (Q16), 0 ohne Samples
+q16_t lockin_amplitude(const lockin_t *li);
+
+// Gleichanteil eines Rechtecksignals (Pulse mit Tastgrad `duty`, Q16 0..1)
+// über dessen Grundpegel, berechnet aus dem Spitzenwert `amplitude` seiner
+// Grundwelle: Pulshöhe A ergibt die Grundwelle 2 A / pi * sin(pi * duty)
+// und den Gleichanteil A * duty.
+q16_t lockin_square_mean(const lockin_t *li, q16_t amplitude, q16_t duty);
+
+#endif // LOCKIN_H
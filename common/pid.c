@@ -0,0 +1,59 @@
+// pid.c
+// PID-Regler in Q16.16-Festkomma (siehe pid.h).
+
+#include "pid.h"
+
+void pid_init(pid_q16_t *pid, q16_t kp, q16_t ki, q16_t kd,
+              q16_t out_min, q16_t out_max, q16_t slew) {
+    pid->kp = kp;
+    pid->ki = ki;
+    pid->kd = kd;
+    pid->out_min = out_min;
+    pid->out_max = out_max;
+    pid->slew = slew;
+    pid_reset(pid, out_min);
+}
+
+void pid_reset(pid_q16_t *pid, q16_t out) {
+    pid->integral = 0;
+    pid->prev_meas = 0;
+    pid->primed = false;
+    pid->out = out;
+}
+
+q16_t pid_update(pid_q16_t *pid, q16_t setpoint, q16_t measurement, q16_t feedforward) {
+    q16_t error = setpoint - measurement;
+
+    // Erlaubter Bereich dieses Schritts: Betragsgrenzen und Änderungsrate
+    q16_t lo = pid->out_min;
+    q16_t hi = pid->out_max;
+    if (pid->slew > 0) {
+        if (pid->out - pid->slew > lo)
+            lo = pid->out - pid->slew;
+        if (pid->out + pid->slew < hi)
+            hi = pid->out + pid->slew;
+    }
+
+    q16_t p = q16_mul(pid->kp, error);
+    q16_t d = 0;
+    if (pid->kd != 0 && pid->primed)
+        d = -q16_mul(pid->kd, measurement - pid->prev_meas);
+    pid->prev_meas = measurement;
+    pid->primed = true;
+
+    // Bedingte Integration (Anti-Windup)
+    q16_t integral = pid->integral + q16_mul(pid->ki, error);
+    q16_t u = feedforward + p + integral + d;
+    if ((u > hi && error > 0) || (u < lo && error < 0)) {
+        integral = pid->integral;
+        u = feedforward + p + integral + d;
+    }
+    pid->integral = integral;
+
+    if (u > hi)
+        u = hi;
+    if (u < lo)
+        u = lo;
+    pid->out = u;
+    return u;
+}
@@ -0,0 +1,42 @@
+// pid.h
+// PID-Regler in Q16.16-Festkomma mit Vorsteuerung, Anti-Windup und
+// Begrenzung der Änderungsrate des Stellwerts.
+//
+// Gedacht für den Aufruf in fester Rate (Timer-IRQ); die Verstärkungen
+// gelten daher pro Regelschritt. Der D-Anteil wirkt auf den Messwert statt
+// auf die Regelabweichung, damit Sollwertsprünge keinen Stoß erzeugen.
+// Anti-Windup durch bedingte Integration: Solange der Stellwert an einer
+// Grenze (Betrag oder Änderungsrate) steht und die Regelabweichung weiter
+// in dieselbe Richtung drückt, wird nicht integriert.
+
+#ifndef PID_H
+#define PID_H
+
+#include <stdbool.h>
+#include "fixed_point.h"
+
+typedef struct {
+    q16_t kp;           // Stellwert pro Einheit Regelabweichung
+    q16_t ki;           // Stellwert pro Einheit Regelabweichung und Schritt
+    q16_t kd;           // Stellwert pro Einheit Messwertänderung je Schritt
+    q16_t out_min;
+    q16_t out_max;
+    q16_t slew;         // max. Änderung des Stellwerts pro Schritt, 0 = unbegrenzt
+
+    q16_t integral;     // I-Anteil in Stellwert-Einheiten
+    q16_t prev_meas;
+    q16_t out;
+    bool primed;        // prev_meas gültig
+} pid_q16_t;
+
+void pid_init(pid_q16_t *pid, q16_t kp, q16_t ki, q16_t kd,
+              q16_t out_min, q16_t out_max, q16_t slew);
+
+// Stoßfreier (Neu-)Start: Integral leeren, Stellwert auf `out` setzen.
+void pid_reset(pid_q16_t *pid, q16_t out);
+
+// Ein Regelschritt. `feedforward` ist der erwartete Stellwert für den
+// Sollwert (z.B. aus einer Kennlinie); der Regler korrigiert nur den Rest.
+q16_t pid_update(pid_q16_t *pid, q16_t setpoint, q16_t measurement, q16_t feedforward);
+
+#endif // PID_H
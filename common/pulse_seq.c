@@ -0,0 +1,46 @@
+// pulse_seq.c
+// Tabellen für den PIO-Pulssequenzer (siehe pulse_seq.h).
+
+#include "pulse_seq.h"
+
+// Nanosekunden auf ganze Takte runden und in ein Tabellenwort umrechnen.
+// False bei zu kurzer Zeit.
+static bool ns_to_word(uint32_t ns, uint32_t clk_hz, uint32_t *word) {
+    uint64_t cycles = ((uint64_t)ns * clk_hz + 500000000u) / 1000000000u;
+    if (cycles < PULSE_SEQ_MIN_CYCLES)
+        return false;
+    *word = (uint32_t)(cycles - PULSE_SEQ_MIN_CYCLES);
+    return true;
+}
+
+pulse_seq_status_t pulse_seq_encode(const pulse_seq_step_t *steps, size_t count,
+                                    uint32_t clk_hz, uint32_t *table, size_t max_words,
+                                    size_t *words) {
+    size_t n = 0;
+    *words = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t high, low;
+        if (!ns_to_word(steps[i].high_ns, clk_hz, &high)
+            || !ns_to_word(steps[i].low_ns, clk_hz, &low))
+            return PULSE_SEQ_ERR_SHORT;
+
+        uint32_t repeat = steps[i].repeat ? steps[i].repeat : 1;
+        if (repeat > (max_words - n) / 2)
+            return PULSE_SEQ_ERR_FULL;
+        for (uint32_t r = 0; r < repeat; r++) {
+            table[n++] = high;
+            table[n++] = low;
+        }
+    }
+
+    *words = n;
+    return PULSE_SEQ_OK;
+}
+
+uint64_t pulse_seq_table_cycles(const uint32_t *table, size_t words) {
+    uint64_t cycles = 0;
+    for (size_t i = 0; i < words; i++)
+        cycles += (uint64_t)table[i] + PULSE_SEQ_MIN_CYCLES;
+    return cycles;
+}
@@ -0,0 +1,65 @@
+// pulse_seq.h
+// Pulsfolgen per PIO: beliebige Folgen aus (Hoch, Tief)-Zeiten mit einer
+// Auflösung von einem Systemtakt (8 ns bei 125 MHz), ohne CPU.
+//
+// Die PIO-Zustandsmaschine (pulse_seq.pio) liest pro Halbperiode ein Wort
+// aus ihrem TX-FIFO und hält den Pin so lange hoch bzw. tief; ein DMA-Kanal
+// speist den FIFO aus einer Tabelle. Ein Wort w ergibt w + PULSE_SEQ_MIN_CYCLES
+// Takte. Nach dem letzten Wort bleibt der Pin tief.
+//
+// pulse_seq_encode() übersetzt eine Beschreibung in Nanosekunden in diese
+// Tabelle; sie ist reines C und baut auch auf dem Host. Der Treiber
+// (pulse_seq_init() ff.) steckt in pulse_seq_pio.c, die Host-Simulation
+// ersetzt ihn durch eine eigene Implementierung.
+
+#ifndef PULSE_SEQ_H
+#define PULSE_SEQ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Takte, die das PIO-Programm pro Halbperiode mindestens braucht
+#define PULSE_SEQ_MIN_CYCLES 3u
+
+typedef struct {
+    uint32_t high_ns;
+    uint32_t low_ns;
+    uint32_t repeat;        // so oft hintereinander (0 zählt wie 1)
+} pulse_seq_step_t;
+
+typedef enum {
+    PULSE_SEQ_OK = 0,
+    PULSE_SEQ_ERR_SHORT,    // Halbperiode kürzer als PULSE_SEQ_MIN_CYCLES Takte
+    PULSE_SEQ_ERR_FULL,     // Tabelle zu klein
+} pulse_seq_status_t;
+
+// Schritte in Tabellenwörter für den Takt `clk_hz` übersetzen (auf ganze
+// Takte gerundet). `*words` erhält die Anzahl geschriebener Wörter.
+pulse_seq_status_t pulse_seq_encode(const pulse_seq_step_t *steps, size_t count,
+                                    uint32_t clk_hz, uint32_t *table, size_t max_words,
+                                    size_t *words);
+
+// Gesamtdauer einer Tabelle in Takten.
+uint64_t pulse_seq_table_cycles(const uint32_t *table, size_t words);
+
+// --- Treiber ---
+
+// PIO-Programm laden, Zustandsmaschine und DMA-Kanal einrichten. Der Pin
+// bleibt bis pulse_seq_start() beim SIO.
+bool pulse_seq_init(unsigned pin);
+
+// Systemtakt, in dem die Tabelle zählt.
+uint32_t pulse_seq_clock_hz(void);
+
+// Tabelle ausgeben (übergibt den Pin an die PIO). Die Tabelle muss bis zum
+// Ende der Folge gültig bleiben. False, wenn noch eine Folge läuft.
+bool pulse_seq_start(const uint32_t *table, size_t words);
+
+// True, solange die Folge noch läuft.
+bool pulse_seq_busy(void);
+
+// Folge abbrechen bzw. nach dem Ende aufräumen: Pin zurück an den SIO, tief.
+void pulse_seq_stop(void);
+
+#endif // PULSE_SEQ_H
@@ -0,0 +1,70 @@
+// pulse_seq_pio.c
+// PIO-/DMA-Treiber des Pulssequenzers (siehe pulse_seq.h).
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+#include "pulse_seq.h"
+#include "pulse_seq.pio.h"
+
+static PIO pio = pio0;
+static uint sm;
+static uint offset;
+static int dma_chan = -1;
+static uint seq_pin;
+
+bool pulse_seq_init(unsigned pin) {
+    if (!pio_can_add_program(pio, &pulse_seq_program))
+        return false;
+    int free_sm = pio_claim_unused_sm(pio, false);
+    if (free_sm < 0)
+        return false;
+    sm = (uint)free_sm;
+    offset = pio_add_program(pio, &pulse_seq_program);
+    seq_pin = pin;
+    pulse_seq_program_init(pio, sm, offset, pin);
+
+    dma_chan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config((uint)dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, true));
+    dma_channel_configure((uint)dma_chan, &c, &pio->txf[sm], NULL, 0, false);
+    return true;
+}
+
+uint32_t pulse_seq_clock_hz(void) {
+    return clock_get_hz(clk_sys);
+}
+
+bool pulse_seq_start(const uint32_t *table, size_t words) {
+    if (dma_chan < 0 || pulse_seq_busy())
+        return false;
+    // Maschine wartet im ersten pull mit Pin tief, Pin erst jetzt übergeben
+    pio_gpio_init(pio, seq_pin);
+    dma_channel_transfer_from_buffer_now((uint)dma_chan, table, (uint32_t)words);
+    return true;
+}
+
+bool pulse_seq_busy(void) {
+    // Fertig, wenn alle Wörter gelesen sind und die Maschine im ersten pull steht
+    return dma_channel_is_busy((uint)dma_chan)
+        || !pio_sm_is_tx_fifo_empty(pio, sm)
+        || pio_sm_get_pc(pio, sm) != offset;
+}
+
+void pulse_seq_stop(void) {
+    dma_channel_abort((uint)dma_chan);
+    pio_sm_set_enabled(pio, sm, false);
+    pio_sm_clear_fifos(pio, sm);
+    pio_sm_restart(pio, sm);
+    pio_sm_exec(pio, sm, pio_encode_jmp(offset));
+    pio_sm_set_enabled(pio, sm, true);
+
+    // Pin tief an den SIO zurückgeben
+    gpio_put(seq_pin, 0);
+    gpio_set_dir(seq_pin, GPIO_OUT);
+    gpio_set_function(seq_pin, GPIO_FUNC_SIO);
+}
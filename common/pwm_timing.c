@@ -0,0 +1,71 @@
+// pwm_timing.c
+// Teiler und wrap für eine PWM-Frequenz, siehe pwm_timing.h.
+
+#include <math.h>
+#include <stddef.h>
+
+#include "pwm_timing.h"
+
+pwm_timing_status_t pwm_timing_solve(uint32_t sys_clk_hz, float freq_hz, uint32_t min_steps,
+                                     uint32_t max_error_ppm, pwm_timing_t *t) {
+    if (min_steps < 2)
+        min_steps = 2;
+    if (!(freq_hz > 0.0f))
+        return PWM_TIMING_TOO_LOW;
+
+    // Periode in 1/16 Systemtakten = div_16 * (wrap + 1)
+    double period_16 = (double)sys_clk_hz * 16.0 / freq_hz;
+    // Mit Teiler 1 rundet die Stufenzahl unten erst ab min_steps - 0.5 ab
+    if (period_16 < PWM_TIMING_DIV_MIN * (min_steps - 0.5))
+        return PWM_TIMING_TOO_HIGH;
+
+    // Kleinster Teiler, bei dem wrap + 1 höchstens 65536 wird
+    double first = floor(period_16 / PWM_TIMING_MAX_STEPS);
+    if (first > PWM_TIMING_DIV_MAX)
+        return PWM_TIMING_TOO_LOW;
+    uint32_t div = first < PWM_TIMING_DIV_MIN ? PWM_TIMING_DIV_MIN : (uint32_t)first;
+
+    bool found = false;
+    pwm_timing_t best = { 0 };
+    for (; div <= PWM_TIMING_DIV_MAX; div++) {
+        double steps = floor(period_16 / div + 0.5);
+        if (steps > PWM_TIMING_MAX_STEPS)
+            continue;
+        if (steps < min_steps)
+            break;
+
+        pwm_timing_t cand = {
+            .sys_clk_hz = sys_clk_hz,
+            .div_16 = (uint16_t)div,
+            .wrap = (uint16_t)(steps - 1.0),
+        };
+        if (!found) {
+            best = cand;
+            found = true;
+        }
+        // Zugabe für die Auflösung der float-Frequenz (6e-8)
+        double error_ppm = fabs(div * steps - period_16) / period_16 * 1e6;
+        if (error_ppm <= max_error_ppm + 0.1) {
+            *t = cand;
+            return PWM_TIMING_OK;
+        }
+    }
+    if (!found)
+        return PWM_TIMING_TOO_LOW;
+    *t = best;
+    return PWM_TIMING_INEXACT;
+}
+
+const char *pwm_timing_status_str(pwm_timing_status_t status) {
+    switch (status) {
+    case PWM_TIMING_OK:
+        return "exakt";
+    case PWM_TIMING_INEXACT:
+        return "nicht exakt";
+    case PWM_TIMING_TOO_LOW:
+        return "Frequenz zu niedrig";
+    case PWM_TIMING_TOO_HIGH:
+        return "Frequenz zu hoch";
+    }
+    return "?";
+}
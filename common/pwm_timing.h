@@ -0,0 +1,85 @@
+// pwm_timing.h
+// Teiler und wrap eines PWM-Slice aus dem tatsächlichen Systemtakt.
+//
+// Ein Slice zählt mit sys_clk / div von 0 bis wrap; div hat 4
+// Nachkommabits (1 <= div < 256). Eine Periode dauert damit
+// div * (wrap + 1) Systemtakte, der Tastgrad hat wrap + 1 Stufen.
+//
+// pwm_timing_solve() nimmt für eine Frequenz den kleinsten Teiler, bei dem
+// wrap noch in 16 Bit passt, also die feinste Auflösung, und geht nur so
+// weit zu größeren Teilern, bis die erreichte Frequenz höchstens
+// `max_error_ppm` von der gewünschten abweicht. Mit 0 ppm entstehen nur
+// exakte Perioden (nötig, wenn die PWM kohärent zum ADC laufen soll).
+// Ein gebrochener Teiler verteilt die Nachkommastellen über die Perioden:
+// einzelne Flanken zittern um einen Systemtakt, die mittlere Periode ist
+// exakt.
+//
+// Übertakten: Der Systemtakt wird mit clock_get_hz(clk_sys) gelesen,
+// pwm_timing_for_freq() rechnet also mit dem Takt, den das SDK eingestellt
+// hat (z.B. per target_compile_definitions(<ziel> PRIVATE SYS_CLK_MHZ=200)
+// oder set_sys_clock_khz()). Ein höherer Takt ergibt feinere Stufen und
+// höhere erreichbare Frequenzen; der ADC hat seinen eigenen 48-MHz-Takt.
+//
+// pwm_timing_solve() ist reines C und baut auch auf dem Host;
+// pwm_timing_for_freq()/pwm_timing_apply()/pwm_timing_report() benutzen
+// das SDK.
+
+#ifndef PWM_TIMING_H
+#define PWM_TIMING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PWM_TIMING_DIV_MIN 16u          // 1.0 in 1/16
+#define PWM_TIMING_DIV_MAX 4095u        // 255 + 15/16
+#define PWM_TIMING_MAX_STEPS 65536u
+
+typedef struct {
+    uint32_t sys_clk_hz;    // zugrunde gelegter Systemtakt
+    uint16_t div_16;        // Teiler in 1/16
+    uint16_t wrap;          // Zählerendwert, Stufen = wrap + 1
+} pwm_timing_t;
+
+typedef enum {
+    PWM_TIMING_OK = 0,
+    PWM_TIMING_INEXACT,     // Abweichung über max_error_ppm; `t` enthält die feinste Einstellung
+    PWM_TIMING_TOO_LOW,     // Frequenz auch mit größtem Teiler und wrap nicht erreichbar
+    PWM_TIMING_TOO_HIGH,    // weniger als min_steps Stufen
+} pwm_timing_status_t;
+
+// Einstellung für `freq_hz` bei `sys_clk_hz` mit mindestens `min_steps`
+// Stufen (>= 2). `t` bleibt bei TOO_LOW/TOO_HIGH unverändert.
+pwm_timing_status_t pwm_timing_solve(uint32_t sys_clk_hz, float freq_hz, uint32_t min_steps,
+                                     uint32_t max_error_ppm, pwm_timing_t *t);
+
+// Kurzer Text zum Status für Meldungen
+const char *pwm_timing_status_str(pwm_timing_status_t status);
+
+// Wie pwm_timing_solve() mit dem aktuellen Systemtakt
+pwm_timing_status_t pwm_timing_for_freq(float freq_hz, uint32_t min_steps,
+                                        uint32_t max_error_ppm, pwm_timing_t *t);
+
+// Teiler und wrap in den Slice schreiben (Tastgrad und Freigabe bleiben)
+void pwm_timing_apply(unsigned slice_num, const pwm_timing_t *t);
+
+// Ergebnis von pwm_timing_for_freq() melden: bei TOO_LOW/TOO_HIGH
+// Fehlermeldung und Stillstand (kehrt nicht zurück), sonst Frequenz,
+// Stufen und Teiler
+void pwm_timing_report(float freq_hz, pwm_timing_status_t status, const pwm_timing_t *t);
+
+// Stufen des Tastgrads
+static inline uint32_t pwm_timing_steps(const pwm_timing_t *t) {
+    return (uint32_t)t->wrap + 1u;
+}
+
+// Tatsächlich erreichte Frequenz
+static inline double pwm_timing_freq_hz(const pwm_timing_t *t) {
+    return (double)t->sys_clk_hz * 16.0 / ((double)t->div_16 * pwm_timing_steps(t));
+}
+
+// Teiler als Zahl (wie pwm_set_clkdiv)
+static inline float pwm_timing_clkdiv(const pwm_timing_t *t) {
+    return t->div_16 / 16.0f;
+}
+
+#endif // PWM_TIMING_H
@@ -0,0 +1,31 @@
+// pwm_timing_pico.c
+// Systemtakt lesen, Einstellung in den PWM-Slice schreiben und melden
+// (siehe pwm_timing.h).
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/pwm.h"
+#include "pwm_timing.h"
+
+pwm_timing_status_t pwm_timing_for_freq(float freq_hz, uint32_t min_steps,
+                                        uint32_t max_error_ppm, pwm_timing_t *t) {
+    return pwm_timing_solve(clock_get_hz(clk_sys), freq_hz, min_steps, max_error_ppm, t);
+}
+
+void pwm_timing_apply(unsigned slice_num, const pwm_timing_t *t) {
+    pwm_set_clkdiv_int_frac(slice_num, (uint8_t)(t->div_16 >> 4), (uint8_t)(t->div_16 & 0x0f));
+    pwm_set_wrap(slice_num, t->wrap);
+}
+
+void pwm_timing_report(float freq_hz, pwm_timing_status_t status, const pwm_timing_t *t) {
+    if (status > PWM_TIMING_INEXACT) {
+        printf("FEHLER: PWM %.0f Hz bei %lu Hz Systemtakt: %s\n", freq_hz,
+               clock_get_hz(clk_sys), pwm_timing_status_str(status));
+        while (true)
+            tight_loop_contents();
+    }
+    printf("PWM: %.3f Hz, %lu Stufen, Teiler %.4f (%s)\n", pwm_timing_freq_hz(t),
+           pwm_timing_steps(t), pwm_timing_clkdiv(t), pwm_timing_status_str(status));
+}
@@ -0,0 +1,239 @@
+// reaction_map.c
+// Reaktionstabelle über Tastgrad und Temperatur, siehe reaction_map.h.
+
+#include <stddef.h>
+#include <string.h>
+
+#include "reaction_map.h"
+
+// Position zwischen zwei Stützstellen: linke Stützstelle und Anteil der
+// rechten (Q16). Am rechten Rand wird die vorletzte Stützstelle mit
+// Anteil 1 verwendet, damit immer zwei Nachbarn existieren.
+typedef struct {
+    uint16_t index;
+    q16_t frac;
+} map_pos_t;
+
+static map_pos_t to_pos(int64_t pos_q16, uint16_t count) {
+    map_pos_t p = { 0, 0 };
+    if (count < 2 || pos_q16 <= 0)
+        return p;
+    if (pos_q16 >= ((int64_t)(count - 1) << Q16_SHIFT)) {
+        p.index = count - 2;
+        p.frac = Q16_ONE;
+        return p;
+    }
+    p.index = (uint16_t)(pos_q16 >> Q16_SHIFT);
+    p.frac = (q16_t)(pos_q16 & (Q16_ONE - 1));
+    return p;
+}
+
+static map_pos_t duty_pos(const reaction_map_t *map, q16_t duty) {
+    return to_pos((int64_t)duty * (map->points - 1), map->points);
+}
+
+static map_pos_t temp_pos(const reaction_map_t *map, q16_t temp_c) {
+    int64_t pos = ((int64_t)(temp_c - map->t_min_c) << Q16_SHIFT) / map->t_step_c;
+    return to_pos(pos, map->rows);
+}
+
+static bool row_is_valid(const reaction_map_t *map, int row) {
+    return (map->row_valid >> row) & 1u;
+}
+
+// Nächste gültige Zeile (bei gleichem Abstand die kältere), -1 wenn keine
+static int nearest_valid(const reaction_map_t *map, int row) {
+    for (int d = 0; d < map->rows; d++) {
+        if (row - d >= 0 && row_is_valid(map, row - d))
+            return row - d;
+        if (row + d < map->rows && row_is_valid(map, row + d))
+            return row + d;
+    }
+    return -1;
+}
+
+static q16_t *row_cells(const reaction_map_t *map, int row) {
+    return map->cells + (size_t)row * map->points;
+}
+
+// Zeile zum Lesen: ungültige Zeilen durch die nächste gültige ersetzen
+static const q16_t *read_row(const reaction_map_t *map, int row) {
+    return row_cells(map, nearest_valid(map, row));
+}
+
+static q16_t mix(q16_t a, q16_t b, q16_t frac) {
+    return a + q16_mul(b - a, frac);
+}
+
+bool reaction_map_init(reaction_map_t *map, q16_t *cells, uint16_t points, uint8_t rows,
+                       q16_t t_min_c, q16_t t_step_c, uint8_t learn_shift) {
+    if (cells == NULL || points < 2 || rows == 0 || rows > REACTION_MAP_MAX_ROWS
+        || t_step_c <= 0 || learn_shift > 16)
+        return false;
+    map->cells = cells;
+    map->points = points;
+    map->rows = rows;
+    map->t_min_c = t_min_c;
+    map->t_step_c = t_step_c;
+    map->learn_shift = learn_shift;
+    map->row_valid = 0;
+    map->updates = 0;
+    return true;
+}
+
+void reaction_map_set_row(reaction_map_t *map, q16_t temp_c, const uint16_t *mv) {
+    map_pos_t t = temp_pos(map, temp_c);
+    int row = t.index + (t.frac >= Q16_HALF ? 1 : 0);
+    if (row >= map->rows)
+        row = map->rows - 1;
+
+    q16_t *cells = row_cells(map, row);
+    for (uint16_t i = 0; i < map->points; i++)
+        cells[i] = q16_from_int(mv[i]);
+    map->row_valid |= 1u << row;
+}
+
+q16_t reaction_map_lookup(const reaction_map_t *map, q16_t duty, q16_t temp_c) {
+    if (!reaction_map_ready(map))
+        return 0;
+
+    map_pos_t d = duty_pos(map, duty);
+    map_pos_t t = temp_pos(map, temp_c);
+    const q16_t *r0 = read_row(map, t.index);
+    q16_t v0 = mix(r0[d.index], r0[d.index + 1], d.frac);
+    if (map->rows < 2 || t.frac == 0)
+        return v0;
+    const q16_t *r1 = read_row(map, t.index + 1);
+    q16_t v1 = mix(r1[d.index], r1[d.index + 1], d.frac);
+    return mix(v0, v1, t.frac);
+}
+
+reaction_map_inv_t reaction_map_inverse(const reaction_map_t *map, q16_t mv, q16_t temp_c,
+                                        q16_t duty_min, q16_t duty_max, q16_t *duty) {
+    *duty = duty_max;
+    if (!reaction_map_ready(map))
+        return REACTION_MAP_INV_ABOVE;
+
+    // Zwischen den Temperaturzeilen gemischte Kennlinie; zwischen den
+    // Stützstellen ist die bilineare Interpolation linear im Tastgrad
+    map_pos_t t = temp_pos(map, temp_c);
+    const q16_t *r0 = read_row(map, t.index);
+    const q16_t *r1 = map->rows < 2 ? r0 : read_row(map, t.index + 1);
+    int steps = map->points - 1;
+    int lo = q16_mul_int_round(duty_min, steps);
+    int hi = q16_mul_int_round(duty_max, steps);
+    if (lo < 0)
+        lo = 0;
+    if (hi > steps)
+        hi = steps;
+
+    reaction_map_inv_t status = REACTION_MAP_INV_ABOVE;
+    q16_t v0 = mix(r0[lo], r1[lo], t.frac);
+    int i = lo + 1;
+    if (v0 >= mv) {
+        *duty = duty_min;
+        status = REACTION_MAP_INV_BELOW;
+    } else {
+        for (; i <= hi; i++) {
+            q16_t v1 = mix(r0[i], r1[i], t.frac);
+            if (v1 >= mv) {
+                q16_t frac = v1 > v0 ? (q16_t)(((int64_t)(mv - v0) << Q16_SHIFT) / (v1 - v0)) : 0;
+                q16_t d = (q16_from_int(i - 1) + frac) / steps;
+                *duty = d < duty_min ? duty_min : d;
+                status = REACTION_MAP_INV_OK;
+                i++;
+                break;
+            }
+            v0 = v1;
+        }
+    }
+    if (status == REACTION_MAP_INV_ABOVE)
+        return status;
+
+    // Hinter dem Treffer darf die Kennlinie nicht wieder unter `mv` fallen
+    for (; i <= hi; i++)
+        if (mix(r0[i], r1[i], t.frac) < mv)
+            return REACTION_MAP_INV_AMBIGUOUS;
+    return status;
+}
+
+// Zeilen um eine Temperatur bei Bedarf aus der nächsten gültigen anlegen.
+// Die Quellen werden vor dem Kopieren bestimmt, wie sie auch
+// reaction_map_lookup() liest: sonst würde die zweite Zeile die eben
+// angelegte erste kopieren statt ihrer eigenen nächsten gültigen.
+// Rückgabe: Anzahl beteiligter Zeilen ab t.index
+static int prepare_rows(reaction_map_t *map, map_pos_t t) {
+    int rows = map->rows < 2 ? 1 : 2;
+    int src[2];
+    for (int k = 0; k < rows; k++)
+        src[k] = nearest_valid(map, t.index + k);
+    for (int k = 0; k < rows; k++) {
+        int row = t.index + k;
+        if (src[k] != row) {
+            memcpy(row_cells(map, row), row_cells(map, src[k]), sizeof(q16_t) * map->points);
+            map->row_valid |= 1u << row;
+        }
+    }
+    return rows;
+}
+
+void reaction_map_learn(reaction_map_t *map, q16_t duty, q16_t temp_c, q16_t mv) {
+    if (!reaction_map_ready(map))
+        return;
+
+    map_pos_t d = duty_pos(map, duty);
+    map_pos_t t = temp_pos(map, temp_c);
+    q16_t error = mv - reaction_map_lookup(map, duty, temp_c);
+
+    int rows = prepare_rows(map, t);
+
+    // Jede Zeile mit ihrem Temperaturgewicht um den Faktor strecken, der
+    // ihren Wert am Arbeitspunkt um error * 2^-learn_shift verschiebt.
+    // Gestreckt wird der Anteil über der Stützstelle 0 (Dunkelsignal);
+    // die Zeile bleibt dabei monoton.
+    q16_t wt[2] = { Q16_ONE - t.frac, t.frac };
+    for (int k = 0; k < rows; k++) {
+        q16_t *cells = row_cells(map, t.index + k);
+        q16_t step = q16_mul(error, wt[k]) >> map->learn_shift;
+        q16_t span = mix(cells[d.index], cells[d.index + 1], d.frac) - cells[0];
+        if (step == 0 || span < Q16_ONE)
+            continue;   // am Dunkelsignal lässt sich keine Verstärkung lernen
+        q16_t scale = (q16_t)(((int64_t)step << Q16_SHIFT) / span);
+        if (scale < -Q16_HALF)
+            scale = -Q16_HALF;
+        for (uint16_t i = 1; i < map->points; i++)
+            cells[i] += q16_mul(cells[i] - cells[0], scale);
+    }
+    map->updates++;
+}
+
+void reaction_map_refresh(reaction_map_t *map, q16_t duty, q16_t temp_c, q16_t mv,
+                          uint8_t shift) {
+    if (!reaction_map_ready(map))
+        return;
+
+    map_pos_t d = duty_pos(map, duty);
+    map_pos_t t = temp_pos(map, temp_c);
+    q16_t error = mv - reaction_map_lookup(map, duty, temp_c);
+    int rows = prepare_rows(map, t);
+
+    q16_t wt[2] = { Q16_ONE - t.frac, t.frac };
+    q16_t wd[2] = { Q16_ONE - d.frac, d.frac };
+    for (int k = 0; k < rows; k++) {
+        q16_t *cells = row_cells(map, t.index + k);
+        for (int j = 0; j < 2; j++) {
+            q16_t w = q16_mul(wt[k], wd[j]);
+            if (w == 0)
+                continue;
+            int i = d.index + j;
+            cells[i] += q16_mul(error, w) >> shift;
+
+            // Monotonie nach beiden Seiten wiederherstellen
+            for (int n = i; n > 0 && cells[n - 1] > cells[n]; n--)
+                cells[n - 1] = cells[n];
+            for (int n = i; n + 1 < map->points && cells[n + 1] < cells[n]; n++)
+                cells[n + 1] = cells[n];
+        }
+    }
+    map->updates++;
+}
@@ -0,0 +1,103 @@
+// reaction_map.h
+// Reaktionstabelle über Tastgrad und Temperatur (Kennlinienfeld).
+//
+// Das Feld besteht aus `rows` Zeilen zu je `points` Stützstellen in mV:
+// Stützstelle i einer Zeile gehört zum Tastgrad i / (points - 1), Zeile r
+// zur Temperatur t_min_c + r * t_step_c. Zwischen den Stützstellen wird
+// bilinear interpoliert, außerhalb des Temperaturbereichs gilt die
+// Randzeile.
+//
+// Eine Zeile wird gültig, wenn sie aus einem Sweep gesetzt wird oder beim
+// Lernen zum ersten Mal gebraucht wird; im zweiten Fall startet sie als
+// Kopie der nächsten gültigen Zeile. Ungültige Zeilen werden beim Lesen
+// durch die nächste gültige ersetzt.
+//
+// Lernen im Betrieb: Jeder eingeschwungene Arbeitspunkt (Tastgrad,
+// Temperatur, gemessene Spannung) zieht die beiden umgebenden Zeilen mit
+// ihren Temperaturgewichten in Richtung des Messwerts (Lernrate
+// 2^-learn_shift). Eine Zeile wird dabei als Ganzes über dem Dunkelsignal
+// (Stützstelle 0) gestreckt, so wie sich der Wirkungsgrad der Laserdiode
+// mit der Temperatur ändert: sie bleibt monoton, und der Arbeitspunkt
+// korrigiert auch die Vorsteuerung für andere Sollwerte. Ein Sweep pro
+// Temperatur ist nicht nötig. Einzelne Stützstellen lassen sich zusätzlich
+// mit kurzen Messschritten auffrischen (reaction_map_refresh()).
+//
+// Reines C in Festkomma, baut auch auf dem Host.
+
+#ifndef REACTION_MAP_H
+#define REACTION_MAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "fixed_point.h"
+
+#define REACTION_MAP_MAX_ROWS 32
+
+typedef struct {
+    q16_t *cells;           // rows x points, zeilenweise, mV in Q16
+    uint16_t points;
+    uint8_t rows;
+    q16_t t_min_c;          // Temperatur der Zeile 0
+    q16_t t_step_c;         // Abstand der Zeilen
+    uint8_t learn_shift;
+    uint32_t row_valid;     // Bit r: Zeile r gültig
+    uint32_t updates;       // eingerechnete Arbeitspunkte
+} reaction_map_t;
+
+// Einrichten; `cells` muss rows * points Werte fassen. Alle Zeilen sind
+// danach ungültig.
+bool reaction_map_init(reaction_map_t *map, q16_t *cells, uint16_t points, uint8_t rows,
+                       q16_t t_min_c, q16_t t_step_c, uint8_t learn_shift);
+
+// Zeile der nächstgelegenen Temperatur aus einer Tabelle mit `points`
+// Werten in ganzen mV setzen (z.B. nach einem Sweep).
+void reaction_map_set_row(reaction_map_t *map, q16_t temp_c, const uint16_t *mv);
+
+// Spannung beim Tastgrad `duty` (Q16, 0..1) und der Temperatur `temp_c`
+// (0 ohne gültige Zeile).
+q16_t reaction_map_lookup(const reaction_map_t *map, q16_t duty, q16_t temp_c);
+
+typedef enum {
+    REACTION_MAP_INV_OK = 0,
+    REACTION_MAP_INV_BELOW,         // schon bei duty_min erreicht
+    REACTION_MAP_INV_ABOVE,         // bis duty_max nicht erreichbar (oder kein Feld)
+    REACTION_MAP_INV_AMBIGUOUS,     // Kennlinie fällt hinter dem Treffer wieder unter `mv`
+} reaction_map_inv_t;
+
+// Umkehrung der Kennlinie bei `temp_c`: kleinster Tastgrad in
+// [duty_min, duty_max], bei dem das Feld die Spannung `mv` erreicht
+// (Umkehrung der monotonen Hülle, linear zwischen den Stützstellen).
+// `duty` erhält den Tastgrad bzw. den passenden Rand. Ein nicht monotoner
+// Abschnitt hinter dem Treffer wird als REACTION_MAP_INV_AMBIGUOUS gemeldet;
+// der Tastgrad gilt dann nur bis zum nächsten Einbruch der Kennlinie.
+reaction_map_inv_t reaction_map_inverse(const reaction_map_t *map, q16_t mv, q16_t temp_c,
+                                        q16_t duty_min, q16_t duty_max, q16_t *duty);
+
+// Wie reaction_map_inverse(), nur der Tastgrad
+static inline q16_t reaction_map_duty_for(const reaction_map_t *map, q16_t mv, q16_t temp_c,
+                                          q16_t duty_min, q16_t duty_max) {
+    q16_t duty;
+    reaction_map_inverse(map, mv, temp_c, duty_min, duty_max, &duty);
+    return duty;
+}
+
+// Eingeschwungenen Arbeitspunkt einrechnen (ohne gültige Zeile wirkungslos).
+void reaction_map_learn(reaction_map_t *map, q16_t duty, q16_t temp_c, q16_t mv);
+
+// Einzelne Messung (z.B. eines Messschritts) lokal einrechnen: nur die
+// umgebenden Zellen gehen mit ihren bilinearen Gewichten und der Rate
+// 2^-shift auf den Messwert zu; Nachbarn, die danach die Monotonie
+// verletzen, werden auf den Wert der Zelle begrenzt.
+void reaction_map_refresh(reaction_map_t *map, q16_t duty, q16_t temp_c, q16_t mv,
+                          uint8_t shift);
+
+static inline bool reaction_map_ready(const reaction_map_t *map) {
+    return map->row_valid != 0;
+}
+
+// Temperatur einer Zeile
+static inline q16_t reaction_map_row_temp(const reaction_map_t *map, uint8_t row) {
+    return map->t_min_c + map->t_step_c * row;
+}
+
+#endif // REACTION_MAP_H
@@ -0,0 +1,60 @@
+// segment_store.c
+// Segmentierter Messspeicher (siehe segment_store.h).
+
+#include <stddef.h>
+#include "segment_store.h"
+
+bool segment_store_init(segment_store_t *store, const trigger_config_t *cfg,
+                        uint16_t *window, uint16_t *storage, uint32_t capacity,
+                        uint64_t *trigger_seq, uint32_t max_info, uint32_t segments) {
+    uint32_t len = cfg->pre + cfg->post;
+    if (storage == NULL || trigger_seq == NULL || len == 0
+        || !trigger_init(&store->trig, cfg, window, len))
+        return false;
+
+    uint32_t n = capacity / len;
+    if (n > max_info)
+        n = max_info;
+    if (segments > 0 && n > segments)
+        n = segments;
+    if (n == 0)
+        return false;
+
+    store->storage = storage;
+    store->trigger_seq = trigger_seq;
+    store->segment_len = len;
+    store->max_segments = n;
+    store->count = 0;
+    return true;
+}
+
+void segment_store_arm(segment_store_t *store) {
+    store->count = 0;
+    trigger_arm(&store->trig);
+}
+
+void segment_store_gap(segment_store_t *store, uint32_t invalid) {
+    store->count = invalid < store->count ? store->count - invalid : 0;
+    trigger_arm(&store->trig);
+}
+
+uint32_t segment_store_feed(segment_store_t *store, const uint16_t *samples,
+                            uint64_t first_seq, uint32_t n) {
+    uint32_t done = 0;
+
+    while (n > 0 && !segment_store_full(store)) {
+        uint32_t used = trigger_feed(&store->trig, samples, first_seq, n);
+        samples += used;
+        first_seq += used;
+        n -= used;
+
+        if (trigger_done(&store->trig)) {
+            uint32_t k = store->count++;
+            trigger_copy_window(&store->trig, store->storage + k * store->segment_len);
+            store->trigger_seq[k] = store->trig.trigger_seq;
+            trigger_rearm(&store->trig);
+            done++;
+        }
+    }
+    return done;
+}
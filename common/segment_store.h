@@ -0,0 +1,67 @@
+// segment_store.h
+// Segmentierter Messspeicher (wie beim Oszilloskop): viele trigger-
+// ausgerichtete Fenster hintereinander, ohne Totzeit zwischen den Fenstern.
+//
+// Der Sample-Strom läuft durch einen trigger_t; jedes fertige Fenster wird
+// in das nächste Segment eines großen Speicherbereichs kopiert und der
+// Trigger sofort wieder scharf geschaltet (trigger_rearm). Auswertung und
+// Ausgabe passieren erst, wenn alle Segmente voll sind.
+//
+// Pro Segment wird der Index des auslösenden Samples festgehalten; die
+// Zeit folgt daraus über die Abtastperiode (adc_clock.h).
+//
+// Reines C ohne SDK-Abhängigkeiten, baut auch auf dem Host.
+
+#ifndef SEGMENT_STORE_H
+#define SEGMENT_STORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "trigger.h"
+
+typedef struct {
+    trigger_t trig;
+    uint16_t *storage;      // max_segments * segment_len Samples
+    uint64_t *trigger_seq;  // Trigger-Index je Segment
+    uint32_t segment_len;   // pre + post
+    uint32_t max_segments;
+    uint32_t count;         // fertige Segmente
+} segment_store_t;
+
+// Einrichten: `storage` fasst `capacity` Samples, `trigger_seq` `max_info`
+// Einträge, `window` pre + post Samples für den Trigger-Ring. Die Anzahl der
+// Segmente ist das Minimum aus Speicher und `max_info`, höchstens `segments`.
+// Gibt false zurück, wenn nicht einmal ein Segment passt.
+bool segment_store_init(segment_store_t *store, const trigger_config_t *cfg,
+                        uint16_t *window, uint16_t *storage, uint32_t capacity,
+                        uint64_t *trigger_seq, uint32_t max_info, uint32_t segments);
+
+// Alle Segmente verwerfen und den Trigger scharf schalten.
+void segment_store_arm(segment_store_t *store);
+
+// `n` aufeinanderfolgende Samples ab Index `first_seq` einspeisen.
+// Rückgabe: Anzahl neu fertiger Segmente.
+uint32_t segment_store_feed(segment_store_t *store, const uint16_t *samples,
+                            uint64_t first_seq, uint32_t n);
+
+// Lücke im Sample-Strom (z.B. DMA-Block-Überlauf): das offene Fenster
+// enthält nicht zusammenhängende Samples und wird verworfen, zusammen mit
+// den letzten `invalid` fertigen Segmenten. Der Trigger wird neu scharf
+// geschaltet und wartet die Vorgeschichte wieder ab.
+void segment_store_gap(segment_store_t *store, uint32_t invalid);
+
+static inline bool segment_store_full(const segment_store_t *store) {
+    return store->count >= store->max_segments;
+}
+
+// Samples von Segment `k` (der Trigger liegt bei Index cfg.pre)
+static inline const uint16_t *segment_store_samples(const segment_store_t *store, uint32_t k) {
+    return store->storage + k * store->segment_len;
+}
+
+// Index des ersten Samples von Segment `k`
+static inline uint64_t segment_store_first_seq(const segment_store_t *store, uint32_t k) {
+    return store->trigger_seq[k] - store->trig.cfg.pre;
+}
+
+#endif // SEGMENT_STORE_H
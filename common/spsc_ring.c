@@ -0,0 +1,54 @@
+// spsc_ring.c
+// Sperrfreier SPSC-Ringpuffer (siehe spsc_ring.h).
+
+#include <stddef.h>
+#include "spsc_ring.h"
+
+bool spsc_ring_init(spsc_ring_t *ring, void *storage, uint32_t slot_size, uint32_t slot_count) {
+    if (storage == NULL || slot_size == 0 || slot_count == 0)
+        return false;
+    if ((slot_count & (slot_count - 1)) != 0)
+        return false;
+
+    ring->storage = storage;
+    ring->slot_size = slot_size;
+    ring->slot_count = slot_count;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->overflows = 0;
+    return true;
+}
+
+static inline void *slot(const spsc_ring_t *ring, uint32_t seq) {
+    return ring->storage + (seq & (ring->slot_count - 1)) * ring->slot_size;
+}
+
+void *spsc_ring_claim(spsc_ring_t *ring) {
+    uint32_t head = ring->head;     // eigener Zähler
+    // Acquire: der Konsument ist mit dem Slot fertig, bevor er ihn freigibt
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if (head - tail >= ring->slot_count) {
+        __atomic_store_n(&ring->overflows, ring->overflows + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    return slot(ring, head);
+}
+
+void spsc_ring_publish(spsc_ring_t *ring) {
+    // Release: Slot-Inhalt vor dem neuen head sichtbar machen
+    __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+const void *spsc_ring_peek(spsc_ring_t *ring) {
+    uint32_t tail = ring->tail;     // eigener Zähler
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    if (head == tail)
+        return NULL;
+    return slot(ring, tail);
+}
+
+void spsc_ring_release(spsc_ring_t *ring) {
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,60 @@
+// spsc_ring.h
+// Sperrfreier Ringpuffer für genau einen Produzenten und einen Konsumenten,
+// z.B. Core1 -> Core0 im gemeinsamen SRAM.
+//
+// Der Ring besteht aus `slot_count` gleich großen Slots (z.B. ein Batch von
+// Samples). Der Produzent holt sich mit spsc_ring_claim() den nächsten
+// freien Slot, füllt ihn und gibt ihn mit spsc_ring_publish() frei. Der
+// Konsument liest mit spsc_ring_peek() den ältesten Slot und gibt ihn mit
+// spsc_ring_release() zurück. `head` schreibt nur der Produzent, `tail` nur
+// der Konsument; die Zugriffe darauf sind Acquire/Release-Atomics, damit
+// der Slot-Inhalt sichtbar ist, bevor der Zähler weitergeht.
+//
+// Ist der Ring voll, liefert spsc_ring_claim() NULL und zählt einen
+// Überlauf; der Produzent entscheidet, was mit den Daten passiert.
+// Reines C ohne SDK-Abhängigkeiten, baut auch auf dem Host (Threads).
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    uint8_t *storage;           // slot_count * slot_size Bytes
+    uint32_t slot_size;
+    uint32_t slot_count;        // Zweierpotenz
+    uint32_t head;              // veröffentlichte Slots (monoton, nur Produzent)
+    uint32_t tail;              // freigegebene Slots (monoton, nur Konsument)
+    uint32_t overflows;         // fehlgeschlagene claims (nur Produzent)
+} spsc_ring_t;
+
+// Initialisiert den Ring. Gibt false bei ungültigen Parametern zurück,
+// auch wenn slot_count keine Zweierpotenz ist (sonst springt der Slot beim
+// Überlauf der 32-Bit-Zähler).
+bool spsc_ring_init(spsc_ring_t *ring, void *storage, uint32_t slot_size, uint32_t slot_count);
+
+// Produzent: nächsten freien Slot holen (NULL und Überlauf, wenn voll).
+void *spsc_ring_claim(spsc_ring_t *ring);
+
+// Produzent: den zuletzt geholten Slot veröffentlichen.
+void spsc_ring_publish(spsc_ring_t *ring);
+
+// Konsument: ältesten veröffentlichten Slot holen (NULL, wenn leer).
+const void *spsc_ring_peek(spsc_ring_t *ring);
+
+// Konsument: den mit spsc_ring_peek() geholten Slot freigeben.
+void spsc_ring_release(spsc_ring_t *ring);
+
+// Anzahl veröffentlichter, noch nicht freigegebener Slots (beide Seiten).
+static inline uint32_t spsc_ring_available(const spsc_ring_t *ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)
+         - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+// Überläufe (von beiden Seiten lesbar).
+static inline uint32_t spsc_ring_overflows(const spsc_ring_t *ring) {
+    return __atomic_load_n(&ring->overflows, __ATOMIC_RELAXED);
+}
+
+#endif // SPSC_RING_H
@@ -0,0 +1,99 @@
+// telemetry.c
+// Binäres Telemetrie-Frameformat (siehe telemetry.h).
+
+#include "pico/stdlib.h"
+#include "crc.h"
+#include "telemetry.h"
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+size_t telemetry_encode(uint8_t *out, size_t out_len, uint8_t type, uint16_t seq,
+                        uint16_t aux, uint64_t timestamp_ns, uint32_t sample_period_ps,
+                        const uint16_t *samples, uint16_t count) {
+    size_t len = TELEMETRY_FRAME_LEN((size_t)count);
+    if (out_len < len)
+        return 0;
+
+    put_u16(out, TELEMETRY_SYNC);
+    out[2] = TELEMETRY_VERSION;
+    out[3] = type;
+    put_u16(out + 4, seq);
+    put_u16(out + 6, count);
+    put_u16(out + 8, aux);
+    put_u64(out + 10, timestamp_ns);
+    put_u32(out + 18, sample_period_ps);
+
+    // Zwei 12-Bit-Samples -> 3 Bytes: a[7:0], b[3:0]|a[11:8], b[11:4]
+    uint8_t *p = out + TELEMETRY_HEADER_LEN;
+    uint16_t i = 0;
+    for (; i + 1 < count; i += 2) {
+        uint16_t a = samples[i] & 0x0fff;
+        uint16_t b = samples[i + 1] & 0x0fff;
+        *p++ = (uint8_t)a;
+        *p++ = (uint8_t)((a >> 8) | (b << 4));
+        *p++ = (uint8_t)(b >> 4);
+    }
+    if (i < count) {
+        uint16_t a = samples[i] & 0x0fff;
+        *p++ = (uint8_t)a;
+        *p++ = (uint8_t)(a >> 8);
+    }
+
+    uint16_t crc = crc16_ccitt(CRC16_INIT, out + 2, (size_t)(p - out) - 2);
+    put_u16(p, crc);
+    return len;
+}
+
+void telemetry_send(uint8_t type, uint16_t seq, uint16_t aux, uint64_t timestamp_ns,
+                    uint32_t sample_period_ps, const uint16_t *samples, uint16_t count) {
+    static uint8_t frame[TELEMETRY_FRAME_LEN(TELEMETRY_MAX_SAMPLES)];
+
+    if (count > TELEMETRY_MAX_SAMPLES)
+        count = TELEMETRY_MAX_SAMPLES;
+    size_t len = telemetry_encode(frame, sizeof(frame), type, seq, aux,
+                                  timestamp_ns, sample_period_ps, samples, count);
+    // Binärdaten dürfen nicht durch die \n -> \r\n Übersetzung laufen
+    stdio_put_string((const char *)frame, (int)len, false, false);
+}
+
+void telemetry_batch_init(telemetry_batch_t *batch, uint8_t type, uint32_t sample_period_ps) {
+    batch->type = type;
+    batch->seq = 0;
+    batch->count = 0;
+    batch->aux = 0;
+    batch->sample_period_ps = sample_period_ps;
+    batch->timestamp_ns = 0;
+}
+
+void telemetry_batch_add_block(telemetry_batch_t *batch, uint64_t t0_ns,
+                               const uint16_t *samples, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        if (batch->count == 0)
+            batch->timestamp_ns = t0_ns + ((uint64_t)i * batch->sample_period_ps + 500u) / 1000u;
+        batch->samples[batch->count++] = samples[i];
+        if (batch->count >= TELEMETRY_MAX_SAMPLES)
+            telemetry_batch_flush(batch);
+    }
+}
+
+void telemetry_batch_flush(telemetry_batch_t *batch) {
+    if (batch->count == 0)
+        return;
+    telemetry_send(batch->type, batch->seq, batch->aux, batch->timestamp_ns,
+                   batch->sample_period_ps, batch->samples, batch->count);
+    batch->seq++;
+    batch->count = 0;
+}
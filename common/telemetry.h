@@ -0,0 +1,86 @@
+// telemetry.h
+// Binäres Telemetrie-Frameformat als Alternative zu den CSV-Zeilen.
+//
+// Aufbau (Little Endian):
+//   0  u16  Sync 0x5AA5 (Bytes A5 5A)
+//   2  u8   Version (TELEMETRY_VERSION)
+//   3  u8   Frame-Typ (telemetry_frame_type_t)
+//   4  u16  Sequenznummer (läuft über)
+//   6  u16  Anzahl Samples
+//   8  u16  Zusatzwert (z.B. PWM in Promille, Pulszustand)
+//  10  u64  Zeitstempel des ersten Samples in ns
+//  18  u32  Abtastperiode in ps (Sample i liegt bei Zeitstempel + i * Periode)
+//  22  ...  Samples, je zwei 12-Bit-Werte in 3 Bytes gepackt
+//   n  u16  CRC-16/CCITT über alles ab Byte 2 bis Ende der Samples
+//
+// Version 1 hatte einen Zeitstempel in us und keine Abtastperiode (Header
+// 18 Bytes). Der Host-Decoder liegt in oszi_visualizer_live/telemetry.py
+// und versteht beide Versionen.
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TELEMETRY_SYNC 0x5AA5u
+#define TELEMETRY_VERSION 2
+#define TELEMETRY_HEADER_LEN 22
+#define TELEMETRY_CRC_LEN 2
+#define TELEMETRY_MAX_SAMPLES 512
+
+// Nutzdatenlänge für n gepackte 12-Bit-Samples
+#define TELEMETRY_PAYLOAD_LEN(n) ((((n) * 3u) + 1u) / 2u)
+#define TELEMETRY_FRAME_LEN(n) (TELEMETRY_HEADER_LEN + TELEMETRY_PAYLOAD_LEN(n) + TELEMETRY_CRC_LEN)
+
+typedef enum {
+    TELEMETRY_CSV = 0,
+    TELEMETRY_BINARY = 1,
+} telemetry_mode_t;
+
+typedef enum {
+    TELEMETRY_FRAME_SAMPLES = 1,
+    TELEMETRY_FRAME_TRIGGER = 2,    // Trigger-Fenster, ggf. auf mehrere Frames verteilt
+    TELEMETRY_FRAME_CHANNEL = 3,    // ein Kanal eines Mehrkanal-Stroms, Zusatzwert = ADC-Eingang
+} telemetry_frame_type_t;
+
+// TELEMETRY_FRAME_CHANNEL: Abtastperiode 0, wenn sie über 4,29 ms liegt; dann
+// trägt jeder Frame nur einen Sample mit eigenem Zeitstempel.
+
+// Zusatzwert von TELEMETRY_FRAME_TRIGGER: Bits 0..14 Anzahl Samples vor dem
+// Trigger im ganzen Fenster, Bit 15 markiert den letzten Frame des Fensters
+#define TELEMETRY_TRIGGER_LAST 0x8000u
+
+// Sammelt Samples bis ein Frame voll ist
+typedef struct {
+    uint8_t type;
+    uint16_t seq;
+    uint16_t count;
+    uint16_t aux;
+    uint32_t sample_period_ps;
+    uint64_t timestamp_ns;
+    uint16_t samples[TELEMETRY_MAX_SAMPLES];
+} telemetry_batch_t;
+
+// Frame in `out` kodieren. Rückgabe: Frame-Länge, 0 wenn `out` zu klein ist.
+size_t telemetry_encode(uint8_t *out, size_t out_len, uint8_t type, uint16_t seq,
+                        uint16_t aux, uint64_t timestamp_ns, uint32_t sample_period_ps,
+                        const uint16_t *samples, uint16_t count);
+
+// Frame kodieren und ohne CRLF-Übersetzung über stdio senden.
+void telemetry_send(uint8_t type, uint16_t seq, uint16_t aux, uint64_t timestamp_ns,
+                    uint32_t sample_period_ps, const uint16_t *samples, uint16_t count);
+
+void telemetry_batch_init(telemetry_batch_t *batch, uint8_t type, uint32_t sample_period_ps);
+
+// `n` aufeinanderfolgende Samples anhängen, das erste fertig bei `t0_ns`.
+// Volle Frames werden gesendet; der Zeitstempel eines neuen Frames folgt
+// aus dem Index im Block und der Abtastperiode.
+void telemetry_batch_add_block(telemetry_batch_t *batch, uint64_t t0_ns,
+                               const uint16_t *samples, uint32_t n);
+
+// Angefangenen Frame senden (falls Samples vorhanden).
+void telemetry_batch_flush(telemetry_batch_t *batch);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,107 @@
+// trigger.c
+// Trigger mit Vorgeschichte (siehe trigger.h).
+
+#include <stddef.h>
+#include "trigger.h"
+
+bool trigger_init(trigger_t *trig, const trigger_config_t *cfg,
+                  uint16_t *samples, uint32_t capacity) {
+    // pre + post könnte überlaufen, daher gegen den Rest prüfen
+    if (samples == NULL || cfg->post == 0 || cfg->post > capacity || cfg->pre > capacity - cfg->post)
+        return false;
+
+    trig->cfg = *cfg;
+    trig->samples = samples;
+    trig->len = cfg->pre + cfg->post;
+    trig->state = TRIGGER_IDLE;
+    trig->external_pending = false;
+    return true;
+}
+
+void trigger_arm(trigger_t *trig) {
+    trig->pos = 0;
+    trig->seen = 0;
+    trig->primed = false;
+    trig->external_pending = false;
+    trig->state = TRIGGER_ARMED;
+}
+
+void trigger_rearm(trigger_t *trig) {
+    // Ring ist voll und lückenlos, `pos` zeigt schon auf den ältesten Sample
+    trig->seen = trig->len;
+    trig->primed = false;
+    trig->external_pending = false;
+    trig->state = TRIGGER_ARMED;
+}
+
+void trigger_external(trigger_t *trig, uint64_t seq) {
+    trig->external_seq = seq;
+    trig->external_pending = true;
+}
+
+// Prüft, ob Sample `v` mit Index `seq` den Trigger auslöst
+static bool fires(trigger_t *trig, uint16_t v, uint64_t seq) {
+    const trigger_config_t *cfg = &trig->cfg;
+
+    // Hysterese für Flanken: erst den Gegenbereich sehen
+    if (cfg->mode == TRIGGER_RISING && v + cfg->hysteresis < cfg->level)
+        trig->primed = true;
+    else if (cfg->mode == TRIGGER_FALLING && v > cfg->level + cfg->hysteresis)
+        trig->primed = true;
+
+    // Vorgeschichte und Holdoff abwarten
+    if (trig->seen < cfg->pre || trig->seen < cfg->holdoff)
+        return false;
+
+    if (trig->external_pending)
+        return seq >= trig->external_seq;
+
+    switch (cfg->mode) {
+    case TRIGGER_RISING:  return trig->primed && v >= cfg->level;
+    case TRIGGER_FALLING: return trig->primed && v <= cfg->level;
+    case TRIGGER_ABOVE:   return v >= cfg->level;
+    case TRIGGER_BELOW:   return v <= cfg->level;
+    default:              return false;
+    }
+}
+
+uint32_t trigger_feed(trigger_t *trig, const uint16_t *samples, uint64_t first_seq, uint32_t n) {
+    uint32_t i = 0;
+
+    for (; i < n; i++) {
+        if (trig->state == TRIGGER_ARMED) {
+            if (fires(trig, samples[i], first_seq + i)) {
+                trig->state = TRIGGER_POST;
+                trig->remaining = trig->cfg.post;
+                trig->external_pending = false;
+                trig->trigger_seq = first_seq + i;
+            }
+        } else if (trig->state != TRIGGER_POST) {
+            break;
+        }
+
+        trig->samples[trig->pos] = samples[i];
+        trig->pos = trig->pos + 1 == trig->len ? 0 : trig->pos + 1;
+        // Sättigen statt überlaufen: bei 500 kS/s wäre der Zähler nach
+        // 2,4 h wieder 0 und Vorgeschichte/Holdoff würden neu abgewartet
+        if (trig->seen != UINT32_MAX)
+            trig->seen++;
+
+        if (trig->state == TRIGGER_POST && --trig->remaining == 0) {
+            trig->state = TRIGGER_DONE;
+            i++;
+            break;
+        }
+    }
+    return i;
+}
+
+void trigger_copy_window(const trigger_t *trig, uint16_t *samples) {
+    // Ring ist voll, der älteste Sample liegt an der Schreibposition
+    for (uint32_t k = 0; k < trig->len; k++) {
+        uint32_t j = trig->pos + k;
+        if (j >= trig->len)
+            j -= trig->len;
+        samples[k] = trig->samples[j];
+    }
+}
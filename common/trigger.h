@@ -0,0 +1,100 @@
+// trigger.h
+// Trigger mit Vorgeschichte (Oszilloskop-Modus) auf einem Sample-Strom.
+//
+// Der Trigger schreibt jeden Sample in einen Ring der Länge pre + post.
+// Bis zum Auslösen enthält der Ring die Vorgeschichte; nach dem Auslösen
+// werden noch `post` Samples (inkl. des auslösenden) aufgenommen, danach
+// steht das Fenster [Trigger - pre, Trigger + post) bereit und der Trigger
+// nimmt nichts mehr an, bis er neu scharf geschaltet wird.
+//
+// Auslösen frühestens, wenn die Vorgeschichte voll und die Holdoff-Zeit
+// seit dem Scharfschalten abgelaufen ist. Flankentrigger brauchen zusätzlich
+// die Hysterese: steigend löst erst aus, nachdem das Signal unter
+// level - hysteresis war, fallend erst nach level + hysteresis.
+//
+// Zeit wird als laufender Sample-Index (64 Bit) übergeben; die Umrechnung
+// in Zeit macht der Aufrufer über die Abtastperiode (adc_clock.h).
+//
+// Reines C ohne SDK-Abhängigkeiten, baut auch auf dem Host.
+
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    TRIGGER_RISING = 0,     // Flanke über `level`
+    TRIGGER_FALLING,        // Flanke unter `level`
+    TRIGGER_ABOVE,          // Pegel >= level
+    TRIGGER_BELOW,          // Pegel <= level
+    TRIGGER_EXTERNAL,       // nur trigger_external() (z.B. kommandierte Pulsflanke)
+} trigger_mode_t;
+
+typedef enum {
+    TRIGGER_IDLE = 0,       // nicht scharf
+    TRIGGER_ARMED,          // wartet auf das Ereignis
+    TRIGGER_POST,           // ausgelöst, sammelt Nachlauf
+    TRIGGER_DONE,           // Fenster vollständig
+} trigger_state_t;
+
+typedef struct {
+    trigger_mode_t mode;
+    uint16_t level;         // Schwelle in ADC-Schritten
+    uint16_t hysteresis;    // in ADC-Schritten
+    uint32_t pre;           // Samples vor dem Trigger
+    uint32_t post;          // Samples ab dem Trigger (>= 1)
+    uint32_t holdoff;       // Samples nach dem Scharfschalten ohne Auslösen
+} trigger_config_t;
+
+typedef struct {
+    trigger_config_t cfg;
+    uint16_t *samples;      // Ring, pre + post Einträge
+    uint32_t len;
+    uint32_t pos;           // nächste Schreibposition
+    uint32_t seen;          // Samples seit dem Scharfschalten, bleibt bei UINT32_MAX stehen
+    uint32_t remaining;     // noch aufzunehmende Nachlauf-Samples
+    bool primed;            // Hysterese-Bedingung für Flanken erfüllt
+    bool external_pending;
+    uint64_t external_seq;
+    volatile trigger_state_t state;
+    uint64_t trigger_seq;   // Index des auslösenden Samples
+} trigger_t;
+
+// Einrichten. `samples` muss pre + post Einträge fassen.
+// Gibt false bei ungültiger Konfiguration zurück.
+bool trigger_init(trigger_t *trig, const trigger_config_t *cfg,
+                  uint16_t *samples, uint32_t capacity);
+
+// Scharf schalten (verwirft die bisherige Vorgeschichte).
+void trigger_arm(trigger_t *trig);
+
+// Nach einem fertigen Fenster sofort wieder scharf schalten, ohne Totzeit:
+// der Ring dient direkt als Vorgeschichte des nächsten Fensters, der
+// Holdoff zählt ab dem Beginn des letzten Fensters.
+void trigger_rearm(trigger_t *trig);
+
+// Externes Ereignis: löst beim ersten Sample mit Index >= seq aus. Wirkt in
+// jeder Betriebsart und hat Vorrang vor der Schwelle; Vorgeschichte und
+// Holdoff gelten auch hier.
+void trigger_external(trigger_t *trig, uint64_t seq);
+
+// `n` aufeinanderfolgende Samples ab Index `first_seq` einspeisen.
+// Rückgabe: Anzahl verbrauchter Samples; weniger als `n`, sobald das
+// Fenster vollständig ist.
+uint32_t trigger_feed(trigger_t *trig, const uint16_t *samples, uint64_t first_seq, uint32_t n);
+
+static inline bool trigger_done(const trigger_t *trig) {
+    return trig->state == TRIGGER_DONE;
+}
+
+// Index des ersten Samples im fertigen Fenster
+static inline uint64_t trigger_window_seq(const trigger_t *trig) {
+    return trig->trigger_seq - trig->cfg.pre;
+}
+
+// Fertiges Fenster in zeitlicher Reihenfolge kopieren (pre + post Samples,
+// der Trigger liegt bei Index pre).
+void trigger_copy_window(const trigger_t *trig, uint16_t *samples);
+
+#endif // TRIGGER_H
@@ -0,0 +1,27 @@
+// hardware/adc.h (Host-Simulation)
+// ADC0 liefert das Photodioden-Signal des Streckenmodells, ADC4 den
+// internen Temperatursensor.
+
+#ifndef _HARDWARE_ADC_H
+#define _HARDWARE_ADC_H
+
+#include "pico.h"
+
+#define NUM_ADC_CHANNELS 5
+#define ADC_TEMPERATURE_CHANNEL_NUM 4
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+uint adc_get_selected_input(void);
+uint16_t adc_read(void);
+void adc_set_temp_sensor_enabled(bool enable);
+void adc_set_clkdiv(float clkdiv);
+void adc_set_round_robin(uint input_mask);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+void adc_run(bool run);
+void adc_fifo_drain(void);
+// Free-Running-Modus: wartet auf die nächste Wandlung im Takt von adc_set_clkdiv
+uint16_t adc_fifo_get_blocking(void);
+
+#endif
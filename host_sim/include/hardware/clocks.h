@@ -0,0 +1,27 @@
+// hardware/clocks.h (Host-Simulation)
+
+#ifndef _HARDWARE_CLOCKS_H
+#define _HARDWARE_CLOCKS_H
+
+#include "pico.h"
+
+typedef enum clock_num_rp2040 {
+    clk_gpout0 = 0,
+    clk_gpout1,
+    clk_gpout2,
+    clk_gpout3,
+    clk_ref,
+    clk_sys,
+    clk_peri,
+    clk_usb,
+    clk_adc,
+    clk_rtc,
+    CLK_COUNT
+} clock_num_t;
+
+typedef clock_num_t clock_handle_t;
+
+uint32_t clock_get_hz(clock_handle_t clock);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+
+#endif
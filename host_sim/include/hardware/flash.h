@@ -0,0 +1,17 @@
+// hardware/flash.h (Host-Simulation)
+// Der Flash ist ein RAM-Abbild (sim_flash_image), optional in einer Datei
+// gespiegelt (SIM_FLASH_FILE).
+
+#ifndef _HARDWARE_FLASH_H
+#define _HARDWARE_FLASH_H
+
+#include "pico.h"
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#define FLASH_BLOCK_SIZE (1u << 16)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif
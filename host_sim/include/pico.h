@@ -0,0 +1,33 @@
+// pico.h (Host-Simulation)
+// Grundtypen und Plattformmakros des Pico-SDK für den Host-Build.
+
+#ifndef _PICO_H
+#define _PICO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PICO_ON_DEVICE 0
+#define PICO_NO_HARDWARE 1
+
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#endif
+
+typedef unsigned int uint;
+
+// Flash-Abbild der Simulation liegt im RAM, XIP_BASE zeigt darauf
+extern uint8_t sim_flash_image[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)sim_flash_image)
+
+#define __not_in_flash_func(f) f
+#define __time_critical_func(f) f
+
+#define PICO_OK 0
+#define PICO_ERROR_TIMEOUT (-1)
+#define PICO_ERROR_GENERIC (-2)
+
+void tight_loop_contents(void);
+
+#endif
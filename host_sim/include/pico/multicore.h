@@ -0,0 +1,17 @@
+// pico/multicore.h (Host-Simulation)
+// Core1 läuft als eigener Thread mit eigener virtueller Uhr (wartet auf
+// Core0), die FIFOs sind 8 Worte tief wie auf dem RP2040.
+
+#ifndef _PICO_MULTICORE_H
+#define _PICO_MULTICORE_H
+
+#include "pico.h"
+
+void multicore_launch_core1(void (*entry)(void));
+bool multicore_fifo_rvalid(void);
+bool multicore_fifo_wready(void);
+void multicore_fifo_push_blocking(uint32_t data);
+uint32_t multicore_fifo_pop_blocking(void);
+void multicore_fifo_drain(void);
+
+#endif
@@ -0,0 +1,16 @@
+// pico/stdlib.h (Host-Simulation)
+
+#ifndef _PICO_STDLIB_H
+#define _PICO_STDLIB_H
+
+#include "pico.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);
+int putchar_raw(int c);
+int stdio_put_string(const char *s, int len, bool newline, bool cr_translation);
+void stdio_flush(void);
+
+#endif
@@ -0,0 +1,204 @@
+// sim_adc_capture.c
+// Host-Ersatz für common/adc_capture.c.
+//
+// Statt DMA und IRQ füllt ein Tick der Simulation die Blöcke des Rings
+// bzw. den Puffer der Einzelerfassung nach: Sample k gehört zum Zeitpunkt
+// t0 + (k + 1) * Periode und wird erzeugt, sobald die virtuelle Zeit diesen
+// Zeitpunkt erreicht hat. Im Round-Robin-Modus gehört Sample k zum Eingang
+// an Position k mod Anzahl der Folge. Die Schnittstelle ist identisch zu
+// adc_capture.h.
+
+#include <stddef.h>
+
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "adc_capture.h"
+#include "sim_hal.h"
+
+typedef enum {
+    MODE_IDLE,
+    MODE_STREAM,
+    MODE_ONESHOT
+} capture_mode_t;
+
+static capture_ring_t ring;
+static adc_capture_config_t config;
+static bool ring_ready = false;
+static bool tick_registered = false;
+
+static volatile capture_mode_t mode = MODE_IDLE;
+static uint64_t t0_ns;
+static double period_ns;            // exakt aus adc_clock_period_ps()
+static uint64_t produced;           // erzeugte Samples seit Start
+
+static unsigned inputs[NUM_ADC_CHANNELS];  // Round-Robin-Folge ab config.input
+static unsigned input_count;
+
+static uint16_t *oneshot_dst;
+static uint32_t oneshot_len;
+
+static uint64_t sample_time(uint64_t k) {
+    return t0_ns + (uint64_t)((double)(k + 1) * period_ns);
+}
+
+static uint16_t sample(uint64_t k) {
+    return sim_adc_sample(inputs[k % input_count], sample_time(k));
+}
+
+// Alle bis `now` fälligen Samples erzeugen (läuft unter sim_lock).
+// Rückgabe: Zeitpunkt, ab dem wieder etwas zu tun ist.
+static uint64_t capture_fill(uint64_t now) {
+    if (mode == MODE_ONESHOT) {
+        while (produced < oneshot_len && sample_time(produced) <= now) {
+            oneshot_dst[produced] = sample(produced);
+            produced++;
+            sim_count_conversions(1);
+        }
+        if (produced >= oneshot_len) {
+            mode = MODE_IDLE;
+            return SIM_NEVER;
+        }
+        // Fortschritt ist über adc_capture_oneshot_position() sichtbar
+        return sample_time(produced);
+    }
+
+    if (mode != MODE_STREAM)
+        return SIM_NEVER;
+
+    // Nach langen Pausen ganze Blöcke ohne Inhalt überspringen: sie wären
+    // ohnehin überschrieben worden, bevor der Konsument sie liest
+    uint64_t due = (uint64_t)((double)(now - t0_ns) / period_ns);
+    uint64_t keep = (uint64_t)ring.block_len * ring.block_count;
+    if (due > produced + keep) {
+        uint64_t skip_blocks = (due - keep - produced) / ring.block_len;
+        if (produced % ring.block_len != 0 && skip_blocks > 0) {
+            // angefangenen Block abschließen
+            produced += ring.block_len - produced % ring.block_len;
+            capture_ring_commit(&ring);
+            skip_blocks--;
+        }
+        for (uint64_t i = 0; i < skip_blocks; i++)
+            capture_ring_commit(&ring);
+        produced += skip_blocks * ring.block_len;
+        sim_count_conversions((uint32_t)(skip_blocks * ring.block_len));
+    }
+
+    while (sample_time(produced) <= now) {
+        uint16_t *block = capture_ring_block(&ring, ring.head);
+        block[produced % ring.block_len] = sample(produced);
+        produced++;
+        sim_count_conversions(1);
+        if (produced % ring.block_len == 0)
+            capture_ring_commit(&ring);
+    }
+    // Der Konsument sieht nur fertige Blöcke
+    return sample_time(produced - produced % ring.block_len + ring.block_len - 1);
+}
+
+bool adc_capture_init(const adc_capture_config_t *cfg) {
+    config = *cfg;
+
+    ring_ready = false;
+    if (cfg->buffer != NULL) {
+        if (!capture_ring_init(&ring, cfg->buffer, cfg->block_len, cfg->block_count))
+            return false;
+        ring_ready = true;
+    }
+
+    if (!tick_registered) {
+        sim_register_tick(capture_fill);
+        tick_registered = true;
+    }
+
+    // Folge wie die Hardware: ab `input` aufsteigend, danach von vorn
+    unsigned mask = cfg->round_robin | (1u << cfg->input);
+    input_count = 0;
+    for (unsigned i = 0; i < NUM_ADC_CHANNELS; i++) {
+        unsigned in = (cfg->input + i) % NUM_ADC_CHANNELS;
+        if (mask & (1u << in))
+            inputs[input_count++] = in;
+    }
+
+    adc_set_round_robin(cfg->round_robin);
+    adc_select_input(cfg->input);
+    adc_set_clkdiv(cfg->clkdiv);
+    period_ns = adc_capture_sample_period_ps() / 1000.0;
+    return true;
+}
+
+uint32_t adc_capture_sample_rate_hz(void) {
+    return adc_clock_rate_hz(adc_capture_sample_period_ps());
+}
+
+uint32_t adc_capture_sample_period_ps(void) {
+    return adc_clock_period_ps(config.clkdiv);
+}
+
+uint64_t adc_capture_sample_time_ns(uint64_t index) {
+    return sample_time(index);
+}
+
+// -------------------------
+//  STREAM-MODUS
+// -------------------------
+void adc_capture_start(void) {
+    if (!ring_ready || mode == MODE_STREAM)
+        return;
+    sim_lock();
+    capture_ring_reset(&ring);
+    produced = 0;
+    t0_ns = sim_time_ns();
+    mode = MODE_STREAM;
+    sim_tick_reschedule();
+    sim_unlock();
+}
+
+void adc_capture_stop(void) {
+    sim_lock();
+    if (mode == MODE_STREAM)
+        mode = MODE_IDLE;
+    sim_unlock();
+}
+
+bool adc_capture_running(void) {
+    return mode == MODE_STREAM;
+}
+
+capture_ring_t *adc_capture_ring(void) {
+    return &ring;
+}
+
+// -------------------------
+//  EINZELERFASSUNG
+// -------------------------
+void adc_capture_oneshot_start(uint16_t *dst, uint32_t n) {
+    sim_lock();
+    oneshot_dst = dst;
+    oneshot_len = n;
+    produced = 0;
+    t0_ns = sim_time_ns();
+    mode = n > 0 ? MODE_ONESHOT : MODE_IDLE;
+    sim_tick_reschedule();
+    sim_unlock();
+}
+
+uint32_t adc_capture_oneshot_position(void) {
+    // Zugriff auf das Zählregister kostet etwas Zeit, wie auf der Hardware
+    sim_advance_ns(50);
+    return mode == MODE_ONESHOT ? (uint32_t)produced : oneshot_len;
+}
+
+void adc_capture_oneshot_wait(void) {
+    while (mode == MODE_ONESHOT) {
+        sim_advance_ns((uint64_t)period_ns);
+        // auch bei gesperrten Interrupts weiterfüllen (DMA braucht keine CPU)
+        sim_lock();
+        capture_fill(sim_time_ns());
+        sim_unlock();
+    }
+}
+
+void adc_capture_oneshot(uint16_t *dst, uint32_t n) {
+    adc_capture_oneshot_start(dst, n);
+    adc_capture_oneshot_wait();
+}
@@ -0,0 +1,830 @@
+// sim_hal.c
+// Host-Simulation der benutzten Pico-SDK-Funktionen: virtuelle Zeit,
+// GPIO, PWM, ADC, stdio, Flash, Interrupt-Sperre und Multicore-FIFO.
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/flash.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "adc_clock.h"
+#include "sim_hal.h"
+
+// -------------------------
+//  ZUSTAND
+// -------------------------
+static pthread_mutex_t state_lock;
+static uint64_t now_ns = 0;             // nur atomar zugreifen
+static __thread int this_core = 0;
+static uint64_t core1_ns = 0;           // eigene Uhr von Core1, nur atomar zugreifen
+static bool core1_running = false;
+static uint64_t duration_ns = 0;        // 0 = endlos
+static int irq_disabled = 0;
+static bool in_tick = false;
+static uint64_t next_tick_ns = 0;       // nur atomar zugreifen
+static bool reschedule_requested = false;
+
+#define MAX_TICKS 8
+static sim_tick_fn ticks[MAX_TICKS];
+static int tick_count = 0;
+
+static uint64_t adc_conversions = 0;
+static struct timespec wall_start;
+
+// GPIO
+static gpio_function_t gpio_func[NUM_BANK0_GPIOS];
+static bool gpio_dir_out[NUM_BANK0_GPIOS];
+static bool gpio_out[NUM_BANK0_GPIOS];
+
+// PWM
+typedef struct {
+    uint16_t wrap;
+    float div;
+    uint16_t level[2];
+    bool enabled;
+    uint64_t t0_ns;     // Zeitpunkt, an dem der Zähler bei 0 stand
+    double counter;     // Zählerstand eines angehaltenen Slice
+} pwm_slice_state_t;
+static pwm_slice_state_t pwm_slices[NUM_PWM_SLICES];
+
+// ADC; im Free-Running-Modus ist Wandlung k zum Zeitpunkt
+// adc_run_ns + (k + 1) * Periode fertig (adc_clock.h)
+#define ADC_FIFO_DEPTH 4
+static uint adc_input = 0;
+static float adc_clkdiv = 0.0f;
+static bool adc_running = false;
+static uint64_t adc_run_ns = 0;
+static uint64_t adc_fifo_taken = 0;     // aus dem FIFO gelesene bzw. verworfene Wandlungen
+static uint64_t adc_fifo_overflows = 0;
+
+// Systemtakt (nur für PWM und Pulssequenzer; der ADC hat seinen eigenen Takt)
+static uint32_t sys_clk_hz = SIM_SYS_CLK_HZ;
+
+// Flash
+uint8_t sim_flash_image[PICO_FLASH_SIZE_BYTES];
+static const char *flash_file = NULL;
+
+// Laser-Pin und Verlauf seiner Ansteuerung (für die Totzeit des Modells)
+static uint laser_gpio = 15;
+
+typedef struct {
+    uint64_t t_ns;
+    gpio_function_t func;
+    bool out;
+    pwm_slice_state_t pwm;
+    uint chan;
+} laser_state_t;
+
+#define LASER_HISTORY 1024
+static laser_state_t laser_history[LASER_HISTORY];
+static uint32_t laser_history_count = 0;
+
+// Eingabe-Skript
+typedef struct {
+    uint64_t t_ns;
+    char *text;
+} script_entry_t;
+static script_entry_t *script = NULL;
+static int script_len = 0;
+static int script_pos = 0;
+static size_t script_char = 0;
+static bool use_script = false;
+static bool stdin_open = true;
+static uint64_t last_stdin_poll_ns = 0;
+
+// -------------------------
+//  HILFEN
+// -------------------------
+double sim_env_double(const char *name, double def) {
+    const char *v = getenv(name);
+    if (v == NULL || *v == '\0')
+        return def;
+    return strtod(v, NULL);
+}
+
+void sim_log(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "[sim %10.3f ms] ", (double)sim_time_ns() / 1e6);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+}
+
+void sim_lock(void) {
+    pthread_mutex_lock(&state_lock);
+}
+
+void sim_unlock(void) {
+    pthread_mutex_unlock(&state_lock);
+}
+
+static void parse_script(const char *spec) {
+    char *copy = strdup(spec);
+    char *save = NULL;
+    for (char *tok = strtok_r(copy, ";", &save); tok; tok = strtok_r(NULL, ";", &save)) {
+        char *colon = strchr(tok, ':');
+        if (colon == NULL)
+            continue;
+        *colon = '\0';
+        script = realloc(script, sizeof(script_entry_t) * (size_t)(script_len + 1));
+        script[script_len].t_ns = (uint64_t)(strtod(tok, NULL) * 1e6);
+        size_t n = strlen(colon + 1);
+        script[script_len].text = malloc(n + 2);
+        memcpy(script[script_len].text, colon + 1, n);
+        script[script_len].text[n] = '\n';
+        script[script_len].text[n + 1] = '\0';
+        script_len++;
+    }
+    free(copy);
+    use_script = true;
+}
+
+static void save_flash(void) {
+    if (flash_file == NULL)
+        return;
+    FILE *f = fopen(flash_file, "wb");
+    if (f) {
+        fwrite(sim_flash_image, 1, sizeof(sim_flash_image), f);
+        fclose(f);
+    }
+}
+
+static void sim_finish(void) {
+    struct timespec wall_end;
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+    double wall_s = (double)(wall_end.tv_sec - wall_start.tv_sec)
+                  + (double)(wall_end.tv_nsec - wall_start.tv_nsec) / 1e9;
+    double sim_s = (double)sim_time_ns() / 1e9;
+
+    fflush(stdout);
+    sim_log("Ende: %.3f s simuliert in %.3f s Rechenzeit (Faktor %.1f), %llu ADC-Wandlungen",
+            sim_s, wall_s, wall_s > 0 ? sim_s / wall_s : 0.0,
+            (unsigned long long)adc_conversions);
+    if (adc_fifo_overflows > 0)
+        sim_log("ADC-FIFO: %llu Wandlungen durch Überlauf verloren",
+                (unsigned long long)adc_fifo_overflows);
+    save_flash();
+    exit(0);
+}
+
+__attribute__((constructor))
+static void sim_init(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&state_lock, &attr);
+
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+    duration_ns = (uint64_t)(sim_env_double("SIM_DURATION_MS", 10000.0) * 1e6);
+    laser_gpio = (uint)sim_env_double("SIM_LASER_GPIO", 15);
+    sys_clk_hz = (uint32_t)(sim_env_double("SIM_SYS_CLK_MHZ", SIM_SYS_CLK_HZ / 1e6) * 1e6 + 0.5);
+
+    for (int i = 0; i < NUM_BANK0_GPIOS; i++)
+        gpio_func[i] = GPIO_FUNC_NULL;
+    for (int i = 0; i < NUM_PWM_SLICES; i++) {
+        pwm_slices[i].wrap = 0xffff;
+        pwm_slices[i].div = 1.0f;
+    }
+
+    memset(sim_flash_image, 0xff, sizeof(sim_flash_image));
+    flash_file = getenv("SIM_FLASH_FILE");
+    if (flash_file) {
+        FILE *f = fopen(flash_file, "rb");
+        if (f) {
+            size_t n = fread(sim_flash_image, 1, sizeof(sim_flash_image), f);
+            (void)n;
+            fclose(f);
+        }
+    }
+
+    const char *spec = getenv("SIM_SCRIPT");
+    if (spec)
+        parse_script(spec);
+
+    sim_laser_changed();
+    sim_plant_init();
+}
+
+// -------------------------
+//  VIRTUELLE ZEIT
+// -------------------------
+uint64_t sim_time_ns(void) {
+    if (this_core == 1)
+        return __atomic_load_n(&core1_ns, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&now_ns, __ATOMIC_SEQ_CST);
+}
+
+void sim_register_tick(sim_tick_fn fn) {
+    sim_lock();
+    if (tick_count < MAX_TICKS)
+        ticks[tick_count++] = fn;
+    sim_tick_reschedule();
+    sim_unlock();
+}
+
+void sim_tick_reschedule(void) {
+    __atomic_store_n(&next_tick_ns, 0, __ATOMIC_SEQ_CST);
+    reschedule_requested = true;
+}
+
+// Alle Tick-Funktionen aufrufen (unter sim_lock). Rückrufe aus einem Tick
+// heraus lösen keinen weiteren Tick aus (wie ein IRQ, der nicht
+// verschachtelt wird).
+static void run_ticks(void) {
+    in_tick = true;
+    reschedule_requested = false;
+    uint64_t next = SIM_NEVER;
+    for (int i = 0; i < tick_count; i++) {
+        uint64_t due = ticks[i](sim_time_ns());
+        if (due < next)
+            next = due;
+    }
+    // Hat ein Rückruf neue Arbeit angemeldet, beim nächsten Schritt erneut prüfen
+    __atomic_store_n(&next_tick_ns, reschedule_requested ? 0 : next, __ATOMIC_SEQ_CST);
+    in_tick = false;
+}
+
+// Core1 hat eine eigene Uhr. Core0 treibt die globale Zeit (Ticks, Skript);
+// beide Kerne warten aufeinander, sobald einer mehr als CORE_SKEW_NS
+// voraus ist. So laufen sie im gleichen Takt, statt dass sich ihre
+// Wartezeiten addieren.
+#define CORE_SKEW_NS 10000u
+
+static void core1_advance_ns(uint64_t ns) {
+    uint64_t t = __atomic_add_fetch(&core1_ns, ns, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&now_ns, __ATOMIC_SEQ_CST) + CORE_SKEW_NS < t)
+        sched_yield();
+}
+
+static void core0_wait_for_core1(uint64_t now) {
+    while (__atomic_load_n(&core1_running, __ATOMIC_SEQ_CST)
+           && __atomic_load_n(&core1_ns, __ATOMIC_SEQ_CST) + CORE_SKEW_NS < now)
+        sched_yield();
+}
+
+void sim_advance_ns(uint64_t ns) {
+    if (this_core == 1) {
+        core1_advance_ns(ns);
+        return;
+    }
+
+    // In Schritten bis zum jeweils nächsten fälligen Tick vorrücken, damit
+    // Timer und DMA genau zu ihrem Zeitpunkt bedient werden
+    uint64_t remaining = ns;
+    uint64_t now;
+    for (;;) {
+        uint64_t cur = sim_time_ns();
+        uint64_t next = __atomic_load_n(&next_tick_ns, __ATOMIC_SEQ_CST);
+        uint64_t step = remaining;
+        if (!in_tick && irq_disabled == 0 && next > cur && next - cur < remaining)
+            step = next - cur;
+        now = __atomic_add_fetch(&now_ns, step, __ATOMIC_SEQ_CST);
+        remaining -= step;
+
+        if (now >= __atomic_load_n(&next_tick_ns, __ATOMIC_SEQ_CST)) {
+            sim_lock();
+            if (!in_tick && irq_disabled == 0)
+                run_ticks();
+            sim_unlock();
+        }
+        if (remaining == 0)
+            break;
+    }
+
+    core0_wait_for_core1(now);
+
+    if (duration_ns != 0 && now >= duration_ns)
+        sim_finish();
+}
+
+void tight_loop_contents(void) {
+    sim_advance_ns(50);
+}
+
+uint64_t time_us_64(void) {
+    sim_advance_ns(50);
+    return sim_time_ns() / 1000u;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)time_us_64();
+}
+
+void sleep_us(uint64_t us) {
+    sim_advance_ns(us * 1000u);
+}
+
+void sleep_ms(uint32_t ms) {
+    sim_advance_ns((uint64_t)ms * 1000000u);
+}
+
+void busy_wait_us(uint64_t us) {
+    sim_advance_ns(us * 1000u);
+}
+
+void busy_wait_us_32(uint32_t us) {
+    sim_advance_ns((uint64_t)us * 1000u);
+}
+
+// -------------------------
+//  STDIO
+// -------------------------
+bool stdio_init_all(void) {
+    return true;
+}
+
+int putchar_raw(int c) {
+    return putchar(c);
+}
+
+int stdio_put_string(const char *s, int len, bool newline, bool cr_translation) {
+    (void)cr_translation;
+    fwrite(s, 1, (size_t)len, stdout);
+    if (newline)
+        putchar('\n');
+    return len;
+}
+
+void stdio_flush(void) {
+    fflush(stdout);
+}
+
+static int next_input_char(void) {
+    if (use_script) {
+        if (script_pos < script_len && script[script_pos].t_ns <= sim_time_ns()) {
+            int c = (unsigned char)script[script_pos].text[script_char++];
+            if (script[script_pos].text[script_char] == '\0') {
+                script_pos++;
+                script_char = 0;
+            }
+            return c;
+        }
+        return PICO_ERROR_TIMEOUT;
+    }
+
+    // stdin höchstens einmal pro virtueller Millisekunde abfragen
+    if (!stdin_open || sim_time_ns() - last_stdin_poll_ns < 1000000u)
+        return PICO_ERROR_TIMEOUT;
+    last_stdin_poll_ns = sim_time_ns();
+
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+    if (poll(&pfd, 1, 0) <= 0)
+        return PICO_ERROR_TIMEOUT;
+    unsigned char c;
+    ssize_t n = read(STDIN_FILENO, &c, 1);
+    if (n <= 0) {
+        stdin_open = false;
+        return PICO_ERROR_TIMEOUT;
+    }
+    return c;
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    int c = next_input_char();
+    if (c != PICO_ERROR_TIMEOUT)
+        return c;
+    sim_advance_ns((uint64_t)(timeout_us > 0 ? timeout_us : 1) * 1000u);
+    return next_input_char();
+}
+
+// -------------------------
+//  LASER-VERLAUF
+// -------------------------
+void sim_laser_changed(void) {
+    sim_lock();
+    laser_state_t *s = &laser_history[laser_history_count % LASER_HISTORY];
+    s->t_ns = sim_time_ns();
+    s->func = gpio_func[laser_gpio];
+    s->out = gpio_dir_out[laser_gpio] && gpio_out[laser_gpio];
+    s->pwm = pwm_slices[pwm_gpio_to_slice_num(laser_gpio)];
+    s->chan = pwm_gpio_to_channel(laser_gpio);
+    laser_history_count++;
+    sim_unlock();
+}
+
+float sim_laser_drive(uint64_t t_ns) {
+    sim_lock();
+    // Jüngsten Eintrag suchen, der zum Zeitpunkt t bereits galt
+    uint32_t n = laser_history_count < LASER_HISTORY ? laser_history_count : LASER_HISTORY;
+    const laser_state_t *s = &laser_history[(laser_history_count - n) % LASER_HISTORY];
+    for (uint32_t i = 1; i <= n; i++) {
+        const laser_state_t *e = &laser_history[(laser_history_count - i) % LASER_HISTORY];
+        if (e->t_ns <= t_ns) {
+            s = e;
+            break;
+        }
+    }
+
+    float drive = 0.0f;
+    if (s->func == GPIO_FUNC_SIO) {
+        drive = s->out ? 1.0f : 0.0f;
+    } else if (s->func == GPIO_FUNC_PWM) {
+        // Ein angehaltener Slice hält den Ausgang auf dem Pegel seines
+        // letzten Zählerstands, wie die Hardware
+        double tick_ns = (double)s->pwm.div * 1e9 / sys_clk_hz;
+        double period_ns = ((double)s->pwm.wrap + 1.0) * tick_ns;
+        double phase = s->pwm.enabled ? fmod((double)(t_ns - s->pwm.t0_ns), period_ns)
+                                      : s->pwm.counter * tick_ns;
+        drive = phase < (double)s->pwm.level[s->chan] * tick_ns ? 1.0f : 0.0f;
+    }
+    sim_unlock();
+    return drive;
+}
+
+// -------------------------
+//  GPIO
+// -------------------------
+void gpio_init(uint gpio) {
+    sim_lock();
+    gpio_func[gpio] = GPIO_FUNC_SIO;
+    gpio_dir_out[gpio] = false;
+    gpio_out[gpio] = false;
+    sim_unlock();
+    if (gpio == laser_gpio)
+        sim_laser_changed();
+}
+
+void gpio_set_function(uint gpio, gpio_function_t fn) {
+    sim_lock();
+    gpio_func[gpio] = fn;
+    sim_unlock();
+    if (gpio == laser_gpio)
+        sim_laser_changed();
+}
+
+gpio_function_t gpio_get_function(uint gpio) {
+    return gpio_func[gpio];
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    sim_lock();
+    gpio_dir_out[gpio] = out;
+    sim_unlock();
+    if (gpio == laser_gpio)
+        sim_laser_changed();
+}
+
+void gpio_put(uint gpio, bool value) {
+    sim_lock();
+    gpio_out[gpio] = value;
+    sim_unlock();
+    if (gpio == laser_gpio)
+        sim_laser_changed();
+}
+
+bool gpio_get(uint gpio) {
+    return gpio_out[gpio];
+}
+
+void gpio_set_pulls(uint gpio, bool up, bool down) {
+    (void)gpio;
+    (void)up;
+    (void)down;
+}
+
+void gpio_pull_down(uint gpio) {
+    (void)gpio;
+}
+
+void gpio_disable_pulls(uint gpio) {
+    (void)gpio;
+}
+
+// -------------------------
+//  TAKTE
+// -------------------------
+uint32_t sim_sys_clk_hz(void) {
+    return sys_clk_hz;
+}
+
+uint32_t clock_get_hz(clock_handle_t clock) {
+    switch (clock) {
+    case clk_sys:
+    case clk_peri:
+        return sys_clk_hz;
+    case clk_usb:
+    case clk_adc:
+        return ADC_CLOCK_HZ;
+    default:
+        return 12000000u;
+    }
+}
+
+// Jeder Takt ist einstellbar; PWM und Pulssequenzer laufen ab sofort damit
+bool set_sys_clock_khz(uint32_t freq_khz, bool required) {
+    (void)required;
+    if (freq_khz == 0)
+        return false;
+    sim_lock();
+    sys_clk_hz = freq_khz * 1000u;
+    sim_unlock();
+    sim_log("Systemtakt %lu kHz", freq_khz);
+    return true;
+}
+
+// -------------------------
+//  PWM
+// -------------------------
+static void pwm_changed(uint slice_num) {
+    if (slice_num == pwm_gpio_to_slice_num(laser_gpio))
+        sim_laser_changed();
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap) {
+    sim_lock();
+    pwm_slices[slice_num].wrap = wrap;
+    sim_unlock();
+    pwm_changed(slice_num);
+}
+
+void pwm_set_clkdiv(uint slice_num, float divider) {
+    // Wie die Hardware: 8.4-Festkomma, 1.0 <= div < 256
+    if (divider < 1.0f)
+        divider = 1.0f;
+    sim_lock();
+    pwm_slices[slice_num].div = floorf(divider * 16.0f) / 16.0f;
+    sim_unlock();
+    pwm_changed(slice_num);
+}
+
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract) {
+    sim_lock();
+    pwm_slices[slice_num].div = (float)(integer == 0 ? 256 : integer) + (float)(fract & 0x0f) / 16.0f;
+    sim_unlock();
+    pwm_changed(slice_num);
+}
+
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level) {
+    sim_lock();
+    pwm_slices[slice_num].level[chan] = level;
+    sim_unlock();
+    pwm_changed(slice_num);
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level) {
+    pwm_set_chan_level(pwm_gpio_to_slice_num(gpio), pwm_gpio_to_channel(gpio), level);
+}
+
+void pwm_set_counter(uint slice_num, uint16_t c) {
+    sim_lock();
+    pwm_slice_state_t *s = &pwm_slices[slice_num];
+    uint64_t offset = (uint64_t)((double)c * s->div * 1e9 / sys_clk_hz);
+    s->t0_ns = sim_time_ns() - offset;
+    s->counter = c;
+    sim_unlock();
+    pwm_changed(slice_num);
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+    sim_lock();
+    pwm_slice_state_t *s = &pwm_slices[slice_num];
+    // Der Zähler bleibt beim Anhalten stehen und läuft beim Freigeben dort
+    // weiter (zurücksetzen nur mit pwm_set_counter)
+    double tick_ns = (double)s->div * 1e9 / sys_clk_hz;
+    if (enabled && !s->enabled)
+        s->t0_ns = sim_time_ns() - (uint64_t)(s->counter * tick_ns);
+    if (!enabled && s->enabled)
+        s->counter = floor(fmod((double)(sim_time_ns() - s->t0_ns) / tick_ns, (double)s->wrap + 1.0));
+    s->enabled = enabled;
+    sim_unlock();
+    pwm_changed(slice_num);
+}
+
+// -------------------------
+//  ADC
+// -------------------------
+void adc_init(void) {
+}
+
+void adc_gpio_init(uint gpio) {
+    (void)gpio;
+}
+
+void adc_select_input(uint input) {
+    adc_input = input;
+}
+
+uint adc_get_selected_input(void) {
+    return adc_input;
+}
+
+uint16_t adc_read(void) {
+    // Eine Wandlung dauert 96 ADC-Takte
+    sim_advance_ns(SIM_ADC_PERIOD_NS);
+    sim_lock();
+    adc_conversions++;
+    uint16_t v = sim_adc_sample(adc_input, sim_time_ns());
+    sim_unlock();
+    return v;
+}
+
+void sim_count_conversions(uint32_t n) {
+    sim_lock();
+    adc_conversions += n;
+    sim_unlock();
+}
+
+void adc_set_temp_sensor_enabled(bool enable) {
+    (void)enable;
+}
+
+void adc_set_clkdiv(float clkdiv) {
+    adc_clkdiv = clkdiv;
+}
+
+void adc_set_round_robin(uint input_mask) {
+    (void)input_mask;
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift) {
+    (void)en;
+    (void)dreq_en;
+    (void)dreq_thresh;
+    (void)err_in_fifo;
+    (void)byte_shift;
+}
+
+void adc_run(bool run) {
+    sim_lock();
+    if (run && !adc_running) {
+        adc_run_ns = sim_time_ns();
+        adc_fifo_taken = 0;
+    }
+    adc_running = run;
+    sim_unlock();
+}
+
+// Anzahl bis `now` fertiger Wandlungen seit adc_run(true)
+static uint64_t adc_completed(uint64_t now) {
+    uint32_t period_ps = adc_clock_period_ps(adc_clkdiv);
+    return now > adc_run_ns ? (now - adc_run_ns) * 1000u / period_ps : 0;
+}
+
+void adc_fifo_drain(void) {
+    sim_lock();
+    if (adc_running)
+        adc_fifo_taken = adc_completed(sim_time_ns());
+    sim_unlock();
+}
+
+uint16_t adc_fifo_get_blocking(void) {
+    sim_lock();
+    uint64_t now = sim_time_ns();
+    // Vereinfachter Überlauf: der FIFO fasst 4 Wandlungen, ältere sind verloren
+    uint64_t done = adc_completed(now);
+    if (done > adc_fifo_taken + ADC_FIFO_DEPTH) {
+        if (adc_fifo_overflows == 0)
+            sim_log("ADC-FIFO übergelaufen (Leser zu langsam)");
+        adc_fifo_overflows += done - ADC_FIFO_DEPTH - adc_fifo_taken;
+        adc_fifo_taken = done - ADC_FIFO_DEPTH;
+    }
+    uint64_t k = adc_fifo_taken++;
+    uint64_t t = adc_run_ns + ((k + 1) * adc_clock_period_ps(adc_clkdiv) + 500u) / 1000u;
+    sim_unlock();
+
+    if (t > now)
+        sim_advance_ns(t - now);
+
+    sim_lock();
+    adc_conversions++;
+    uint16_t v = sim_adc_sample(adc_input, t);
+    sim_unlock();
+    return v;
+}
+
+// -------------------------
+//  FLASH
+// -------------------------
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    if (flash_offs % FLASH_SECTOR_SIZE || count % FLASH_SECTOR_SIZE
+        || flash_offs + count > sizeof(sim_flash_image)) {
+        sim_log("FEHLER: flash_range_erase(0x%x, %zu) nicht sektorausgerichtet", flash_offs, count);
+        abort();
+    }
+    memset(sim_flash_image + flash_offs, 0xff, count);
+    // Löschen eines Sektors dauert typ. 45 ms
+    sim_advance_ns((count / FLASH_SECTOR_SIZE) * 45000000ull);
+    save_flash();
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    if (flash_offs % FLASH_PAGE_SIZE || count % FLASH_PAGE_SIZE
+        || flash_offs + count > sizeof(sim_flash_image)) {
+        sim_log("FEHLER: flash_range_program(0x%x, %zu) nicht seitenausgerichtet", flash_offs, count);
+        abort();
+    }
+    // NOR-Flash kann beim Programmieren nur Bits löschen
+    for (size_t i = 0; i < count; i++)
+        sim_flash_image[flash_offs + i] &= data[i];
+    sim_advance_ns((count / FLASH_PAGE_SIZE) * 400000ull);
+    save_flash();
+}
+
+// -------------------------
+//  INTERRUPT-SPERRE
+// -------------------------
+uint32_t save_and_disable_interrupts(void) {
+    sim_lock();
+    irq_disabled++;
+    return 0;
+}
+
+void restore_interrupts(uint32_t status) {
+    (void)status;
+    irq_disabled--;
+    sim_unlock();
+}
+
+// -------------------------
+//  MULTICORE
+// -------------------------
+#define FIFO_DEPTH 8
+
+typedef struct {
+    uint32_t data[FIFO_DEPTH];
+    int count;
+    int head;
+} fifo_t;
+
+static pthread_mutex_t fifo_lock = PTHREAD_MUTEX_INITIALIZER;
+static fifo_t fifos[2];              // [0]: Core0 -> Core1, [1]: Core1 -> Core0
+static pthread_t core1_thread;
+
+static void *core1_main(void *arg) {
+    this_core = 1;
+    ((void (*)(void))arg)();
+    __atomic_store_n(&core1_running, false, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+// Warten bei voller/leerer FIFO: virtuelle Zeit läuft weiter, damit der
+// andere Kern (mit eigener Uhr) vorankommt
+static void fifo_wait(void) {
+    pthread_mutex_unlock(&fifo_lock);
+    sim_advance_ns(100);
+    pthread_mutex_lock(&fifo_lock);
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    __atomic_store_n(&core1_ns, sim_time_ns(), __ATOMIC_SEQ_CST);
+    __atomic_store_n(&core1_running, true, __ATOMIC_SEQ_CST);
+    pthread_create(&core1_thread, NULL, core1_main, (void *)entry);
+}
+
+bool multicore_fifo_rvalid(void) {
+    pthread_mutex_lock(&fifo_lock);
+    bool r = fifos[1 - this_core].count > 0;
+    pthread_mutex_unlock(&fifo_lock);
+    return r;
+}
+
+bool multicore_fifo_wready(void) {
+    pthread_mutex_lock(&fifo_lock);
+    bool r = fifos[this_core].count < FIFO_DEPTH;
+    pthread_mutex_unlock(&fifo_lock);
+    return r;
+}
+
+void multicore_fifo_push_blocking(uint32_t data) {
+    pthread_mutex_lock(&fifo_lock);
+    fifo_t *f = &fifos[this_core];
+    while (f->count >= FIFO_DEPTH)
+        fifo_wait();
+    f->data[(f->head + f->count) % FIFO_DEPTH] = data;
+    f->count++;
+    pthread_mutex_unlock(&fifo_lock);
+}
+
+uint32_t multicore_fifo_pop_blocking(void) {
+    pthread_mutex_lock(&fifo_lock);
+    fifo_t *f = &fifos[1 - this_core];
+    while (f->count == 0)
+        fifo_wait();
+    uint32_t data = f->data[f->head];
+    f->head = (f->head + 1) % FIFO_DEPTH;
+    f->count--;
+    pthread_mutex_unlock(&fifo_lock);
+    return data;
+}
+
+void multicore_fifo_drain(void) {
+    pthread_mutex_lock(&fifo_lock);
+    fifos[1 - this_core].count = 0;
+    pthread_mutex_unlock(&fifo_lock);
+}
@@ -0,0 +1,82 @@
+// sim_hal.h
+// Interne Schnittstelle der Host-Simulation (nicht Teil des Pico-SDK).
+//
+// Die Simulation ersetzt die SDK-Funktionen, die die Firmware benutzt, und
+// treibt den ADC mit einem Streckenmodell (Laser + Photodiode) oder mit
+// einer aufgezeichneten CSV-Datei. Die Zeit ist virtuell und läuft nur,
+// wenn die Firmware SDK-Funktionen aufruft; dadurch sind Läufe
+// reproduzierbar und schneller als Echtzeit.
+//
+// Konfiguration über Umgebungsvariablen:
+//   SIM_DURATION_MS   virtuelle Laufzeit bis zum Programmende (Standard 10000, 0 = endlos)
+//   SIM_SCRIPT        Eingaben "t_ms:text;t_ms:text;..." (jeweils mit '\n'), sonst stdin
+//   SIM_LASER_GPIO    Pin, der den Laser treibt (Standard 15)
+//   SIM_SYS_CLK_MHZ   Systemtakt beim Start, z.B. übertaktet 200 (Standard 125)
+//   SIM_DELAY_US      Totzeit Laser -> Photodiode (Standard 5)
+//   SIM_TAU_US        Zeitkonstante der Photodiode (Standard 20)
+//   SIM_GAIN_MV       Signal bei Laser voll an (Standard 600)
+//   SIM_DARK_MV       Dunkelsignal / Umgebungslicht (Standard 50)
+//   SIM_NOISE_MV      Rauschen, Standardabweichung (Standard 3)
+//   SIM_SAT_MV        Sättigung der Photodiode, 0 = linear (Standard 0)
+//   SIM_SEED          Startwert des Zufallsgenerators (Standard 1)
+//   SIM_TEMP_C        Chiptemperatur für ADC4 beim Start (Standard 27)
+//   SIM_TEMP_END_C    Temperatur nach dem Aufwärmen (Standard SIM_TEMP_C)
+//   SIM_TEMP_TAU_S    Zeitkonstante des Aufwärmens in s (Standard 60)
+//   SIM_GAIN_TC       Änderung der Laserleistung in %/K, bezogen auf 27 °C (Standard 0)
+//   SIM_AMBIENT_MV    Amplitude schwankenden Umgebungslichts (Standard 0)
+//   SIM_AMBIENT_HZ    Frequenz des Umgebungslichts (Standard 1)
+//   SIM_REF_MV        Referenz-Photodiode an ADC1 bei Laser voll an (Standard 300)
+//   SIM_REPLAY_CSV    CSV-Aufzeichnung (Spalten: RX-Zeit, Zeit in us, mV) statt Modell
+//   SIM_FLASH_FILE    Datei, in der der Flash-Inhalt über Läufe erhalten bleibt
+
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Abtastperiode des ADC bei voller Rate (96 Takte bei 48 MHz)
+#define SIM_ADC_PERIOD_NS 2000u
+#define SIM_SYS_CLK_HZ 125000000u
+
+// Aktueller Systemtakt (clock_get_hz(clk_sys), set_sys_clock_khz())
+uint32_t sim_sys_clk_hz(void);
+
+// --- Virtuelle Zeit ---
+uint64_t sim_time_ns(void);
+void sim_advance_ns(uint64_t ns);
+
+// Funktion, die beim Fortschreiten der Zeit aufgerufen wird (emuliert DMA,
+// Timer-IRQs, ...). Läuft mit gesperrtem sim_lock und gibt den nächsten
+// Zeitpunkt zurück, zu dem sie wieder aufgerufen werden muss
+// (SIM_NEVER: erst nach sim_tick_reschedule()).
+#define SIM_NEVER UINT64_MAX
+typedef uint64_t (*sim_tick_fn)(uint64_t now_ns);
+void sim_register_tick(sim_tick_fn fn);
+// Zustand einer Tick-Funktion hat sich geändert: beim nächsten Schritt aufrufen.
+void sim_tick_reschedule(void);
+
+// Globale Sperre für den Zustand der Simulation (rekursiv)
+void sim_lock(void);
+void sim_unlock(void);
+
+// --- Laser-Ausgang ---
+// Momentaner Ansteuerwert (0..1) des Laser-Pins zum Zeitpunkt t.
+float sim_laser_drive(uint64_t t_ns);
+// Vom Pin-Zustand abhängige Änderungen protokollieren (GPIO/PWM-Stubs).
+void sim_laser_changed(void);
+
+// --- Streckenmodell ---
+void sim_plant_init(void);
+// Photodioden-Spannung in mV zum Zeitpunkt t (Aufrufe zeitlich aufsteigend).
+float sim_plant_mv(uint64_t t_ns);
+// ADC-Rohwert für Eingang 0..4 zum Zeitpunkt t.
+uint16_t sim_adc_sample(unsigned input, uint64_t t_ns);
+// Zähler für die Zusammenfassung am Programmende (DMA-Erfassung).
+void sim_count_conversions(uint32_t n);
+
+// --- Hilfen ---
+double sim_env_double(const char *name, double def);
+void sim_log(const char *fmt, ...);
+
+#endif // SIM_HAL_H
@@ -0,0 +1,222 @@
+// sim_plant.c
+// Streckenmodell für die Host-Simulation: Laser -> Photodiode -> ADC.
+//
+// Modell: Totzeit, danach Tiefpass 1. Ordnung auf den Ansteuerwert des
+// Laser-Pins (GPIO oder PWM), optional Sättigung, plus Dunkelsignal und
+// Gaußsches Rauschen. ADC1 liefert eine Referenz-Photodiode direkt am
+// Laser (ohne Totzeit und Tiefpass), ADC4 den Temperatursensor. Die
+// Temperatur läuft exponentiell von SIM_TEMP_C nach SIM_TEMP_END_C
+// (Aufwärmen), die Laserleistung ändert sich mit SIM_GAIN_TC. Optional
+// schwankt das Umgebungslicht sinusförmig (SIM_AMBIENT_MV/_HZ).
+// Alternativ wird eine mit dem Oszi-Visualizer aufgezeichnete CSV-Datei
+// abgespielt (Sample-and-Hold, in Schleife).
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim_hal.h"
+
+// Maximale Schrittweite der Integration und maximal nachgeholte Zeitspanne
+#define SUBSTEP_NS 250u
+#define MAX_GAP_TAU 20.0
+
+static double delay_ns, tau_ns, gain_mv, dark_mv, noise_mv, temp_c, sat_mv, ref_mv;
+static double temp_end_c, temp_tau_ns, gain_tc, ambient_mv, ambient_hz;
+static double alpha_substep;      // Filterfaktor für einen vollen Teilschritt
+
+static double y_mv = 0.0;         // gefilterter Laseranteil
+static uint64_t last_t_ns = 0;
+
+static uint64_t rng_state = 1;
+
+// Wiedergabe
+static bool replay = false;
+static double *replay_t_us = NULL;
+static float *replay_mv = NULL;
+static size_t replay_len = 0;
+
+// -------------------------
+//  ZUFALL
+// -------------------------
+static double rand_uniform(void) {
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    uint64_t r = rng_state * 0x2545F4914F6CDD1Dull;
+    return ((double)(r >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static double rand_gauss(void) {
+    // Box-Muller, zweiter Wert wird verworfen
+    double u1 = rand_uniform();
+    double u2 = rand_uniform();
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+// -------------------------
+//  CSV-WIEDERGABE
+// -------------------------
+static void load_replay(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        sim_log("FEHLER: %s kann nicht geöffnet werden, verwende Modell", path);
+        return;
+    }
+
+    size_t cap = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        // Kopfzeile, Statusmeldungen und BOM überspringen: nur Zeilen mit
+        // drei Zahlen (RX-Zeit, Zeit in us, Spannung in mV) zählen
+        char *p = line;
+        if ((unsigned char)p[0] == 0xEF && (unsigned char)p[1] == 0xBB && (unsigned char)p[2] == 0xBF)
+            p += 3;
+        double t_us, mv;
+        if (sscanf(p, "%*[^,],%lf,%lf", &t_us, &mv) != 2)
+            continue;
+        if (replay_len == cap) {
+            cap = cap ? cap * 2 : 4096;
+            replay_t_us = realloc(replay_t_us, cap * sizeof(double));
+            replay_mv = realloc(replay_mv, cap * sizeof(float));
+        }
+        replay_t_us[replay_len] = t_us;
+        replay_mv[replay_len] = (float)mv;
+        replay_len++;
+    }
+    fclose(f);
+
+    if (replay_len < 2 || replay_t_us[replay_len - 1] <= replay_t_us[0]) {
+        sim_log("FEHLER: %s enthält keine verwertbaren Daten, verwende Modell", path);
+        replay_len = 0;
+        return;
+    }
+    replay = true;
+    sim_log("Wiedergabe von %s: %zu Samples, %.1f ms", path, replay_len,
+            (replay_t_us[replay_len - 1] - replay_t_us[0]) / 1000.0);
+}
+
+static float replay_at(uint64_t t_ns) {
+    double span = replay_t_us[replay_len - 1] - replay_t_us[0];
+    double t = replay_t_us[0] + fmod((double)t_ns / 1000.0, span);
+
+    // Letztes Sample mit Zeit <= t (binäre Suche)
+    size_t lo = 0, hi = replay_len - 1;
+    while (lo < hi) {
+        size_t mid = (lo + hi + 1) / 2;
+        if (replay_t_us[mid] <= t)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    return replay_mv[lo];
+}
+
+// -------------------------
+//  MODELL
+// -------------------------
+void sim_plant_init(void) {
+    delay_ns = sim_env_double("SIM_DELAY_US", 5.0) * 1000.0;
+    tau_ns = sim_env_double("SIM_TAU_US", 20.0) * 1000.0;
+    gain_mv = sim_env_double("SIM_GAIN_MV", 600.0);
+    dark_mv = sim_env_double("SIM_DARK_MV", 50.0);
+    noise_mv = sim_env_double("SIM_NOISE_MV", 3.0);
+    temp_c = sim_env_double("SIM_TEMP_C", 27.0);
+    temp_end_c = sim_env_double("SIM_TEMP_END_C", temp_c);
+    temp_tau_ns = sim_env_double("SIM_TEMP_TAU_S", 60.0) * 1e9;
+    gain_tc = sim_env_double("SIM_GAIN_TC", 0.0) / 100.0;
+    ambient_mv = sim_env_double("SIM_AMBIENT_MV", 0.0);
+    ambient_hz = sim_env_double("SIM_AMBIENT_HZ", 1.0);
+    sat_mv = sim_env_double("SIM_SAT_MV", 0.0);
+    ref_mv = sim_env_double("SIM_REF_MV", 300.0);
+    rng_state = (uint64_t)sim_env_double("SIM_SEED", 1.0);
+    if (rng_state == 0)
+        rng_state = 1;
+    if (tau_ns < 1.0)
+        tau_ns = 1.0;
+    if (temp_tau_ns < 1.0)
+        temp_tau_ns = 1.0;
+    alpha_substep = 1.0 - exp(-(double)SUBSTEP_NS / tau_ns);
+
+    const char *path = getenv("SIM_REPLAY_CSV");
+    if (path && *path)
+        load_replay(path);
+}
+
+static double temp_at(uint64_t t_ns) {
+    return temp_end_c + (temp_c - temp_end_c) * exp(-(double)t_ns / temp_tau_ns);
+}
+
+float sim_plant_mv(uint64_t t_ns) {
+    sim_lock();
+    if (replay) {
+        float mv = replay_at(t_ns);
+        sim_unlock();
+        return mv;
+    }
+
+    if (t_ns > last_t_ns) {
+        // Längere Pausen nur teilweise nachrechnen; danach ist der Filter
+        // ohnehin eingeschwungen
+        uint64_t max_gap = (uint64_t)(MAX_GAP_TAU * tau_ns);
+        uint64_t t = t_ns - last_t_ns > max_gap ? t_ns - max_gap : last_t_ns;
+        // Temperatur ändert sich langsam: einmal pro Aufruf genügt
+        double gain = gain_mv * (1.0 + gain_tc * (temp_at(t_ns) - 27.0));
+        while (t < t_ns) {
+            uint64_t dt = t_ns - t < SUBSTEP_NS ? t_ns - t : SUBSTEP_NS;
+            t += dt;
+            uint64_t t_drive = (double)t > delay_ns ? t - (uint64_t)delay_ns : 0;
+            double target = gain * sim_laser_drive(t_drive);
+            double alpha = dt == SUBSTEP_NS ? alpha_substep : 1.0 - exp(-(double)dt / tau_ns);
+            y_mv += (target - y_mv) * alpha;
+        }
+        last_t_ns = t_ns;
+    }
+
+    // Optionale Sättigung der Photodiode (macht die Kennlinie bei langsamer
+    // Photodiode nichtlinear im Tastgrad)
+    double y = sat_mv > 0.0 ? sat_mv * (1.0 - exp(-y_mv / sat_mv)) : y_mv;
+    double mv = dark_mv + y + noise_mv * rand_gauss();
+    if (ambient_mv != 0.0)
+        mv += ambient_mv * sin(2.0 * M_PI * ambient_hz * (double)t_ns * 1e-9);
+    sim_unlock();
+    return (float)mv;
+}
+
+static uint16_t mv_to_raw(double mv) {
+    double raw = mv * 4096.0 / 3300.0;
+    if (raw < 0.0)
+        raw = 0.0;
+    if (raw > 4095.0)
+        raw = 4095.0;
+    return (uint16_t)(raw + 0.5);
+}
+
+uint16_t sim_adc_sample(unsigned input, uint64_t t_ns) {
+    switch (input) {
+        case 0:
+            return mv_to_raw(sim_plant_mv(t_ns));
+        case 1: {
+            sim_lock();
+            double mv = ref_mv * sim_laser_drive(t_ns) + noise_mv * rand_gauss();
+            sim_unlock();
+            return mv_to_raw(mv);
+        }
+        case 4: {
+            // Temperatursensor laut Datenblatt: 0,706 V bei 27 °C, -1,721 mV/K
+            double mv = 706.0 - (temp_at(t_ns) - 27.0) * 1.721;
+            sim_lock();
+            mv += noise_mv * rand_gauss();
+            sim_unlock();
+            return mv_to_raw(mv);
+        }
+        default: {
+            sim_lock();
+            double mv = noise_mv * fabs(rand_gauss());
+            sim_unlock();
+            return mv_to_raw(mv);
+        }
+    }
+}
@@ -0,0 +1,78 @@
+// sim_pulse_seq.c
+// Host-Ersatz für common/pulse_seq_pio.c.
+//
+// Statt PIO und DMA schaltet ein Tick der Simulation den Pin zu den aus
+// der Tabelle berechneten Zeitpunkten (gleiche Taktzählung wie das
+// PIO-Programm). Die Schnittstelle ist identisch zu pulse_seq.h.
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "pulse_seq.h"
+#include "sim_hal.h"
+
+static unsigned seq_pin;
+static bool tick_registered = false;
+
+static const uint32_t *seq_table;
+static size_t seq_words;
+static volatile size_t seq_pos;     // nächstes Wort
+static uint64_t seq_next_ns;        // Zeitpunkt der nächsten Flanke
+static volatile bool running = false;
+
+static uint64_t cycles_to_ns(uint64_t cycles) {
+    return cycles * 1000000000u / sim_sys_clk_hz();
+}
+
+// Fällige Flanken schalten (läuft unter sim_lock)
+static uint64_t pulse_seq_tick(uint64_t now) {
+    while (running && seq_next_ns <= now) {
+        if (seq_pos == seq_words) {
+            // Letzte Tief-Zeit vorbei, Maschine wartet im pull
+            running = false;
+            break;
+        }
+        uint64_t t = seq_next_ns;
+        gpio_put(seq_pin, (seq_pos % 2) == 0);
+        seq_next_ns = t + cycles_to_ns((uint64_t)seq_table[seq_pos] + PULSE_SEQ_MIN_CYCLES);
+        seq_pos++;
+    }
+    return running ? seq_next_ns : SIM_NEVER;
+}
+
+bool pulse_seq_init(unsigned pin) {
+    seq_pin = pin;
+    if (!tick_registered) {
+        sim_register_tick(pulse_seq_tick);
+        tick_registered = true;
+    }
+    return true;
+}
+
+uint32_t pulse_seq_clock_hz(void) {
+    return sim_sys_clk_hz();
+}
+
+bool pulse_seq_start(const uint32_t *table, size_t words) {
+    if (running)
+        return false;
+    sim_lock();
+    seq_table = table;
+    seq_words = words;
+    seq_pos = 0;
+    seq_next_ns = sim_time_ns();
+    running = words > 0;
+    sim_tick_reschedule();
+    sim_unlock();
+    return true;
+}
+
+bool pulse_seq_busy(void) {
+    return running;
+}
+
+void pulse_seq_stop(void) {
+    sim_lock();
+    running = false;
+    gpio_put(seq_pin, 0);
+    sim_unlock();
+}
@@ -0,0 +1,130 @@
+// sim_timer.c
+// Alarme und Wiederholungs-Timer aus pico/time.h für die Host-Simulation.
+//
+// Fällige Alarme werden aus dem Tick der Simulation heraus aufgerufen;
+// sim_advance_ns() hält die virtuelle Zeit dafür genau am Fälligkeits-
+// zeitpunkt an, wie es der Timer-Interrupt auf dem Pico tut.
+
+#include "pico/stdlib.h"
+#include "sim_hal.h"
+
+#define MAX_ALARMS 16
+
+typedef struct {
+    alarm_id_t id;          // 0 = frei
+    uint64_t target_ns;
+    alarm_callback_t callback;
+    void *user_data;
+} sim_alarm_t;
+
+static sim_alarm_t alarms[MAX_ALARMS];
+static alarm_id_t next_id = 1;
+static bool tick_registered = false;
+
+static uint64_t alarm_tick(uint64_t now) {
+    // Fällige Alarme in zeitlicher Reihenfolge abarbeiten
+    for (;;) {
+        sim_alarm_t *due = NULL;
+        for (int i = 0; i < MAX_ALARMS; i++) {
+            if (alarms[i].id != 0 && alarms[i].target_ns <= now
+                && (due == NULL || alarms[i].target_ns < due->target_ns))
+                due = &alarms[i];
+        }
+        if (due == NULL)
+            break;
+
+        alarm_id_t id = due->id;
+        int64_t r = due->callback(id, due->user_data);
+        if (due->id != id)
+            continue;           // im Rückruf abgebrochen
+        if (r > 0)
+            due->target_ns = sim_time_ns() + (uint64_t)r * 1000u;
+        else if (r < 0)
+            due->target_ns += (uint64_t)(-r) * 1000u;
+        else
+            due->id = 0;
+    }
+
+    uint64_t next = SIM_NEVER;
+    for (int i = 0; i < MAX_ALARMS; i++) {
+        if (alarms[i].id != 0 && alarms[i].target_ns < next)
+            next = alarms[i].target_ns;
+    }
+    return next;
+}
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    uint64_t target = time * 1000u;
+    if (target <= sim_time_ns() && !fire_if_past)
+        return 0;
+
+    sim_lock();
+    if (!tick_registered) {
+        sim_register_tick(alarm_tick);
+        tick_registered = true;
+    }
+    alarm_id_t id = -1;
+    for (int i = 0; i < MAX_ALARMS; i++) {
+        if (alarms[i].id == 0) {
+            id = next_id++;
+            alarms[i] = (sim_alarm_t){ id, target, callback, user_data };
+            break;
+        }
+    }
+    sim_tick_reschedule();
+    sim_unlock();
+    return id;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    return add_alarm_at(sim_time_ns() / 1000u + us, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    return add_alarm_in_us((uint64_t)ms * 1000u, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+    bool found = false;
+    sim_lock();
+    for (int i = 0; i < MAX_ALARMS; i++) {
+        if (alarm_id > 0 && alarms[i].id == alarm_id) {
+            alarms[i].id = 0;
+            found = true;
+        }
+    }
+    sim_unlock();
+    return found;
+}
+
+// Wie im SDK: delay_us > 0 zählt ab Ende des Rückrufs, < 0 ab dem
+// vorigen Fälligkeitszeitpunkt (feste Rate)
+static int64_t repeating_timer_callback(alarm_id_t id, void *user_data) {
+    (void)id;
+    repeating_timer_t *rt = (repeating_timer_t *)user_data;
+    if (rt->callback(rt))
+        return rt->delay_us;
+    rt->alarm_id = 0;
+    return 0;
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out) {
+    if (delay_us == 0)
+        delay_us = 1;
+    out->delay_us = delay_us;
+    out->callback = callback;
+    out->user_data = user_data;
+    uint64_t first = (uint64_t)(delay_us < 0 ? -delay_us : delay_us);
+    out->alarm_id = add_alarm_in_us(first, repeating_timer_callback, out, true);
+    return out->alarm_id > 0;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out) {
+    return add_repeating_timer_us((int64_t)delay_ms * 1000, callback, user_data, out);
+}
+
+bool cancel_repeating_timer(repeating_timer_t *timer) {
+    bool found = cancel_alarm(timer->alarm_id);
+    timer->alarm_id = 0;
+    return found;
+}
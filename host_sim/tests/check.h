@@ -0,0 +1,52 @@
+// check.h
+// Minimaler Prüfrahmen für die Host-Tests (ctest).
+//
+//     CHECK(bedingung, "format", ...)     Fehler zählen und melden
+//     CHECK_NEAR(ist, soll, tol)          |ist - soll| <= tol
+//     return check_summary();             Exit-Code 0 nur ohne Fehler
+//
+// check_now_ns() liefert eine monotone Zeit für Laufzeitmessungen.
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+static int check_failures = 0;
+static int check_count = 0;
+
+#define CHECK(cond, ...)                                                    \
+    do {                                                                    \
+        check_count++;                                                      \
+        if (!(cond)) {                                                      \
+            check_failures++;                                               \
+            printf("FEHLER %s:%d: %s: ", __FILE__, __LINE__, #cond);        \
+            printf(__VA_ARGS__);                                            \
+            printf("\n");                                                   \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tol)                                   \
+    do {                                                                    \
+        double check_a_ = (double)(actual);                                 \
+        double check_e_ = (double)(expected);                               \
+        CHECK(fabs(check_a_ - check_e_) <= (double)(tol),                   \
+              "%s = %.6g, erwartet %.6g +- %.3g",                           \
+              #actual, check_a_, check_e_, (double)(tol));                  \
+    } while (0)
+
+static inline uint64_t check_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline int check_summary(void) {
+    printf("%d Prüfungen, %d Fehler\n", check_count, check_failures);
+    return check_failures == 0 ? 0 : 1;
+}
+
+#endif // CHECK_H
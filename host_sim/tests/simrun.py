@@ -0,0 +1,82 @@
+"""Hilfen für die skriptgesteuerten Tests der Host-Simulation.
+
+Die Tests werden von ctest mit dem Build-Verzeichnis als erstem Argument
+aufgerufen und starten die *_sim-Programme mit SIM_SCRIPT/SIM_*-Variablen.
+"""
+
+import os
+import re
+import subprocess
+import sys
+
+_failures = 0
+_count = 0
+
+
+def build_dir():
+    if len(sys.argv) < 2:
+        sys.exit("Aufruf: %s <build-verzeichnis>" % sys.argv[0])
+    return sys.argv[1]
+
+
+def run(program, script=None, duration_ms=None, env=None, timeout=120):
+    """Startet <program>_sim und liefert (stdout, stderr).
+
+    script: Liste von (t_ms, text) für SIM_SCRIPT.
+    Bricht ab, wenn das Programm nicht sauber mit "Ende:" endet.
+    """
+    full_env = dict(os.environ)
+    if script is not None:
+        full_env["SIM_SCRIPT"] = ";".join("%g:%s" % (t, text) for t, text in script)
+    if duration_ms is not None:
+        full_env["SIM_DURATION_MS"] = str(duration_ms)
+    if env:
+        full_env.update({k: str(v) for k, v in env.items()})
+    exe = os.path.join(build_dir(), program + "_sim")
+    proc = subprocess.run([exe], env=full_env, stdin=subprocess.DEVNULL,
+                          capture_output=True, timeout=timeout)
+    out = proc.stdout.decode("utf-8", "replace")
+    err = proc.stderr.decode("utf-8", "replace")
+    if proc.returncode != 0 or "Ende:" not in err:
+        print(out[-2000:])
+        print(err[-2000:])
+        sys.exit("%s_sim: Exit-Code %d" % (program, proc.returncode))
+    return out, err
+
+
+def csv_rows(text, columns):
+    """Zeilen mit genau `columns` Zahlen, durch Komma getrennt."""
+    rows = []
+    for line in text.splitlines():
+        parts = line.split(",")
+        if len(parts) != columns:
+            continue
+        try:
+            rows.append([float(p) for p in parts])
+        except ValueError:
+            pass
+    return rows
+
+
+def find(pattern, text, group=1, conv=float):
+    m = re.search(pattern, text)
+    check(m is not None, "Muster nicht gefunden: %r" % pattern)
+    return conv(m.group(group)) if m else None
+
+
+def check(cond, msg):
+    global _failures, _count
+    _count += 1
+    if not cond:
+        _failures += 1
+        print("FEHLER: " + msg)
+
+
+def check_near(actual, expected, tol, what):
+    check(actual is not None and abs(actual - expected) <= tol,
+          "%s = %s, erwartet %g +- %g" % (what, actual, expected, tol))
+
+
+def summary():
+    print("%d Prüfungen, %d Fehler" % (_count, _failures))
+    sys.exit(0 if _failures == 0 else 1)
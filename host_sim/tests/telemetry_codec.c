@@ -0,0 +1,131 @@
+// telemetry_codec.c
+// Gegenstelle für test_telemetry_roundtrip.py.
+//
+//     telemetry_codec encode   Testframes mit telemetry_encode() nach stdout
+//     telemetry_codec decode   von Python kodierte Testframes von stdin
+//                              prüfen (Exit-Code 0 = alle korrekt)
+//
+// Beide Seiten erzeugen dieselben Testframes aus test_frame(); die Liste
+// muss zu FRAMES in test_telemetry_roundtrip.py passen.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "check.h"
+#include "crc.h"
+#include "telemetry.h"
+
+// Ungerade und gerade Anzahlen, leerer und voller Frame
+static const uint16_t frame_counts[] = { 0, 1, 2, 3, 7, 64, 511, 512 };
+#define NUM_FRAMES (sizeof(frame_counts) / sizeof(frame_counts[0]))
+
+typedef struct {
+    uint8_t type;
+    uint16_t seq;
+    uint16_t aux;
+    uint64_t timestamp_ns;
+    uint32_t period_ps;
+    uint16_t count;
+    uint16_t samples[TELEMETRY_MAX_SAMPLES];
+} test_frame_t;
+
+static void test_frame(uint32_t f, test_frame_t *t) {
+    t->type = (uint8_t)(1 + f % 3);
+    t->seq = (uint16_t)(65532u + f);                    // läuft über
+    t->aux = (uint16_t)(f * 4099u);
+    t->timestamp_ns = (1ull << 40) + f * 1000000007ull;
+    t->period_ps = f % 4 == 3 ? 0 : 2000000u + f;
+    t->count = frame_counts[f];
+    for (uint32_t k = 0; k < t->count; k++)
+        t->samples[k] = (uint16_t)((f * 977u + k * 131u) & 0x0fff);
+    if (t->count > 1) {
+        t->samples[0] = 0x0fff;
+        t->samples[t->count - 1] = 0;
+    }
+}
+
+static uint32_t get_le(const uint8_t *p, int n) {
+    uint32_t v = 0;
+    for (int i = n - 1; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static int encode(void) {
+    static uint8_t buf[TELEMETRY_FRAME_LEN(TELEMETRY_MAX_SAMPLES)];
+    static test_frame_t t;
+    for (uint32_t f = 0; f < NUM_FRAMES; f++) {
+        test_frame(f, &t);
+        size_t len = telemetry_encode(buf, sizeof(buf), t.type, t.seq, t.aux, t.timestamp_ns,
+                                      t.period_ps, t.samples, t.count);
+        if (len != TELEMETRY_FRAME_LEN((size_t)t.count))
+            return 1;
+        // Textzeilen zwischen den Frames wie im echten Datenstrom
+        printf("Frame %lu\n", (unsigned long)f);
+        fwrite(buf, 1, len, stdout);
+    }
+    // Zu kleiner Puffer: nichts kodieren
+    if (telemetry_encode(buf, TELEMETRY_FRAME_LEN(3) - 1, 1, 0, 0, 0, 0, t.samples, 3) != 0)
+        return 1;
+    return 0;
+}
+
+// Frame ab `p` (len Bytes verfügbar) mit Testframe `f` vergleichen
+static size_t check_frame(const uint8_t *p, size_t len, uint32_t f) {
+    static test_frame_t t;
+    test_frame(f, &t);
+    size_t total = TELEMETRY_FRAME_LEN((size_t)t.count);
+    CHECK(len >= total, "Frame %lu: nur %zu Bytes", (unsigned long)f, len);
+    if (len < total)
+        return len;
+
+    CHECK(get_le(p, 2) == TELEMETRY_SYNC, "Frame %lu: Sync", (unsigned long)f);
+    CHECK(p[2] == TELEMETRY_VERSION, "Frame %lu: Version %u", (unsigned long)f, p[2]);
+    CHECK(p[3] == t.type, "Frame %lu: Typ %u", (unsigned long)f, p[3]);
+    CHECK(get_le(p + 4, 2) == t.seq, "Frame %lu: seq", (unsigned long)f);
+    CHECK(get_le(p + 6, 2) == t.count, "Frame %lu: Anzahl", (unsigned long)f);
+    CHECK(get_le(p + 8, 2) == t.aux, "Frame %lu: Zusatzwert", (unsigned long)f);
+    uint64_t ts = get_le(p + 10, 4) | ((uint64_t)get_le(p + 14, 4) << 32);
+    CHECK(ts == t.timestamp_ns, "Frame %lu: Zeitstempel", (unsigned long)f);
+    CHECK(get_le(p + 18, 4) == t.period_ps, "Frame %lu: Periode", (unsigned long)f);
+
+    const uint8_t *s = p + TELEMETRY_HEADER_LEN;
+    for (uint32_t k = 0; k < t.count; k++) {
+        const uint8_t *q = s + 3 * (k / 2);
+        uint16_t v = k % 2 == 0 ? (uint16_t)(q[0] | ((q[1] & 0x0f) << 8))
+                                : (uint16_t)((q[1] >> 4) | (q[2] << 4));
+        if (v != t.samples[k]) {
+            CHECK(v == t.samples[k], "Frame %lu Sample %lu: %u statt %u", (unsigned long)f,
+                  (unsigned long)k, v, t.samples[k]);
+            break;
+        }
+    }
+    uint16_t crc = crc16_ccitt(CRC16_INIT, p + 2, total - TELEMETRY_CRC_LEN - 2);
+    CHECK(get_le(p + total - TELEMETRY_CRC_LEN, 2) == crc, "Frame %lu: CRC", (unsigned long)f);
+
+    // Byte für Byte identisch mit dem eigenen Encoder
+    static uint8_t own[TELEMETRY_FRAME_LEN(TELEMETRY_MAX_SAMPLES)];
+    telemetry_encode(own, sizeof(own), t.type, t.seq, t.aux, t.timestamp_ns, t.period_ps,
+                     t.samples, t.count);
+    CHECK(memcmp(own, p, total) == 0, "Frame %lu: Bytes weichen ab", (unsigned long)f);
+    return total;
+}
+
+static int decode(void) {
+    static uint8_t buf[NUM_FRAMES * TELEMETRY_FRAME_LEN(TELEMETRY_MAX_SAMPLES)];
+    size_t len = fread(buf, 1, sizeof(buf), stdin);
+    size_t pos = 0;
+    for (uint32_t f = 0; f < NUM_FRAMES && pos < len; f++)
+        pos += check_frame(buf + pos, len - pos, f);
+    CHECK(pos == len, "%zu von %zu Bytes dekodiert", pos, len);
+    return check_summary();
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2 && strcmp(argv[1], "encode") == 0)
+        return encode();
+    if (argc == 2 && strcmp(argv[1], "decode") == 0)
+        return decode();
+    fprintf(stderr, "Aufruf: %s encode|decode\n", argv[0]);
+    return 2;
+}
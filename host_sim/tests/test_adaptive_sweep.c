@@ -0,0 +1,257 @@
+// test_adaptive_sweep.c
+// Adaptiver Sweep (adaptive_sweep.c) an einer Strecke aus Rückrufen: pro
+// Block nähert sich der Ausgang um `alpha` der Kennlinie. Geprüft werden
+// die Einschwing-Erkennung (sofort, langsam, nie), die Verfeinerung an
+// einem steilen Abschnitt und an einer Parabel, Mittelpunkte, die durch
+// die PWM-Auflösung auf einen vorhandenen Punkt fallen, die Interpolation
+// von adaptive_table_lookup() und ungültige Konfigurationen.
+
+#include "adaptive_sweep.h"
+#include "check.h"
+
+typedef struct {
+    double (*curve)(double duty);   // eingeschwungener Wert in mV
+    double alpha;                   // Annäherung pro Block (1 = sofort)
+    double jitter_mv;               // abwechselnd +- pro Block
+    uint32_t levels;                // PWM-Stufen, 0 = keine Rundung
+    double duty;
+    double y;
+    uint32_t sets;
+    uint32_t blocks;
+} plant_t;
+
+static q16_t plant_set_duty(q16_t duty, void *ctx) {
+    plant_t *p = ctx;
+    p->sets++;
+    if (p->levels) {
+        // Wie die Firmware: auf die Stufe runden, tatsächlichen Wert melden
+        int32_t level = q16_mul_int_round(duty, (int32_t)p->levels);
+        duty = (q16_t)(((int64_t)level << Q16_SHIFT) / p->levels);
+    }
+    p->duty = duty / (double)Q16_ONE;
+    return duty;
+}
+
+static q16_t plant_measure_block(void *ctx) {
+    plant_t *p = ctx;
+    p->y += (p->curve(p->duty) - p->y) * p->alpha;
+    double mv = p->y + (p->blocks++ % 2 ? p->jitter_mv : -p->jitter_mv);
+    return (q16_t)(mv * Q16_ONE);
+}
+
+static adaptive_sweep_config_t base_config(plant_t *p) {
+    adaptive_sweep_config_t cfg = {
+        .duty_min = 0,
+        .duty_max = Q16_ONE,
+        .coarse_points = 17,
+        .min_step = Q16_ONE / 256,
+        .settle_tol_mv = Q16_CONST(0.5),
+        .settle_blocks = 3,
+        .max_blocks = 20,
+        .refine_tol_mv = Q16_CONST(0.5),
+        .max_delta_mv = Q16_CONST(50.0),
+        .set_duty = plant_set_duty,
+        .measure_block = plant_measure_block,
+        .ctx = p,
+    };
+    return cfg;
+}
+
+static double q(q16_t v) {
+    return v / (double)Q16_ONE;
+}
+
+static double linear(double d) {
+    return 100.0 + 200.0 * d;
+}
+
+// Flach mit leichter Steigung, zwischen 0,40 und 0,45 ein Anstieg um 1 V
+static double step(double d) {
+    double ramp = d < 0.40 ? 0.0 : d > 0.45 ? 1.0 : (d - 0.40) / 0.05;
+    return 100.0 + 40.0 * d + 1000.0 * ramp;
+}
+
+static double parabola(double d) {
+    return 50.0 + 2000.0 * d * d;
+}
+
+// Tabelle aufsteigend, ohne doppelte Tastgrade
+static bool ascending(const adaptive_table_t *t) {
+    for (int i = 0; i + 1 < t->count; i++)
+        if (t->duty[i + 1] <= t->duty[i])
+            return false;
+    return true;
+}
+
+// -------------------------
+//  EINSCHWINGEN
+// -------------------------
+static void test_settle(void) {
+    static adaptive_table_t t;
+
+    // Sofort eingeschwungen: settle_blocks + 1 Blöcke pro Punkt, exakt;
+    // gerade Kennlinie, keine Verfeinerung
+    plant_t p = { .curve = linear, .alpha = 1.0 };
+    adaptive_sweep_config_t cfg = base_config(&p);
+    CHECK(adaptive_sweep_run(&cfg, &t), "Lauf sofort");
+    CHECK(t.count == 17 && t.blocks == 17 * 4 && t.unsettled == 0,
+          "sofort: %u Punkte, %u Blöcke, %u nicht eingeschwungen", t.count, t.blocks, t.unsettled);
+    double worst = 0.0;
+    for (int i = 0; i < t.count; i++)
+        worst = fmax(worst, fabs(q(t.mv[i]) - linear(q(t.duty[i]))));
+    CHECK(worst < 1e-3, "sofort: Abweichung %.5f mV", worst);
+
+    // Langsam (30 % pro Block): mehr Blöcke, Rest innerhalb weniger
+    // Toleranzen (Mittel der letzten Blöcke hinkt nach)
+    p = (plant_t){ .curve = linear, .alpha = 0.3 };
+    cfg = base_config(&p);
+    CHECK(adaptive_sweep_run(&cfg, &t), "Lauf langsam");
+    worst = 0.0;
+    for (int i = 0; i < t.count; i++)
+        worst = fmax(worst, fabs(q(t.mv[i]) - linear(q(t.duty[i]))));
+    printf("langsam: %u Punkte, %u Blöcke, Abweichung bis %.3f mV\n", t.count, t.blocks, worst);
+    CHECK(t.unsettled == 0 && t.blocks > t.count * 4u, "langsam: %u Blöcke, %u nicht eingeschwungen",
+          t.blocks, t.unsettled);
+    CHECK(worst < 6.0 * q(cfg.settle_tol_mv), "langsam: Abweichung %.3f mV", worst);
+
+    // Nie eingeschwungen (Sprünge > Toleranz): max_blocks pro Punkt,
+    // letzter Block als Messwert
+    p = (plant_t){ .curve = linear, .alpha = 1.0, .jitter_mv = 2.0 };
+    cfg = base_config(&p);
+    cfg.max_blocks = 10;
+    CHECK(adaptive_sweep_run(&cfg, &t), "Lauf unruhig");
+    CHECK(t.unsettled == t.count && t.blocks == t.count * 10u,
+          "unruhig: %u Punkte, %u Blöcke, %u nicht eingeschwungen", t.count, t.blocks, t.unsettled);
+    CHECK_NEAR(q(t.mv[0]), linear(0.0) + 2.0, 1e-3);
+}
+
+// -------------------------
+//  VERFEINERUNG
+// -------------------------
+// Im steilen Abschnitt bis auf min_step, weit davon grob
+static void test_refine_steep(void) {
+    static adaptive_table_t t;
+    plant_t p = { .curve = step, .alpha = 1.0 };
+    adaptive_sweep_config_t cfg = base_config(&p);
+    CHECK(adaptive_sweep_run(&cfg, &t), "Lauf");
+    CHECK(ascending(&t), "nicht aufsteigend");
+
+    int steep = 0;
+    for (int i = 0; i + 1 < t.count; i++) {
+        double d0 = q(t.duty[i]), d1 = q(t.duty[i + 1]), h = d1 - d0;
+        if (d1 > 0.40 && d0 < 0.45) {
+            steep++;
+            CHECK(h < 2.0 * q(cfg.min_step), "steil [%.4f, %.4f]: Breite %.4f", d0, d1, h);
+        }
+        if (d1 <= 0.25 || d0 >= 0.625)
+            CHECK(fabs(h - 1.0 / 16) < 1e-4, "flach [%.4f, %.4f]: verfeinert", d0, d1);
+        double delta = fabs(q(t.mv[i + 1]) - q(t.mv[i]));
+        CHECK(delta <= q(cfg.max_delta_mv) || h < 2.0 * q(cfg.min_step),
+              "[%.4f, %.4f]: Sprung %.1f mV", d0, d1, delta);
+    }
+    printf("Stufe: %u Punkte, %d im steilen Abschnitt\n", t.count, steep);
+    CHECK(steep >= 10, "nur %d Intervalle im steilen Abschnitt", steep);
+}
+
+// Parabel: Interpolationsfehler überall innerhalb refine_tol_mv (die
+// Schätzung aus den Nachbarsteigungen ist dort das Doppelte des Fehlers)
+static void test_refine_curvature(void) {
+    static adaptive_table_t t;
+    plant_t p = { .curve = parabola, .alpha = 1.0 };
+    adaptive_sweep_config_t cfg = base_config(&p);
+    cfg.coarse_points = 5;
+    cfg.min_step = Q16_ONE / 4096;
+    cfg.max_delta_mv = Q16_CONST(5000.0);
+    CHECK(adaptive_sweep_run(&cfg, &t), "Lauf");
+    CHECK(ascending(&t), "nicht aufsteigend");
+
+    double worst = 0.0;
+    for (int i = 0; i <= 10000; i++) {
+        double d = i / 10000.0;
+        worst = fmax(worst, fabs(q(adaptive_table_lookup(&t, (q16_t)(d * Q16_ONE))) - parabola(d)));
+    }
+    printf("Parabel: %u Punkte, Interpolationsfehler bis %.3f mV\n", t.count, worst);
+    CHECK(worst <= q(cfg.refine_tol_mv) + 0.01, "Interpolationsfehler %.3f mV", worst);
+    CHECK(t.count < ADAPTIVE_SWEEP_MAX_POINTS, "Tabelle voll (%u Punkte)", t.count);
+}
+
+// Gröbere PWM als min_step: Mittelpunkte runden auf einen der beiden
+// Nachbarn und werden nicht eingefügt; der Lauf endet trotzdem
+static void test_quantised_mid(void) {
+    static adaptive_table_t t;
+    plant_t p = { .curve = step, .alpha = 1.0, .levels = 64 };
+    adaptive_sweep_config_t cfg = base_config(&p);
+    cfg.min_step = Q16_ONE / 1024;
+    CHECK(adaptive_sweep_run(&cfg, &t), "Lauf");
+    CHECK(ascending(&t), "doppelter oder fallender Tastgrad");
+
+    int steep = 0;
+    for (int i = 0; i < t.count; i++) {
+        CHECK(t.duty[i] % (Q16_ONE / 64) == 0, "Punkt %d nicht auf der PWM-Stufe: %.6f", i,
+              q(t.duty[i]));
+        if (i + 1 < t.count && q(t.duty[i + 1]) > 0.40 && q(t.duty[i]) < 0.45) {
+            steep++;
+            CHECK(t.duty[i + 1] - t.duty[i] == Q16_ONE / 64, "steil [%.4f, %.4f] nicht auf 1/64",
+                  q(t.duty[i]), q(t.duty[i + 1]));
+        }
+    }
+    printf("1/64-PWM: %u Punkte, %u Messungen (%u verworfen)\n", t.count, p.sets, p.sets - t.count);
+    CHECK(steep >= 3 && p.sets > t.count, "%d steile Intervalle, %u Messungen", steep, p.sets);
+    CHECK(t.blocks == p.blocks, "Blockzähler %u, Strecke %u", t.blocks, p.blocks);
+}
+
+// -------------------------
+//  INTERPOLATION, KONFIGURATION
+// -------------------------
+static void test_lookup(void) {
+    static adaptive_table_t t;
+    t.count = 0;
+    CHECK(adaptive_table_lookup(&t, Q16_CONST(0.5)) == 0, "leere Tabelle");
+
+    t.count = 3;
+    t.duty[0] = Q16_CONST(0.2), t.mv[0] = Q16_CONST(10.0);
+    t.duty[1] = Q16_CONST(0.5), t.mv[1] = Q16_CONST(40.0);
+    t.duty[2] = Q16_CONST(0.6), t.mv[2] = Q16_CONST(20.0);
+    CHECK_NEAR(q(adaptive_table_lookup(&t, Q16_CONST(0.1))), 10.0, 0.0);
+    CHECK_NEAR(q(adaptive_table_lookup(&t, Q16_CONST(0.9))), 20.0, 0.0);
+    CHECK_NEAR(q(adaptive_table_lookup(&t, Q16_CONST(0.5))), 40.0, 0.0);
+    CHECK_NEAR(q(adaptive_table_lookup(&t, Q16_CONST(0.35))), 25.0, 1e-3);
+    CHECK_NEAR(q(adaptive_table_lookup(&t, Q16_CONST(0.55))), 30.0, 1e-3);
+}
+
+static void test_invalid(void) {
+    static adaptive_table_t t;
+    plant_t p = { .curve = linear, .alpha = 1.0 };
+    adaptive_sweep_config_t cfg = base_config(&p);
+
+    cfg.coarse_points = 1;
+    CHECK(!adaptive_sweep_run(&cfg, &t), "1 Rasterpunkt");
+    cfg = base_config(&p);
+    cfg.coarse_points = ADAPTIVE_SWEEP_MAX_POINTS + 1;
+    CHECK(!adaptive_sweep_run(&cfg, &t), "Raster zu groß");
+    cfg = base_config(&p);
+    cfg.duty_max = cfg.duty_min;
+    CHECK(!adaptive_sweep_run(&cfg, &t), "leerer Bereich");
+    cfg = base_config(&p);
+    cfg.min_step = 0;
+    CHECK(!adaptive_sweep_run(&cfg, &t), "min_step 0");
+    cfg = base_config(&p);
+    cfg.settle_blocks = 0;
+    CHECK(!adaptive_sweep_run(&cfg, &t), "settle_blocks 0");
+    cfg.settle_blocks = ADAPTIVE_SWEEP_MAX_SETTLE;
+    CHECK(!adaptive_sweep_run(&cfg, &t), "settle_blocks zu groß");
+    cfg = base_config(&p);
+    cfg.max_blocks = cfg.settle_blocks;
+    CHECK(!adaptive_sweep_run(&cfg, &t), "max_blocks <= settle_blocks");
+    CHECK(p.sets == 0, "ungültige Konfiguration hat %u Punkte angefahren", p.sets);
+}
+
+int main(void) {
+    test_settle();
+    test_refine_steep();
+    test_refine_curvature();
+    test_quantised_mid();
+    test_lookup();
+    test_invalid();
+    return check_summary();
+}
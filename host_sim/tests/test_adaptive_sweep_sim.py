@@ -0,0 +1,73 @@
+"""Adaptiver Kalibrier-Sweep von pwm_sweep gegen den vollen Sweep.
+
+Langsame Photodiode (SIM_TAU_US=300) mit Sättigung (SIM_SAT_MV=400), die
+Kennlinie ist damit gekrümmt. Referenz ist der volle Sweep ohne Rauschen.
+Verglichen werden auf dem festen Raster 0..255:
+
+    Dauer       adaptiv höchstens 1/10 des vollen Sweeps
+    rms-Fehler  adaptiv (linear interpoliert) gegen die Referenz höchstens
+                RMS_MAX_MV und höchstens doppelt so groß wie beim vollen
+                Sweep mit Rauschen (der misst jeden Rasterpunkt, der
+                adaptive interpoliert dazwischen)
+
+Mit linearer Kennlinie (ohne Sättigung) bleibt das Raster grob.
+"""
+
+import math
+
+import simrun
+
+ENV = {"SIM_TAU_US": 300, "SIM_SAT_MV": 400}
+MAX_DUTY = 255
+COARSE_POINTS = 17
+RMS_MAX_MV = 0.3
+
+
+def sweep(script, env):
+    """(Dauer in ms, [(Tastgrad, mV)], Kopfzeile) des ersten Sweeps."""
+    out, err = simrun.run("pwm_sweep", script=[(1100, script)], duration_ms=8000, env=env)
+    start = out.find("Sweep beendet!")
+    simrun.check(start >= 0, "kein Sweep in der Ausgabe")
+    head = out[start:out.find("\n", start)]
+    end = out.find("Bereit.", start)
+    rows = simrun.csv_rows(out[start:end], 2)
+    return simrun.find(r"Sweep beendet! \((\d+) ms", head), rows, head
+
+
+def interpolate(rows, duty):
+    for (d0, v0), (d1, v1) in zip(rows, rows[1:]):
+        if d0 <= duty <= d1:
+            return v0 + (v1 - v0) * (duty - d0) / (d1 - d0)
+    return rows[0][1] if duty < rows[0][0] else rows[-1][1]
+
+
+def rms(values, ref):
+    return math.sqrt(sum((v - r) ** 2 for v, r in zip(values, ref)) / len(ref))
+
+
+_, ref_rows, _ = sweep("voll", dict(ENV, SIM_NOISE_MV=0))
+full_ms, full_rows, _ = sweep("voll", ENV)
+adapt_ms, adapt_rows, head = sweep("", ENV)
+simrun.check(len(ref_rows) == MAX_DUTY + 1 and len(full_rows) == MAX_DUTY + 1,
+             "voller Sweep: %d/%d Punkte" % (len(ref_rows), len(full_rows)))
+
+ref = [r[1] for r in ref_rows]
+full_rms = rms([r[1] for r in full_rows], ref)
+adapt_rms = rms([interpolate(adapt_rows, d) for d in range(MAX_DUTY + 1)], ref)
+points = simrun.find(r"(\d+) Punkte", head, conv=int)
+print("voll:    %5d ms, %3d Punkte, %.3f mV rms" % (full_ms, len(full_rows), full_rms))
+print("adaptiv: %5d ms, %3d Punkte, %.3f mV rms" % (adapt_ms, points, adapt_rms))
+
+simrun.check(adapt_ms * 10 <= full_ms, "adaptiv %d ms, voll %d ms" % (adapt_ms, full_ms))
+simrun.check(adapt_rms <= RMS_MAX_MV, "adaptiv %.3f mV rms" % adapt_rms)
+simrun.check(adapt_rms <= 2 * full_rms, "adaptiv %.3f mV rms, voll %.3f mV rms" % (adapt_rms, full_rms))
+simrun.check(points == len(adapt_rows) and points > COARSE_POINTS,
+             "%d Punkte (%d Zeilen), keine Verfeinerung" % (points, len(adapt_rows)))
+simrun.check("0 nicht eingeschwungen" in head, "Punkte nicht eingeschwungen: " + head)
+
+# Ohne Sättigung ist die Kennlinie gerade: kaum Verfeinerung
+_, linear_rows, _ = sweep("", dict(ENV, SIM_SAT_MV=0))
+print("linear:  %d Punkte" % len(linear_rows))
+simrun.check(len(linear_rows) < points, "linear %d Punkte, gesättigt %d" % (len(linear_rows), points))
+
+simrun.summary()
@@ -0,0 +1,44 @@
+"""Bode-Messung von pwm_sweep gegen das Streckenmodell.
+
+Die Strecke ist ein Tiefpass erster Ordnung (SIM_TAU_US) mit Totzeit
+(SIM_DELAY_US), die Referenz an ADC1 folgt dem Laser ohne Verzögerung mit
+SIM_REF_MV. Erwartet:
+
+    Verstärkung   20 log10(GAIN / REF) - 10 log10(1 + (2 pi f tau)^2)
+    Phase         -atan(2 pi f tau) - 360 f delay
+
+Ohne Referenz (SIM_REF_MV=0) muss die Messung mit einer Fehlermeldung
+abbrechen, statt eine Tabelle aus Rauschen auszugeben.
+"""
+
+import math
+
+import simrun
+
+DELAY_US, TAU_US, GAIN_MV, REF_MV = 5, 20, 600, 300
+ENV = {"SIM_DELAY_US": DELAY_US, "SIM_TAU_US": TAU_US, "SIM_GAIN_MV": GAIN_MV, "SIM_REF_MV": REF_MV}
+SCRIPT = [(1100, "bode 200 20000 8")]
+
+out, err = simrun.run("pwm_sweep", script=SCRIPT, duration_ms=3000, env=ENV)
+start = out.find("f_Hz, Verstärkung_dB, Phase_Grad")
+simrun.check(start >= 0, "keine Bode-Tabelle")
+rows = simrun.csv_rows(out[start:], 3)
+simrun.check(len(rows) == 8, "%d Punkte statt 8" % len(rows))
+
+for f, gain_db, phase_deg in rows:
+    wt = 2 * math.pi * f * TAU_US * 1e-6
+    want_db = 20 * math.log10(GAIN_MV / REF_MV) - 10 * math.log10(1 + wt * wt)
+    want_deg = -math.degrees(math.atan(wt)) - 360 * f * DELAY_US * 1e-6
+    simrun.check_near(gain_db, want_db, 0.3, "Verstärkung bei %.0f Hz (dB)" % f)
+    simrun.check_near(phase_deg, want_deg, 3.0 + 0.1 * abs(want_deg), "Phase bei %.0f Hz (Grad)" % f)
+
+corner = simrun.find(r"-3 dB bei (\d+) Hz", out)
+simrun.check_near(corner, 1 / (2 * math.pi * TAU_US * 1e-6), 1000, "-3-dB-Grenze (Hz)")
+
+# Offener Referenzeingang: Abbruch ohne Tabelle
+out, err = simrun.run("pwm_sweep", script=SCRIPT, duration_ms=3000, env=dict(ENV, SIM_REF_MV=0))
+simrun.check("FEHLER: Keine Referenz an ADC1" in out, "fehlende Referenz nicht gemeldet")
+simrun.check("Bode-Messung abgebrochen" in out, "Messung nicht abgebrochen")
+simrun.check("f_Hz, Verstärkung_dB" not in out, "Tabelle trotz fehlender Referenz")
+
+simrun.summary()
@@ -0,0 +1,151 @@
+// test_cal_store.c
+// Kalibrierdatensätze (cal_store.c, cal_store_flash.c): Hin- und Rückweg,
+// verfälschte CRC, abgeschnittener Datensatz, falsche Version, A/B-Sektoren.
+
+#include <string.h>
+
+#include "check.h"
+#include "hardware/flash.h"
+#include "cal_store.h"
+
+#define POINTS 101
+
+static uint8_t rec[CAL_RECORD_LEN(CAL_MAX_POINTS)];
+static uint16_t values[CAL_MAX_POINTS];
+static uint16_t read_back[CAL_MAX_POINTS];
+
+static cal_header_t test_header(uint16_t points) {
+    cal_header_t hdr = {
+        .seq = 0x89abcdefu,
+        .timestamp_us = 0x0123456789abull,
+        .points = points,
+        .duty_max = 50,
+        .pwm_freq_hz = 1000,
+        .pwm_wrap = 62499,
+        .samples_per_step = 1500,
+        .settle_ms = 20,
+    };
+    for (uint16_t i = 0; i < points; i++)
+        values[i] = (uint16_t)(50 * CAL_MV_SCALE + i * 97u + (i & 1));
+    return hdr;
+}
+
+static void test_round_trip(void) {
+    static const uint16_t counts[] = { 0, 1, POINTS, CAL_MAX_POINTS };
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        cal_header_t hdr = test_header(counts[c]);
+        size_t len = cal_serialize(rec, sizeof(rec), &hdr, values);
+        CHECK(len == CAL_RECORD_LEN((size_t)counts[c]), "%u Punkte: Länge %zu", counts[c], len);
+
+        cal_header_t out;
+        memset(read_back, 0, sizeof(read_back));
+        cal_status_t st = cal_deserialize(rec, len, &out, read_back, CAL_MAX_POINTS);
+        CHECK(st == CAL_OK, "%u Punkte: Status %d", counts[c], st);
+        CHECK(out.seq == hdr.seq && out.timestamp_us == hdr.timestamp_us
+              && out.points == hdr.points && out.duty_max == hdr.duty_max
+              && out.pwm_freq_hz == hdr.pwm_freq_hz && out.pwm_wrap == hdr.pwm_wrap
+              && out.samples_per_step == hdr.samples_per_step && out.settle_ms == hdr.settle_ms,
+              "%u Punkte: Kopf weicht ab", counts[c]);
+        CHECK(memcmp(read_back, values, 2u * counts[c]) == 0, "%u Punkte: Messwerte", counts[c]);
+        // Nur prüfen, ohne Zielpuffer
+        CHECK(cal_deserialize(rec, len, &out, NULL, 0) == CAL_OK, "%u Punkte: ohne Werte", counts[c]);
+    }
+
+    // Zu viele Punkte bzw. zu kleiner Puffer
+    cal_header_t hdr = test_header(POINTS);
+    hdr.points = CAL_MAX_POINTS + 1;
+    CHECK(cal_serialize(rec, sizeof(rec), &hdr, values) == 0, "zu viele Punkte serialisiert");
+    hdr.points = POINTS;
+    CHECK(cal_serialize(rec, CAL_RECORD_LEN(POINTS) - 1, &hdr, values) == 0, "Puffer zu klein");
+    size_t len = cal_serialize(rec, sizeof(rec), &hdr, values);
+    cal_header_t out;
+    CHECK(cal_deserialize(rec, len, &out, read_back, POINTS - 1) == CAL_ERR_POINTS,
+          "Zielpuffer zu klein nicht erkannt");
+}
+
+static void test_corruption(void) {
+    cal_header_t hdr = test_header(POINTS);
+    size_t len = cal_serialize(rec, sizeof(rec), &hdr, values);
+    cal_header_t out;
+
+    // Jedes einzelne gekippte Bit außerhalb von Magic, Version und Punktzahl
+    // muss als CRC-Fehler auffallen
+    int missed = 0;
+    for (size_t byte = 0; byte < len; byte++) {
+        if (byte < 8 || byte == 20 || byte == 21)
+            continue;
+        for (int bit = 0; bit < 8; bit++) {
+            rec[byte] ^= (uint8_t)(1u << bit);
+            if (cal_deserialize(rec, len, &out, read_back, CAL_MAX_POINTS) != CAL_ERR_CRC)
+                missed++;
+            rec[byte] ^= (uint8_t)(1u << bit);
+        }
+    }
+    CHECK(missed == 0, "%d gekippte Bits nicht als CRC-Fehler erkannt", missed);
+
+    // Punktzahl verfälscht: anderer Datensatzumfang, CRC passt nicht
+    rec[20] ^= 0x01;
+    CHECK(cal_deserialize(rec, len, &out, read_back, CAL_MAX_POINTS) != CAL_OK,
+          "verfälschte Punktzahl akzeptiert");
+    rec[20] ^= 0x01;
+
+    // Abgeschnitten: im Kopf und in den Messwerten
+    CHECK(cal_deserialize(rec, CAL_HEADER_LEN - 1, &out, NULL, 0) == CAL_ERR_SHORT,
+          "abgeschnittener Kopf");
+    CHECK(cal_deserialize(rec, len - 1, &out, NULL, 0) == CAL_ERR_SHORT,
+          "abgeschnittene Messwerte");
+    CHECK(cal_deserialize(rec, CAL_HEADER_LEN, &out, NULL, 0) == CAL_ERR_SHORT,
+          "nur Kopf");
+
+    // Gelöschter Flash, andere Version, andere Kopflänge
+    uint8_t erased[CAL_HEADER_LEN];
+    memset(erased, 0xff, sizeof(erased));
+    CHECK(cal_deserialize(erased, sizeof(erased), &out, NULL, 0) == CAL_ERR_MAGIC, "gelöschter Flash");
+    rec[4] = CAL_VERSION + 1;
+    CHECK(cal_deserialize(rec, len, &out, NULL, 0) == CAL_ERR_VERSION, "Version");
+    rec[4] = CAL_VERSION;
+    rec[6] = CAL_HEADER_LEN + 4;
+    CHECK(cal_deserialize(rec, len, &out, NULL, 0) == CAL_ERR_VERSION, "Kopflänge");
+    rec[6] = CAL_HEADER_LEN;
+    CHECK(cal_deserialize(rec, len, &out, NULL, 0) == CAL_OK, "Datensatz nicht wiederhergestellt");
+}
+
+// A/B-Sektoren am Ende des (simulierten) Flash
+static void test_flash_slots(void) {
+    uint32_t slot_a = PICO_FLASH_SIZE_BYTES - 2 * FLASH_SECTOR_SIZE;
+    flash_range_erase(slot_a, 2 * FLASH_SECTOR_SIZE);
+
+    cal_header_t out;
+    CHECK(!cal_store_load(&out, read_back, CAL_MAX_POINTS), "leerer Flash geladen");
+
+    cal_header_t hdr = test_header(POINTS);
+    CHECK(cal_store_save(&hdr, values), "erstes Speichern");
+    CHECK(hdr.seq == 1, "seq %lu", (unsigned long)hdr.seq);
+    values[0] = 1234;
+    CHECK(cal_store_save(&hdr, values), "zweites Speichern");
+    CHECK(hdr.seq == 2, "seq %lu", (unsigned long)hdr.seq);
+    CHECK(cal_store_load(&out, read_back, CAL_MAX_POINTS) && out.seq == 2 && read_back[0] == 1234,
+          "neuester Datensatz nicht geladen");
+
+    // Stromausfall beim dritten Schreiben: A (der ältere) gelöscht, nicht programmiert
+    flash_range_erase(slot_a, FLASH_SECTOR_SIZE);
+    CHECK(cal_store_load(&out, read_back, CAL_MAX_POINTS) && out.seq == 2,
+          "Datensatz 2 nach Abbruch nicht mehr lesbar");
+    // Datensatz 3 landet in A; wird er verfälscht, gilt wieder 2 aus B
+    CHECK(cal_store_save(&hdr, values) && hdr.seq == 3, "drittes Speichern");
+    CHECK(cal_store_load(&out, read_back, CAL_MAX_POINTS) && out.seq == 3, "Datensatz 3");
+    static uint8_t page[FLASH_PAGE_SIZE];
+    memcpy(page, (const uint8_t *)(XIP_BASE + slot_a), sizeof(page));
+    flash_range_erase(slot_a, FLASH_SECTOR_SIZE);
+    page[CAL_HEADER_LEN] ^= 0x40;
+    flash_range_program(slot_a, page, sizeof(page));
+    CHECK(cal_store_load(&out, read_back, CAL_MAX_POINTS) && out.seq == 2,
+          "nach verfälschtem A nicht Datensatz 2 aus B");
+}
+
+int main(void) {
+    test_round_trip();
+    test_corruption();
+    test_flash_slots();
+    return check_summary();
+}
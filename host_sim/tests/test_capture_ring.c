@@ -0,0 +1,192 @@
+// test_capture_ring.c
+// Buchhaltung des Erfassungs-Rings (capture_ring.c) ohne DMA: der Produzent
+// schreibt die Blocknummer in jeden Block und meldet ihn mit
+// capture_ring_commit(). Geprüft werden Reihenfolge von peek/release,
+// Overruns in capture_ring_peek(), capture_ring_release() nach dem
+// Überschreiben, capture_ring_skip_to_latest(), der Überlauf des 32-Bit-
+// Zählers `head` und die Ablehnung von Blockzahlen, die keine Zweierpotenz
+// sind. Zum Schluss die Laufzeit eines Blockumlaufs.
+
+#include <stddef.h>
+
+#include "capture_ring.h"
+#include "check.h"
+
+#define BLOCK_LEN 8
+#define MAX_BLOCKS 16
+#define BENCH_BLOCKS 10000000u
+
+static uint16_t storage[MAX_BLOCKS * BLOCK_LEN];
+
+// Block `head` fertig beschreiben (Inhalt: untere 16 Bit der Blocknummer)
+// und melden. Der zurückgegebene Block muss der übernächste sein.
+static void produce(capture_ring_t *ring) {
+    uint32_t seq = ring->head;
+    uint16_t *b = capture_ring_block(ring, seq);
+    for (int i = 0; i < BLOCK_LEN; i++)
+        b[i] = (uint16_t)seq;
+    uint16_t *next = capture_ring_commit(ring);
+    CHECK(next == capture_ring_block(ring, seq + 2), "commit bei %u: falscher Folgeblock", seq);
+}
+
+// Ältesten Block lesen und freigeben; erwartet Nummer `want`
+static void consume(capture_ring_t *ring, uint32_t want) {
+    uint32_t seq = 0xdeadbeef;
+    const uint16_t *b = capture_ring_peek(ring, &seq);
+    CHECK(b != NULL && seq == want, "peek: %u statt %u", seq, want);
+    if (b == NULL)
+        return;
+    // Nie einer der beiden Blöcke, die die DMA gerade beschreibt
+    CHECK(b != capture_ring_block(ring, ring->head) && b != capture_ring_block(ring, ring->head + 1),
+          "peek liefert Block %u, der gerade beschrieben wird", seq);
+    CHECK(b[0] == (uint16_t)want && b[BLOCK_LEN - 1] == (uint16_t)want,
+          "Block %u enthält %u", want, b[0]);
+    CHECK(capture_ring_release(ring, seq), "release %u", seq);
+}
+
+static void test_init(void) {
+    capture_ring_t ring;
+    static const uint32_t good[] = { 4, 8, 16 };
+    static const uint32_t bad[] = { 0, 1, 2, 3, 5, 6, 7, 12 };
+    for (size_t i = 0; i < sizeof(good) / sizeof(good[0]); i++)
+        CHECK(capture_ring_init(&ring, storage, BLOCK_LEN, good[i]), "%u Blöcke abgelehnt", good[i]);
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+        CHECK(!capture_ring_init(&ring, storage, BLOCK_LEN, bad[i]), "%u Blöcke angenommen", bad[i]);
+    CHECK(!capture_ring_init(&ring, storage, 0, 4), "Blocklänge 0");
+    CHECK(!capture_ring_init(&ring, NULL, BLOCK_LEN, 4), "kein Speicher");
+}
+
+// Abwechselnd produzieren und lesen, auch mit vollem Ring
+static void test_order(void) {
+    capture_ring_t ring;
+    CHECK(capture_ring_init(&ring, storage, BLOCK_LEN, 8), "Init");
+    CHECK(capture_ring_capacity(&ring) == 6, "Kapazität %u", capture_ring_capacity(&ring));
+    CHECK(capture_ring_peek(&ring, NULL) == NULL, "leerer Ring liefert Block");
+
+    uint32_t next = 0;
+    for (int round = 0; round < 20; round++) {
+        uint32_t n = (uint32_t)(round % 7);  // 0 bis zur Kapazität
+        for (uint32_t i = 0; i < n; i++)
+            produce(&ring);
+        CHECK(capture_ring_available(&ring) == n, "Runde %d: %u verfügbar statt %u", round,
+              capture_ring_available(&ring), n);
+        for (uint32_t i = 0; i < n; i++)
+            consume(&ring, next++);
+        CHECK(capture_ring_peek(&ring, NULL) == NULL, "Runde %d: Ring nicht leer", round);
+    }
+    CHECK(ring.overruns == 0, "%u Overruns", ring.overruns);
+}
+
+// Mehr Blöcke als die Kapazität: peek verwirft die ältesten und zählt sie
+static void test_peek_overrun(void) {
+    capture_ring_t ring;
+    CHECK(capture_ring_init(&ring, storage, BLOCK_LEN, 4), "Init");
+    for (int i = 0; i < 5; i++)
+        produce(&ring);
+    CHECK(capture_ring_available(&ring) == 2, "%u verfügbar", capture_ring_available(&ring));
+    consume(&ring, 3);
+    CHECK(ring.overruns == 3, "%u Overruns statt 3", ring.overruns);
+    consume(&ring, 4);
+    CHECK(ring.overruns == 3, "%u Overruns nach dem Aufholen", ring.overruns);
+}
+
+// Während des Lesens überschrieben: release meldet es, der Ring läuft weiter
+static void test_release_overwritten(void) {
+    capture_ring_t ring;
+    CHECK(capture_ring_init(&ring, storage, BLOCK_LEN, 4), "Init");
+    produce(&ring);
+    uint32_t seq;
+    CHECK(capture_ring_peek(&ring, &seq) != NULL && seq == 0, "peek");
+    produce(&ring);
+    // Block 0 ist bei head = 2 noch gültig (in Arbeit sind 2 und 3)
+    CHECK(capture_ring_release(&ring, seq) && ring.overruns == 0,
+          "Block 0 bei head 2 als überschrieben gezählt");
+
+    CHECK(capture_ring_peek(&ring, &seq) != NULL && seq == 1, "peek 1");
+    produce(&ring);
+    produce(&ring);  // head = 4: Block 1 teilt sich den Speicher mit Block 5 (in Arbeit)
+    CHECK(!capture_ring_release(&ring, seq), "release nach dem Überschreiben");
+    CHECK(ring.overruns == 1, "%u Overruns statt 1", ring.overruns);
+    consume(&ring, 2);
+    consume(&ring, 3);
+    CHECK(ring.overruns == 1, "%u Overruns am Ende", ring.overruns);
+}
+
+static void test_skip_to_latest(void) {
+    capture_ring_t ring;
+    CHECK(capture_ring_init(&ring, storage, BLOCK_LEN, 8), "Init");
+    CHECK(capture_ring_skip_to_latest(&ring) == 0, "leerer Ring");
+    produce(&ring);
+    CHECK(capture_ring_skip_to_latest(&ring) == 0, "ein Block");
+    consume(&ring, 0);
+
+    for (int i = 0; i < 5; i++)
+        produce(&ring);
+    CHECK(capture_ring_skip_to_latest(&ring) == 4, "5 Blöcke: nicht 4 übersprungen");
+    consume(&ring, 5);
+    CHECK(ring.overruns == 0, "Überspringen als Overrun gezählt (%u)", ring.overruns);
+}
+
+// head und tail laufen über 2^32; die Blockadresse muss dabei lückenlos
+// weiterzählen (mit seq % block_count und 6 Blöcken fiele Block 0 auf
+// denselben Speicher wie Block 2^32 - 1)
+static void test_wraparound(void) {
+    capture_ring_t ring;
+    CHECK(capture_ring_init(&ring, storage, BLOCK_LEN, 8), "Init");
+    uint32_t start = UINT32_MAX - 20;
+    ring.head = ring.tail = start;
+
+    uint32_t next = start;
+    for (int round = 0; round < 16; round++) {
+        uint32_t n = 1 + (uint32_t)round % 6;
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t seq = ring.head;
+            uint16_t *a = capture_ring_block(&ring, seq), *b = capture_ring_block(&ring, seq + 1);
+            CHECK(b - a == BLOCK_LEN || a - b == 7 * BLOCK_LEN,
+                  "Block %u -> %u: Adresssprung %td", seq, seq + 1, b - a);
+            produce(&ring);
+        }
+        for (uint32_t i = 0; i < n; i++)
+            consume(&ring, next++);
+    }
+    CHECK(next < start && ring.overruns == 0, "kein Überlauf (next %u, %u Overruns)", next,
+          ring.overruns);
+
+    // Overrun über die Grenze hinweg
+    ring.head = ring.tail = UINT32_MAX - 1;
+    for (int i = 0; i < 10; i++)
+        produce(&ring);
+    consume(&ring, 2);
+    CHECK(ring.overruns == 4, "%u Overruns über den Überlauf statt 4", ring.overruns);
+}
+
+// Ein Umlauf commit + peek + release, wie ihn Produzent und Konsument
+// pro Block kosten
+static void bench(void) {
+    capture_ring_t ring;
+    CHECK(capture_ring_init(&ring, storage, BLOCK_LEN, 8), "Init");
+    uint32_t sum = 0;
+    uint64_t t0 = check_now_ns();
+    for (uint32_t i = 0; i < BENCH_BLOCKS; i++) {
+        capture_ring_commit(&ring);
+        uint32_t seq;
+        const uint16_t *b = capture_ring_peek(&ring, &seq);
+        sum += (uint32_t)(b - storage);
+        capture_ring_release(&ring, seq);
+    }
+    double ns = (double)(check_now_ns() - t0) / BENCH_BLOCKS;
+    printf("commit + peek + release: %.2f ns pro Block (Prüfsumme %u)\n", ns, sum);
+    CHECK(ring.head == BENCH_BLOCKS && ring.overruns == 0, "Bench: head %u, %u Overruns",
+          ring.head, ring.overruns);
+}
+
+int main(void) {
+    test_init();
+    test_order();
+    test_peek_overrun();
+    test_release_overwritten();
+    test_skip_to_latest();
+    test_wraparound();
+    bench();
+    return check_summary();
+}
@@ -0,0 +1,273 @@
+// test_decimator.c
+// Dezimierer (decimator.c): Gleichanteil, Amplitudengang von Boxcar, CIC
+// und FIR bei mehreren Faktoren gegen die geschlossene Formel, Unabhängigkeit
+// von der Blockaufteilung, ungültige Konfigurationen und Laufzeit pro
+// Eingangssample.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "check.h"
+#include "decimator.h"
+
+#define PI 3.14159265358979323846
+#define OFFSET 2048.0
+#define AMPLITUDE 1000.0
+#define FIT_OUT 512             // ausgewertete Ausgangssamples
+#define FIR_TAPS 32
+
+static const uint32_t ratios[] = { 2, 4, 8, 16, 64 };
+#define NUM_RATIOS (sizeof(ratios) / sizeof(ratios[0]))
+
+// Frequenzen in Vielfachen der Ausgangsrate fs / ratio: Durchlass, Rand,
+// Sperrbereich; keine ganzen Vielfachen (die fallen auf den Gleichanteil)
+static const double rel_freqs[] = { 0.05, 0.21, 0.37, 0.9, 1.3, 2.45 };
+#define NUM_FREQS (sizeof(rel_freqs) / sizeof(rel_freqs[0]))
+
+static int16_t fir_coef[FIR_TAPS];
+
+// Ausgangssamples, bis die FIR-Historie gefüllt und der CIC eingeschwungen ist
+static uint32_t settle_out(uint32_t ratio) {
+    return FIR_TAPS / ratio + 4;
+}
+
+static const char *type_name(decimator_type_t type) {
+    switch (type) {
+    case DECIMATOR_BOXCAR: return "Boxcar";
+    case DECIMATOR_CIC:    return "CIC3";
+    case DECIMATOR_FIR:    return "FIR";
+    }
+    return "?";
+}
+
+static bool setup(decimator_t *d, decimator_type_t type, uint32_t ratio) {
+    decimator_config_t cfg = { .type = type, .ratio = ratio, .order = 3 };
+    if (type == DECIMATOR_FIR) {
+        decimator_fir_design(fir_coef, FIR_TAPS, ratio);
+        cfg.taps = FIR_TAPS;
+        cfg.coef = fir_coef;
+    }
+    return decimator_init(d, &cfg);
+}
+
+// Betrag des Frequenzgangs bei f (relativ zu fs)
+static double expected_gain(const decimator_t *d, double f) {
+    const uint32_t r = d->cfg.ratio;
+    if (d->cfg.type == DECIMATOR_FIR) {
+        double re = 0.0, im = 0.0;
+        for (uint8_t k = 0; k < d->cfg.taps; k++) {
+            re += d->coef[k] / 32768.0 * cos(2.0 * PI * f * k);
+            im -= d->coef[k] / 32768.0 * sin(2.0 * PI * f * k);
+        }
+        return hypot(re, im);
+    }
+    double box = fabs(sin(PI * f * r) / (r * sin(PI * f)));
+    return d->cfg.type == DECIMATOR_CIC ? pow(box, d->cfg.order) : box;
+}
+
+// Sinus (gerundet auf ADC-Schritte) dezimieren und die Amplitude am Ausgang
+// per Ausgleichsrechnung bei der gefalteten Frequenz f * ratio bestimmen
+static double measured_gain(decimator_t *d, double f) {
+    const uint32_t r = d->cfg.ratio;
+    const uint32_t settle = settle_out(r);
+    const uint32_t n_out = settle + FIT_OUT;
+    uint16_t *in = malloc((size_t)n_out * r * sizeof(uint16_t));
+    uint16_t *out = malloc((n_out + 1) * sizeof(uint16_t));
+
+    for (uint32_t i = 0; i < n_out * r; i++)
+        in[i] = (uint16_t)lround(OFFSET + AMPLITUDE * sin(2.0 * PI * f * i + 0.3));
+    decimator_reset(d);
+    uint32_t m = decimator_process(d, in, n_out * r, out);
+    CHECK(m == n_out, "%s/%u: %u Ausgangssamples", type_name(d->cfg.type), r, m);
+
+    // y = c + a cos(w j) + b sin(w j), Normalgleichungen für 3 Parameter
+    double w = 2.0 * PI * f * r;
+    double s[3][4] = { { 0 } };
+    for (uint32_t j = settle; j < m; j++) {
+        double base[3] = { 1.0, cos(w * j), sin(w * j) };
+        double y = out[j] / (double)(1 << DECIMATOR_OUT_SHIFT);
+        for (int p = 0; p < 3; p++) {
+            for (int q = 0; q < 3; q++)
+                s[p][q] += base[p] * base[q];
+            s[p][3] += base[p] * y;
+        }
+    }
+    for (int p = 0; p < 3; p++) {
+        for (int q = p + 1; q < 3; q++) {
+            double k = s[q][p] / s[p][p];
+            for (int c = p; c < 4; c++)
+                s[q][c] -= k * s[p][c];
+        }
+    }
+    double x[3];
+    for (int p = 2; p >= 0; p--) {
+        double v = s[p][3];
+        for (int q = p + 1; q < 3; q++)
+            v -= s[p][q] * x[q];
+        x[p] = v / s[p][p];
+    }
+    CHECK_NEAR(x[0], OFFSET, 0.5);
+
+    free(in);
+    free(out);
+    return hypot(x[1], x[2]) / AMPLITUDE;
+}
+
+static void test_dc(void) {
+    static const decimator_type_t types[] = { DECIMATOR_BOXCAR, DECIMATOR_CIC, DECIMATOR_FIR };
+    static const uint16_t levels[] = { 0, 1, 2047, 4095 };
+    uint16_t in[64 * 40], out[41];
+    decimator_t d;
+
+    for (size_t t = 0; t < 3; t++) {
+        for (size_t r = 0; r < NUM_RATIOS; r++) {
+            CHECK(setup(&d, types[t], ratios[r]), "%s/%u", type_name(types[t]), ratios[r]);
+            for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+                for (uint32_t i = 0; i < 40 * ratios[r]; i++)
+                    in[i] = levels[l];
+                decimator_reset(&d);
+                uint32_t m = decimator_process(&d, in, 40 * ratios[r], out);
+                uint32_t bad = 0;
+                for (uint32_t j = settle_out(ratios[r]); j < m; j++)
+                    bad += abs((int)out[j] - (int)levels[l] * (1 << DECIMATOR_OUT_SHIFT)) > 1;
+                CHECK(m == 40 && bad == 0, "%s/%u: Gleichanteil %u, %u Abweichungen",
+                      type_name(types[t]), ratios[r], levels[l], bad);
+            }
+        }
+    }
+}
+
+static void test_response(void) {
+    static const decimator_type_t types[] = { DECIMATOR_BOXCAR, DECIMATOR_CIC, DECIMATOR_FIR };
+    decimator_t d;
+
+    for (size_t t = 0; t < 3; t++) {
+        for (size_t r = 0; r < NUM_RATIOS; r++) {
+            if (!setup(&d, types[t], ratios[r])) {
+                CHECK(false, "%s/%u ungültig", type_name(types[t]), ratios[r]);
+                continue;
+            }
+            // FIR mit 32 Koeffizienten ist ab Faktor 32 kürzer als eine
+            // Ausgangsperiode und sperrt kaum noch; die Formel gilt trotzdem
+            printf("%-6s /%-3u", type_name(types[t]), ratios[r]);
+            for (size_t k = 0; k < NUM_FREQS; k++) {
+                double f = rel_freqs[k] / ratios[r];
+                double want = expected_gain(&d, f);
+                double got = measured_gain(&d, f);
+                // Rundung des Eingangs auf ganze Schritte: etwa 0,3 Schritte Rauschen
+                double tol = 0.01 * want + 1.0 / AMPLITUDE;
+                CHECK(fabs(got - want) <= tol, "%s/%u bei %.2f fs/R: %.4f statt %.4f",
+                      type_name(types[t]), ratios[r], rel_freqs[k], got, want);
+                printf("  %.2f: %6.1f dB", rel_freqs[k], 20.0 * log10(got > 1e-6 ? got : 1e-6));
+            }
+            printf("\n");
+        }
+    }
+
+    // Nullstellen von Boxcar und CIC bei Vielfachen von fs / ratio: der
+    // Sinus verschwindet ganz, es bleibt der Gleichanteil
+    for (size_t t = 0; t < 2; t++) {
+        uint16_t in[8 * 40], out[41];
+        CHECK(setup(&d, types[t], 8), "%s/8", type_name(types[t]));
+        for (uint32_t harmonic = 1; harmonic <= 3; harmonic++) {
+            for (uint32_t i = 0; i < 8 * 40; i++)
+                in[i] = (uint16_t)lround(OFFSET + AMPLITUDE * sin(2.0 * PI * harmonic * i / 8 + 0.3));
+            decimator_reset(&d);
+            uint32_t m = decimator_process(&d, in, 8 * 40, out);
+            uint16_t lo = UINT16_MAX, hi = 0;
+            for (uint32_t j = settle_out(8); j < m; j++) {
+                lo = out[j] < lo ? out[j] : lo;
+                hi = out[j] > hi ? out[j] : hi;
+            }
+            CHECK(hi - lo <= 1 && fabs(lo / (double)(1 << DECIMATOR_OUT_SHIFT) - OFFSET) <= 1.0, "%s/8: %u. Nullstelle %u..%u",
+                  type_name(types[t]), harmonic, lo, hi);
+        }
+    }
+}
+
+// Gleiche Ausgabe bei beliebiger Aufteilung in Blöcke
+static void test_chunks(void) {
+    static const decimator_type_t types[] = { DECIMATOR_BOXCAR, DECIMATOR_CIC, DECIMATOR_FIR };
+    enum { N = 4000 };
+    static uint16_t in[N], whole[N], parts[N];
+    decimator_t d;
+
+    srand(7);
+    for (uint32_t i = 0; i < N; i++)
+        in[i] = (uint16_t)(rand() % 4096);
+
+    for (size_t t = 0; t < 3; t++) {
+        CHECK(setup(&d, types[t], 16), "%s/16", type_name(types[t]));
+        uint32_t m = decimator_process(&d, in, N, whole);
+
+        decimator_reset(&d);
+        uint32_t pos = 0, k = 0;
+        while (pos < N) {
+            uint32_t n = 1 + (uint32_t)(rand() % 300);
+            if (n > N - pos)
+                n = N - pos;
+            k += decimator_process(&d, in + pos, n, parts + k);
+            pos += n;
+        }
+        CHECK(k == m && memcmp(whole, parts, m * sizeof(uint16_t)) == 0,
+              "%s: Blockaufteilung ändert die Ausgabe", type_name(types[t]));
+    }
+}
+
+static void test_invalid(void) {
+    decimator_t d;
+    decimator_config_t cfg = { .type = DECIMATOR_BOXCAR, .ratio = 0 };
+    CHECK(!decimator_init(&d, &cfg), "Faktor 0");
+    cfg.ratio = DECIMATOR_MAX_RATIO + 1;
+    CHECK(!decimator_init(&d, &cfg), "Faktor über dem Maximum");
+
+    // CIC: 12 + N * ceil(log2(R)) <= 32
+    cfg = (decimator_config_t){ .type = DECIMATOR_CIC, .ratio = 64, .order = 3 };
+    CHECK(decimator_init(&d, &cfg), "CIC3/64 (30 Bit)");
+    cfg.ratio = 65;
+    CHECK(!decimator_init(&d, &cfg), "CIC3/65 (33 Bit)");
+    cfg = (decimator_config_t){ .type = DECIMATOR_CIC, .ratio = 2, .order = DECIMATOR_MAX_ORDER + 1 };
+    CHECK(!decimator_init(&d, &cfg), "CIC-Ordnung");
+
+    cfg = (decimator_config_t){ .type = DECIMATOR_FIR, .ratio = 4, .taps = DECIMATOR_MAX_TAPS + 1,
+                                .coef = fir_coef };
+    CHECK(!decimator_init(&d, &cfg), "zu viele Koeffizienten");
+    cfg.taps = 8;
+    cfg.coef = NULL;
+    CHECK(!decimator_init(&d, &cfg), "FIR ohne Koeffizienten");
+}
+
+// Laufzeit pro Eingangssample auf dem Host (nur zur Einordnung, der RP2040
+// ist um ein Vielfaches langsamer; FIR rechnet nur jedes `ratio`-te Sample)
+static void bench(void) {
+    static const decimator_type_t types[] = { DECIMATOR_BOXCAR, DECIMATOR_CIC, DECIMATOR_FIR };
+    enum { N = 1 << 16, ROUNDS = 32 };
+    static uint16_t in[N], out[N];
+    decimator_t d;
+
+    for (uint32_t i = 0; i < N; i++)
+        in[i] = (uint16_t)(i * 37 % 4096);
+
+    for (size_t t = 0; t < 3; t++) {
+        static const uint32_t bench_ratios[] = { 4, 16, 64 };
+        for (size_t r = 0; r < 3; r++) {
+            setup(&d, types[t], bench_ratios[r]);
+            uint32_t sink = 0;
+            uint64_t t0 = check_now_ns();
+            for (int k = 0; k < ROUNDS; k++)
+                sink += decimator_process(&d, in, N, out);
+            uint64_t t1 = check_now_ns();
+            printf("%-6s /%-3u %6.2f ns/Sample (%u)\n", type_name(types[t]), bench_ratios[r],
+                   (double)(t1 - t0) / ((double)N * ROUNDS), sink);
+        }
+    }
+}
+
+int main(void) {
+    test_dc();
+    test_response();
+    test_chunks();
+    test_invalid();
+    bench();
+    return check_summary();
+}
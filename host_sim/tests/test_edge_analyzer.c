@@ -0,0 +1,197 @@
+// test_edge_analyzer.c
+// Flankenanalyse (edge_analyzer.c) auf Aufzeichnungen aus oszi_visualizer/.
+//
+// Jede CSV-Datei (Spalten: RX-Zeit, Zeit in us, mV) wird in ADC-Schritte
+// umgerechnet und in verschieden großen Stücken eingespeist; das Ergebnis
+// muss unabhängig von der Stückelung sein und mit einer einfachen
+// Referenz (zweiter Durchlauf in double) übereinstimmen: gleiche Pulse,
+// Flanken auf 2/65536 Sample genau, gleiche Phasensummen. Dazu ein
+// synthetischer Puls mit bekannter Lage und die Laufzeit pro Sample.
+//
+//     test_edge_analyzer <datei.csv>...
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "check.h"
+#include "edge_analyzer.h"
+
+#define MAX_PULSES 256
+#define HYSTERESIS 25           // 20 mV
+#define MV_PER_COUNT 0.806
+
+static uint16_t *load_csv(const char *path, uint32_t *n) {
+    FILE *f = fopen(path, "r");
+    CHECK(f != NULL, "%s nicht lesbar", path);
+    if (f == NULL)
+        return NULL;
+    uint32_t cap = 4096;
+    uint16_t *s = malloc(cap * sizeof(uint16_t));
+    char line[256];
+    *n = 0;
+    while (fgets(line, sizeof(line), f)) {
+        // Kopfzeile und Statusmeldungen überspringen
+        double t_us, mv;
+        if (sscanf(line, "%*[^,],%lf,%lf", &t_us, &mv) != 2)
+            continue;
+        if (*n == cap) {
+            cap *= 2;
+            s = realloc(s, cap * sizeof(uint16_t));
+        }
+        double counts = mv / MV_PER_COUNT + 0.5;
+        s[(*n)++] = (uint16_t)(counts < 0 ? 0 : counts > 4095 ? 4095 : counts);
+    }
+    fclose(f);
+    return s;
+}
+
+// -------------------------
+//  REFERENZ
+// -------------------------
+typedef struct {
+    double rise, fall;      // fall < 0: Puls offen
+    uint32_t on_count, off_count;
+    uint64_t on_sum, off_sum;
+} ref_pulse_t;
+
+static uint32_t reference(const uint16_t *s, uint32_t n, uint16_t level, ref_pulse_t *out,
+                          uint64_t *base_sum) {
+    uint32_t count = 0;
+    bool high = s[0] >= level;
+    double cross = 0.0;
+    int phase = 0;          // 0 Grundlinie, 1 high, 2 low nach Puls
+    *base_sum = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (i > 0) {
+            if ((s[i - 1] < level) != (s[i] < level))
+                cross = (i - 1) + (double)(level - s[i - 1]) / (double)(s[i] - s[i - 1]);
+            if (!high && s[i] >= level + HYSTERESIS) {
+                high = true;
+                if (count == MAX_PULSES)
+                    break;
+                out[count++] = (ref_pulse_t){ .rise = cross, .fall = -1.0 };
+                phase = 1;
+            } else if (high && s[i] <= level - HYSTERESIS) {
+                high = false;
+                if (phase == 1) {
+                    out[count - 1].fall = cross;
+                    phase = 2;
+                }
+            }
+        }
+        if (phase == 0) {
+            *base_sum += s[i];
+        } else if (phase == 1) {
+            out[count - 1].on_count++;
+            out[count - 1].on_sum += s[i];
+        } else {
+            out[count - 1].off_count++;
+            out[count - 1].off_sum += s[i];
+        }
+    }
+    return count;
+}
+
+static void analyze(const uint16_t *s, uint32_t n, uint16_t level, uint32_t chunk,
+                    edge_analyzer_t *ea, edge_pulse_t *pulses) {
+    edge_analyzer_config_t cfg = { level, HYSTERESIS };
+    edge_analyzer_init(ea, &cfg, pulses, MAX_PULSES);
+    for (uint32_t i = 0; i < n; i += chunk)
+        edge_analyzer_feed(ea, s + i, n - i < chunk ? n - i : chunk);
+}
+
+static void test_file(const char *path) {
+    uint32_t n = 0;
+    uint16_t *s = load_csv(path, &n);
+    if (s == NULL)
+        return;
+    CHECK(n > 1000, "%s: nur %u Samples", path, n);
+    if (n <= 1000) {
+        free(s);
+        return;
+    }
+    uint16_t lo = UINT16_MAX, hi = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        lo = s[i] < lo ? s[i] : lo;
+        hi = s[i] > hi ? s[i] : hi;
+    }
+    uint16_t level = (uint16_t)((lo + hi) / 2);
+
+    static ref_pulse_t ref[MAX_PULSES];
+    uint64_t base_sum;
+    uint32_t ref_count = reference(s, n, level, ref, &base_sum);
+
+    static edge_pulse_t pulses[MAX_PULSES], first[MAX_PULSES];
+    edge_analyzer_t ea;
+    static const uint32_t chunks[] = { UINT32_MAX, 1, 3, 250, 500 };
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        analyze(s, n, level, chunks[c] > n ? n : chunks[c], &ea, pulses);
+        if (c == 0) {
+            memcpy(first, pulses, sizeof(first));
+            CHECK(ea.count == ref_count, "%s: %u Pulse statt %u", path, ea.count, ref_count);
+            CHECK(ea.baseline.sum == base_sum, "%s: Grundlinie", path);
+            int bad = 0;
+            for (uint32_t k = 0; k < ea.count && k < ref_count; k++) {
+                double rise = ea.pulses[k].rise_q16 / 65536.0;
+                double fall = ea.pulses[k].fall_q16 < 0 ? -1.0 : ea.pulses[k].fall_q16 / 65536.0;
+                if (fabs(rise - ref[k].rise) > 2.0 / 65536 || fabs(fall - ref[k].fall) > 2.0 / 65536
+                    || ea.pulses[k].on.count != ref[k].on_count || ea.pulses[k].on.sum != ref[k].on_sum
+                    || ea.pulses[k].off.count != ref[k].off_count || ea.pulses[k].off.sum != ref[k].off_sum)
+                    bad++;
+            }
+            CHECK(bad == 0, "%s: %d Pulse weichen von der Referenz ab", path, bad);
+            printf("%s: %u Samples, Schwelle %u, %u Pulse, %u vollständig\n", path, n, level,
+                   ea.count, edge_analyzer_complete(&ea));
+        } else {
+            CHECK(memcmp(first, pulses, ea.count * sizeof(edge_pulse_t)) == 0,
+                  "%s: Stücke zu %u Samples ergeben andere Pulse", path, chunks[c]);
+        }
+    }
+
+    // Laufzeit pro Sample (Host)
+    enum { PASSES = 200 };
+    edge_analyzer_config_t cfg = { level, HYSTERESIS };
+    edge_analyzer_init(&ea, &cfg, pulses, MAX_PULSES);
+    uint64_t t0 = check_now_ns();
+    for (int p = 0; p < PASSES; p++) {
+        edge_analyzer_reset(&ea);
+        edge_analyzer_feed(&ea, s, n);
+    }
+    uint64_t t1 = check_now_ns();
+    printf("Laufzeit (Host): %.2f ns pro Sample\n", (double)(t1 - t0) / ((double)PASSES * n));
+    free(s);
+}
+
+// Synthetischer Puls: Rampen mit bekannter Schwellenlage
+static void test_synthetic(void) {
+    static uint16_t s[1000];
+    for (int i = 0; i < 1000; i++)
+        s[i] = i < 100 ? 100 : i < 110 ? (uint16_t)(100 + (i - 100) * 100) : i < 600 ? 1100 : 100;
+    edge_pulse_t pulses[4];
+    edge_analyzer_t ea;
+    edge_analyzer_config_t cfg = { 600, 50 };
+    edge_analyzer_init(&ea, &cfg, pulses, 4);
+    edge_analyzer_feed(&ea, s, 1000);
+    // 600 wird bei Index 105 erreicht, fallend zwischen 599 und 600 (1100 -> 100)
+    CHECK(ea.count == 1 && edge_analyzer_complete(&ea) == 1, "synthetisch: %u Pulse", ea.count);
+    CHECK(pulses[0].rise_q16 == 105 << 16, "steigend bei %.5f", pulses[0].rise_q16 / 65536.0);
+    CHECK_NEAR(pulses[0].fall_q16 / 65536.0, 599.5, 1.0 / 65536);
+    CHECK(pulses[0].on.min == 700 && pulses[0].on.max == 1100, "High-Phase %u..%u",
+          pulses[0].on.min, pulses[0].on.max);
+    CHECK(ea.baseline.count == 106 && pulses[0].off.count == 400, "Phasen %u/%u",
+          ea.baseline.count, pulses[0].off.count);
+
+    // Pulsliste voll: weitere Pulse zählen als verworfen
+    edge_analyzer_init(&ea, &cfg, pulses, 1);
+    edge_analyzer_feed(&ea, s, 1000);
+    edge_analyzer_feed(&ea, s, 1000);
+    CHECK(ea.count == 1 && ea.dropped == 1, "voll: %u Pulse, %u verworfen", ea.count, ea.dropped);
+}
+
+int main(int argc, char **argv) {
+    test_synthetic();
+    CHECK(argc > 1, "keine CSV-Datei angegeben");
+    for (int i = 1; i < argc; i++)
+        test_file(argv[i]);
+    return check_summary();
+}
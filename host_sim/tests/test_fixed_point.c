@@ -0,0 +1,174 @@
+// test_fixed_point.c
+// Q16-Pfad (fixed_point.h) gegen den früheren float-Pfad von laser_control.
+//
+// Geprüft wird dieselbe Rechnung einmal in float und einmal in Q16:
+//   Mittelwert in mV    |q16 - float| <= 0,002 mV (Quantisierung von 0,806
+//                       in Q16: 3e-7 relativ, also 1e-3 mV bei 3,3 V)
+//   Tabellenindex       gleich, außer Tastgrad liegt < 1e-4 an x.5 %
+//   PWM-Level           gleich oder 1 daneben (float rundet wrap * pwm)
+//   Regelentscheidung   gleich, außer der Messwert liegt < 1 mV an der
+//                       Schwelle (die Tabelle speichert ganze mV);
+//                       Tastgrad weniger als 0,001 auseinander
+//
+// Einschränkungen:
+// - Die Regelschleife ist hier nachgebaut (float und Q16 nebeneinander),
+//   nicht die Funktionen aus laser_control.c aufgerufen; sie prüft die
+//   Rechenregeln aus fixed_point.h, nicht laser_control selbst.
+// - Die Laufzeiten gelten nur für den Host mit FPU. Auf dem M0+ wurden
+//   keine Takte gemessen; dass float dort teurer ist als Q16, ist
+//   erwartet (Soft-Float), aber von diesem Test nicht belegt.
+
+#include <stdlib.h>
+
+#include "check.h"
+#include "fixed_point.h"
+
+#define VperDev 0.806f
+#define NUM_SAMPLES 500
+#define WRAP 62499
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+// -------------------------
+//  MITTELWERT
+// -------------------------
+static void test_average(void) {
+    static const uint32_t counts[] = { 1, 7, 500, 1500, 4096, 65535 };
+    double worst = 0.0;
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        uint32_t n = counts[c];
+        for (int i = 0; i < 20000; i++) {
+            uint32_t sum = i < 2 ? (i == 0 ? 0 : 4095u * n) : (uint32_t)((uint64_t)rng() * 4096u * n >> 24);
+            float avg_f = (float)sum / n * VperDev;
+            double avg_q = adc_sum_to_mv_q16(sum, n) / 65536.0;
+            double err = fabs(avg_q - avg_f);
+            if (err > worst)
+                worst = err;
+        }
+    }
+    printf("Mittelwert: größte Abweichung %.5f mV\n", worst);
+    CHECK(worst <= 0.002, "Abweichung %.5f mV", worst);
+}
+
+// -------------------------
+//  TABELLENINDEX UND PWM-LEVEL
+// -------------------------
+static void test_index_and_level(void) {
+    int idx_diff = 0, level_diff = 0, level_off_by_one = 0;
+    for (q16_t pwm = 0; pwm <= Q16_ONE; pwm++) {
+        float pwm_f = (float)pwm / 65536.0f;
+
+        int idx_f = (int)(pwm_f * 100.0f + 0.5f);
+        int idx_q = q16_mul_int_round(pwm, 100);
+        double dist = fabs(pwm / 65536.0 * 100.0 - (floor(pwm / 65536.0 * 100.0) + 0.5));
+        if (idx_f != idx_q && dist >= 1e-4)
+            idx_diff++;
+
+        int level_f = (uint16_t)(WRAP * pwm_f);
+        int level_q = (uint16_t)q16_mul_int(pwm, WRAP);
+        if (abs(level_f - level_q) > 1)
+            level_diff++;
+        else if (level_f != level_q)
+            level_off_by_one++;
+    }
+    printf("Index: %d Abweichungen, Level: %d um 1 daneben von %d\n",
+           idx_diff, level_off_by_one, Q16_ONE + 1);
+    CHECK(idx_diff == 0, "%d Indizes abweichend", idx_diff);
+    CHECK(level_diff == 0, "%d Level um mehr als 1 daneben", level_diff);
+}
+
+// -------------------------
+//  REGELSCHLEIFE
+// -------------------------
+// Bang-Bang-Regelung von laser_control (vor dem PID) nachgebaut an einer
+// Strecke erster Ordnung, einmal float und einmal Q16 mit derselben Messung.
+// Die Streckenverstärkung wechselt, damit der Tastgrad wandert.
+static float plant_mv(float duty, int step) {
+    float gain = (step / 2500) % 2 ? 700.0f : 1100.0f;
+    return 50.0f + gain * duty;
+}
+
+static void test_regulation(void) {
+    float table_f[101];
+    uint16_t table_q[101];
+    for (int i = 0; i <= 100; i++) {
+        table_f[i] = plant_mv(i / 100.0f, 0) * (1.0f - 0.002f * i);
+        table_q[i] = (uint16_t)(table_f[i] + 0.5f);
+    }
+
+    float pwm_f = 0.05f, y = 0.0f, worst_pwm = 0.0f;
+    q16_t pwm_q = Q16_CONST(0.05);
+    int decisions = 0, differ = 0, near = 0;
+    for (int step = 0; step < 20000; step++) {
+        // Beide Pfade sehen dieselbe ADC-Summe
+        y += (plant_mv(pwm_f, step) - y) * 0.2f;
+        uint32_t sum = (uint32_t)(y / VperDev * NUM_SAMPLES) + rng() % NUM_SAMPLES;
+
+        float avg_f = (float)sum / NUM_SAMPLES * VperDev;
+        int idx_f = (int)(pwm_f * 100.0f + 0.5f);
+        int dec_f = avg_f < table_f[idx_f] - 25.0f ? 1 : -1;
+
+        q16_t avg_q = adc_sum_to_mv_q16(sum, NUM_SAMPLES);
+        int idx_q = q16_mul_int_round(pwm_q, 100);
+        int dec_q = avg_q < q16_from_int(table_q[idx_q]) - q16_from_int(25) ? 1 : -1;
+
+        pwm_f += dec_f * 0.01f;
+        pwm_f = pwm_f < 0.01f ? 0.01f : pwm_f > 0.50f ? 0.50f : pwm_f;
+        pwm_q += dec_q * Q16_CONST(0.01);
+        pwm_q = pwm_q < Q16_CONST(0.01) ? Q16_CONST(0.01) : pwm_q > Q16_CONST(0.50) ? Q16_CONST(0.50) : pwm_q;
+
+        decisions++;
+        if (dec_f != dec_q) {
+            if (fabsf(avg_f - (table_f[idx_f] - 25.0f)) < 1.0f)
+                near++;
+            else
+                differ++;
+            // Nach einer Abweichung an der Schwelle mit dem float-Pfad weiter
+            pwm_q = (q16_t)(pwm_f * 65536.0f + 0.5f);
+        }
+        float d = fabsf(pwm_q / 65536.0f - pwm_f);
+        if (d > worst_pwm)
+            worst_pwm = d;
+    }
+    printf("Regelung: %d Entscheidungen, %d an der Schwelle verschieden, %d sonst, "
+           "Tastgrad bis %.5f auseinander\n", decisions, near, differ, worst_pwm);
+    CHECK(differ == 0, "%d Entscheidungen abweichend", differ);
+    CHECK(worst_pwm < 0.001f, "Tastgrad %.5f auseinander", worst_pwm);
+}
+
+// -------------------------
+//  LAUFZEIT
+// -------------------------
+static volatile uint32_t sink;
+
+static void bench(void) {
+    enum { N = 2000000 };
+    uint64_t t0 = check_now_ns();
+    for (uint32_t i = 0; i < N; i++) {
+        float avg = (float)(i * 7u) / NUM_SAMPLES * VperDev;
+        float pwm = (float)(i & 0xffff) / 65536.0f;
+        sink = (uint16_t)(WRAP * pwm) + (uint32_t)(avg * 100.0f + 0.5f);
+    }
+    uint64_t t1 = check_now_ns();
+    for (uint32_t i = 0; i < N; i++) {
+        q16_t avg = adc_sum_to_mv_q16(i * 7u, NUM_SAMPLES);
+        q16_t pwm = (q16_t)(i & 0xffff);
+        sink = (uint16_t)q16_mul_int(pwm, WRAP) + (uint32_t)q16_mul_int_round(avg, 100);
+    }
+    uint64_t t2 = check_now_ns();
+    printf("Laufzeit (Host, nicht M0+): float %.2f ns, Q16 %.2f ns pro Regelschritt\n",
+           (double)(t1 - t0) / N, (double)(t2 - t1) / N);
+}
+
+int main(void) {
+    test_average();
+    test_index_and_level();
+    test_regulation();
+    bench();
+    return check_summary();
+}
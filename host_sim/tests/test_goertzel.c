@@ -0,0 +1,178 @@
+// test_goertzel.c
+// Goertzel-Filter (goertzel.c) mit synthetischen Sinussignalen: Betrag und
+// Phase gegen die Vorgabe über Blocklängen und Linien, Gleichanteil bei
+// tiefen Linien, Nachbarlinien, Round-Robin-Blöcke (stride) und ungültige
+// Grenzen.
+
+#include <stdlib.h>
+
+#include "check.h"
+#include "goertzel.h"
+
+#define PI 3.14159265358979323846
+
+// Abweichung des Festkomma-Filters von der DFT derselben Samples: der auf
+// Q30 gerundete Koeffizient legt die Linie minimal neben k
+#define DFT_AMP_REL 1e-4
+#define DFT_PHASE_RAD 3e-4
+
+static uint16_t block[2 * GOERTZEL_MAX_N];
+
+// x[n] = dc + a cos(2 pi k n / N + phi), auf ADC-Schritte gerundet, jedes
+// `stride`-te Sample
+static void make_sine(uint32_t n, double k, double dc, double a, double phi, uint32_t stride) {
+    for (uint32_t i = 0; i < n; i++)
+        block[i * stride] = (uint16_t)lround(dc + a * cos(2.0 * PI * k * i / n + phi));
+}
+
+// Linie k der DFT in double über dieselben (gerundeten) Samples als
+// Referenz: Betrag als Spitzenwert, Phase bezogen auf Sample 0
+static goertzel_result_t dft_line(uint32_t n, uint32_t k, uint32_t stride) {
+    double re = 0.0, im = 0.0;
+    for (uint32_t i = 0; i < n; i++) {
+        double w = 2.0 * PI * (double)((uint64_t)k * i % n) / n;
+        re += block[i * stride] * cos(w);
+        im -= block[i * stride] * sin(w);
+    }
+    goertzel_result_t r = { (float)(2.0 * hypot(re, im) / n), (float)atan2(im, re) };
+    return r;
+}
+
+// Differenz zweier Winkel auf (-pi, pi]
+static double angle_diff(double a, double b) {
+    double d = fmod(a - b, 2.0 * PI);
+    if (d > PI)
+        d -= 2.0 * PI;
+    if (d <= -PI)
+        d += 2.0 * PI;
+    return d;
+}
+
+static void test_lines(void) {
+    static const uint32_t lengths[] = { 16, 250, 500, 1000, GOERTZEL_MAX_N };
+    static const double amplitudes[] = { 5.0, 300.0, 2000.0 };
+    goertzel_t g;
+
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        uint32_t n = lengths[l];
+        // Tiefste Linie (nach GOERTZEL_MAX_PERIOD), Mitte, knapp unter Nyquist
+        uint32_t k_low = (n + GOERTZEL_MAX_PERIOD - 1) / GOERTZEL_MAX_PERIOD;
+        uint32_t lines[] = { k_low, n / 8 + 1, n / 2 - 1 };
+        for (size_t j = 0; j < 3; j++) {
+            uint32_t k = lines[j];
+            CHECK(goertzel_init(&g, k, n), "Init k=%u N=%u", k, n);
+            for (size_t a = 0; a < sizeof(amplitudes) / sizeof(amplitudes[0]); a++) {
+                double amp = amplitudes[a];
+                double phi = 0.7 - 0.9 * (double)a;
+                make_sine(n, k, 2048.0, amp, phi, 1);
+                goertzel_reset(&g);
+                goertzel_feed(&g, block, n, 1);
+                goertzel_result_t r = goertzel_result(&g);
+
+                // Festkomma gegen die DFT derselben Samples
+                goertzel_result_t ref = dft_line(n, k, 1);
+                CHECK(fabs(r.amplitude - ref.amplitude) <= DFT_AMP_REL * amp + 2e-3,
+                      "N=%u k=%u: Betrag %.5f statt %.5f (DFT)", n, k, r.amplitude, ref.amplitude);
+                CHECK(fabs(angle_diff(r.phase, ref.phase)) <= DFT_PHASE_RAD + 2e-3 / amp,
+                      "N=%u k=%u A=%.0f: Phase %.6f statt %.6f (DFT)", n, k, amp, r.phase, ref.phase);
+
+                // Gegen die Vorgabe: die Rundung auf ganze Schritte macht
+                // bei kleinen Amplituden und kurzen Blöcken etwa 1 % aus
+                CHECK(fabs(r.amplitude - amp) <= 2e-3 * amp + 0.06,
+                      "N=%u k=%u: Betrag %.4f statt %.1f", n, k, r.amplitude, amp);
+                CHECK(fabs(angle_diff(r.phase, phi)) <= 0.2 / amp + 1e-3,
+                      "N=%u k=%u A=%.0f: Phase %.5f statt %.5f", n, k, amp, r.phase, phi);
+                CHECK(g.count == n, "N=%u: %u Samples gezählt", n, g.count);
+            }
+        }
+    }
+}
+
+// Großer Gleichanteil neben der tiefsten Linie: mit der ADC-Mitte als
+// Offset sickert er ein, mit dem Blockmittel nicht
+static void test_offset(void) {
+    const uint32_t n = 4096, k = 2;
+    goertzel_t g;
+    CHECK(goertzel_init(&g, k, n), "Init");
+
+    make_sine(n, k, 3900.0, 20.0, 0.3, 1);
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < n; i++)
+        sum += block[i];
+
+    goertzel_feed(&g, block, n, 1);
+    double err_mid = fabs(goertzel_result(&g).amplitude - 20.0);
+
+    goertzel_set_offset(&g, sum, n);
+    goertzel_reset(&g);
+    goertzel_feed(&g, block, n, 1);
+    goertzel_result_t r = goertzel_result(&g);
+    printf("Gleichanteil 3900 bei k=2/4096: Fehler %.4f (ADC-Mitte) / %.4f (Blockmittel)\n",
+           err_mid, fabs(r.amplitude - 20.0));
+    goertzel_result_t ref = dft_line(n, k, 1);
+    CHECK_NEAR(r.amplitude, ref.amplitude, DFT_AMP_REL * 20.0 + 2e-3);
+    CHECK(fabs(angle_diff(r.phase, ref.phase)) < DFT_PHASE_RAD, "Phase %.5f statt %.5f", r.phase, ref.phase);
+    CHECK(err_mid > 10.0 * fabs(r.amplitude - ref.amplitude), "Blockmittel bringt nichts");
+}
+
+// Ein Sinus auf Linie k2 erscheint auf Linie k nicht; in Teilen
+// eingespeist ergibt sich dasselbe wie am Stück
+static void test_neighbours_and_chunks(void) {
+    const uint32_t n = 500;
+    goertzel_t g;
+    CHECK(goertzel_init(&g, 10, n), "Init");
+
+    make_sine(n, 11, 2048.0, 1500.0, 0.0, 1);
+    goertzel_feed(&g, block, n, 1);
+    CHECK(goertzel_result(&g).amplitude < 0.05, "Linie 11 auf Linie 10: %.4f",
+          goertzel_result(&g).amplitude);
+
+    make_sine(n, 10, 2048.0, 1500.0, -2.0, 1);
+    goertzel_reset(&g);
+    goertzel_feed(&g, block, n, 1);
+    goertzel_result_t whole = goertzel_result(&g);
+    goertzel_reset(&g);
+    for (uint32_t i = 0; i < n; i += 37)
+        goertzel_feed(&g, block + i, n - i < 37 ? n - i : 37, 1);
+    goertzel_result_t parts = goertzel_result(&g);
+    CHECK(whole.amplitude == parts.amplitude && whole.phase == parts.phase,
+          "Teilblöcke: %.6f/%.6f statt %.6f/%.6f", parts.amplitude, parts.phase,
+          whole.amplitude, whole.phase);
+}
+
+// Round-Robin: Signal auf geraden, Störer auf ungeraden Indizes
+static void test_stride(void) {
+    const uint32_t n = 1000, k = 25;
+    goertzel_t g;
+    CHECK(goertzel_init(&g, k, n), "Init");
+
+    make_sine(n, k, 2048.0, 800.0, 1.2, 2);
+    for (uint32_t i = 0; i < n; i++)
+        block[2 * i + 1] = (uint16_t)(i % 2 ? 4095 : 0);
+    goertzel_feed(&g, block, 2 * n, 2);
+    goertzel_result_t r = goertzel_result(&g);
+    CHECK(g.count == n, "%u Samples gezählt", g.count);
+    goertzel_result_t ref = dft_line(n, k, 2);
+    CHECK_NEAR(r.amplitude, ref.amplitude, DFT_AMP_REL * 800.0);
+    CHECK(fabs(angle_diff(r.phase, ref.phase)) < DFT_PHASE_RAD, "Phase %.5f statt %.5f", r.phase, ref.phase);
+}
+
+static void test_invalid(void) {
+    goertzel_t g;
+    CHECK(!goertzel_init(&g, 0, 100), "k = 0");
+    CHECK(!goertzel_init(&g, 51, 100), "k > N/2");
+    CHECK(goertzel_init(&g, 50, 100), "k = N/2");
+    CHECK(!goertzel_init(&g, 1, 0), "N = 0");
+    CHECK(!goertzel_init(&g, 4, GOERTZEL_MAX_N + 4), "N zu groß");
+    CHECK(!goertzel_init(&g, 1, GOERTZEL_MAX_PERIOD + 1), "Periode zu lang");
+    CHECK(goertzel_init(&g, 1, GOERTZEL_MAX_PERIOD), "längste Periode");
+}
+
+int main(void) {
+    test_lines();
+    test_offset();
+    test_neighbours_and_chunks();
+    test_stride();
+    test_invalid();
+    return check_summary();
+}
@@ -0,0 +1,258 @@
+// test_lockin.c
+// Lock-in-Demodulation (lockin.c) mit kohärenten synthetischen Signalen:
+// Betrag und Phase eines Sinus, Grundwelle eines Rechtecks, Unterdrückung
+// von Gleichanteil und Umgebungslicht über ganze Perioden (und die
+// Abweichung bei einer halben Periode zu viel), Phase über Blockgrenzen,
+// Round-Robin (stride), Vollaussteuerung ohne Überlauf der Teilsummen und
+// lockin_square_mean() über den ganzen Tastgradbereich bis nahe 0 und 1.
+
+#include "check.h"
+#include "lockin.h"
+
+#define PI 3.14159265358979323846
+#define MAX_SAMPLES 20000
+
+static int16_t lut[2 * LOCKIN_MAX_PERIOD];
+static uint16_t block[2 * MAX_SAMPLES];
+
+static double real(q16_t v) {
+    return v / 65536.0;
+}
+
+// Phase der Grundwelle bezogen auf Sample 0: x = A cos(wt + phi) ergibt
+// I = A N/2 cos(phi), Q = -A N/2 sin(phi)
+static double lockin_phase(const lockin_t *li) {
+    return atan2(-(double)li->q_acc, (double)li->i_acc);
+}
+
+static double angle_diff(double a, double b) {
+    double d = fmod(a - b, 2.0 * PI);
+    if (d > PI)
+        d -= 2.0 * PI;
+    if (d <= -PI)
+        d += 2.0 * PI;
+    return d;
+}
+
+// x[n] = dc + a cos(2 pi n / period + phi) + amb sin(2 pi n * amb_cycles / n_total)
+static void make_sine(uint32_t n, uint32_t period, double dc, double a, double phi,
+                      double amb, double amb_cycles) {
+    for (uint32_t i = 0; i < n; i++) {
+        double v = dc + a * cos(2.0 * PI * i / period + phi)
+                 + amb * sin(2.0 * PI * amb_cycles * i / n);
+        block[i] = (uint16_t)lround(v);
+    }
+}
+
+// Pulse der Höhe `height` über `base`, `high` Samples je Periode ab Sample 0
+static void make_square(uint32_t n, uint32_t period, uint32_t high, uint16_t base, uint16_t height) {
+    for (uint32_t i = 0; i < n; i++)
+        block[i] = (uint16_t)(base + (i % period < high ? height : 0));
+}
+
+// Grundwelle derselben Samples in double (Spitzenwert und Phase)
+static double dft(uint32_t n, uint32_t period, double *phase) {
+    double re = 0.0, im = 0.0;
+    for (uint32_t i = 0; i < n; i++) {
+        double w = 2.0 * PI * (i % period) / period;
+        re += block[i] * cos(w);
+        im += block[i] * sin(w);
+    }
+    if (phase != NULL)
+        *phase = atan2(-im, re);
+    return 2.0 * hypot(re, im) / n;
+}
+
+static double dft_amplitude(uint32_t n, uint32_t period) {
+    return dft(n, period, NULL);
+}
+
+static void test_sine(void) {
+    static const uint16_t periods[] = { 3, 16, 100, 250, 1000 };
+    static const double amplitudes[] = { 10.0, 300.0, 1800.0 };
+    lockin_t li;
+    for (size_t p = 0; p < sizeof(periods) / sizeof(periods[0]); p++) {
+        uint32_t period = periods[p];
+        uint32_t n = period * (MAX_SAMPLES / 2 / period);
+        CHECK(lockin_init(&li, lut, (uint16_t)period), "Init %u", period);
+        for (size_t a = 0; a < sizeof(amplitudes) / sizeof(amplitudes[0]); a++) {
+            double amp = amplitudes[a], phi = 1.1 - 0.8 * (double)a;
+            make_sine(n, period, 2048.0, amp, phi, 0.0, 0.0);
+            lockin_reset(&li);
+            lockin_feed(&li, block, n, 1);
+            double got = real(lockin_amplitude(&li)), ref_phase;
+            double ref = dft(n, period, &ref_phase);
+            CHECK(li.count == n, "%u Samples gezählt statt %u", li.count, n);
+
+            // Gegen die DFT der gerundeten Samples: nur Tabelle und Q16
+            CHECK(fabs(got - ref) <= 1e-4 * amp + 2e-4, "P=%u A=%.0f: %.5f statt %.5f (DFT)",
+                  period, amp, got, ref);
+            CHECK(fabs(angle_diff(lockin_phase(&li), ref_phase)) <= 1e-4,
+                  "P=%u A=%.0f: Phase %.5f statt %.5f (DFT)", period, amp, lockin_phase(&li), ref_phase);
+
+            // Gegen das Signal selbst: das Runden auf ganze ADC-Schritte
+            // (je höchstens 0,5) verschiebt die Grundwelle um höchstens 1
+            CHECK(fabs(got - amp) <= 1.0, "P=%u: Betrag %.4f statt %.1f", period, got, amp);
+            CHECK(fabs(angle_diff(lockin_phase(&li), phi)) <= asin(1.0 / amp) + 1e-4,
+                  "P=%u A=%.0f: Phase %.5f statt %.5f", period, amp, lockin_phase(&li), phi);
+        }
+    }
+}
+
+// Rechteck: Grundwelle 2 H / P * sin(pi h / P) / sin(pi / P), Phase in
+// der Pulsmitte
+static void test_square(void) {
+    const uint32_t period = 100, high = 30, n = 100 * period;
+    lockin_t li;
+    CHECK(lockin_init(&li, lut, period), "Init");
+    make_square(n, period, high, 500, 1000);
+    lockin_feed(&li, block, n, 1);
+    double want = 2.0 * 1000.0 / period * sin(PI * high / period) / sin(PI / period);
+    CHECK_NEAR(real(lockin_amplitude(&li)), want, 1e-3);
+    CHECK(fabs(angle_diff(lockin_phase(&li), -PI * (high - 1) / period)) < 1e-4,
+          "Phase %.5f statt %.5f", lockin_phase(&li), -PI * (high - 1) / period);
+}
+
+// Gleichanteil und Umgebungslicht (nicht harmonisch, ganze Zahl Zyklen im
+// Fenster) fallen über ganze Perioden heraus
+static void test_rejection(void) {
+    const uint32_t period = 100, n = 10 * period;
+    lockin_t li;
+    CHECK(lockin_init(&li, lut, period), "Init");
+
+    make_sine(n, period, 300.0, 200.0, 0.4, 0.0, 0.0);
+    lockin_feed(&li, block, n, 1);
+    int64_t i_ref = li.i_acc, q_ref = li.q_acc;
+    double ref = real(lockin_amplitude(&li));
+
+    make_sine(n, period, 3500.0, 200.0, 0.4, 0.0, 0.0);
+    lockin_reset(&li);
+    lockin_feed(&li, block, n, 1);
+    CHECK(li.i_acc == i_ref && li.q_acc == q_ref, "Gleichanteil 300 -> 3500 verändert I/Q");
+
+    // Umgebungslicht mit 3 Zyklen auf 10 Perioden (0,3 * Referenz), 2,5-fach
+    make_sine(n, period, 2000.0, 200.0, 0.4, 500.0, 3.0);
+    lockin_reset(&li);
+    lockin_feed(&li, block, n, 1);
+    double amb = real(lockin_amplitude(&li));
+    printf("Umgebungslicht 500 bei 0,3 f_ref: Betrag %.4f statt %.4f\n", amb, ref);
+    CHECK(fabs(amb - ref) < 0.05, "Umgebungslicht: %.4f statt %.4f", amb, ref);
+
+    // Eine halbe Periode zu viel: der Gleichanteil sickert ein
+    uint32_t odd = n + period / 2;
+    make_sine(odd, period, 3500.0, 200.0, 0.4, 0.0, 0.0);
+    lockin_reset(&li);
+    li.phase = 0;
+    lockin_feed(&li, block, odd, 1);
+    double leak = real(lockin_amplitude(&li));
+    printf("Gleichanteil 3500 über 10,5 Perioden: Betrag %.2f statt %.2f\n", leak, ref);
+    CHECK(fabs(leak - ref) > 10.0, "halbe Periode: kein Einfluss des Gleichanteils (%.2f)", leak);
+}
+
+// Blöcke beliebiger Länge ergeben dieselben Summen wie am Stück; die
+// Phase läuft auch über lockin_reset() weiter
+static void test_blocks_and_stride(void) {
+    const uint32_t period = 64, n = 20 * period;
+    lockin_t li;
+    CHECK(lockin_init(&li, lut, period), "Init");
+    make_sine(n, period, 2048.0, 700.0, -2.2, 0.0, 0.0);
+    lockin_feed(&li, block, n, 1);
+    int64_t i_ref = li.i_acc, q_ref = li.q_acc;
+
+    lockin_reset(&li);
+    CHECK(li.phase == 0, "Phase nach %u Samples %u", n, li.phase);
+    for (uint32_t k = 0; k < n; k += 37)
+        lockin_feed(&li, block + k, n - k < 37 ? n - k : 37, 1);
+    CHECK(li.i_acc == i_ref && li.q_acc == q_ref && li.count == n, "Teilblöcke: andere Summen");
+
+    // Round-Robin: Signal auf geraden, Störer auf ungeraden Indizes
+    for (uint32_t k = n; k-- > 0;) {
+        block[2 * k] = block[k];
+        block[2 * k + 1] = (uint16_t)(k % 3 ? 4095 : 0);
+    }
+    lockin_reset(&li);
+    lockin_feed(&li, block, 2 * n, 2);
+    CHECK(li.i_acc == i_ref && li.q_acc == q_ref && li.count == n, "stride 2: andere Summen");
+}
+
+// Volle Aussteuerung: 16 Samples 4095 * 32767 pro Teilsumme gerade noch in int32
+static void test_full_scale(void) {
+    const uint32_t period = 4, n = MAX_SAMPLES;
+    lockin_t li;
+    CHECK(lockin_init(&li, lut, period), "Init");
+    make_square(n, period, 2, 0, 4095);
+    lockin_feed(&li, block, n, 1);
+    CHECK_NEAR(real(lockin_amplitude(&li)), dft_amplitude(n, period), 0.01);
+
+    for (uint32_t i = 0; i < n; i++)
+        block[i] = 4095;
+    lockin_reset(&li);
+    lockin_feed(&li, block, n, 1);
+    CHECK(li.i_acc == 0 && li.q_acc == 0, "Gleichanteil 4095: I %lld, Q %lld",
+          (long long)li.i_acc, (long long)li.q_acc);
+}
+
+// Gleichanteil aus der Grundwelle über alle darstellbaren Tastgrade. Bei
+// ungeradem duty * period fällt der Index für sin(pi * duty) zwischen zwei
+// Tabelleneinträge; die Sehne liegt um bis zu (2 pi / P)^2 / 8 relativ zu
+// tief (P = 250 wie in laser_control: 8e-5, P = 50: 0,2 %). Dazu kommt die
+// Grundwelle des abgetasteten Rechtecks, (pi / P) / sin(pi / P), und nahe
+// Tastgrad 1 die Rundung von Tabelle und Q16, etwa 1e-4 / sin(pi * duty).
+static void test_square_mean(void) {
+    static const uint16_t periods[] = { 250, 50 };
+    const uint16_t height = 1000;
+    lockin_t li;
+    for (size_t p = 0; p < sizeof(periods) / sizeof(periods[0]); p++) {
+        uint32_t period = periods[p], n = 20 * period;
+        CHECK(lockin_init(&li, lut, (uint16_t)period), "Init %u", period);
+        double worst = 0.0, worst_duty = 0.0;
+        for (uint32_t high = 1; high < period; high++) {
+            make_square(n, period, high, 100, height);
+            lockin_reset(&li);
+            lockin_feed(&li, block, n, 1);
+            q16_t duty = (q16_t)(((int64_t)high << Q16_SHIFT) / period);
+            double mean = real(lockin_square_mean(&li, lockin_amplitude(&li), duty));
+            double want = (double)height * high / period;
+            double err = fabs(mean - want);
+            double chord = pow(2.0 * PI / period, 2) / 8.0;
+            double sampled = pow(PI / period, 2) / 6.0;
+            double tol = 0.01 + want * (chord + sampled + 1e-4 / sin(PI * high / period));
+            if (err > worst) {
+                worst = err;
+                worst_duty = (double)high / period;
+            }
+            CHECK(err <= tol, "P=%u Tastgrad %.3f: %.3f statt %.3f (max. %.3f)", period, real(duty), mean,
+                  want, tol);
+        }
+        printf("P=%u: Gleichanteil aus Grundwelle bis %.4f daneben (Tastgrad %.3f)\n", period, worst,
+               worst_duty);
+    }
+
+    // Grenzen: Tastgrad 0 liefert den Grenzwert A/2, Tastgrad 1 (und
+    // knapp darunter) keine Aussage
+    CHECK(lockin_init(&li, lut, 250), "Init");
+    CHECK(lockin_square_mean(&li, Q16_CONST(10.0), 0) == Q16_CONST(5.0), "Tastgrad 0");
+    CHECK(lockin_square_mean(&li, Q16_CONST(10.0), Q16_ONE) == 0, "Tastgrad 1");
+    CHECK(lockin_square_mean(&li, Q16_CONST(10.0), Q16_CONST(0.9995)) == 0, "Tastgrad 0,9995");
+    CHECK(lockin_square_mean(&li, 0, Q16_CONST(0.4)) == 0, "ohne Grundwelle");
+}
+
+static void test_invalid(void) {
+    lockin_t li;
+    CHECK(!lockin_init(&li, NULL, 100), "kein Speicher");
+    CHECK(!lockin_init(&li, lut, 2), "Periode 2");
+    CHECK(!lockin_init(&li, lut, LOCKIN_MAX_PERIOD + 1), "Periode zu lang");
+    CHECK(lockin_init(&li, lut, LOCKIN_MAX_PERIOD), "längste Periode");
+    CHECK(lockin_amplitude(&li) == 0, "ohne Samples");
+}
+
+int main(void) {
+    test_sine();
+    test_square();
+    test_rejection();
+    test_blocks_and_stride();
+    test_full_scale();
+    test_square_mean();
+    test_invalid();
+    return check_summary();
+}
@@ -0,0 +1,65 @@
+"""Sprungantwort der Regelung von laser_control (common/pid.c).
+
+Die Kalibrierung stammt aus einem Lauf mit SIM_GAIN_MV=600, geregelt wird
+dann mit 750 mV: die Vorsteuerung liegt gut 20 % daneben, den Rest muss der
+PID ausregeln. Nachkalibrierung ist aus. Für jeden Sollwertsprung gilt:
+
+    Einschwingzeit   bis zum letzten Sample außerhalb +-2 % (mind. 3 mV)
+    Überschwingen    höchstens 5 % des Sollwerts über den Sollwert hinaus,
+                     von der Seite des ersten Messwerts nach dem Sprung aus
+    Restfehler       Mittelwert der letzten 200 ms auf 0,5 mV genau
+    Welligkeit       Spitze-Spitze der letzten 200 ms
+"""
+
+import os
+import statistics
+import tempfile
+
+import simrun
+
+SETTLE_MAX_MS = 50
+RIPPLE_PP_MAX_MV = 3.0
+STEPS = [(2100, "an", 200), (2600, "set 300", 300), (3100, "set 120", 120)]
+
+with tempfile.TemporaryDirectory() as tmp:
+    flash = os.path.join(tmp, "flash.bin")
+    simrun.run("laser_control", script=[(100, "")], duration_ms=2500,
+               env={"SIM_FLASH_FILE": flash})
+    script = [(100, ""), (2050, "recal aus"), (2060, "set 200")] + [(t, cmd) for t, cmd, _ in STEPS]
+    out, err = simrun.run("laser_control", script=script, duration_ms=3600,
+                          env={"SIM_FLASH_FILE": flash, "SIM_GAIN_MV": 750})
+
+simrun.check("Keine gültige Kalibrierung" not in out, "Kalibrierung nicht aus dem Flash geladen")
+
+# Zeilen "t_us, mV, Tastgrad" den Sprüngen zuordnen
+windows = []
+for line in out.splitlines():
+    if line.startswith("OK: Laser_an") or (line.startswith("OK: Sollwert") and windows):
+        windows.append([])
+    elif windows:
+        rows = simrun.csv_rows(line, 3)
+        if rows:
+            windows[-1].append(rows[0])
+simrun.check(len(windows) == len(STEPS), "%d Sprünge gefunden" % len(windows))
+
+for (t_cmd, cmd, setpoint), rows in zip(STEPS, windows):
+    t0 = rows[0][0]
+    band = max(0.02 * setpoint, 3.0)
+    outside = [r[0] for r in rows if abs(r[1] - setpoint) > band]
+    settle_ms = (outside[-1] - t0) / 1000.0 + 1.0 if outside else 0.0
+    tail = [r[1] for r in rows if r[0] - t0 >= (rows[-1][0] - t0) - 200000]
+    mean = statistics.fmean(tail)
+    pp = max(tail) - min(tail)
+    if setpoint > rows[0][1]:
+        overshoot = max(r[1] for r in rows) - setpoint
+    else:
+        overshoot = setpoint - min(r[1] for r in rows)
+    print("%-8s -> %3d mV: Einschwingen %5.1f ms, Überschwingen %5.2f mV, "
+          "Mittel %7.2f mV, Welligkeit %.2f mV (Std. %.2f)"
+          % (cmd, setpoint, settle_ms, overshoot, mean, pp, statistics.pstdev(tail)))
+    simrun.check(settle_ms <= SETTLE_MAX_MS, "%s: Einschwingzeit %.1f ms" % (cmd, settle_ms))
+    simrun.check(overshoot <= 0.05 * setpoint, "%s: Überschwingen %.2f mV" % (cmd, overshoot))
+    simrun.check_near(mean, setpoint, 0.5, "%s: Mittelwert" % cmd)
+    simrun.check(pp <= RIPPLE_PP_MAX_MV, "%s: Welligkeit %.2f mV" % (cmd, pp))
+
+simrun.summary()
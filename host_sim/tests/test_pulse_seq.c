@@ -0,0 +1,107 @@
+// test_pulse_seq.c
+// Tabellen-Encoder des PIO-Pulssequenzers (pulse_seq.c): Rundung auf ganze
+// Takte, zu kurze Halbperioden, volle Tabelle, Gesamtdauer.
+
+#include "check.h"
+#include "pulse_seq.h"
+
+#define MAX_WORDS 64
+
+static uint32_t table[MAX_WORDS];
+
+static pulse_seq_status_t encode_one(uint32_t high_ns, uint32_t low_ns, uint32_t clk_hz,
+                                     size_t *words) {
+    pulse_seq_step_t step = { high_ns, low_ns, 1 };
+    return pulse_seq_encode(&step, 1, clk_hz, table, MAX_WORDS, words);
+}
+
+static void test_rounding(void) {
+    size_t words;
+
+    // 125 MHz: 8 ns pro Takt; 20 ns = 2,5 Takte rundet auf 3 (= Minimum)
+    CHECK(encode_one(20, 100, 125000000, &words) == PULSE_SEQ_OK && words == 2, "20 ns");
+    CHECK(table[0] == 0, "20 ns -> Wort %u", table[0]);
+    CHECK(table[1] == 13 - PULSE_SEQ_MIN_CYCLES, "100 ns -> Wort %u", table[1]);
+    CHECK(encode_one(19, 100, 125000000, &words) == PULSE_SEQ_ERR_SHORT && words == 0, "19 ns");
+    CHECK(encode_one(100, 19, 125000000, &words) == PULSE_SEQ_ERR_SHORT, "19 ns tief");
+
+    // Knapp unter/über einem halben Takt
+    CHECK(encode_one(1003, 1004, 125000000, &words) == PULSE_SEQ_OK, "1003/1004 ns");
+    CHECK(table[0] == 125 - PULSE_SEQ_MIN_CYCLES && table[1] == 126 - PULSE_SEQ_MIN_CYCLES,
+          "1003/1004 ns -> %u/%u", table[0], table[1]);
+
+    // Andere Systemtakte: Takte = round(ns * clk / 1e9)
+    static const uint32_t clocks[] = { 48000000, 125000000, 133000000, 200000000 };
+    static const uint32_t times[] = { 37, 250, 1001, 123457, 4000000000u };
+    for (size_t c = 0; c < sizeof(clocks) / sizeof(clocks[0]); c++) {
+        for (size_t t = 0; t < sizeof(times) / sizeof(times[0]); t++) {
+            uint64_t cycles = ((uint64_t)times[t] * clocks[c] + 500000000u) / 1000000000u;
+            pulse_seq_status_t st = encode_one(times[t], times[t], clocks[c], &words);
+            if (cycles < PULSE_SEQ_MIN_CYCLES) {
+                CHECK(st == PULSE_SEQ_ERR_SHORT, "%u ns bei %u Hz", times[t], clocks[c]);
+                continue;
+            }
+            double exact = (double)times[t] * clocks[c] / 1e9;
+            CHECK(st == PULSE_SEQ_OK && table[0] + PULSE_SEQ_MIN_CYCLES == cycles,
+                  "%u ns bei %u Hz", times[t], clocks[c]);
+            CHECK(fabs(table[0] + PULSE_SEQ_MIN_CYCLES - exact) <= 0.5,
+                  "%u ns bei %u Hz: %u Takte statt %.2f", times[t], clocks[c],
+                  table[0] + PULSE_SEQ_MIN_CYCLES, exact);
+        }
+    }
+}
+
+static void test_full(void) {
+    size_t words;
+    pulse_seq_step_t steps[] = {
+        { 1000, 1000, 10 },
+        { 500, 2000, 0 },               // repeat 0 zählt wie 1
+        { 200, 200, 21 },
+    };
+
+    // Genau passend: 2 * (10 + 1 + 21) = 64 Wörter
+    CHECK(pulse_seq_encode(steps, 3, 125000000, table, MAX_WORDS, &words) == PULSE_SEQ_OK
+          && words == MAX_WORDS, "64 Wörter: %zu", words);
+    CHECK(table[20] == 63 - PULSE_SEQ_MIN_CYCLES && table[21] == 250 - PULSE_SEQ_MIN_CYCLES,
+          "repeat 0: %u/%u", table[20], table[21]);
+
+    // Ein Wortpaar mehr passt nicht, auch nicht bei ungerader Restgröße
+    steps[2].repeat = 22;
+    CHECK(pulse_seq_encode(steps, 3, 125000000, table, MAX_WORDS, &words) == PULSE_SEQ_ERR_FULL
+          && words == 0, "65 Wörter");
+    steps[2].repeat = 21;
+    CHECK(pulse_seq_encode(steps, 3, 125000000, table, MAX_WORDS - 1, &words) == PULSE_SEQ_ERR_FULL,
+          "63 Wörter Platz");
+    // Riesiges repeat ohne Überlauf der Rechnung
+    steps[0].repeat = UINT32_MAX;
+    CHECK(pulse_seq_encode(steps, 1, 125000000, table, MAX_WORDS, &words) == PULSE_SEQ_ERR_FULL,
+          "repeat UINT32_MAX");
+    CHECK(pulse_seq_encode(steps, 0, 125000000, table, MAX_WORDS, &words) == PULSE_SEQ_OK
+          && words == 0, "leere Folge");
+}
+
+static void test_total_cycles(void) {
+    size_t words;
+    pulse_seq_step_t steps[] = {
+        { 1000, 3000, 5 },              // 125 + 375 Takte
+        { 24, 24, 3 },                  // 3 + 3 Takte
+        { 1000000, 9000000, 1 },        // 125000 + 1125000 Takte
+    };
+    CHECK(pulse_seq_encode(steps, 3, 125000000, table, MAX_WORDS, &words) == PULSE_SEQ_OK
+          && words == 18, "Folge: %zu Wörter", words);
+    uint64_t expected = 5 * (125 + 375) + 3 * (3 + 3) + 125000 + 1125000;
+    CHECK(pulse_seq_table_cycles(table, words) == expected, "Gesamtdauer %llu statt %llu",
+          (unsigned long long)pulse_seq_table_cycles(table, words), (unsigned long long)expected);
+    CHECK(pulse_seq_table_cycles(table, 0) == 0, "leere Tabelle");
+
+    // Große Wörter summieren ohne 32-Bit-Überlauf
+    table[0] = table[1] = UINT32_MAX - PULSE_SEQ_MIN_CYCLES;
+    CHECK(pulse_seq_table_cycles(table, 2) == 2ull * UINT32_MAX, "64-Bit-Summe");
+}
+
+int main(void) {
+    test_rounding();
+    test_full();
+    test_total_cycles();
+    return check_summary();
+}
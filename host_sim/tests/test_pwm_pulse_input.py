@@ -0,0 +1,36 @@
+"""pwm-pulse: Tippfehler lösen keinen Puls aus, Zahlen und Enter schon.
+
+Trigger-Befehle mit Werten außerhalb des Bereichs (Fenster, dessen Summe
+in 32 Bit überläuft, Schwelle über VREF oder als int negativ, Holdoff
+über 2^32 Samples) werden abgelehnt, ohne den Trigger scharf zu schalten.
+"""
+
+import simrun
+
+out, err = simrun.run("pwm-pulse", script=[(1100, "statt"), (1150, "12x"), (1200, "50"), (1400, "")],
+                      duration_ms=1600)
+lines = [line for line in out.splitlines() if not line[:1].isdigit()]
+
+simrun.check(sum("Unbekannter Befehl" in line for line in lines) == 2,
+             "Tippfehler nicht abgelehnt: %r" % lines)
+simrun.check(sum(line == "Puls (asynchron)!" for line in lines) == 2,
+             "Anzahl Pulse falsch: %r" % lines)
+simrun.check("Neue Pulsdauer: 50 ms" in lines, "Pulsdauer nicht übernommen")
+simrun.check("Wiederhole letzten Puls (50 ms)" in lines, "Enter wiederholt nicht")
+
+out, err = simrun.run("pwm-pulse", duration_ms=1500, script=[
+    (1100, "fenster 4294967295 2"), (1150, "fenster 2 4294967295"),
+    (1200, "trig steigend 4294967295"), (1250, "trig hoch 99999"), (1300, "trig hoch 100 0 999999999"),
+    (1350, "fenster 100 200"), (1400, "trig steigend 500 20 0")])
+lines = [line for line in out.splitlines() if not line[:1].isdigit()]
+simrun.check(sum(line.startswith("Fenster: Vorlauf + Nachlauf 1..") for line in lines) == 2,
+             "übergroßes Fenster angenommen: %r" % lines)
+simrun.check(sum(line.startswith("Trigger: Schwelle und Hysterese") for line in lines) == 2,
+             "Schwelle außerhalb angenommen: %r" % lines)
+simrun.check(any(line.startswith("Trigger: Holdoff zu lang") for line in lines),
+             "Holdoff über 2^32 Samples angenommen")
+armed = [line for line in lines if line.startswith("Trigger scharf")]
+simrun.check(len(armed) == 1 and "Fenster 100 + 200 Samples" in armed[0],
+             "nur der gültige Trigger darf scharf werden: %r" % armed)
+
+simrun.summary()
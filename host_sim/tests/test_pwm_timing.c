@@ -0,0 +1,178 @@
+// test_pwm_timing.c
+// Teiler und wrap aus dem Systemtakt (pwm_timing_solve): exakte und nicht
+// exakte Frequenzen, zu niedrige und zu hohe, Begrenzung durch min_steps,
+// bei mehreren Systemtakten. Ein Vergleich mit der vollständigen Suche über
+// alle Teiler prüft die Auswahlregel aus pwm_timing.h.
+
+#include "check.h"
+#include "pwm_timing.h"
+
+static const uint32_t clocks[] = { 48000000, 125000000, 133000000, 200000000 };
+#define NUM_CLOCKS (sizeof(clocks) / sizeof(clocks[0]))
+
+static const pwm_timing_t untouched = { 0xdeadbeef, 0x5555, 0xaaaa };
+
+static double error_ppm(const pwm_timing_t *t, float freq_hz) {
+    return fabs(pwm_timing_freq_hz(t) - freq_hz) / freq_hz * 1e6;
+}
+
+static bool same(const pwm_timing_t *a, const pwm_timing_t *b) {
+    return a->sys_clk_hz == b->sys_clk_hz && a->div_16 == b->div_16 && a->wrap == b->wrap;
+}
+
+// Auswahlregel nachgerechnet: alle Teiler aufsteigend, Stufen gerundet;
+// der erste gültige ist die feinste Einstellung, der erste innerhalb der
+// Toleranz das Ergebnis
+static pwm_timing_status_t brute_force(uint32_t sys_clk_hz, float freq_hz, uint32_t min_steps,
+                                       uint32_t max_error_ppm, pwm_timing_t *t) {
+    if (min_steps < 2)
+        min_steps = 2;
+    double period_16 = (double)sys_clk_hz * 16.0 / freq_hz;
+    bool found = false;
+    for (uint32_t div = PWM_TIMING_DIV_MIN; div <= PWM_TIMING_DIV_MAX; div++) {
+        double steps = floor(period_16 / div + 0.5);
+        if (steps > PWM_TIMING_MAX_STEPS || steps < min_steps)
+            continue;
+        pwm_timing_t cand = { sys_clk_hz, (uint16_t)div, (uint16_t)(steps - 1.0) };
+        if (!found) {
+            *t = cand;
+            found = true;
+        }
+        if (fabs(div * steps - period_16) / period_16 * 1e6 <= max_error_ppm + 0.1) {
+            *t = cand;
+            return PWM_TIMING_OK;
+        }
+    }
+    if (found)
+        return PWM_TIMING_INEXACT;
+    // Kürzeste Periode mit Teiler 1: zu hoch, sonst zu niedrig
+    return period_16 < (double)PWM_TIMING_DIV_MIN * min_steps ? PWM_TIMING_TOO_HIGH
+                                                                : PWM_TIMING_TOO_LOW;
+}
+
+// Von Hand nachgerechnete Fälle
+static void test_cases(void) {
+    pwm_timing_t t;
+
+    // 1 kHz bei 125 MHz: 125000 Takte; Teiler 1,875 ergäbe 66667 Stufen,
+    // 2,0 genau 62500
+    CHECK(pwm_timing_solve(125000000, 1000.0f, 2, 0, &t) == PWM_TIMING_OK, "1 kHz @ 125 MHz");
+    CHECK(t.div_16 == 32 && t.wrap == 62499 && t.sys_clk_hz == 125000000,
+          "1 kHz @ 125 MHz: %u/16, wrap %u", t.div_16, t.wrap);
+    CHECK(pwm_timing_freq_hz(&t) == 1000.0, "1 kHz @ 125 MHz: %.6f Hz", pwm_timing_freq_hz(&t));
+
+    // 1 kHz bei 133 MHz: 133000 = 2,1875 * 60800
+    CHECK(pwm_timing_solve(133000000, 1000.0f, 2, 0, &t) == PWM_TIMING_OK, "1 kHz @ 133 MHz");
+    CHECK(t.div_16 == 35 && t.wrap == 60799, "1 kHz @ 133 MHz: %u/16, wrap %u", t.div_16, t.wrap);
+
+    // 3 kHz bei 125 MHz: 41666,67 Takte, nie exakt. Mit 0 ppm kommt die
+    // feinste Einstellung (Teiler 1: 41667 Stufen, 8 ppm), mit 10 ppm
+    // dieselbe als OK
+    CHECK(pwm_timing_solve(125000000, 3000.0f, 2, 0, &t) == PWM_TIMING_INEXACT, "3 kHz @ 125 MHz");
+    CHECK(t.div_16 == 16 && t.wrap == 41666, "3 kHz feinste Einstellung: %u/16, wrap %u",
+          t.div_16, t.wrap);
+    CHECK_NEAR(error_ppm(&t, 3000.0f), 8.0, 0.1);
+    CHECK(pwm_timing_solve(125000000, 3000.0f, 2, 10, &t) == PWM_TIMING_OK
+          && t.div_16 == 16 && t.wrap == 41666, "3 kHz, 10 ppm: %u/16", t.div_16);
+
+    // Mit 1 ppm erst ein gröberer Teiler; verlangt man mehr Stufen, als
+    // dieser hat, bleibt nur die feinste, nicht exakte Einstellung
+    pwm_timing_t coarse;
+    CHECK(pwm_timing_solve(125000000, 3000.0f, 2, 1, &coarse) == PWM_TIMING_OK, "3 kHz, 1 ppm");
+    CHECK(coarse.div_16 > 16 && error_ppm(&coarse, 3000.0f) <= 1.1, "3 kHz, 1 ppm: %u/16, %.3f ppm",
+          coarse.div_16, error_ppm(&coarse, 3000.0f));
+    CHECK(pwm_timing_solve(125000000, 3000.0f, pwm_timing_steps(&coarse) + 1, 1, &t)
+          == PWM_TIMING_INEXACT && t.div_16 == 16, "3 kHz, 1 ppm, min. %u Stufen: %u/16",
+          pwm_timing_steps(&coarse) + 1, t.div_16);
+
+    // min_steps über der Stufenzahl mit Teiler 1 (gerundet 41667)
+    CHECK(pwm_timing_solve(125000000, 3000.0f, 41667, 0, &t) == PWM_TIMING_INEXACT,
+          "3 kHz, min. 41667 Stufen");
+    CHECK(pwm_timing_solve(125000000, 3000.0f, 41668, 0, &t) == PWM_TIMING_TOO_HIGH,
+          "3 kHz, min. 41668 Stufen");
+
+    // Untere Grenze: sys_clk / (255 15/16 * 65536), bei 125 MHz 7,45 Hz
+    t = untouched;
+    CHECK(pwm_timing_solve(125000000, 7.4f, 2, 0, &t) == PWM_TIMING_TOO_LOW, "7,4 Hz @ 125 MHz");
+    CHECK(same(&t, &untouched), "TOO_LOW verändert t");
+    CHECK(pwm_timing_solve(125000000, 7.5f, 2, 1000000, &t) <= PWM_TIMING_INEXACT,
+          "7,5 Hz @ 125 MHz");
+    CHECK(pwm_timing_solve(125000000, 0.0f, 2, 0, &t) == PWM_TIMING_TOO_LOW, "0 Hz");
+    CHECK(pwm_timing_solve(125000000, -5.0f, 2, 0, &t) == PWM_TIMING_TOO_LOW, "-5 Hz");
+
+    // Obere Grenze: Teiler 1 und min_steps Stufen; min_steps < 2 zählt als 2
+    CHECK(pwm_timing_solve(125000000, 62500000.0f, 0, 0, &t) == PWM_TIMING_OK
+          && t.div_16 == 16 && t.wrap == 1, "fs/2 mit 2 Stufen");
+    t = untouched;
+    CHECK(pwm_timing_solve(125000000, 63000000.0f, 0, 0, &t) == PWM_TIMING_INEXACT
+          && t.div_16 == 16 && t.wrap == 1, "knapp über fs/2 rundet auf 2 Stufen");
+    t = untouched;
+    CHECK(pwm_timing_solve(125000000, 90000000.0f, 0, 0, &t) == PWM_TIMING_TOO_HIGH, "fs/1,4");
+    CHECK(same(&t, &untouched), "TOO_HIGH verändert t");
+    CHECK(pwm_timing_solve(125000000, 500000.0f, 250, 0, &t) == PWM_TIMING_OK
+          && pwm_timing_steps(&t) == 250, "500 kHz, 250 Stufen");
+    CHECK(pwm_timing_solve(125000000, 500000.0f, 251, 0, &t) == PWM_TIMING_TOO_HIGH,
+          "500 kHz, 251 Stufen");
+}
+
+// Alle Systemtakte, Frequenzen von 1 Hz bis 100 MHz, mehrere Toleranzen
+// und Mindeststufen gegen die vollständige Suche
+static void test_sweep(void) {
+    static const uint32_t tolerances[] = { 0, 10, 1000 };
+    static const uint32_t min_steps[] = { 0, 100, 4096, 65536 };
+    uint32_t counts[4] = { 0 };
+
+    for (size_t c = 0; c < NUM_CLOCKS; c++) {
+        for (int e = 0; e <= 80; e++) {
+            float f = powf(10.0f, e / 10.0f) * 1.0123f;
+            for (size_t p = 0; p < sizeof(tolerances) / sizeof(tolerances[0]); p++) {
+                for (size_t m = 0; m < sizeof(min_steps) / sizeof(min_steps[0]); m++) {
+                    pwm_timing_t t = untouched, want = untouched;
+                    pwm_timing_status_t st = pwm_timing_solve(clocks[c], f, min_steps[m],
+                                                              tolerances[p], &t);
+                    pwm_timing_status_t ref = brute_force(clocks[c], f, min_steps[m],
+                                                          tolerances[p], &want);
+                    counts[st]++;
+                    CHECK(st == ref && same(&t, &want),
+                          "%.3f Hz @ %u Hz, %u ppm, min. %u: %s %u/16 wrap %u, erwartet %s %u/16 wrap %u",
+                          f, clocks[c], tolerances[p], min_steps[m], pwm_timing_status_str(st),
+                          t.div_16, t.wrap, pwm_timing_status_str(ref), want.div_16, want.wrap);
+                    if (st > PWM_TIMING_INEXACT)
+                        continue;
+                    CHECK(t.div_16 >= PWM_TIMING_DIV_MIN && t.div_16 <= PWM_TIMING_DIV_MAX
+                          && pwm_timing_steps(&t) >= (min_steps[m] < 2 ? 2 : min_steps[m]),
+                          "%.3f Hz @ %u Hz: %u/16, %u Stufen", f, clocks[c], t.div_16,
+                          pwm_timing_steps(&t));
+                    if (st == PWM_TIMING_OK)
+                        CHECK(error_ppm(&t, f) <= tolerances[p] + 0.2, "%.3f Hz @ %u Hz: %.3f ppm",
+                              f, clocks[c], error_ppm(&t, f));
+                }
+            }
+        }
+    }
+    printf("%u exakt, %u nicht exakt, %u zu niedrig, %u zu hoch\n", counts[PWM_TIMING_OK],
+           counts[PWM_TIMING_INEXACT], counts[PWM_TIMING_TOO_LOW], counts[PWM_TIMING_TOO_HIGH]);
+    CHECK(counts[PWM_TIMING_OK] > 0 && counts[PWM_TIMING_INEXACT] > 0
+          && counts[PWM_TIMING_TOO_LOW] > 0 && counts[PWM_TIMING_TOO_HIGH] > 0,
+          "nicht alle Fälle abgedeckt");
+}
+
+// Höherer Systemtakt: feinere Stufen und höhere erreichbare Frequenzen
+static void test_clock_scaling(void) {
+    pwm_timing_t slow, fast;
+    CHECK(pwm_timing_solve(48000000, 20000.0f, 2, 0, &slow) == PWM_TIMING_OK, "20 kHz @ 48 MHz");
+    CHECK(pwm_timing_solve(200000000, 20000.0f, 2, 0, &fast) == PWM_TIMING_OK, "20 kHz @ 200 MHz");
+    CHECK(pwm_timing_steps(&fast) > pwm_timing_steps(&slow), "Stufen %u @ 200 MHz, %u @ 48 MHz",
+          pwm_timing_steps(&fast), pwm_timing_steps(&slow));
+    CHECK(pwm_timing_solve(48000000, 1e6f, 100, 0, &slow) == PWM_TIMING_TOO_HIGH,
+          "1 MHz, 100 Stufen @ 48 MHz");
+    CHECK(pwm_timing_solve(200000000, 1e6f, 100, 0, &fast) == PWM_TIMING_OK,
+          "1 MHz, 100 Stufen @ 200 MHz");
+}
+
+int main(void) {
+    test_cases();
+    test_sweep();
+    test_clock_scaling();
+    return check_summary();
+}
@@ -0,0 +1,261 @@
+// test_reaction_map.c
+// Kennlinienfeld (reaction_map.c) mit 11 Stützstellen und 5 Zeilen
+// (10..50 °C): bilineare Interpolation über Zeilen und Stützstellen,
+// ungültige Zeilen und Randzeilen, Umkehrung mit BELOW/ABOVE/AMBIGUOUS
+// an einer nicht monotonen Zeile, Lernen und Auffrischen, die Zeilen
+// monoton lassen, und das Anlegen neuer Zeilen als Kopie der nächsten
+// gültigen.
+
+#include "check.h"
+#include "reaction_map.h"
+
+#define POINTS 11
+#define ROWS 5
+
+static q16_t cells[ROWS * POINTS];
+
+// Zeile A (20 °C): 100 + 100 i mV, Zeile B (30 °C): 100 + 200 i mV
+static uint16_t row_a[POINTS], row_b[POINTS];
+// Nicht monoton: Einbruch zwischen Stützstelle 3 und 6
+static const uint16_t row_c[POINTS] = { 100, 200, 400, 600, 500, 450, 700, 800, 900, 950, 1000 };
+
+static double real(q16_t v) {
+    return v / 65536.0;
+}
+
+static q16_t duty_q(double d) {
+    return (q16_t)(d * 65536.0 + 0.5);
+}
+
+static q16_t temp_q(double t) {
+    return (q16_t)(t * 65536.0 + (t >= 0 ? 0.5 : -0.5));
+}
+
+static void setup(reaction_map_t *map) {
+    for (int i = 0; i < POINTS; i++) {
+        row_a[i] = (uint16_t)(100 + 100 * i);
+        row_b[i] = (uint16_t)(100 + 200 * i);
+    }
+    CHECK(reaction_map_init(map, cells, POINTS, ROWS, Q16_CONST(10.0), Q16_CONST(10.0), 2), "Init");
+}
+
+static bool row_monotonic(const reaction_map_t *map, int row) {
+    const q16_t *c = map->cells + row * POINTS;
+    for (int i = 0; i + 1 < POINTS; i++)
+        if (c[i + 1] < c[i])
+            return false;
+    return true;
+}
+
+static bool row_equals(const reaction_map_t *map, int row, const uint16_t *want) {
+    const q16_t *c = map->cells + row * POINTS;
+    for (int i = 0; i < POINTS; i++)
+        if (c[i] != q16_from_int(want[i]))
+            return false;
+    return true;
+}
+
+static void test_empty_and_init(void) {
+    reaction_map_t map;
+    setup(&map);
+    q16_t duty = 0;
+    CHECK(!reaction_map_ready(&map) && reaction_map_lookup(&map, Q16_HALF, temp_q(20)) == 0,
+          "leeres Feld");
+    CHECK(reaction_map_inverse(&map, Q16_CONST(300.0), temp_q(20), 0, Q16_ONE, &duty)
+          == REACTION_MAP_INV_ABOVE && duty == Q16_ONE, "Umkehrung ohne Feld");
+    reaction_map_learn(&map, Q16_HALF, temp_q(20), Q16_CONST(500.0));
+    reaction_map_refresh(&map, Q16_HALF, temp_q(20), Q16_CONST(500.0), 0);
+    CHECK(map.row_valid == 0 && map.updates == 0, "Lernen ohne gültige Zeile");
+
+    CHECK(!reaction_map_init(&map, NULL, POINTS, ROWS, 0, Q16_ONE, 2), "kein Speicher");
+    CHECK(!reaction_map_init(&map, cells, 1, ROWS, 0, Q16_ONE, 2), "1 Stützstelle");
+    CHECK(!reaction_map_init(&map, cells, POINTS, 0, 0, Q16_ONE, 2), "0 Zeilen");
+    CHECK(!reaction_map_init(&map, cells, POINTS, REACTION_MAP_MAX_ROWS + 1, 0, Q16_ONE, 2),
+          "zu viele Zeilen");
+    CHECK(!reaction_map_init(&map, cells, POINTS, ROWS, 0, 0, 2), "Zeilenabstand 0");
+    CHECK(!reaction_map_init(&map, cells, POINTS, ROWS, 0, Q16_ONE, 17), "learn_shift 17");
+}
+
+// set_row wählt die nächste Zeile, lookup interpoliert bilinear
+static void test_lookup(void) {
+    reaction_map_t map;
+    setup(&map);
+    reaction_map_set_row(&map, temp_q(24.9), row_a);    // -> Zeile 1 (20 °C)
+    reaction_map_set_row(&map, temp_q(25.1), row_b);    // -> Zeile 2 (30 °C)
+    CHECK(map.row_valid == 0x6, "gültige Zeilen 0x%x statt 0x6", map.row_valid);
+    CHECK(row_equals(&map, 1, row_a) && row_equals(&map, 2, row_b), "Zeilen falsch gesetzt");
+
+    // Zwischen den Zeilen: (1 - u) A + u B, A und B linear im Tastgrad
+    double worst = 0.0;
+    for (int ti = 0; ti <= 20; ti++) {
+        double t = 20.0 + ti * 0.5, u = (t - 20.0) / 10.0;
+        for (int di = 0; di <= 40; di++) {
+            double d = di / 40.0;
+            double want = (1.0 - u) * (100.0 + 1000.0 * d) + u * (100.0 + 2000.0 * d);
+            double got = real(reaction_map_lookup(&map, duty_q(d), temp_q(t)));
+            worst = fmax(worst, fabs(got - want));
+        }
+    }
+    CHECK(worst < 0.1, "bilinear: Abweichung bis %.4f mV", worst);
+    CHECK_NEAR(real(reaction_map_lookup(&map, duty_q(0.25), temp_q(25))), 475.0, 0.05);
+
+    // Ungültige Zeilen lesen die nächste gültige, außerhalb gilt die Randzeile
+    CHECK_NEAR(real(reaction_map_lookup(&map, duty_q(0.5), temp_q(15))), 600.0, 0.05);    // Zeile 0 -> A
+    CHECK_NEAR(real(reaction_map_lookup(&map, duty_q(0.5), temp_q(-40))), 600.0, 0.05);
+    CHECK_NEAR(real(reaction_map_lookup(&map, duty_q(0.5), temp_q(45))), 1100.0, 0.05);   // 3, 4 -> B
+    CHECK_NEAR(real(reaction_map_lookup(&map, duty_q(0.5), temp_q(90))), 1100.0, 0.05);
+    CHECK_NEAR(real(reaction_map_lookup(&map, duty_q(1.5), temp_q(20))), 1100.0, 0.05);
+    CHECK_NEAR(real(reaction_map_lookup(&map, -Q16_HALF, temp_q(30))), 100.0, 0.05);
+}
+
+static void test_inverse(void) {
+    reaction_map_t map;
+    setup(&map);
+    reaction_map_set_row(&map, temp_q(20), row_a);
+    reaction_map_set_row(&map, temp_q(30), row_b);
+    reaction_map_set_row(&map, temp_q(50), row_c);
+    q16_t duty;
+
+    // Monoton: Treffer, unter duty_min, über duty_max
+    CHECK(reaction_map_inverse(&map, Q16_CONST(350.0), temp_q(20), 0, Q16_ONE, &duty)
+          == REACTION_MAP_INV_OK, "350 mV bei 20 °C");
+    CHECK_NEAR(real(duty), 0.25, 1e-4);
+    CHECK(reaction_map_inverse(&map, Q16_CONST(475.0), temp_q(25), 0, Q16_ONE, &duty)
+          == REACTION_MAP_INV_OK, "475 mV bei 25 °C");
+    CHECK_NEAR(real(duty), 0.25, 1e-4);
+    CHECK(reaction_map_inverse(&map, Q16_CONST(150.0), temp_q(20), duty_q(0.1), duty_q(0.9), &duty)
+          == REACTION_MAP_INV_BELOW && duty == duty_q(0.1), "unter duty_min: %.4f", real(duty));
+    CHECK(reaction_map_inverse(&map, Q16_CONST(1050.0), temp_q(20), duty_q(0.1), duty_q(0.9), &duty)
+          == REACTION_MAP_INV_ABOVE && duty == duty_q(0.9), "über duty_max: %.4f", real(duty));
+
+    // Nicht monoton (50 °C): vor dem Einbruch eindeutig, im Einbruch
+    // mehrdeutig, dahinter wieder eindeutig
+    CHECK(reaction_map_inverse(&map, Q16_CONST(300.0), temp_q(50), 0, Q16_ONE, &duty)
+          == REACTION_MAP_INV_OK, "300 mV vor dem Einbruch");
+    CHECK_NEAR(real(duty), 0.15, 1e-4);
+    CHECK(reaction_map_inverse(&map, Q16_CONST(480.0), temp_q(50), 0, Q16_ONE, &duty)
+          == REACTION_MAP_INV_AMBIGUOUS, "480 mV: Einbruch auf 450 nicht gemeldet");
+    CHECK_NEAR(real(duty), 0.24, 1e-4);
+    CHECK(reaction_map_inverse(&map, Q16_CONST(550.0), temp_q(50), 0, Q16_ONE, &duty)
+          == REACTION_MAP_INV_AMBIGUOUS, "550 mV: Einbruch nicht gemeldet");
+    CHECK(reaction_map_inverse(&map, Q16_CONST(550.0), temp_q(50), 0, duty_q(0.3), &duty)
+          == REACTION_MAP_INV_OK, "550 mV, Einbruch hinter duty_max");
+    CHECK_NEAR(real(duty), 0.275, 1e-4);
+    CHECK(reaction_map_inverse(&map, Q16_CONST(650.0), temp_q(50), 0, Q16_ONE, &duty)
+          == REACTION_MAP_INV_OK, "650 mV hinter dem Einbruch");
+    CHECK_NEAR(real(duty), 0.58, 1e-4);
+    CHECK(reaction_map_inverse(&map, Q16_CONST(50.0), temp_q(50), 0, Q16_ONE, &duty)
+          == REACTION_MAP_INV_BELOW && duty == 0, "50 mV bei 50 °C");
+    CHECK(reaction_map_inverse(&map, Q16_CONST(1200.0), temp_q(50), 0, Q16_ONE, &duty)
+          == REACTION_MAP_INV_ABOVE && duty == Q16_ONE, "1200 mV bei 50 °C");
+}
+
+// Lernen streckt die Zeile über dem Dunkelsignal: monoton, Stützstelle 0
+// fest, Arbeitspunkt läuft auf den Messwert zu
+static void test_learn(void) {
+    reaction_map_t map;
+    setup(&map);
+    reaction_map_set_row(&map, temp_q(20), row_a);
+
+    static const double targets[] = { 700.0, 150.0, 600.0 };
+    for (size_t k = 0; k < sizeof(targets) / sizeof(targets[0]); k++) {
+        bool mono = true;
+        for (int n = 0; n < 60; n++) {
+            reaction_map_learn(&map, Q16_HALF, temp_q(20), q16_from_int((int32_t)targets[k]));
+            mono = mono && row_monotonic(&map, 1);
+        }
+        double got = real(reaction_map_lookup(&map, Q16_HALF, temp_q(20)));
+        CHECK(mono, "Lernen auf %.0f mV: Zeile nicht monoton", targets[k]);
+        CHECK(fabs(got - targets[k]) < 1.0, "Lernen auf %.0f mV: %.2f mV", targets[k], got);
+        CHECK(cells[1 * POINTS] == q16_from_int(100), "Dunkelsignal verändert: %.2f",
+              real(cells[1 * POINTS]));
+    }
+    // Genau auf Zeile 1 entsteht Zeile 2 als Kopie, ohne Gewicht
+    CHECK(map.row_valid == 0x6 && map.updates == 180, "Zeilen 0x%x, %u Updates", map.row_valid,
+          map.updates);
+
+    // Zwischen zwei Zeilen: die fehlende entsteht als Kopie und beide
+    // werden mit halbem Gewicht gestreckt, bleiben also gleich
+    setup(&map);
+    reaction_map_set_row(&map, temp_q(20), row_a);
+    reaction_map_learn(&map, Q16_HALF, temp_q(25), Q16_CONST(700.0));
+    CHECK(map.row_valid == 0x6, "Zeilen 0x%x statt 0x6", map.row_valid);
+    bool same = true;
+    for (int i = 0; i < POINTS; i++)
+        same = same && cells[POINTS + i] == cells[2 * POINTS + i];
+    CHECK(same && row_monotonic(&map, 2), "neue Zeile 2 weicht von Zeile 1 ab");
+}
+
+// Auffrischen verändert nur die umgebenden Zellen und begrenzt Nachbarn
+static void test_refresh(void) {
+    reaction_map_t map;
+    setup(&map);
+    reaction_map_set_row(&map, temp_q(20), row_a);
+
+    // Weit unter der Kennlinie: Zelle 5 auf 50 mV, die Zellen davor folgen
+    reaction_map_refresh(&map, duty_q(0.5), temp_q(20), Q16_CONST(50.0), 0);
+    CHECK(row_monotonic(&map, 1), "nach Einbruch nicht monoton");
+    CHECK_NEAR(real(cells[POINTS + 5]), 50.0, 0.01);
+    CHECK_NEAR(real(cells[POINTS + 0]), 50.0, 0.01);
+    CHECK_NEAR(real(cells[POINTS + 6]), 700.0, 0.01);
+
+    // Weit darüber: Zelle 3 auf 5000 mV, die Zellen dahinter folgen
+    reaction_map_set_row(&map, temp_q(20), row_a);
+    reaction_map_refresh(&map, duty_q(0.3), temp_q(20), Q16_CONST(5000.0), 0);
+    CHECK(row_monotonic(&map, 1), "nach Spitze nicht monoton");
+    CHECK_NEAR(real(cells[POINTS + 2]), 300.0, 0.01);
+    CHECK_NEAR(real(cells[POINTS + 10]), 5000.0, 0.5);    // 0,3 liegt in Q16 knapp über Stützstelle 3
+
+    // Zwischen zwei Stützstellen mit Rate 1/2: beide Zellen je zur Hälfte
+    // gewichtet, ein Viertel des Fehlers je Zelle
+    reaction_map_set_row(&map, temp_q(20), row_a);
+    reaction_map_refresh(&map, duty_q(0.35), temp_q(20), Q16_CONST(550.0), 1);
+    CHECK_NEAR(real(cells[POINTS + 3]), 425.0, 0.01);
+    CHECK_NEAR(real(cells[POINTS + 4]), 525.0, 0.01);
+    CHECK_NEAR(real(cells[POINTS + 5]), 600.0, 0.0);
+}
+
+// Neue Zeilen kopieren jeweils ihre eigene nächste gültige Zeile, so wie
+// lookup sie vorher gelesen hat; das Feld ändert sich dadurch nicht
+static void test_prepare_rows(void) {
+    reaction_map_t map;
+    setup(&map);
+    reaction_map_set_row(&map, temp_q(20), row_a);  // Zeile 1
+    reaction_map_set_row(&map, temp_q(50), row_c);  // Zeile 4
+
+    q16_t before[21];
+    for (int i = 0; i <= 20; i++)
+        before[i] = reaction_map_lookup(&map, duty_q(i / 20.0), temp_q(35));
+
+    // Fehler 0 am rechten Rand (dort ist Zeile C monoton): nur Zeilen 2
+    // und 3 anlegen
+    q16_t at = reaction_map_lookup(&map, Q16_ONE, temp_q(35));
+    reaction_map_refresh(&map, Q16_ONE, temp_q(35), at, 0);
+    CHECK(map.row_valid == 0x1e, "Zeilen 0x%x statt 0x1e", map.row_valid);
+    CHECK(row_equals(&map, 2, row_a), "Zeile 2 keine Kopie von Zeile 1");
+    CHECK(row_equals(&map, 3, row_c), "Zeile 3 keine Kopie von Zeile 4");
+
+    int changed = 0;
+    for (int i = 0; i <= 20; i++)
+        if (reaction_map_lookup(&map, duty_q(i / 20.0), temp_q(35)) != before[i])
+            changed++;
+    CHECK(changed == 0, "Anlegen der Zeilen ändert %d Werte bei 35 °C", changed);
+
+    // Gleicher Abstand zu zwei gültigen Zeilen: die kältere
+    setup(&map);
+    reaction_map_set_row(&map, temp_q(10), row_a);  // Zeile 0
+    reaction_map_set_row(&map, temp_q(30), row_b);  // Zeile 2
+    at = reaction_map_lookup(&map, Q16_ONE, temp_q(20));
+    reaction_map_refresh(&map, Q16_ONE, temp_q(20), at, 0);
+    CHECK(row_equals(&map, 1, row_a), "Zeile 1 nicht aus der kälteren Zeile 0");
+}
+
+int main(void) {
+    test_empty_and_init();
+    test_lookup();
+    test_inverse();
+    test_learn();
+    test_refresh();
+    test_prepare_rows();
+    return check_summary();
+}
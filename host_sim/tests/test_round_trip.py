@@ -0,0 +1,50 @@
+"""round_trip: Dunkelpegel, Pulsmessung und Latenz in der Simulation."""
+
+import math
+
+import simrun
+
+DARK_MV = 50
+
+out, err = simrun.run("round_trip", duration_ms=2500, env={"SIM_DARK_MV": DARK_MV})
+
+# Laser aus heißt dunkel: Start- und laufender Dunkelpegel am Modellwert
+simrun.check_near(simrun.find(r"Durchschnitt: ([\d.]+) mV", out), DARK_MV, 3, "Startmessung")
+simrun.check_near(simrun.find(r"Basislinie: ([\d.]+) mV", out), DARK_MV, 3, "Basislinie")
+simrun.check("Dunkelpegel nicht erreicht" not in out, "Dunkelpegel nicht erreicht")
+simrun.check("Kein Puls erkannt" not in out, "Puls nicht erkannt")
+
+# Latenz Einschalten -> Flanke: Totzeit plus Anstieg bis zur Schwelle
+# (275 mV von 600 mV mit tau = 20 us). Die PWM muss bei jedem Puls ab
+# Zählerstand 0 starten, sonst streut die Latenz über eine ganze Periode.
+DELAY_US, TAU_US, GAIN_MV = 5, 20, 600
+expected_us = DELAY_US - TAU_US * math.log(1 - 340 * 0.806 / GAIN_MV)
+out, err = simrun.run("round_trip", script=[(1100, "lat 200")], duration_ms=3000,
+                      env={"SIM_DELAY_US": DELAY_US, "SIM_TAU_US": TAU_US, "SIM_GAIN_MV": GAIN_MV})
+lat_min = simrun.find(r"Latenz: n=\d+, min ([\d.]+)", out)
+lat_p50 = simrun.find(r"Latenz: .* p50 ([\d.]+)", out)
+lat_max = simrun.find(r"Latenz: .* max ([\d.]+)", out)
+simrun.check(simrun.find(r"Latenz: n=(\d+)", out, conv=int) == 200, "nicht alle Pulse gemessen")
+simrun.check_near(lat_p50, expected_us, 1.0, "Latenz p50 (us)")
+simrun.check(lat_max - lat_min < 2.0, "Latenz streut %.3f..%.3f us" % (lat_min, lat_max))
+
+# Mittelung: dieselbe Ausrichtung auf die kommandierte Flanke, die Varianz
+# je Sample bleibt auch an der Flanke beim Rauschen (3 mV -> 9 mV^2).
+# Zu große m würden die 32-Bit-Summe überlaufen lassen und werden abgelehnt.
+out, err = simrun.run("round_trip", script=[(1100, "mittel 2000000"), (1150, "mittel 64")],
+                      duration_ms=3000, env={"SIM_DELAY_US": DELAY_US, "SIM_TAU_US": TAU_US,
+                                             "SIM_GAIN_MV": GAIN_MV, "SIM_DARK_MV": DARK_MV})
+simrun.check("Mittelung: höchstens 1048832 Pulse" in out, "m > 1048832 nicht abgelehnt")
+simrun.check("Mittelung: 2000000 Pulse" not in out, "m > 1048832 gestartet")
+start = out.find("Mittelung: 64 Pulse,")
+simrun.check(start >= 0, "Mittelung nicht ausgegeben")
+rows = simrun.csv_rows(out[start:out.find("Ende der Mittelung", start)], 3)
+simrun.check(len(rows) == 400, "%d Zeilen statt 400" % len(rows))
+simrun.check(max(r[2] for r in rows) < 20, "Varianz bis %.1f mV^2" % max(r[2] for r in rows))
+dark = [r[1] for r in rows if r[0] < 0]
+simrun.check_near(sum(dark) / len(dark), DARK_MV, 1.0, "Mittel vor der Flanke (mV)")
+at_20us = next(r[1] for r in rows if r[0] >= 20)
+simrun.check_near(at_20us, DARK_MV + GAIN_MV * (1 - math.exp(-(20 - DELAY_US) / TAU_US)), 10,
+                  "Mittel 20 us nach der Flanke (mV)")
+
+simrun.summary()
@@ -0,0 +1,141 @@
+// test_segment_store.c
+// Segmentierter Speicher (segment_store.c, trigger.c) auf einem
+// synthetischen Pulsstrom: lückenloser Strom, verlorener DMA-Block
+// (segment_store_gap) und der Sample-Zähler des Triggers nach langer Laufzeit.
+
+#include <string.h>
+
+#include "check.h"
+#include "segment_store.h"
+
+#define PERIOD 500              // Samples zwischen zwei Pulsen
+#define PULSE_AT 300            // Pulsbeginn innerhalb der Periode
+#define PULSE_LEN 50
+#define BLOCK 256
+#define PRE 128
+#define POST 128
+#define MAX_SEGMENTS 16
+
+static uint16_t window[PRE + POST];
+static uint16_t storage[MAX_SEGMENTS * (PRE + POST)];
+static uint64_t trigger_seq[MAX_SEGMENTS];
+
+// Wert von Sample `seq`; der Grundpegel hängt vom Index ab, damit ein
+// Fenster aus nicht zusammenhängenden Samples auffällt
+static uint16_t sample(uint64_t seq) {
+    uint32_t phase = (uint32_t)(seq % PERIOD);
+    if (phase >= PULSE_AT && phase < PULSE_AT + PULSE_LEN)
+        return 3000;
+    return (uint16_t)(200 + (seq % 13) * 10);
+}
+
+static void make_block(uint32_t block, uint16_t *samples) {
+    for (uint32_t i = 0; i < BLOCK; i++)
+        samples[i] = sample((uint64_t)block * BLOCK + i);
+}
+
+static void setup(segment_store_t *store) {
+    const trigger_config_t cfg = {
+        .mode = TRIGGER_RISING,
+        .level = 2000,
+        .hysteresis = 25,
+        .pre = PRE,
+        .post = POST,
+    };
+    CHECK(segment_store_init(store, &cfg, window, storage, sizeof(storage) / sizeof(storage[0]),
+                             trigger_seq, MAX_SEGMENTS, 0),
+          "Init");
+    segment_store_arm(store);
+}
+
+// Jedes Segment muss genau die Samples ab seinem ersten Index enthalten
+static void check_segments(const segment_store_t *store, const char *what) {
+    for (uint32_t k = 0; k < store->count; k++) {
+        const uint16_t *s = segment_store_samples(store, k);
+        uint64_t first = segment_store_first_seq(store, k);
+        uint32_t bad = 0;
+        for (uint32_t i = 0; i < store->segment_len; i++)
+            bad += s[i] != sample(first + i);
+        CHECK(bad == 0, "%s: Segment %u (Trigger %llu) mit %u fremden Samples", what, k,
+              (unsigned long long)store->trigger_seq[k], bad);
+        CHECK(store->trigger_seq[k] % PERIOD == PULSE_AT, "%s: Trigger %llu", what,
+              (unsigned long long)store->trigger_seq[k]);
+    }
+}
+
+static void test_continuous(void) {
+    segment_store_t store;
+    uint16_t block[BLOCK];
+    setup(&store);
+
+    for (uint32_t b = 0; !segment_store_full(&store); b++) {
+        make_block(b, block);
+        segment_store_feed(&store, block, (uint64_t)b * BLOCK, BLOCK);
+    }
+    CHECK(store.count == MAX_SEGMENTS, "%u Segmente", store.count);
+    check_segments(&store, "lückenlos");
+    CHECK(store.trigger_seq[0] == PULSE_AT, "erster Trigger %llu",
+          (unsigned long long)store.trigger_seq[0]);
+}
+
+// Block 6 (Samples 1536..1791) fehlt. Der Puls bei 1800 hätte nur 8
+// Samples Vorgeschichte nach der Lücke; ohne segment_store_gap() stammte
+// der Rest des Vorlaufs von vor der Lücke.
+static void test_lost_block(void) {
+    segment_store_t store;
+    uint16_t block[BLOCK];
+    const uint32_t lost = 6;
+    setup(&store);
+
+    uint32_t next = 0;
+    for (uint32_t b = 0; b < 21; b++) {
+        if (b == lost)
+            continue;
+        if (b != next)
+            segment_store_gap(&store, 0);
+        make_block(b, block);
+        segment_store_feed(&store, block, (uint64_t)b * BLOCK, BLOCK);
+        next = b + 1;
+    }
+    check_segments(&store, "verlorener Block");
+    for (uint32_t k = 0; k < store.count; k++)
+        CHECK(store.trigger_seq[k] != 1800, "Segment %u über die Lücke", k);
+    CHECK(store.count == 9, "%u Segmente", store.count);
+
+    // Block während des Lesens überschrieben: daraus fertige Segmente verwerfen
+    uint32_t before = store.count;
+    make_block(21, block);
+    uint32_t done = segment_store_feed(&store, block, 21u * BLOCK, BLOCK);
+    CHECK(done == 1, "Block 21: %u Segmente", done);
+    segment_store_gap(&store, done);
+    CHECK(store.count == before, "%u Segmente nach dem Verwerfen", store.count);
+    CHECK(store.trig.state == TRIGGER_ARMED && store.trig.seen == 0, "Trigger neu scharf");
+}
+
+// Nach 2^32 Samples (2,4 h bei 500 kS/s) darf der Zähler nicht auf 0
+// springen, sonst wartet der Trigger Vorgeschichte und Holdoff neu ab.
+static void test_seen_saturates(void) {
+    segment_store_t store;
+    uint16_t block[PERIOD];
+    setup(&store);
+
+    for (uint32_t i = 0; i < PERIOD; i++)
+        block[i] = sample(i);
+    segment_store_feed(&store, block, 0, PULSE_AT);
+    store.trig.seen = UINT32_MAX - 10;
+
+    uint64_t base = 1000ull * PERIOD;   // entspricht einem späten Index
+    segment_store_feed(&store, block, base, PULSE_AT);
+    CHECK(store.trig.seen == UINT32_MAX, "seen = %u", store.trig.seen);
+    uint32_t done = segment_store_feed(&store, block + PULSE_AT, base + PULSE_AT, POST);
+    CHECK(done == 1, "Trigger nach Zählerende: %u Segmente", done);
+    CHECK(store.count == 1 && store.trigger_seq[0] == base + PULSE_AT, "Trigger %llu",
+          (unsigned long long)store.trigger_seq[0]);
+}
+
+int main(void) {
+    test_continuous();
+    test_lost_block();
+    test_seen_saturates();
+    return check_summary();
+}
@@ -0,0 +1,74 @@
+"""Sollwertsprünge von laser_control: Sprung auf die Umkehrung der Kennlinie
+gegen den ratenbegrenzten Regler allein (laser_control_pid_only, gebaut mit
+SETPOINT_JUMP=0).
+
+Beide Programme laden dieselbe Kalibrierung aus einem vorherigen Lauf,
+Nachkalibrierung ist aus. Gemessen wird je Sprung die Zeit bis zum letzten
+Regelschritt außerhalb von +-5 mV:
+
+    ab Befehl       ab der Skriptzeit des Befehls; enthält die serielle
+                    Eingabe (ein Zeichen pro Regelschritt)
+    ab Übernahme    ab dem ersten Regelschritt nach "OK: Sollwert"
+"""
+
+import os
+import tempfile
+
+import simrun
+
+BAND_MV = 5.0
+JUMP_MAX_MS = 5.0
+STEPS = [(2400, 330), (2700, 100), (3000, 250), (3300, 150), (3600, 300), (3900, 120)]
+
+
+def settle_times(out):
+    """(ab Befehl, ab Übernahme) in ms je Sprung aus den Zeilen "t_us, mV, Tastgrad"."""
+    windows = []
+    laser_on = False
+    for line in out.splitlines():
+        if line.startswith("OK: Laser_an"):
+            laser_on = True
+        elif line.startswith("OK: Sollwert") and laser_on:
+            windows.append([])
+        elif windows:
+            rows = simrun.csv_rows(line, 3)
+            if rows:
+                windows[-1].append(rows[0])
+    simrun.check(len(windows) == len(STEPS), "%d Sprünge gefunden" % len(windows))
+
+    times = []
+    for (t_cmd, setpoint), rows in zip(STEPS, windows):
+        outside = [r[0] for r in rows if abs(r[1] - setpoint) > BAND_MV]
+        end_us = outside[-1] + 1000.0 if outside else rows[0][0]
+        times.append(((end_us - t_cmd * 1000.0) / 1000.0, (end_us - rows[0][0]) / 1000.0))
+    return times
+
+
+with tempfile.TemporaryDirectory() as tmp:
+    flash = os.path.join(tmp, "flash.bin")
+    simrun.run("laser_control", script=[(100, "")], duration_ms=2500,
+               env={"SIM_FLASH_FILE": flash})
+    script = [(100, ""), (2050, "recal aus"), (2060, "set 200"), (2100, "an")]
+    script += [(t, "set %d" % mv) for t, mv in STEPS]
+    results = {}
+    for program in ("laser_control", "laser_control_pid_only"):
+        out, err = simrun.run(program, script=script, duration_ms=4200,
+                              env={"SIM_FLASH_FILE": flash})
+        simrun.check("Keine gültige Kalibrierung" not in out,
+                     "%s: Kalibrierung nicht aus dem Flash geladen" % program)
+        results[program] = settle_times(out)
+
+print("Sprung          Sprung auf Kennlinie        nur Regler")
+print("                ab Befehl  ab Übernahme     ab Befehl  ab Übernahme")
+prev = 200
+for k, (t_cmd, setpoint) in enumerate(STEPS):
+    jump = results["laser_control"][k]
+    pid = results["laser_control_pid_only"][k]
+    print("%3d -> %3d mV   %6.1f ms  %6.1f ms        %6.1f ms  %6.1f ms"
+          % (prev, setpoint, jump[0], jump[1], pid[0], pid[1]))
+    simrun.check(jump[1] <= JUMP_MAX_MS, "%d mV: Sprung %.1f ms" % (setpoint, jump[1]))
+    simrun.check(jump[1] < pid[1], "%d mV: Sprung %.1f ms nicht schneller als Regler %.1f ms"
+                 % (setpoint, jump[1], pid[1]))
+    prev = setpoint
+
+simrun.summary()
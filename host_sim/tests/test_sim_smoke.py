@@ -0,0 +1,23 @@
+"""Jedes *_sim-Programm startet, läuft kurz und endet sauber."""
+
+import simrun
+
+PROGRAMS = [
+    "adc_console",
+    "laser_control",
+    "pulse_and_sense",
+    "pulse_and_sense_pwm",
+    "pwm-pulse",
+    "pwm_sweep",
+    "round_trip",
+    "round_trip_verbose",
+]
+
+for program in PROGRAMS:
+    out, err = simrun.run(program, duration_ms=1500)
+    simrun.check("FEHLER" not in out, "%s meldet: %s" % (program, out[-500:]))
+    # pulse_and_sense pulst per PIO statt PWM
+    simrun.check("PWM:" in out or program == "pulse_and_sense",
+                 "%s: keine PWM-Zeile" % program)
+
+simrun.summary()
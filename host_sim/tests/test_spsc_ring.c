@@ -0,0 +1,139 @@
+// test_spsc_ring.c
+// Stresstest des SPSC-Rings (spsc_ring.c) mit zwei Threads.
+//
+// Der Produzent schreibt fortlaufende Nummern samt Prüfmuster in die Slots
+// und verwirft eine Nummer, wenn der Ring voll ist. Der Konsument prüft:
+// Nummern streng steigend, Slot-Inhalt vollständig (kein halb geschriebener
+// Slot sichtbar), Lücken = verworfene Nummern = spsc_ring_overflows().
+// Ein Lauf startet kurz vor dem Überlauf der 32-Bit-Zähler.
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#include "check.h"
+#include "spsc_ring.h"
+
+#define SLOT_WORDS 16
+#define SLOT_COUNT 8
+#define MESSAGES 500000u
+
+typedef struct {
+    spsc_ring_t ring;
+    uint32_t storage[SLOT_COUNT * SLOT_WORDS];
+    uint32_t dropped;       // nur Produzent
+    volatile bool done;
+    uint32_t produce_work;  // Rechenschritte zwischen zwei Nachrichten
+    uint32_t consume_work;  // Rechenschritte des Konsumenten pro Slot
+} stress_t;
+
+static void busy(uint32_t n) {
+    for (volatile uint32_t i = 0; i < n; i++) {
+    }
+}
+
+static void fill(uint32_t *w, uint32_t seq) {
+    w[0] = seq;
+    for (int i = 1; i < SLOT_WORDS; i++)
+        w[i] = seq * 2654435761u + (uint32_t)i;
+}
+
+static void *producer(void *arg) {
+    stress_t *s = arg;
+    for (uint32_t seq = 1; seq <= MESSAGES; seq++) {
+        uint32_t *w = spsc_ring_claim(&s->ring);
+        if (w == NULL) {
+            // Verwerfen und dem Konsumenten Zeit lassen (auch auf einer CPU)
+            s->dropped++;
+            sched_yield();
+            continue;
+        }
+        fill(w, seq);
+        spsc_ring_publish(&s->ring);
+        busy(s->produce_work);
+    }
+    __atomic_store_n(&s->done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void run(const char *name, uint32_t start, uint32_t produce_work, uint32_t consume_work) {
+    static stress_t s;
+    memset(&s, 0, sizeof(s));
+    CHECK(spsc_ring_init(&s.ring, s.storage, SLOT_WORDS * sizeof(uint32_t), SLOT_COUNT), "init");
+    s.ring.head = s.ring.tail = start;
+    s.produce_work = produce_work;
+    s.consume_work = consume_work;
+
+    pthread_t thread;
+    uint64_t t0 = check_now_ns();
+    pthread_create(&thread, NULL, producer, &s);
+
+    uint32_t received = 0, last = 0, gaps = 0, order_errors = 0, torn = 0;
+    uint32_t expect[SLOT_WORDS];
+    for (;;) {
+        const uint32_t *w = spsc_ring_peek(&s.ring);
+        if (w == NULL) {
+            if (__atomic_load_n(&s.done, __ATOMIC_ACQUIRE) && spsc_ring_available(&s.ring) == 0)
+                break;
+            sched_yield();
+            continue;
+        }
+        uint32_t seq = w[0];
+        fill(expect, seq);
+        if (memcmp(w, expect, sizeof(expect)) != 0)
+            torn++;
+        if (seq <= last)
+            order_errors++;
+        else
+            gaps += seq - last - 1;
+        last = seq;
+        received++;
+        spsc_ring_release(&s.ring);
+        busy(s.consume_work);
+    }
+    pthread_join(thread, NULL);
+    uint64_t t1 = check_now_ns();
+
+    uint32_t overflows = spsc_ring_overflows(&s.ring);
+    gaps += MESSAGES - last;    // verworfene Nummern am Ende
+    printf("%s: %u empfangen, %u verworfen, %u Überläufe, %.1f ns pro Nachricht inkl. Wartezeit\n",
+           name, received, s.dropped, overflows, (double)(t1 - t0) / MESSAGES);
+    CHECK(received > 0, "%s: nichts empfangen", name);
+    if (consume_work > produce_work)
+        CHECK(s.dropped > 0, "%s: langsamer Konsument ohne Überlauf", name);
+    CHECK(order_errors == 0, "%s: %u Nummern nicht aufsteigend", name, order_errors);
+    CHECK(torn == 0, "%s: %u Slots unvollständig", name, torn);
+    CHECK(received + s.dropped == MESSAGES, "%s: %u + %u != %u", name, received, s.dropped, MESSAGES);
+    CHECK(gaps == s.dropped, "%s: %u Lücken, %u verworfen", name, gaps, s.dropped);
+    CHECK(overflows == s.dropped, "%s: %u Überläufe, %u verworfen", name, overflows, s.dropped);
+    CHECK(s.ring.head == start + received && s.ring.tail == start + received,
+          "%s: head/tail %u/%u", name, s.ring.head - start, s.ring.tail - start);
+}
+
+int main(void) {
+    // Einzel-Thread: Parameter, voll, leer, Überlaufzähler
+    static uint32_t storage[2 * SLOT_WORDS];
+    spsc_ring_t ring;
+    CHECK(!spsc_ring_init(&ring, NULL, 4, 2), "init ohne Speicher");
+    CHECK(!spsc_ring_init(&ring, storage, 0, 2), "init ohne Slotgröße");
+    CHECK(!spsc_ring_init(&ring, storage, 4, 0), "init ohne Slots");
+    CHECK(!spsc_ring_init(&ring, storage, 4, 3), "init mit 3 Slots (keine Zweierpotenz)");
+    CHECK(!spsc_ring_init(&ring, storage, 4, 24), "init mit 24 Slots (keine Zweierpotenz)");
+    CHECK(spsc_ring_init(&ring, storage, 4, 1), "init mit 1 Slot");
+    CHECK(spsc_ring_init(&ring, storage, SLOT_WORDS * 4, 2), "init");
+    CHECK(spsc_ring_peek(&ring) == NULL, "leerer Ring liefert Slot");
+    for (int i = 0; i < 2; i++) {
+        CHECK(spsc_ring_claim(&ring) != NULL, "claim %d", i);
+        spsc_ring_publish(&ring);
+    }
+    CHECK(spsc_ring_claim(&ring) == NULL && spsc_ring_overflows(&ring) == 1, "voller Ring");
+    CHECK(spsc_ring_available(&ring) == 2, "available %u", spsc_ring_available(&ring));
+    spsc_ring_peek(&ring);
+    spsc_ring_release(&ring);
+    CHECK(spsc_ring_claim(&ring) != NULL && spsc_ring_overflows(&ring) == 1, "Slot wieder frei");
+
+    run("schneller Konsument", 0, 200, 0);
+    run("langsamer Konsument", 0, 100, 150);
+    run("Zählerüberlauf", UINT32_MAX - 1000u, 100, 150);
+    return check_summary();
+}
@@ -0,0 +1,108 @@
+"""Telemetrie-Frames zwischen common/telemetry.c und telemetry.py.
+
+C -> Python: telemetry_codec encode liefert Frames mit Textzeilen dazwischen;
+FrameParser muss sie bei beliebiger Stückelung, mit CRC-Fehlern und Müll im
+Strom wiederfinden.
+Python -> C: encode_frame() kodiert dieselben Testframes, telemetry_codec
+decode prüft Felder, Samples und CRC.
+"""
+
+import os
+import random
+import subprocess
+import sys
+
+import simrun
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "..", "oszi_visualizer_live"))
+import telemetry  # noqa: E402
+
+CODEC = os.path.join(simrun.build_dir(), "telemetry_codec")
+
+# Wie test_frame() in telemetry_codec.c
+FRAME_COUNTS = [0, 1, 2, 3, 7, 64, 511, 512]
+
+
+def test_frame(f):
+    count = FRAME_COUNTS[f]
+    samples = [(f * 977 + k * 131) & 0x0FFF for k in range(count)]
+    if count > 1:
+        samples[0] = 0x0FFF
+        samples[-1] = 0
+    return dict(frame_type=1 + f % 3, seq=(65532 + f) & 0xFFFF, aux=(f * 4099) & 0xFFFF,
+                timestamp_ns=(1 << 40) + f * 1000000007,
+                sample_period_ps=0 if f % 4 == 3 else 2000000 + f, samples=samples)
+
+
+def check_frame(frame, f):
+    t = test_frame(f)
+    simrun.check(frame.version == telemetry.VERSION, "Frame %d: Version %d" % (f, frame.version))
+    simrun.check(frame.type == t["frame_type"], "Frame %d: Typ %d" % (f, frame.type))
+    simrun.check(frame.seq == t["seq"], "Frame %d: seq %d" % (f, frame.seq))
+    simrun.check(frame.aux == t["aux"], "Frame %d: Zusatzwert %d" % (f, frame.aux))
+    simrun.check(frame.timestamp_us == t["timestamp_ns"] / 1000.0, "Frame %d: Zeitstempel" % f)
+    simrun.check(frame.sample_period_us == t["sample_period_ps"] / 1e6, "Frame %d: Periode" % f)
+    simrun.check(frame.samples == t["samples"], "Frame %d: Samples" % f)
+
+
+def parse(stream, chunk_sizes):
+    parser = telemetry.FrameParser()
+    items = []
+    pos = 0
+    while pos < len(stream):
+        n = chunk_sizes()
+        items += parser.feed(stream[pos:pos + n])
+        pos += n
+    frames = [item for kind, item in items if kind == "frame"]
+    lines = [item for kind, item in items if kind == "line"]
+    return parser, frames, lines
+
+
+# -------------------------
+#  C -> Python
+# -------------------------
+c_stream = subprocess.run([CODEC, "encode"], capture_output=True, check=True).stdout
+rng = random.Random(1)
+for name, chunks in (("am Stück", lambda: len(c_stream)),
+                     ("byteweise", lambda: 1),
+                     ("zufällig", lambda: rng.randint(1, 700))):
+    parser, frames, lines = parse(c_stream, chunks)
+    simrun.check(len(frames) == len(FRAME_COUNTS), "%s: %d Frames" % (name, len(frames)))
+    for f, frame in enumerate(frames):
+        check_frame(frame, f)
+    simrun.check(lines == ["Frame %d" % f for f in range(len(FRAME_COUNTS))],
+                 "%s: Textzeilen %r" % (name, lines[:4]))
+    simrun.check(parser.crc_errors == 0, "%s: %d CRC-Fehler" % (name, parser.crc_errors))
+    simrun.check(parser.lost_frames == 0, "%s: %d verlorene Frames" % (name, parser.lost_frames))
+
+# CRC-Fehler und Resynchronisation: Frame 4 (7 Samples) verfälschen, Müll
+# samt falschem Sync-Wort vor Frame 6 einfügen
+starts = [c_stream.index(b"Frame %d\n" % f) + len(b"Frame %d\n" % f) for f in range(len(FRAME_COUNTS))]
+broken = bytearray(c_stream)
+broken[starts[4] + telemetry.HEADER_LEN + 2] ^= 0x10
+broken[starts[6] - len(b"Frame 6\n"):starts[6] - len(b"Frame 6\n")] = b"\xa5\x5a\x02\x01xyz\xa5"
+parser, frames, lines = parse(bytes(broken), lambda: rng.randint(1, 300))
+seqs = [frame.seq for frame in frames]
+expected = [test_frame(f)["seq"] for f in range(len(FRAME_COUNTS)) if f != 4]
+simrun.check(seqs == expected, "Resync: seq %r, erwartet %r" % (seqs, expected))
+for frame in frames:
+    check_frame(frame, [test_frame(f)["seq"] for f in range(len(FRAME_COUNTS))].index(frame.seq))
+simrun.check(parser.crc_errors >= 2, "Resync: %d CRC-Fehler" % parser.crc_errors)
+simrun.check(parser.lost_frames == 1, "Resync: %d verlorene Frames" % parser.lost_frames)
+simrun.check(any(line.endswith("Frame 6") for line in lines), "Resync: Textzeile nach dem Müll fehlt")
+
+# -------------------------
+#  Python -> C
+# -------------------------
+py_stream = b"".join(telemetry.encode_frame(**test_frame(f)) for f in range(len(FRAME_COUNTS)))
+proc = subprocess.run([CODEC, "decode"], input=py_stream, capture_output=True)
+print(proc.stdout.decode("utf-8", "replace"), end="")
+simrun.check(proc.returncode == 0, "telemetry_codec decode: Exit-Code %d" % proc.returncode)
+
+# Der C-Decoder muss einen verfälschten Frame ablehnen
+bad = bytearray(telemetry.encode_frame(**test_frame(3)))
+bad[-3] ^= 0x01
+proc = subprocess.run([CODEC, "decode"], input=bytes(bad), capture_output=True)
+simrun.check(proc.returncode != 0, "telemetry_codec decode: verfälschter Frame akzeptiert")
+
+simrun.summary()
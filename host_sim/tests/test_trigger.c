@@ -0,0 +1,217 @@
+// test_trigger.c
+// Trigger mit Vorgeschichte (trigger.c) an synthetischen Sample-Strömen:
+// Fensterinhalt und -lage, Auslösen erst mit voller Vorgeschichte,
+// Hysterese für steigende und fallende Flanken, Holdoff ab dem
+// Scharfschalten, trigger_rearm() ohne Totzeit, externe Ereignisse und
+// ungültige Konfigurationen (auch pre + post mit 32-Bit-Überlauf).
+
+#include "check.h"
+#include "trigger.h"
+
+#define CAPACITY 64
+#define STREAM 4096
+
+static uint16_t ring[CAPACITY];
+static uint16_t window[CAPACITY];
+static uint16_t stream[STREAM];
+
+static trigger_config_t config(trigger_mode_t mode, uint16_t level, uint16_t hyst,
+                               uint32_t pre, uint32_t post, uint32_t holdoff) {
+    trigger_config_t cfg = { mode, level, hyst, pre, post, holdoff };
+    return cfg;
+}
+
+// Signal mit Index als Wert: am Fensterinhalt ist die Lage ablesbar
+static void make_ramp(void) {
+    for (uint32_t i = 0; i < STREAM; i++)
+        stream[i] = (uint16_t)i;
+}
+
+// Fenster muss genau die Samples ab `first` in Folge enthalten
+static void check_window(const trigger_t *trig, uint32_t first, const char *what) {
+    trigger_copy_window(trig, window);
+    uint32_t bad = 0;
+    for (uint32_t k = 0; k < trig->len; k++)
+        if (window[k] != stream[first + k])
+            bad++;
+    CHECK(bad == 0 && trigger_window_seq(trig) == first, "%s: Fenster ab %llu, %u Samples falsch",
+          what, (unsigned long long)trigger_window_seq(trig), bad);
+}
+
+static void test_pre_history(void) {
+    trigger_t trig;
+    trigger_config_t cfg = config(TRIGGER_ABOVE, 100, 0, 8, 8, 0);
+    CHECK(trigger_init(&trig, &cfg, ring, CAPACITY), "Init");
+    trigger_arm(&trig);
+    make_ramp();
+
+    // Schwelle ab Sample 100 überschritten, Vorgeschichte längst voll
+    uint32_t used = trigger_feed(&trig, stream, 0, 300);
+    CHECK(trigger_done(&trig) && trig.trigger_seq == 100, "Trigger bei %llu",
+          (unsigned long long)trig.trigger_seq);
+    CHECK(used == 108, "%u Samples verbraucht statt 108", used);
+    CHECK(trigger_feed(&trig, stream + used, used, 10) == 0, "nimmt nach dem Fenster noch an");
+    check_window(&trig, 92, "Vorgeschichte");
+
+    // Schwelle gleich erfüllt: erst mit voller Vorgeschichte auslösen,
+    // auch in kleinen Stücken eingespeist
+    trigger_arm(&trig);
+    for (uint32_t i = 0; i < STREAM; i++)
+        stream[i] = (uint16_t)(1000 + i);
+    uint32_t pos = 0;
+    while (!trigger_done(&trig) && pos < 100)
+        pos += trigger_feed(&trig, stream + pos, pos, 3);
+    CHECK(trig.trigger_seq == 8 && pos == 16, "Trigger bei %llu, %u verbraucht",
+          (unsigned long long)trig.trigger_seq, pos);
+    check_window(&trig, 0, "Vorgeschichte in Stücken");
+}
+
+static void test_hysteresis(void) {
+    trigger_t trig;
+
+    // Steigend: 950 liegt nicht unter 1000 - 100, der Sprung auf 1100
+    // löst daher nicht aus; erst nach 850 wieder
+    trigger_config_t cfg = config(TRIGGER_RISING, 1000, 100, 4, 4, 0);
+    CHECK(trigger_init(&trig, &cfg, ring, CAPACITY), "Init steigend");
+    trigger_arm(&trig);
+    for (uint32_t i = 0; i < 200; i++)
+        stream[i] = i < 20 ? 950 : i < 40 ? 1100 : i < 60 ? 950 : i < 80 ? 850 : i < 90 ? 990 : 1000;
+    trigger_feed(&trig, stream, 0, 200);
+    CHECK(trigger_done(&trig) && trig.trigger_seq == 90, "steigend: Trigger bei %llu",
+          (unsigned long long)trig.trigger_seq);
+
+    // Fallend spiegelbildlich
+    cfg = config(TRIGGER_FALLING, 1000, 100, 4, 4, 0);
+    CHECK(trigger_init(&trig, &cfg, ring, CAPACITY), "Init fallend");
+    trigger_arm(&trig);
+    for (uint32_t i = 0; i < 200; i++)
+        stream[i] = i < 20 ? 1050 : i < 40 ? 900 : i < 60 ? 1050 : i < 80 ? 1150 : i < 90 ? 1010 : 1000;
+    trigger_feed(&trig, stream, 0, 200);
+    CHECK(trigger_done(&trig) && trig.trigger_seq == 90, "fallend: Trigger bei %llu",
+          (unsigned long long)trig.trigger_seq);
+
+    // Rauschen um die Schwelle innerhalb der Hysterese: genau ein Fenster
+    // pro Durchgang durch den Gegenbereich
+    cfg = config(TRIGGER_RISING, 1000, 100, 4, 4, 0);
+    CHECK(trigger_init(&trig, &cfg, ring, CAPACITY), "Init Rauschen");
+    trigger_arm(&trig);
+    for (uint32_t i = 0; i < 400; i++)
+        stream[i] = (uint16_t)((i < 10 || (i >= 200 && i < 210) ? 800 : 960) + (i % 2) * 80);
+    uint32_t fired = 0, pos = 0;
+    while (pos < 400) {
+        pos += trigger_feed(&trig, stream + pos, pos, 400 - pos);
+        if (trigger_done(&trig)) {
+            fired++;
+            trigger_rearm(&trig);
+        }
+    }
+    CHECK(fired == 2, "Rauschen an der Schwelle: %u Fenster statt 2", fired);
+}
+
+static void test_holdoff_and_rearm(void) {
+    trigger_t trig;
+    trigger_config_t cfg = config(TRIGGER_ABOVE, 0, 0, 4, 4, 50);
+    CHECK(trigger_init(&trig, &cfg, ring, CAPACITY), "Init");
+    make_ramp();
+
+    // Holdoff ab dem Scharfschalten (Index des Stroms beliebig)
+    trigger_arm(&trig);
+    uint32_t base = 1000;
+    uint32_t used = trigger_feed(&trig, stream + base, base, 500);
+    CHECK(trig.trigger_seq == base + 50 && used == 54, "Holdoff: Trigger bei %llu, %u verbraucht",
+          (unsigned long long)trig.trigger_seq, used);
+    check_window(&trig, base + 46, "Holdoff");
+
+    // rearm: Holdoff zählt ab dem Beginn des letzten Fensters (46), also
+    // nächster Trigger bei 46 + 50 = 96; der Ring enthält nahtlos den
+    // Nachlauf des vorigen Fensters
+    trigger_rearm(&trig);
+    uint32_t pos = base + used;
+    used = trigger_feed(&trig, stream + pos, pos, 500);
+    CHECK(trig.trigger_seq == base + 96, "rearm: Trigger bei %llu statt %u",
+          (unsigned long long)trig.trigger_seq, base + 96);
+    check_window(&trig, base + 92, "rearm");
+
+    // Ohne Holdoff löst rearm sofort beim nächsten Sample aus; das Fenster
+    // überlappt mit dem Nachlauf des vorigen
+    cfg.holdoff = 0;
+    CHECK(trigger_init(&trig, &cfg, ring, CAPACITY), "Init ohne Holdoff");
+    trigger_arm(&trig);
+    pos = 0;
+    for (uint32_t w = 0; w < 5; w++) {
+        pos += trigger_feed(&trig, stream + pos, pos, 100);
+        CHECK(trigger_done(&trig), "Fenster %u nicht fertig", w);
+        uint32_t want = w == 0 ? 4 : 4 + 4 * w;
+        CHECK(trig.trigger_seq == want, "Fenster %u: Trigger bei %llu statt %u", w,
+              (unsigned long long)trig.trigger_seq, want);
+        check_window(&trig, want - 4, "ohne Totzeit");
+        trigger_rearm(&trig);
+    }
+
+    // trigger_arm verwirft die Vorgeschichte: wieder pre Samples warten
+    trigger_arm(&trig);
+    trigger_feed(&trig, stream + pos, pos, 100);
+    CHECK(trig.trigger_seq == pos + 4, "arm: Trigger bei %llu statt %u",
+          (unsigned long long)trig.trigger_seq, pos + 4);
+}
+
+static void test_external(void) {
+    trigger_t trig;
+    trigger_config_t cfg = config(TRIGGER_EXTERNAL, 0, 0, 8, 8, 0);
+    CHECK(trigger_init(&trig, &cfg, ring, CAPACITY), "Init");
+    make_ramp();
+
+    // Ohne Ereignis kein Auslösen
+    trigger_arm(&trig);
+    CHECK(trigger_feed(&trig, stream, 0, 100) == 100 && !trigger_done(&trig), "ohne Ereignis ausgelöst");
+
+    // Ereignis in der Zukunft, auch zwischen zwei Stücken
+    trigger_external(&trig, 130);
+    trigger_feed(&trig, stream + 100, 100, 20);
+    CHECK(!trigger_done(&trig), "vor dem Ereignis ausgelöst");
+    trigger_feed(&trig, stream + 120, 120, 100);
+    CHECK(trig.trigger_seq == 130, "extern: Trigger bei %llu", (unsigned long long)trig.trigger_seq);
+    check_window(&trig, 122, "extern");
+
+    // Ereignis vor voller Vorgeschichte: bei Sample pre
+    trigger_arm(&trig);
+    trigger_external(&trig, 2);
+    trigger_feed(&trig, stream, 0, 100);
+    CHECK(trig.trigger_seq == 8, "extern früh: Trigger bei %llu", (unsigned long long)trig.trigger_seq);
+
+    // Vorrang vor der Schwelle in einer Pegel-Betriebsart
+    cfg = config(TRIGGER_BELOW, 0, 0, 8, 8, 0);
+    CHECK(trigger_init(&trig, &cfg, ring, CAPACITY), "Init tief");
+    trigger_arm(&trig);
+    trigger_external(&trig, 40);
+    trigger_feed(&trig, stream + 1, 1, 100);
+    CHECK(trig.trigger_seq == 40, "extern vor Schwelle: Trigger bei %llu",
+          (unsigned long long)trig.trigger_seq);
+}
+
+static void test_invalid(void) {
+    trigger_t trig;
+    trigger_config_t cfg = config(TRIGGER_RISING, 100, 0, 8, 0, 0);
+    CHECK(!trigger_init(&trig, &cfg, ring, CAPACITY), "post = 0");
+    cfg = config(TRIGGER_RISING, 100, 0, 8, 8, 0);
+    CHECK(!trigger_init(&trig, &cfg, NULL, CAPACITY), "kein Speicher");
+    cfg = config(TRIGGER_RISING, 100, 0, CAPACITY - 7, 8, 0);
+    CHECK(!trigger_init(&trig, &cfg, ring, CAPACITY), "pre + post > Kapazität");
+    cfg = config(TRIGGER_RISING, 100, 0, CAPACITY - 8, 8, 0);
+    CHECK(trigger_init(&trig, &cfg, ring, CAPACITY), "pre + post = Kapazität");
+
+    // pre + post läuft in 32 Bit auf einen kleinen Wert über
+    cfg = config(TRIGGER_RISING, 100, 0, UINT32_MAX, 2, 0);
+    CHECK(!trigger_init(&trig, &cfg, ring, CAPACITY), "pre = 2^32 - 1, post = 2");
+    cfg = config(TRIGGER_RISING, 100, 0, 2, UINT32_MAX, 0);
+    CHECK(!trigger_init(&trig, &cfg, ring, CAPACITY), "pre = 2, post = 2^32 - 1");
+}
+
+int main(void) {
+    test_pre_history();
+    test_hysteresis();
+    test_holdoff_and_rearm();
+    test_external();
+    test_invalid();
+    return check_summary();
+}
@@ -5,25 +5,85 @@
 #include "hardware/gpio.h"
 #include "hardware/adc.h"
 #include "hardware/pwm.h" // PWM-Header hinzufügen
+#include "hardware/sync.h"
 #include "pico/time.h" // Zeitfunktionen hinzufügen
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
-
-#define NUM_SAMPLES 20
+#include "adc_capture.h"
+#include "adaptive_sweep.h"
+#include "cal_store.h"
+#include "fixed_point.h"
+#include "lockin.h"
+#include "pid.h"
+#include "pwm_timing.h"
+#include "reaction_map.h"
+#include "telemetry.h"
+
+#define NUM_SAMPLES 500 // Samples pro DMA-Block = eine PWM-Periode bei 1 kHz und 500 kS/s
+#define CAPTURE_BLOCKS 4 // Blöcke im Erfassungs-Ring
+// Round-Robin ADC0 (Photodiode) / TEMP_INPUT (Temperatur): im Block liegen
+// die Photodiode auf geraden, die Temperatur auf ungeraden Indizes
+#define TEMP_INPUT 4 // interner Sensor; externer Fühler an ADC1..3: temp_from_mv() anpassen
+#define SIGNAL_SAMPLES (NUM_SAMPLES / 2) // Photodioden-Samples pro Block
+#define TEMP_FILTER_SHIFT 4 // Glättung der Temperatur: 2^-4 pro Block
 #define THRESHOLD 200 // Schwellwert für Flankenerkennung 4096 enspricht 3.3V
 // 600mV entsprechen 744 ADC-Wert bei 12 Bit Auflösung
 #define SAMPLES_PER_STEP 1500
-#define VperDev 0.806f
-#define START_DUTY_CYCLE 0.05f
+#define SETTLE_MS 20
+#define PWM_FREQ_HZ 1000
+#define START_DUTY_CYCLE Q16_CONST(0.05)
 #define MAX_DUTY_CYCLE 100
 
-
-#define pwm_min 0.01f // Untere Grenze für PWM
-#define pwm_max 0.50f // Obere Grenze für PWM
-#define pwm_step 0.01f // Schrittweite für PWM-Anpassung
-#define response_tolerance 25.0f // einstellbar (ADC units*VperDev)
+// Adaptiver Sweep (adaptive_sweep.h): grobes Raster, Verfeinerung bis 1 %
+#define ADAPTIVE_COARSE_POINTS 11
+#define ADAPTIVE_SETTLE_TOL_MV Q16_CONST(1.0)
+#define ADAPTIVE_SETTLE_BLOCKS 2
+#define ADAPTIVE_MAX_BLOCKS 20
+#define ADAPTIVE_REFINE_TOL_MV Q16_CONST(1.0)
+#define ADAPTIVE_MAX_DELTA_MV Q16_CONST(100.0)
+
+// Kennlinienfeld Tastgrad x Temperatur (reaction_map.h): Zeilen alle 5 °C
+// von 15 bis 65 °C, nachgelernt an eingeschwungenen Arbeitspunkten
+#define MAP_TEMP_MIN_C Q16_CONST(15.0)
+#define MAP_TEMP_STEP_C Q16_CONST(5.0)
+#define MAP_TEMP_ROWS 11
+#define MAP_LEARN_SHIFT 6 // Lernrate 2^-6 pro Regelschritt
+#define LEARN_MAX_STEP Q16_CONST(0.002) // max. Tastgradänderung eines eingeschwungenen Arbeitspunkts
+#define LEARN_STEADY_STEPS 2 // so viele Regelschritte ohne größere Änderung
+#define FEEDFORWARD_UPDATE_STEPS 100 // Vorsteuerung alle 100 Regelschritte nachführen
+
+// Nachkalibrierung im Betrieb ("recal"): alle RECAL_INTERVAL_STEPS
+// Regelschritte ein kurzer Messschritt auf eine Stützstelle des Feldes
+#define RECAL_INTERVAL_STEPS 100
+#define PROBE_SETTLE_BLOCKS 2 // Blöcke nach dem Umschalten verwerfen (PWM übernimmt erst am Periodenende)
+#define RECAL_SHIFT 1 // Gewicht eines Messschritts 2^-1
+
+// Lock-in-Modus ("lockin"): Rückführung ist die Grundwelle der PWM im
+// Photodiodensignal statt des Blockmittels. Ein Block umfasst genau eine
+// PWM-Periode (SIGNAL_SAMPLES Photodioden-Samples), PWM und ADC laufen vom
+// selben Quarz; Umgebungslicht und langsame Drift fallen heraus.
+#define LOCKIN_PERIOD SIGNAL_SAMPLES
+
+// Regelpfad in Q16.16-Festkomma (fixed_point.h): Tastgrad als Anteil 0..1,
+// Spannungen in mV. Der M0+ hat keine FPU.
+#define pwm_min Q16_CONST(0.01) // Untere Grenze für PWM
+#define pwm_max Q16_CONST(0.50) // Obere Grenze für PWM
+
+// PI-Regler im Timer-IRQ, ein Regelschritt pro DMA-Block (= eine PWM-Periode)
+#define CONTROL_PERIOD_US 1000
+#define SETPOINT_DEFAULT_MV 475 // Mitte zwischen lower/upper_avg_threshold
+#define PID_KP Q16_CONST(0.0005) // Tastgrad pro mV Regelabweichung
+#define PID_KI Q16_CONST(0.0003) // Tastgrad pro mV und Regelschritt
+#define PID_KD 0
+#define PID_SLEW Q16_CONST(0.02) // max. Tastgradänderung pro Regelschritt
+// Sollwertsprung direkt auf die Umkehrung der Kennlinie; mit 0 läuft nur
+// der ratenbegrenzte Regler zum neuen Sollwert (Vergleich in host_sim)
+#ifndef SETPOINT_JUMP
+#define SETPOINT_JUMP 1
+#endif
 
 #define lower_avg_threshold 450.0f // Untere Grenze für PWM-Regelung
 #define upper_avg_threshold 500.0f // Obere Grenze für PWM-Regelung
@@ -36,22 +96,102 @@
 // Funktionsprototypen einfügen
 void init_safe_pwm_pin(void);
 void run_pwm_sweep(void);
-void pwm_sweep(float *result_array);
+void pwm_sweep(uint16_t *result_array);
+void pwm_sweep_adaptive(uint16_t *result_array);
 void laser_on(void);
 void laser_off(void);
-void set_pwm_from_float(float pwm);
+void set_pwm_q16(q16_t pwm);
+uint32_t sum_next_blocks(int blocks, uint16_t *last_copy);
+void control_start(void);
+bool load_calibration(uint16_t *table);
+void save_calibration(const uint16_t *table);
+bool control_tick(repeating_timer_t *rt);
+reaction_map_inv_t set_setpoint_mv(int32_t mv);
+void update_feedforward(void);
+void recal_next_probe(void);
+bool lockin_start(void);
 
 // Globals to manage PWM state from multiple functions
 static uint pwm_slice = 0;
 static uint pwm_channel = 0;
+static pwm_timing_t pwm_timing_g;                   // Teiler und wrap für PWM_FREQ_HZ
+static pwm_timing_status_t pwm_timing_status_g;     // OK: Periode exakt (Lock-in)
 static uint16_t pwm_wrap_g = 0;
-static float pwm_clkdiv_g = 0.0f;
-static float current_pwm = START_DUTY_CYCLE;
+static q16_t current_pwm = START_DUTY_CYCLE;
 static bool pwm_enabled = false;
 
-// Reaction table (in RAM) used for measurements
-static float reaction_table[MAX_DUTY_CYCLE + 1];
-static bool reaction_table_ready = false;
+// Reaktionstabelle eines Sweeps bzw. aus dem Flash, in ganzen mV; geht als
+// Zeile der aktuellen Temperatur in das Kennlinienfeld ein
+static uint16_t reaction_table[MAX_DUTY_CYCLE + 1];
+static q16_t reaction_cells[MAP_TEMP_ROWS * (MAX_DUTY_CYCLE + 1)];
+static reaction_map_t reaction_map;
+
+// Geglättete Temperatur in °C, nachgeführt mit jedem ausgewerteten Block
+static volatile q16_t temperature_c = 0;
+static bool temperature_valid = false;
+
+// DMA-Zielpuffer der ADC-Erfassung
+static uint16_t capture_buf[CAPTURE_BLOCKS * NUM_SAMPLES];
+
+// Ausgabeformat: CSV-Zeilen oder Binär-Frames mit den Rohsamples (Befehle "csv" / "bin")
+static telemetry_mode_t telemetry_mode = TELEMETRY_CSV;
+static uint16_t telemetry_seq = 0;
+static uint16_t last_block[SIGNAL_SAMPLES];
+static uint32_t last_block_seq;                 // Blocknummer von last_block (Zeit über adc_capture_sample_time_ns)
+static volatile bool block_requested = false;   // IRQ kopiert den nächsten Block nach last_block
+
+// Regelung: läuft im Timer-IRQ, unabhängig von printf/USB in der Hauptschleife
+typedef struct {
+    uint32_t block_seq;
+    uint64_t t_us;
+    q16_t avg_mv;
+    q16_t pwm;
+    q16_t temp_c;
+} control_status_t;
+
+static pid_q16_t pid;
+static repeating_timer_t control_timer;
+static volatile bool control_active = false;    // aus während eines Sweeps
+static volatile q16_t setpoint_mv = 0;
+static volatile q16_t feedforward_pwm = 0;
+static control_status_t control_status;          // nur mit gesperrten IRQs lesen
+static volatile uint32_t control_count = 0;      // Anzahl Regelschritte
+
+// Messschritte der Nachkalibrierung: der Timer-IRQ stellt den Messpunkt
+// statt des Reglerausgangs ein, verwirft die Blöcke des Umschaltens und
+// misst einen Block; danach gilt wieder der Reglerausgang. Der Regler
+// rechnet währenddessen nicht weiter.
+typedef enum {
+    PROBE_IDLE,
+    PROBE_RUN,          // Messpunkt eingestellt, warten auf probe_wait_seq
+    PROBE_RESTORE,      // Reglerausgang wieder eingestellt, Umschalten abwarten
+} probe_state_t;
+
+typedef struct {
+    q16_t duty;
+    q16_t mv;
+    q16_t temp_c;
+} probe_result_t;
+
+// Nach einem Sollwertsprung setzt der Regler aus, bis die Blöcke mit dem
+// alten Stellwert durch sind (sonst regelt er gegen den Sprung an)
+static bool hold_active = false;
+static uint32_t hold_seq;
+
+static int16_t lockin_lut[2 * LOCKIN_PERIOD];
+static lockin_t lockin;
+static volatile bool lockin_active = false;
+static volatile q16_t lockin_dark_mv;            // Dunkelsignal laut Kennlinienfeld
+
+static volatile bool recal_active = false;
+static probe_state_t probe_state = PROBE_IDLE;
+static uint32_t probe_wait_seq;                  // erster Block nach dem Umschalten
+static uint32_t probe_countdown = 0;
+static volatile q16_t probe_duty;                // nächster Messpunkt (Hauptschleife)
+static probe_result_t probe_result;              // gültig, solange probe_ready
+static volatile bool probe_ready = false;
+static int recal_index;                          // Stützstelle von probe_duty
+static uint32_t recal_passes = 0;
 
 
 int main(void) {
@@ -63,27 +203,41 @@ int main(void) {
     // ADC Setup
     adc_init();
     adc_gpio_init(26);
+#if TEMP_INPUT < 4
+    adc_gpio_init(26 + TEMP_INPUT);
+#endif
     adc_select_input(0);
 
-    const float sys_clk = 125000000;
-    float freq = 1000.0f;
-    float clkdiv = 125.0f;
-    uint16_t wrap = (uint16_t)((sys_clk / clkdiv) / freq) - 1;
+    // ADC läuft frei mit 500 kS/s abwechselnd auf Photodiode und
+    // Temperatur, DMA füllt den Ring blockweise
+    adc_capture_config_t capture_cfg = {
+        .input = 0,
+        .round_robin = 1u << TEMP_INPUT,
+        .clkdiv = 0.0f,
+        .buffer = capture_buf,
+        .block_len = NUM_SAMPLES,
+        .block_count = CAPTURE_BLOCKS,
+    };
+    adc_capture_init(&capture_cfg);
+    adc_capture_start();
+    printf("Abtastung: %.3f Hz (Periode %lu ps)\n",
+           1e12 / adc_capture_sample_period_ps(), adc_capture_sample_period_ps());
+
+    // Feinste Auflösung bei PWM_FREQ_HZ für den aktuellen Systemtakt;
+    // der Lock-in braucht eine exakte Periode
+    pwm_timing_status_g = pwm_timing_for_freq(PWM_FREQ_HZ, MAX_DUTY_CYCLE + 1, 0, &pwm_timing_g);
     // store globals for helper functions
     pwm_slice = pwm_gpio_to_slice_num(PWM_GPIO);
     pwm_channel = pwm_gpio_to_channel(PWM_GPIO);
-    pwm_wrap_g = wrap;
-    pwm_clkdiv_g = clkdiv;
-    
-    float pwm = START_DUTY_CYCLE;
+    pwm_wrap_g = pwm_timing_g.wrap;
 
-    sleep_ms(1000); // Warten bis USB-Serial bereit
 
-    uint16_t samples[NUM_SAMPLES];
+    sleep_ms(1000); // Warten bis USB-Serial bereit
+    pwm_timing_report(PWM_FREQ_HZ, pwm_timing_status_g, &pwm_timing_g);
 
-    // Reaction table (im RAM) wird zu Beginn erstellt
-    // (global: reaction_table)
-    reaction_table_ready = false;
+    // Kennlinienfeld: leer, die erste Zeile kommt aus Flash oder Sweep
+    reaction_map_init(&reaction_map, reaction_cells, MAX_DUTY_CYCLE + 1, MAP_TEMP_ROWS,
+                      MAP_TEMP_MIN_C, MAP_TEMP_STEP_C, MAP_LEARN_SHIFT);
 
     // serial command buffer
     char cmd_buf[64];
@@ -93,7 +247,7 @@ int main(void) {
 
     while (!startup_done) {
         // Gebe jede Sekunde eine Nachricht aus
-        printf("Commands: an, aus, sweep\n");
+        printf("Commands: an, aus, sweep, sweep voll, recal, recal aus, lockin, lockin aus, csv, bin, set <mV>, temp\n");
         sleep_ms(1000);  // Eine Sekunde warten
 
         // Warten auf Eingabe von Enter (Carriage Return oder Line Feed)
@@ -103,65 +257,77 @@ int main(void) {
         }
     }
 
-    // Erstelle die Reaktionstabelle zu Beginn im RAM
-    printf("Erstelle Reaktionstabelle (Sweep) im RAM...\n");
-    pwm_sweep(reaction_table);
-    reaction_table_ready = true;
-    printf("Reaktionstabelle erstellt.\n");
+    // Reaktionstabelle aus dem Flash laden, nur ohne gültige Kalibrierung neu
+    // messen. Der Datensatz enthält keine Temperatur; er gilt für die
+    // Temperatur beim Start, Abweichungen lernt das Feld im Betrieb nach.
+    if (!load_calibration(reaction_table)) {
+        printf("Erstelle Reaktionstabelle (Sweep) im RAM...\n");
+        pwm_sweep_adaptive(reaction_table);
+        printf("Reaktionstabelle erstellt.\n");
+        save_calibration(reaction_table);
+    }
+    sum_next_blocks(1, NULL);   // Temperatur messen
+    reaction_map_set_row(&reaction_map, temperature_c, reaction_table);
+
+    pid_init(&pid, PID_KP, PID_KI, PID_KD, pwm_min, pwm_max, PID_SLEW);
+    set_setpoint_mv(SETPOINT_DEFAULT_MV);
+    control_start();
+    // Negative Periode: feste Rate, gemessen von Aufruf zu Aufruf
+    add_repeating_timer_us(-CONTROL_PERIOD_US, control_tick, NULL, &control_timer);
+
+    uint32_t last_count = control_count;
+    q16_t last_pwm = current_pwm;
+    int steady_steps = 0;
+    uint32_t feedforward_steps = 0;
 
     while (1) {   // Dauerschleife
 
-        // Messungenen durchführen
-        for (int i = 0; i < NUM_SAMPLES; i++) {
-            samples[i] = adc_read();
+        // Auf den nächsten Regelschritt warten und dessen Ergebnis ausgeben
+        if (telemetry_mode == TELEMETRY_BINARY)
+            block_requested = true;
+        while (control_count == last_count)
+            tight_loop_contents();
+
+        uint32_t irq = save_and_disable_interrupts();
+        control_status_t status = control_status;
+        last_count = control_count;
+        bool block_valid = !block_requested;
+        restore_interrupts(irq);
+
+        if (telemetry_mode == TELEMETRY_BINARY) {
+            // Rohsamples des Blocks, PWM in Promille als Zusatzwert
+            if (block_valid)
+                telemetry_send(TELEMETRY_FRAME_SAMPLES, telemetry_seq++,
+                               (uint16_t)q16_mul_int_round(status.pwm, 1000),
+                               adc_capture_sample_time_ns((uint64_t)last_block_seq * NUM_SAMPLES),
+                               2 * adc_capture_sample_period_ps(), last_block, SIGNAL_SAMPLES);
+        } else {
+            long avg_c = q16_mul_int_round(status.avg_mv, 100);
+            long pwm_c = q16_mul_int_round(status.pwm, 100);
+            printf("%lu, %ld.%02ld, %ld.%02ld\n", (uint32_t)status.t_us,
+                   avg_c / 100, avg_c % 100, pwm_c / 100, pwm_c % 100);
         }
 
-        // Berechnung der durchschnittlichen Amplitude
-        float avg_an = 0.0f;
-        float sum_an = 0.0f;
-        for (int i = 0; i < NUM_SAMPLES; i++) {
-            sum_an += samples[i];
+        // Eingeschwungene Arbeitspunkte ins Kennlinienfeld einrechnen und die
+        // Vorsteuerung regelmäßig auf Feld und Temperatur nachführen
+        q16_t dpwm = status.pwm - last_pwm;
+        last_pwm = status.pwm;
+        steady_steps = (dpwm <= LEARN_MAX_STEP && dpwm >= -LEARN_MAX_STEP) ? steady_steps + 1 : 0;
+        if (pwm_enabled && steady_steps >= LEARN_STEADY_STEPS)
+            reaction_map_learn(&reaction_map, status.pwm, status.temp_c, status.avg_mv);
+
+        // Messschritt der Nachkalibrierung lokal einrechnen, nächsten vorgeben
+        if (probe_ready) {
+            probe_result_t r = probe_result;
+            reaction_map_refresh(&reaction_map, r.duty, r.temp_c, r.mv, RECAL_SHIFT);
+            recal_next_probe();
+            probe_ready = false;
         }
-        avg_an = (float)sum_an / NUM_SAMPLES * VperDev;
-
-        // String-Variable, die die formatierte Ausgabe speichert
-        char print_message[100];  // Ein Puffer, um die Nachricht zu speichern
-
-        // === Regelung: Wenn Tabelle vorhanden, vergleiche mit Erwartungswert ===
-        if (reaction_table_ready) {
-            // map current pwm (0..1) to index 0..MAX_DUTY_CYCLE
-            int idx = (int)(pwm * (float)MAX_DUTY_CYCLE + 0.5f);
-            if (idx < 0) idx = 0; if (idx > MAX_DUTY_CYCLE) idx = MAX_DUTY_CYCLE;
-            float expected = reaction_table[idx];
-            
-
-            if (avg_an < expected - response_tolerance) {
-                pwm += pwm_step;
-                if (pwm > pwm_max) pwm = pwm_max;
-                uint16_t new_level = (uint16_t)(wrap * pwm);
-                pwm_set_gpio_level(PWM_GPIO, new_level);
-                snprintf(print_message, sizeof(print_message), "%.2f, PWM erhöht (gemessen %.2f < erwartet %.2f)\n", pwm, avg_an, expected);
-                // printf("%.2f, PWM erhöht (gemessen %.2f < erwartet %.2f)\n", pwm, avg_an, expected);
-            } else if (avg_an > expected - response_tolerance) {
-                pwm -= pwm_step;
-                if (pwm < pwm_min) pwm = pwm_min;
-                uint16_t new_level = (uint16_t)(wrap * pwm);
-                pwm_set_gpio_level(PWM_GPIO, new_level);
-                // Verwende snprintf, um die formatierte Nachricht in den String zu schreiben
-                snprintf(print_message, sizeof(print_message), "%.2f, PWM verringert (gemessen %.2f > erwartet %.2f)\n", pwm, avg_an, expected);
-                //printf("%.2f, PWM verringert (gemessen %.2f > erwartet %.2f)\n", pwm, avg_an, expected);
-            } else {
-                        snprintf(print_message, sizeof(print_message), "%.2f, PWM bleibt (gemessen %.2f ≈ erwartet %.2f)\n", pwm, avg_an, expected);
-                //printf("%.2f, PWM bleibt (gemessen %.2f ≈ erwartet %.2f)\n", pwm, avg_an, expected);
-            }
-        } else {
-            printf("Keine Reaktionstabelle vorhanden! Command 'sweep'\n");
+        if (++feedforward_steps >= FEEDFORWARD_UPDATE_STEPS) {
+            feedforward_steps = 0;
+            update_feedforward();
         }
 
-        // Ausgabe der Ergebnisse
-        //printf("%s", print_message);
-        printf("%lu, %.2f, %.2f\n", time_us_32(), avg_an, pwm);
-
         // --- Serielle Eingabe verarbeiten (nicht-blockierend) ---
         int ch = getchar_timeout_us(0);
         if (ch >= 0) {
@@ -170,16 +336,74 @@ int main(void) {
                     cmd_buf[cmd_idx] = '\0';
                     // process command
                     if (strcmp(cmd_buf, "an") == 0) {
+                        control_start();
                         laser_on();
                         printf("OK: Laser_an\n");
                     } else if (strcmp(cmd_buf, "aus") == 0) {
                         laser_off();
                         printf("OK: Laser_aus\n");
-                    } else if (strcmp(cmd_buf, "sweep") == 0) {
+                    } else if (strcmp(cmd_buf, "sweep") == 0 || strcmp(cmd_buf, "sweep voll") == 0) {
                         printf("Starte manuellen Sweep und aktualisiere Reaktionstabelle im RAM...\n");
-                        pwm_sweep(reaction_table);
-                        reaction_table_ready = true;
+                        // Der Sweep braucht den Laser und die Erfassung exklusiv
+                        control_active = false;
+                        laser_off();
+                        // "sweep voll": klassischer Sweep mit festen Wartezeiten
+                        if (strcmp(cmd_buf, "sweep voll") == 0)
+                            pwm_sweep(reaction_table);
+                        else
+                            pwm_sweep_adaptive(reaction_table);
+                        reaction_map_set_row(&reaction_map, temperature_c, reaction_table);
+                        save_calibration(reaction_table);
+                        set_setpoint_mv(q16_round(setpoint_mv));
+                        control_start();
                         printf("Tabelle nach manuellem Sweep aktualisiert.\n");
+                    } else if (strncmp(cmd_buf, "set ", 4) == 0) {
+                        int mv = atoi(cmd_buf + 4);
+                        if (mv > 0 && mv < 3300) {
+                            reaction_map_inv_t inv = set_setpoint_mv(mv);
+                            long ff_c = q16_mul_int_round(feedforward_pwm, 100);
+                            printf("OK: Sollwert %d mV, Vorsteuerung %ld.%02ld\n", mv, ff_c / 100, ff_c % 100);
+                            if (inv == REACTION_MAP_INV_ABOVE)
+                                printf("WARNUNG: Sollwert laut Kennlinie bis pwm_max nicht erreichbar\n");
+                            else if (inv == REACTION_MAP_INV_AMBIGUOUS)
+                                printf("WARNUNG: Kennlinie oberhalb der Vorsteuerung nicht monoton\n");
+                        } else {
+                            printf("Ungültiger Sollwert: %s\n", cmd_buf + 4);
+                        }
+                    } else if (strcmp(cmd_buf, "recal") == 0) {
+                        // Stützstellen einzeln zwischen den Regelschritten auffrischen
+                        recal_index = q16_mul_int_round(pwm_max, MAX_DUTY_CYCLE);
+                        recal_next_probe();
+                        recal_active = true;
+                        printf("OK: Nachkalibrierung an (ein Messschritt alle %d ms)\n",
+                               RECAL_INTERVAL_STEPS * CONTROL_PERIOD_US / 1000);
+                    } else if (strcmp(cmd_buf, "recal aus") == 0) {
+                        recal_active = false;
+                        printf("OK: Nachkalibrierung aus (%lu Durchläufe)\n", recal_passes);
+                    } else if (strcmp(cmd_buf, "lockin") == 0) {
+                        if (lockin_start())
+                            printf("OK: Lock-in an (%d Samples pro PWM-Periode)\n", LOCKIN_PERIOD);
+                        else
+                            printf("FEHLER: Abtastung nicht kohärent zur PWM (%lu Hz / %d Hz)\n",
+                                   adc_capture_sample_rate_hz() / 2, PWM_FREQ_HZ);
+                    } else if (strcmp(cmd_buf, "lockin aus") == 0) {
+                        lockin_active = false;
+                        printf("OK: Lock-in aus\n");
+                    } else if (strcmp(cmd_buf, "temp") == 0) {
+                        long t_c = q16_mul_int_round(temperature_c, 10);
+                        long ff_c = q16_mul_int_round(feedforward_pwm, 100);
+                        printf("Temperatur %ld.%ld C, Vorsteuerung %ld.%02ld, Zeilen",
+                               t_c / 10, labs(t_c % 10), ff_c / 100, ff_c % 100);
+                        for (int r = 0; r < MAP_TEMP_ROWS; r++)
+                            if (reaction_map.row_valid & (1u << r))
+                                printf(" %ld", (long)q16_round(reaction_map_row_temp(&reaction_map, r)));
+                        printf(" C, %lu Arbeitspunkte gelernt\n", reaction_map.updates);
+                    } else if (strcmp(cmd_buf, "bin") == 0) {
+                        telemetry_mode = TELEMETRY_BINARY;
+                        printf("OK: Ausgabe Binär-Frames\n");
+                    } else if (strcmp(cmd_buf, "csv") == 0) {
+                        telemetry_mode = TELEMETRY_CSV;
+                        printf("OK: Ausgabe CSV\n");
                     } else {
                         printf("Unbekannter Befehl: %s\n", cmd_buf);
                     }
@@ -197,11 +421,328 @@ int main(void) {
     }
 }
 
+// -------------------------
+//  REGELUNG (TIMER-IRQ)
+// -------------------------
+// Summe der Photodioden-Samples eines Blocks; die Summe der
+// Temperatur-Samples landet in `temp_sum`
+static uint32_t block_sum(const uint16_t *block, uint32_t *temp_sum) {
+    uint32_t sum = 0, temp = 0;
+    for (int i = 0; i < NUM_SAMPLES; i += 2) {
+        sum += block[i];
+        temp += block[i + 1];
+    }
+    *temp_sum = temp;
+    return sum;
+}
+
+// Photodioden-Samples eines Blocks nach `dst` (SIGNAL_SAMPLES Werte)
+static void copy_signal(uint16_t *dst, const uint16_t *block) {
+    for (int i = 0; i < SIGNAL_SAMPLES; i++)
+        dst[i] = block[2 * i];
+}
+
+// Sensorspannung -> °C. Interner Sensor laut Datenblatt: 0,706 V bei 27 °C,
+// -1,721 mV/K
+static q16_t temp_from_mv(q16_t mv) {
+    return Q16_CONST(27.0) - q16_mul(mv - Q16_CONST(706.0), Q16_CONST(1.0 / 1.721));
+}
+
+// Temperatur mit der Summe eines Blocks nachführen (erster Block: Startwert)
+static void temp_update(uint32_t temp_sum) {
+    q16_t t = temp_from_mv(adc_sum_to_mv_q16(temp_sum, SIGNAL_SAMPLES));
+    if (!temperature_valid) {
+        temperature_c = t;
+        temperature_valid = true;
+    } else {
+        temperature_c += (t - temperature_c) >> TEMP_FILTER_SHIFT;
+    }
+}
+
+// Rückführung im Lock-in-Modus: Gleichanteil des Lasers aus der Grundwelle
+// des Blocks (Rechteck mit dem aktuellen Tastgrad) plus Dunkelsignal aus
+// dem Kennlinienfeld, damit Sollwert und Feld dieselbe Skala behalten
+static q16_t lockin_measure(const uint16_t *block) {
+    lockin_reset(&lockin);
+    lockin_feed(&lockin, block, NUM_SAMPLES, 2);
+    q16_t amp_mv = q16_mul(lockin_amplitude(&lockin), ADC_MV_PER_COUNT_Q16);
+    return lockin_dark_mv + lockin_square_mean(&lockin, amp_mv, current_pwm);
+}
+
+// Blöcke vor `first` gehören noch zum Umschalten (Blocknummern laufen über)
+static bool block_before(uint32_t seq, uint32_t first) {
+    return (int32_t)(seq - first) < 0;
+}
+
+// Messschritt der Nachkalibrierung weiterführen. Rückgabe: true, wenn der
+// Block zum Messschritt gehört und der Regler diesmal aussetzt.
+static bool probe_step(const capture_ring_t *ring, uint32_t seq, q16_t avg_mv) {
+    switch (probe_state) {
+        case PROBE_IDLE:
+            if (!recal_active || !pwm_enabled || probe_ready
+                || ++probe_countdown < RECAL_INTERVAL_STEPS)
+                return false;
+            probe_countdown = 0;
+            set_pwm_q16(probe_duty);
+            probe_wait_seq = ring->head + PROBE_SETTLE_BLOCKS;
+            probe_state = PROBE_RUN;
+            return true;
+        case PROBE_RUN:
+            if (block_before(seq, probe_wait_seq))
+                return true;
+            probe_result.duty = probe_duty;
+            probe_result.mv = avg_mv;
+            probe_result.temp_c = temperature_c;
+            probe_ready = true;
+            set_pwm_q16(pid.out);
+            probe_wait_seq = ring->head + PROBE_SETTLE_BLOCKS;
+            probe_state = PROBE_RESTORE;
+            return true;
+        case PROBE_RESTORE:
+            if (block_before(seq, probe_wait_seq))
+                return true;
+            probe_state = PROBE_IDLE;
+            return false;
+    }
+    return false;
+}
+
+// Ein Regelschritt mit dem neuesten fertigen DMA-Block
+bool control_tick(repeating_timer_t *rt) {
+    (void)rt;
+    if (!control_active)
+        return true;
+
+    capture_ring_t *ring = adc_capture_ring();
+    if (capture_ring_available(ring) == 0)
+        return true;    // noch kein neuer Block (Timer und ADC laufen nicht synchron)
+    capture_ring_skip_to_latest(ring);
+
+    uint32_t seq;
+    const uint16_t *block = capture_ring_peek(ring, &seq);
+    uint32_t temp_sum;
+    uint32_t sum = block_sum(block, &temp_sum);
+    q16_t avg_mv = lockin_active ? lockin_measure(block)
+                                 : adc_sum_to_mv_q16(sum, SIGNAL_SAMPLES);
+    if (block_requested) {
+        copy_signal(last_block, block);
+        last_block_seq = seq;
+        block_requested = false;
+    }
+    if (!capture_ring_release(ring, seq))
+        return true;    // Block wurde während des Lesens überschrieben
+
+    temp_update(temp_sum);
+    if (hold_active) {
+        if (block_before(seq, hold_seq))
+            return true;
+        hold_active = false;
+    }
+    if (probe_step(ring, seq, avg_mv))
+        return true;
+    if (pwm_enabled)
+        set_pwm_q16(pid_update(&pid, setpoint_mv, avg_mv, feedforward_pwm));
+
+    control_status.block_seq = seq;
+    control_status.t_us = time_us_64();
+    control_status.avg_mv = avg_mv;
+    control_status.pwm = current_pwm;
+    control_status.temp_c = temperature_c;
+    control_count++;
+    return true;
+}
+
+// Regler stoßfrei auf die Vorsteuerung setzen und freigeben
+void control_start(void) {
+    uint32_t irq = save_and_disable_interrupts();
+    pid_reset(&pid, feedforward_pwm);
+    set_pwm_q16(feedforward_pwm);
+    probe_state = PROBE_IDLE;
+    hold_active = false;
+    control_active = reaction_map_ready(&reaction_map);
+    restore_interrupts(irq);
+}
+
+// Vorsteuerung: kleinster Tastgrad, bei dem das Kennlinienfeld bei der
+// aktuellen Temperatur den Sollwert erreicht
+static q16_t feedforward_for(q16_t mv) {
+    return reaction_map_duty_for(&reaction_map, mv, temperature_c, pwm_min, pwm_max);
+}
+
+// Neuer Sollwert. Bei laufender Regelung springt der Stellwert sofort auf
+// die Umkehrung der Kennlinie (plus bisherigem I-Anteil), ohne
+// Ratenbegrenzung; der Regler gleicht danach nur noch den Rest aus.
+// Rückgabe: Ergebnis der Umkehrung (z.B. nicht monotoner Abschnitt)
+reaction_map_inv_t set_setpoint_mv(int32_t mv) {
+    q16_t ff;
+    reaction_map_inv_t inv = reaction_map_inverse(&reaction_map, q16_from_int(mv), temperature_c,
+                                                  pwm_min, pwm_max, &ff);
+    uint32_t irq = save_and_disable_interrupts();
+    setpoint_mv = q16_from_int(mv);
+    feedforward_pwm = ff;
+    if (SETPOINT_JUMP && control_active) {
+        q16_t out = ff + pid.integral;
+        if (out < pwm_min)
+            out = pwm_min;
+        if (out > pwm_max)
+            out = pwm_max;
+        pid.out = out;
+        pid.primed = false;
+        if (probe_state == PROBE_IDLE)
+            set_pwm_q16(out);   // im Messschritt übernimmt PROBE_RUN den Wert
+        hold_seq = adc_capture_ring()->head + PROBE_SETTLE_BLOCKS;
+        hold_active = true;
+    }
+    restore_interrupts(irq);
+    return inv;
+}
+
+// Vorsteuerung auf Temperatur und nachgelerntes Feld nachführen; die
+// Änderung wird dem I-Anteil abgezogen, damit der Stellwert nicht springt
+void update_feedforward(void) {
+    q16_t ff = feedforward_for(setpoint_mv);
+    uint32_t irq = save_and_disable_interrupts();
+    pid.integral -= ff - feedforward_pwm;
+    feedforward_pwm = ff;
+    restore_interrupts(irq);
+    lockin_dark_mv = reaction_map_lookup(&reaction_map, 0, temperature_c);
+}
+
+// Lock-in-Modus einschalten. Die Tabelle wird nur beim ersten Mal
+// berechnet. Rückgabe: false, wenn die Abtastung nicht genau
+// LOCKIN_PERIOD Samples pro PWM-Periode liefert (auch, wenn der
+// Systemtakt keine exakte PWM-Periode zulässt)
+bool lockin_start(void) {
+    uint32_t rate = adc_capture_sample_rate_hz() / 2;
+    if (pwm_timing_status_g != PWM_TIMING_OK
+        || rate % PWM_FREQ_HZ != 0 || rate / PWM_FREQ_HZ != LOCKIN_PERIOD)
+        return false;
+    if (lockin.period != LOCKIN_PERIOD)
+        lockin_init(&lockin, lockin_lut, LOCKIN_PERIOD);
+    lockin_dark_mv = reaction_map_lookup(&reaction_map, 0, temperature_c);
+    lockin_active = true;
+    return true;
+}
+
+// Nächste Stützstelle der Nachkalibrierung: reihum von 0 (Dunkelsignal,
+// Bezugspunkt beim Lernen am Arbeitspunkt) bis pwm_max
+void recal_next_probe(void) {
+    int lo = 0;
+    int hi = q16_mul_int_round(pwm_max, MAX_DUTY_CYCLE);
+    if (++recal_index > hi) {
+        if (recal_active) {
+            recal_passes++;
+            long t_c = q16_mul_int_round(temperature_c, 10);
+            printf("Nachkalibrierung: Durchlauf %lu bei %ld.%ld C\n",
+                   recal_passes, t_c / 10, labs(t_c % 10));
+        }
+        recal_index = lo;
+    }
+    probe_duty = (q16_t)(((int64_t)recal_index << Q16_SHIFT) / MAX_DUTY_CYCLE);
+}
+
+// -------------------------
+//  KALIBRIERUNG IM FLASH
+// -------------------------
+// Gespeicherte Kennlinie (von pwm_sweep oder einem früheren Lauf) laden und
+// auf die Stützstellen 0..MAX_DUTY_CYCLE der Reaktionstabelle umrechnen.
+bool load_calibration(uint16_t *table) {
+    static uint16_t values[CAL_MAX_POINTS];
+    cal_header_t hdr;
+
+    if (!cal_store_load(&hdr, values, CAL_MAX_POINTS)) {
+        printf("Keine gültige Kalibrierung im Flash.\n");
+        return false;
+    }
+    if (hdr.pwm_freq_hz != PWM_FREQ_HZ || hdr.points < 2 || hdr.duty_max == 0) {
+        printf("Kalibrierung im Flash passt nicht (%lu Hz, %u Punkte).\n",
+               hdr.pwm_freq_hz, hdr.points);
+        return false;
+    }
+
+    for (int d = 0; d <= MAX_DUTY_CYCLE; d++) {
+        // Position in der gespeicherten Tabelle: d / MAX_DUTY_CYCLE * duty_max
+        uint32_t pos = (uint32_t)d * hdr.duty_max;
+        uint32_t idx = pos / MAX_DUTY_CYCLE;
+        uint32_t frac = pos % MAX_DUTY_CYCLE;
+        uint32_t v;
+        if (idx >= (uint32_t)hdr.points - 1) {
+            v = values[hdr.points - 1];
+        } else {
+            v = (values[idx] * (MAX_DUTY_CYCLE - frac) + values[idx + 1] * frac
+                 + MAX_DUTY_CYCLE / 2) / MAX_DUTY_CYCLE;
+        }
+        table[d] = (uint16_t)((v + CAL_MV_SCALE / 2) / CAL_MV_SCALE);
+    }
+
+    printf("Reaktionstabelle aus Flash geladen (Datensatz %lu, %u Punkte).\n",
+           hdr.seq, hdr.points);
+    return true;
+}
+
+void save_calibration(const uint16_t *table) {
+    static uint16_t values[MAX_DUTY_CYCLE + 1];
+
+    for (int d = 0; d <= MAX_DUTY_CYCLE; d++)
+        values[d] = (uint16_t)(table[d] * CAL_MV_SCALE);
+
+    cal_header_t hdr = {
+        .timestamp_us = time_us_64(),
+        .points = MAX_DUTY_CYCLE + 1,
+        .duty_max = MAX_DUTY_CYCLE,
+        .pwm_freq_hz = PWM_FREQ_HZ,
+        .pwm_wrap = pwm_wrap_g,
+        .samples_per_step = SAMPLES_PER_STEP,
+        .settle_ms = SETTLE_MS,
+    };
+    // cal_store_save sperrt für Löschen und Schreiben (~50 ms) die
+    // Interrupts. Ohne adc_capture_dma_irq setzt niemand die Zieladresse
+    // der verketteten DMA-Kanäle zurück, sie liefen über capture_buf
+    // hinaus; die Erfassung ruht daher währenddessen. (Die Host-Simulation
+    // kennt weder gesperrte Interrupts noch DMA und kann das nicht zeigen.)
+    bool streaming = adc_capture_running();
+    if (streaming)
+        adc_capture_stop();
+    bool ok = cal_store_save(&hdr, values);
+    if (streaming)
+        adc_capture_start();
+
+    if (ok)
+        printf("Reaktionstabelle im Flash gespeichert (Datensatz %lu).\n", hdr.seq);
+    else
+        printf("FEHLER: Reaktionstabelle konnte nicht gespeichert werden.\n");
+}
+
+// --- ADC helpers ---
+// Summe der Photodioden-Rohwerte über die nächsten `blocks` fertigen
+// DMA-Blöcke (je SIGNAL_SAMPLES). Ältere, noch ungelesene Blöcke werden
+// übersprungen; die Temperatur wird nebenbei nachgeführt. Ist `last_copy`
+// gesetzt, werden die Photodioden-Samples des letzten Blocks dorthin kopiert.
+uint32_t sum_next_blocks(int blocks, uint16_t *last_copy) {
+    capture_ring_t *ring = adc_capture_ring();
+    uint32_t sum = 0;
+
+    capture_ring_skip_to_latest(ring);
+    for (int b = 0; b < blocks; b++) {
+        const uint16_t *block;
+        uint32_t seq;
+        while ((block = capture_ring_peek(ring, &seq)) == NULL)
+            tight_loop_contents();
+        uint32_t temp_sum;
+        sum += block_sum(block, &temp_sum);
+        temp_update(temp_sum);
+        if (last_copy && b == blocks - 1)
+            copy_signal(last_copy, block);
+        capture_ring_release(ring, seq);
+    }
+    return sum;
+}
+
 // --- PWM control helpers ---
-void set_pwm_from_float(float pwm) {
+void set_pwm_q16(q16_t pwm) {
     current_pwm = pwm;
     if (pwm_enabled) {
-        uint16_t level = (uint16_t)((float)pwm_wrap_g * current_pwm);
+        uint16_t level = (uint16_t)q16_mul_int(current_pwm, pwm_wrap_g);
         pwm_set_chan_level(pwm_slice, pwm_channel, level);
     }
 }
@@ -209,9 +750,8 @@ void set_pwm_from_float(float pwm) {
 void laser_on(void) {
     // configure pin for PWM and enable slice
     gpio_set_function(PWM_GPIO, GPIO_FUNC_PWM);
-    pwm_set_wrap(pwm_slice, pwm_wrap_g);
-    pwm_set_clkdiv(pwm_slice, pwm_clkdiv_g);
-    uint16_t level = (uint16_t)((float)pwm_wrap_g * current_pwm);
+    pwm_timing_apply(pwm_slice, &pwm_timing_g);
+    uint16_t level = (uint16_t)q16_mul_int(current_pwm, pwm_wrap_g);
     pwm_set_chan_level(pwm_slice, pwm_channel, level);
     pwm_set_enabled(pwm_slice, true);
     pwm_enabled = true;
@@ -247,7 +787,7 @@ void run_pwm_sweep(){
 
     printf("Starte Sweep...");
 
-    static float sweep_results[MAX_DUTY_CYCLE + 1];
+    static uint16_t sweep_results[MAX_DUTY_CYCLE + 1];
 
     pwm_sweep(sweep_results);
 
@@ -255,31 +795,27 @@ void run_pwm_sweep(){
     for (int i = 0; i <= MAX_DUTY_CYCLE; i++) {
         reaction_table[i] = sweep_results[i];
     }
-    reaction_table_ready = true;
+    reaction_map_set_row(&reaction_map, temperature_c, reaction_table);
 
     printf("Sweep beendet! Reaktionstabelle im RAM aktualisiert.\n");
 
     for (int i = 0; i <= MAX_DUTY_CYCLE; i++)
-        printf("%d, %.3f\n", i, sweep_results[i]);
+        printf("%d, %u\n", i, sweep_results[i]);
 }
 
 // -------------------------
 //  PWM-SWEEP AUSGELAGERT
 // -------------------------
-void pwm_sweep(float *result_array) {
+void pwm_sweep(uint16_t *result_array) {
 
-    const float sys_clk = 125000000;
-    float freq = 1000.0f;
-    float clkdiv = 125.0f;
-    uint16_t _wrap = (uint16_t)((sys_clk / clkdiv) / freq) - 1;
+    uint16_t _wrap = pwm_wrap_g;
 
     uint slice_num = pwm_gpio_to_slice_num(PWM_GPIO);
     uint channel   = pwm_gpio_to_channel(PWM_GPIO);
 
     // Erst hier PWM aktivieren!
     gpio_set_function(PWM_GPIO, GPIO_FUNC_PWM);
-    pwm_set_wrap(slice_num, _wrap);
-    pwm_set_clkdiv(slice_num, clkdiv);
+    pwm_timing_apply(slice_num, &pwm_timing_g);
     pwm_set_enabled(slice_num, true);
 
     for (int duty = 0; duty <= MAX_DUTY_CYCLE; duty++) {
@@ -287,14 +823,13 @@ void pwm_sweep(float *result_array) {
         uint16_t level = (_wrap * duty) / MAX_DUTY_CYCLE;
         pwm_set_chan_level(slice_num, channel, level);
 
-        sleep_ms(20);
+        sleep_ms(SETTLE_MS);
 
-        uint64_t sum = 0;
-        for (int i = 0; i < SAMPLES_PER_STEP; i++)
-            sum += adc_read();
+        // SAMPLES_PER_STEP Samples als ganze DMA-Blöcke mitteln
+        const int blocks = SAMPLES_PER_STEP / NUM_SAMPLES;
+        uint32_t sum = sum_next_blocks(blocks, NULL);
 
-        float avg_adc = (float)sum / SAMPLES_PER_STEP;
-        result_array[duty] = avg_adc * VperDev;
+        result_array[duty] = (uint16_t)q16_round(adc_sum_to_mv_q16(sum, blocks * SIGNAL_SAMPLES));
     }
 
     // Nach Sweep PWM wieder komplett abschalten
@@ -304,3 +839,62 @@ void pwm_sweep(float *result_array) {
     gpio_put(PWM_GPIO, 0);  // DEAD-SAFE
 }
 
+// Rückrufe für den adaptiven Sweep
+static q16_t sweep_set_duty(q16_t duty, void *ctx) {
+    (void)ctx;
+    uint16_t level = (uint16_t)q16_mul_int_round(duty, pwm_wrap_g);
+    pwm_set_chan_level(pwm_slice, pwm_channel, level);
+    return (q16_t)(((int64_t)level << Q16_SHIFT) / pwm_wrap_g);
+}
+
+static q16_t sweep_measure_block(void *ctx) {
+    (void)ctx;
+    return adc_sum_to_mv_q16(sum_next_blocks(1, NULL), SIGNAL_SAMPLES);
+}
+
+// Adaptiver Sweep: wartet nur bis zum Einschwingen und misst dort dichter,
+// wo die Kennlinie steil oder gekrümmt ist. Die nicht-äquidistante Tabelle
+// wird danach auf die MAX_DUTY_CYCLE + 1 Stützstellen interpoliert.
+void pwm_sweep_adaptive(uint16_t *result_array) {
+    static adaptive_table_t table;
+    const adaptive_sweep_config_t cfg = {
+        .duty_min = 0,
+        .duty_max = Q16_ONE,
+        .coarse_points = ADAPTIVE_COARSE_POINTS,
+        .min_step = Q16_ONE / MAX_DUTY_CYCLE,
+        .settle_tol_mv = ADAPTIVE_SETTLE_TOL_MV,
+        .settle_blocks = ADAPTIVE_SETTLE_BLOCKS,
+        .max_blocks = ADAPTIVE_MAX_BLOCKS,
+        .refine_tol_mv = ADAPTIVE_REFINE_TOL_MV,
+        .max_delta_mv = ADAPTIVE_MAX_DELTA_MV,
+        .set_duty = sweep_set_duty,
+        .measure_block = sweep_measure_block,
+        .ctx = NULL,
+    };
+
+    gpio_set_function(PWM_GPIO, GPIO_FUNC_PWM);
+    pwm_timing_apply(pwm_slice, &pwm_timing_g);
+    pwm_set_enabled(pwm_slice, true);
+
+    uint64_t t0 = time_us_64();
+    adaptive_sweep_run(&cfg, &table);
+    uint32_t dt_ms = (uint32_t)((time_us_64() - t0) / 1000);
+
+    // Nach Sweep PWM wieder komplett abschalten
+    pwm_set_enabled(pwm_slice, false);
+    gpio_set_function(PWM_GPIO, GPIO_FUNC_SIO);
+    gpio_set_dir(PWM_GPIO, GPIO_OUT);
+    gpio_put(PWM_GPIO, 0);  // DEAD-SAFE
+
+    for (int duty = 0; duty <= MAX_DUTY_CYCLE; duty++) {
+        q16_t mv = adaptive_table_lookup(&table, (q16_t)(((int64_t)duty << Q16_SHIFT) / MAX_DUTY_CYCLE));
+        result_array[duty] = (uint16_t)q16_round(mv);
+    }
+
+    printf("Adaptiver Sweep: %u Punkte, %lu Blöcke, %lu ms",
+           table.count, (unsigned long)table.blocks, (unsigned long)dt_ms);
+    if (table.unsettled)
+        printf(", %u Punkte nicht eingeschwungen", table.unsettled);
+    printf("\n");
+}
+
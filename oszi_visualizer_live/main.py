@@ -11,9 +11,13 @@ from PyQt5.QtWidgets import (QApplication, QMainWindow, QWidget, QVBoxLayout,
 from PyQt5.QtCore import Qt, pyqtSignal, QObject, QTimer
 from PyQt5.QtGui import QFont
 
+from telemetry import FrameParser, FRAME_TRIGGER, TRIGGER_LAST
+
 BUFFER_SIZE = 10000
 PLOT_INTERVAL = 300  # in ms
 PRE_TRIGGER = 100  # number of samples to include before the trigger
+VPERDEV = 0.806  # mV pro ADC-Schritt (wie in der Firmware)
+DEFAULT_SAMPLE_PERIOD_US = 2.0  # 500 kS/s, falls noch kein Frame-Abstand bekannt ist
 
 timestamps = []
 signals = []
@@ -60,15 +64,61 @@ def open_serial_port(com_port, baud_rate):
         print(f"Fehler beim Öffnen des Ports {com_port}: {e}")
         return None
 
+# Letzter Frame (Zeitstempel, Anzahl) zur Schätzung des Sample-Abstands
+last_frame_info = None
+
+def frame_rows(frame):
+    """Binär-Frame in (zeit, signal_mv, pwm)-Tupel umrechnen.
+
+    Der Sample-Abstand steht im Frame (Version 2); bei Version 1 wird er aus
+    dem Abstand zum vorherigen Frame geschätzt.
+    """
+    global last_frame_info
+    period_us = DEFAULT_SAMPLE_PERIOD_US
+    if frame.sample_period_us is not None:
+        period_us = frame.sample_period_us
+    elif last_frame_info is not None:
+        prev_ts, prev_count = last_frame_info
+        if prev_count > 0 and frame.timestamp_us > prev_ts:
+            period_us = (frame.timestamp_us - prev_ts) / prev_count
+    last_frame_info = (frame.timestamp_us, len(frame.samples))
+
+    pwm_val = frame.aux / 1000.0
+    return [(frame.timestamp_us + i * period_us, s * VPERDEV, pwm_val)
+            for i, s in enumerate(frame.samples)]
+
+def trigger_window_rows(frames):
+    """Trigger-Fenster (mehrere Frames) in Zeit-, Signal- und PWM-Listen umrechnen.
+
+    Der Sample-Abstand steht im Frame (Version 2), sonst ergibt er sich aus
+    den Zeitstempeln der Frames im Fenster.
+    """
+    period_us = DEFAULT_SAMPLE_PERIOD_US
+    if frames[0].sample_period_us is not None:
+        period_us = frames[0].sample_period_us
+    elif len(frames) > 1 and frames[0].samples:
+        span = frames[-1].timestamp_us - frames[0].timestamp_us
+        count = sum(len(f.samples) for f in frames[:-1])
+        if span > 0:
+            period_us = span / count
+    ts, sig = [], []
+    for f in frames:
+        for i, s in enumerate(f.samples):
+            ts.append(f.timestamp_us + i * period_us)
+            sig.append(s * VPERDEV)
+    return ts, sig, [0.0] * len(sig)
+
+
 def read_serial_data(ser):
     global timestamps, signals, pwm, running, trigger_enabled, trigger_threshold, trigger_hold, processed_since_last_update
     emitter.log_signal.emit("Serial-Lese-Thread gestartet...")
-    byte_buf = b''
+    parser = FrameParser()
     processed = 0
     collecting_snapshot = False
     snapshot_ts = []
     snapshot_sig = []
     snapshot_target_len = None
+    device_window = []  # Frames des laufenden Trigger-Fensters der Firmware
 
     while running:
         try:
@@ -80,28 +130,40 @@ def read_serial_data(ser):
                     time.sleep(0.001)
                     continue
 
-                byte_buf += data
-
-                # Splitte auf '\n' (handle auch '\r\n')
-                while b'\n' in byte_buf:
-                    line_bytes, byte_buf = byte_buf.split(b'\n', 1)
-                    # entferne \r und decode, ersetze invalid bytes
-                    line = line_bytes.replace(b'\r', b'').decode('utf-8', errors='replace').strip()
-                    if not line:
+                for kind, item in parser.feed(data):
+                    if kind == 'frame' and item.type == FRAME_TRIGGER:
+                        # Fenster vom Geräte-Trigger: nicht in den Live-Puffer,
+                        # sondern komplett als Snapshot anzeigen
+                        device_window.append(item)
+                        if item.aux & TRIGGER_LAST:
+                            pre = item.aux & ~TRIGGER_LAST
+                            emitter.log_signal.emit(f"▶ Geräte-Trigger: {sum(len(f.samples) for f in device_window)} Samples, {pre} Vorlauf")
+                            emitter.trigger_snapshot.emit(*trigger_window_rows(device_window))
+                            device_window = []
                         continue
-
-                    # Erwartetes Format: "time_ns, signal_mv, pwm"
-                    # Entferne Leerzeichen und prüfe, ob die Zeile die richtige Anzahl an Teilen hat
-                    parts = line.strip().split(',')
-                    if len(parts) != 3:
-                        emitter.log_signal.emit(f"⚠ Unparsable Zeile (nicht 3 Teile): '{line}'")
+                    if kind == 'frame':
+                        rows = frame_rows(item)
+                        label = f"Frame #{item.seq}"
                     else:
-                        time_ns_str, signal_mv_str, pwm_str = map(str.strip, parts)
+                        line = item
+                        label = f"'{line}'"
+
+                        # Erwartetes Format: "time_ns, signal_mv, pwm"
+                        # Entferne Leerzeichen und prüfe, ob die Zeile die richtige Anzahl an Teilen hat
+                        parts = line.strip().split(',')
+                        if len(parts) != 3:
+                            emitter.log_signal.emit(f"⚠ Unparsable Zeile (nicht 3 Teile): '{line}'")
+                            continue
                         try:
-                            time_ns = float(time_ns_str)
-                            signal_mv = float(signal_mv_str)
-                            pwm_val = float(pwm_str)
+                            time_ns_str, signal_mv_str, pwm_str = map(str.strip, parts)
+                            rows = [(float(time_ns_str), float(signal_mv_str), float(pwm_str))]
+                        except ValueError:
+                            # Logge die rohe Zeile zur Analyse, versuche keine weitere Zerlegung hier
+                            emitter.log_signal.emit(f"⚠ Unparsable Zeile: '{line}'")
+                            continue
 
+                    for time_ns, signal_mv, pwm_val in rows:
+                        try:
                             with data_lock:
                                 timestamps.append(time_ns)
                                 signals.append(signal_mv)
@@ -156,12 +218,8 @@ def read_serial_data(ser):
                             processed_since_last_update += 1
                             # if processed % 50 == 0:
                             #     emitter.log_signal.emit(f"✓ Daten verarbeitet: {processed} (puffer: {len(timestamps)})")
-
-                        except ValueError:
-                            # Logge die rohe Zeile zur Analyse, versuche keine weitere Zerlegung hier
-                            emitter.log_signal.emit(f"⚠ Unparsable Zeile: '{line}'")
                         except Exception as e:
-                            emitter.log_signal.emit(f"Fehler beim Verarbeiten: '{line}' ({e})")
+                            emitter.log_signal.emit(f"Fehler beim Verarbeiten: {label} ({e})")
         except Exception as e:
             emitter.log_signal.emit(f"Fehler beim Lesen: {e}")
             break
@@ -334,6 +392,14 @@ class PicoVisualizerApp(QMainWindow):
         btn7 = QPushButton('aus')
         btn7.clicked.connect(lambda: self.send_predefined_command('aus'))
         btn_layout.addWidget(btn7)
+
+        btn8 = QPushButton('bin (Binär-Frames)')
+        btn8.clicked.connect(lambda: self.send_predefined_command('bin'))
+        btn_layout.addWidget(btn8)
+
+        btn9 = QPushButton('csv (Text)')
+        btn9.clicked.connect(lambda: self.send_predefined_command('csv'))
+        btn_layout.addWidget(btn9)
         
         right_layout.addLayout(btn_layout)
 
@@ -357,6 +423,12 @@ class PicoVisualizerApp(QMainWindow):
         self.trig_release_btn.clicked.connect(self.release_trigger)
         trig_hbox.addWidget(self.trig_release_btn)
 
+        # Trigger in der Firmware (pwm-pulse, Binärmodus): nur das Fenster wird übertragen
+        self.dev_trig_btn = QPushButton('Geräte-Trigger')
+        self.dev_trig_btn.setCheckable(True)
+        self.dev_trig_btn.clicked.connect(self.toggle_device_trigger)
+        trig_hbox.addWidget(self.dev_trig_btn)
+
         right_layout.addLayout(trig_hbox)
         # Buffer size controls (adjustable + reset)
         buf_hbox = QHBoxLayout()
@@ -433,6 +505,20 @@ class PicoVisualizerApp(QMainWindow):
             self.trig_btn.setText('Trigger: OFF')
             emitter.log_signal.emit("Trigger deaktiviert.")
 
+    def toggle_device_trigger(self):
+        """Trigger der Firmware mit der eingestellten Schwelle scharf schalten bzw. abschalten."""
+        if self.dev_trig_btn.isChecked():
+            try:
+                level = float(self.trig_input.text())
+            except ValueError:
+                emitter.log_signal.emit(f"Ungültige Schwelle: '{self.trig_input.text()}'")
+                self.dev_trig_btn.setChecked(False)
+                return
+            send_command_to_pico('bin')
+            send_command_to_pico(f'trig steigend {int(level)}')
+        else:
+            send_command_to_pico('trig aus')
+
     def release_trigger(self):
         """Release trigger hold so buffer popping resumes."""
         global trigger_hold
@@ -0,0 +1,161 @@
+"""Decoder für die binären Telemetrie-Frames der Pico-Firmware.
+
+Gegenstück zu common/telemetry.c. Aufbau eines Frames (Little Endian):
+
+    u16 sync 0x5AA5, u8 version, u8 typ, u16 seq, u16 anzahl, u16 zusatzwert,
+    u64 zeitstempel_ns, u32 abtastperiode_ps, gepackte 12-Bit-Samples,
+    u16 CRC-16/CCITT
+
+Version 1 (ältere Firmware) hat einen Zeitstempel in us und keine
+Abtastperiode; beide Versionen werden dekodiert. Frame.timestamp_us ist
+immer in us (bei Version 2 mit Nachkommastellen), Frame.sample_period_us
+ist bei Version 1 None.
+
+Der Datenstrom darf Textzeilen (CSV, Statusmeldungen) und Frames mischen;
+FrameParser trennt beides.
+"""
+
+import struct
+from collections import namedtuple
+
+SYNC = b'\xa5\x5a'
+VERSION = 2
+HEADER_FMT = '<HBBHHHQI'
+HEADER_LEN = struct.calcsize(HEADER_FMT)
+HEADER_FMT_V1 = '<HBBHHHQ'
+HEADER_LEN_V1 = struct.calcsize(HEADER_FMT_V1)
+CRC_LEN = 2
+MAX_SAMPLES = 512
+
+FRAME_SAMPLES = 1
+FRAME_TRIGGER = 2       # Trigger-Fenster der Firmware, Zusatzwert = Vorlauf | TRIGGER_LAST
+TRIGGER_LAST = 0x8000   # letzter Frame des Fensters
+FRAME_CHANNEL = 3       # Kanal eines Mehrkanal-Stroms, Zusatzwert = ADC-Eingang
+
+Frame = namedtuple('Frame', 'version type seq timestamp_us aux samples sample_period_us')
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE wie in common/crc.c."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            if crc & 0x8000:
+                crc = ((crc << 1) ^ 0x1021) & 0xFFFF
+            else:
+                crc = (crc << 1) & 0xFFFF
+    return crc
+
+
+def payload_len(count):
+    return (count * 3 + 1) // 2
+
+
+def pack12(samples):
+    """Je zwei 12-Bit-Werte in 3 Bytes packen."""
+    out = bytearray()
+    for i in range(0, len(samples) - 1, 2):
+        a = samples[i] & 0x0FFF
+        b = samples[i + 1] & 0x0FFF
+        out += bytes((a & 0xFF, (a >> 8) | ((b << 4) & 0xF0), b >> 4))
+    if len(samples) % 2:
+        a = samples[-1] & 0x0FFF
+        out += bytes((a & 0xFF, a >> 8))
+    return bytes(out)
+
+
+def unpack12(payload, count):
+    samples = []
+    for i in range(0, count - 1, 2):
+        b0, b1, b2 = payload[3 * (i // 2):3 * (i // 2) + 3]
+        samples.append(b0 | ((b1 & 0x0F) << 8))
+        samples.append((b1 >> 4) | (b2 << 4))
+    if count % 2:
+        off = 3 * (count // 2)
+        samples.append(payload[off] | ((payload[off + 1] & 0x0F) << 8))
+    return samples
+
+
+def encode_frame(seq, timestamp_ns, samples, aux=0, frame_type=FRAME_SAMPLES,
+                 sample_period_ps=2000000):
+    """Frame wie die Firmware kodieren (für Tests und Wiedergabe)."""
+    header = struct.pack(HEADER_FMT, 0x5AA5, VERSION, frame_type, seq & 0xFFFF,
+                         len(samples), aux & 0xFFFF, timestamp_ns, sample_period_ps)
+    body = header + pack12(samples)
+    return body + struct.pack('<H', crc16_ccitt(body[2:]))
+
+
+def decode_frame(buf):
+    """Einen vollständigen Frame am Anfang von `buf` dekodieren.
+
+    Rückgabe: (Frame, verbrauchte Bytes). (None, 0) wenn noch Bytes fehlen.
+    Wirft ValueError bei ungültigem Frame.
+    """
+    if len(buf) < HEADER_LEN_V1:
+        return None, 0
+    sync, version, frame_type, seq, count, aux, ts = struct.unpack_from(HEADER_FMT_V1, buf)
+    if sync != 0x5AA5:
+        raise ValueError('kein Sync-Wort')
+    if version not in (1, VERSION) or count > MAX_SAMPLES:
+        raise ValueError(f'ungültiger Header (Version {version}, {count} Samples)')
+    if version == 1:
+        header_len, timestamp_us, period_us = HEADER_LEN_V1, ts, None
+    else:
+        if len(buf) < HEADER_LEN:
+            return None, 0
+        (period_ps,) = struct.unpack_from('<I', buf, HEADER_LEN_V1)
+        header_len, timestamp_us, period_us = HEADER_LEN, ts / 1000.0, period_ps / 1e6
+    total = header_len + payload_len(count) + CRC_LEN
+    if len(buf) < total:
+        return None, 0
+    (crc,) = struct.unpack_from('<H', buf, total - CRC_LEN)
+    if crc16_ccitt(buf[2:total - CRC_LEN]) != crc:
+        raise ValueError('CRC-Fehler')
+    samples = unpack12(buf[header_len:total - CRC_LEN], count)
+    return Frame(version, frame_type, seq, timestamp_us, aux, samples, period_us), total
+
+
+class FrameParser:
+    """Trennt einen gemischten Byte-Strom in Textzeilen und Frames."""
+
+    def __init__(self):
+        self.buf = b''
+        self.crc_errors = 0
+        self.lost_frames = 0
+        self._last_seq = None
+
+    def feed(self, data):
+        """Bytes anhängen. Liefert eine Liste von ('line', str) / ('frame', Frame)."""
+        self.buf += data
+        items = []
+        while self.buf:
+            sync_pos = self.buf.find(SYNC)
+            nl_pos = self.buf.find(b'\n')
+
+            # Zuerst vollständige Textzeilen vor dem nächsten Frame abarbeiten
+            if nl_pos != -1 and (sync_pos == -1 or nl_pos < sync_pos):
+                line_bytes, self.buf = self.buf[:nl_pos], self.buf[nl_pos + 1:]
+                line = line_bytes.replace(b'\r', b'').decode('utf-8', errors='replace').strip()
+                if line:
+                    items.append(('line', line))
+                continue
+
+            if sync_pos == -1:
+                break  # angefangene Textzeile, auf mehr Bytes warten
+
+            try:
+                frame, used = decode_frame(self.buf[sync_pos:])
+            except ValueError:
+                # Kein gültiger Frame: Sync-Byte als Text behandeln
+                self.crc_errors += 1
+                self.buf = self.buf[:sync_pos] + self.buf[sync_pos + 1:]
+                continue
+            if frame is None:
+                break  # Frame unvollständig
+
+            if self._last_seq is not None:
+                self.lost_frames += (frame.seq - self._last_seq - 1) & 0xFFFF
+            self._last_seq = frame.seq
+            self.buf = self.buf[:sync_pos] + self.buf[sync_pos + used:]
+            items.append(('frame', frame))
+        return items
@@ -1,26 +1,346 @@
 // Dieses Skript steuert einen Puls auf einem GPIO-Pin und misst die Reaktion über den ADC.
 // Der Puls kann asynchron gestartet werden, während die ADC-Messungen fortgesetzt werden.
 // Die Pulsdauer kann über die serielle Schnittstelle eingestellt werden. Die Pulsstärke liegt bei 100%.
+// Start und Ende des Pulses setzen Hardware-Alarme (Timer-IRQ), unabhängig von der Messschleife;
+// die tatsächlichen Flankenzeiten werden nach jedem Puls ausgegeben.
+// Mit "seg" werden viele trigger-ausgerichtete Antworten ohne Totzeit in den
+// RAM aufgenommen und erst danach mit "dump" ausgegeben.
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "hardware/adc.h"
 #include "pico/time.h"
+#include "adc_capture.h"
+#include "pulse_seq.h"
+#include "segment_store.h"
+#include "telemetry.h"
 
 #define PULSE_PIN 15       // GPIO für den Puls
 #define DEFAULT_PULSE_MS 100
 #define NUM_SAMPLES 1000
 #define THRESHOLD 400
 #define VperDev 0.806
+#define PULSE_LEAD_US 100  // Vorlauf vom Befehl bis zum geplanten Pulsstart
+#define BENCH_PULSES 20    // Pulse pro "bench"
+#define BENCH_GAP_MS 20    // Pause zwischen zwei Pulsen im Benchmark
+#define SEQ_MAX_STEPS 8    // Schritte pro "seq"-Befehl
+#define SEQ_MAX_WORDS 1024 // Tabellenwörter (2 pro Puls)
+
+// Segmentierter Speicher ("seg"): der größte Teil des SRAM nimmt die Fenster auf
+#define SEG_MEMORY_SAMPLES (96 * 1024)  // 192 KB
+#define SEG_MAX_SEGMENTS 1024
+#define SEG_MAX_WINDOW 4096             // Samples pro Segment (Vorlauf + Nachlauf)
+#define SEG_DEFAULT_PRE 64
+#define SEG_DEFAULT_POST 448            // 1 ms pro Segment bei 500 kS/s
+#define SEG_HYSTERESIS 25
+#define SEG_BLOCK_LEN 256               // DMA-Blöcke während der Aufnahme
+#define SEG_BLOCKS 8
 
 typedef struct {
-    bool active;
-    uint32_t start_us;
-    uint32_t duration_ms;
+    volatile bool active;           // Puls geplant oder läuft
+    volatile bool done;             // Puls beendet, noch nicht ausgegeben
+    volatile bool failed;           // kein Alarm frei, Puls abgebrochen, noch nicht ausgegeben
+    uint64_t start_cmd_us;          // geplante Startzeit
+    uint32_t duration_us;           // geplante Dauer
+    volatile uint64_t start_us;     // tatsächliche Flanken, im Alarm-IRQ gemessen
+    volatile uint64_t end_us;
 } PulseState;
 
+// Abweichungen Ist - Soll in us
+typedef struct {
+    uint32_t count;
+    int64_t sum;
+    int32_t min;
+    int32_t max;
+} JitterStats;
+
+static PulseState pulse;
+static JitterStats start_stats, duration_stats;
+
+// Pulsfolge per PIO (Befehl "seq"), Tabelle muss bis zum Ende gültig bleiben
+static uint32_t seq_table[SEQ_MAX_WORDS];
+static bool seq_running = false;
+
+// Segmentierter Speicher
+static uint16_t seg_memory[SEG_MEMORY_SAMPLES];
+static uint64_t seg_trigger_seq[SEG_MAX_SEGMENTS];
+static uint16_t seg_window[SEG_MAX_WINDOW];
+static uint16_t seg_ring[SEG_BLOCK_LEN * SEG_BLOCKS];
+static segment_store_t segments;
+static bool seg_valid = false;          // Speicher enthält eine Aufnahme
+static bool seg_active = false;         // Aufnahme läuft
+static uint64_t seg_t0_ns;              // Zeit von Sample 0 der Aufnahme
+static uint32_t seg_next_block;         // erwarteter nächster DMA-Block
+static uint32_t seg_gaps;               // wegen Lücken verworfene Fenster
+static uint16_t seg_frame_seq = 0;
+
+// -------------------------
+//  PULS PER ALARM
+// -------------------------
+static int64_t pulse_end_alarm(alarm_id_t id, void *user_data) {
+    (void)id;
+    (void)user_data;
+    gpio_put(PULSE_PIN, 0);
+    pulse.end_us = time_us_64();
+    pulse.active = false;
+    pulse.done = true;
+    return 0;
+}
+
+static int64_t pulse_start_alarm(alarm_id_t id, void *user_data) {
+    (void)id;
+    (void)user_data;
+    gpio_put(PULSE_PIN, 1);
+    pulse.start_us = time_us_64();
+    // Ende relativ zum geplanten Start, damit sich die Startlatenz nicht addiert
+    if (add_alarm_at(from_us_since_boot(pulse.start_cmd_us + pulse.duration_us),
+                     pulse_end_alarm, NULL, true) < 0) {
+        // Ohne End-Alarm bliebe der Laser an
+        gpio_put(PULSE_PIN, 0);
+        pulse.active = false;
+        pulse.failed = true;
+    }
+    return 0;
+}
+
+// Puls mit Start in PULSE_LEAD_US planen. Gibt false zurück, wenn noch einer
+// läuft oder kein Alarm frei ist (dann ist pulse.failed gesetzt).
+static bool pulse_schedule(uint32_t duration_ms) {
+    if (pulse.active || seq_running)
+        return false;
+    pulse.active = true;
+    pulse.done = false;
+    pulse.duration_us = duration_ms * 1000u;
+    pulse.start_cmd_us = time_us_64() + PULSE_LEAD_US;
+    if (add_alarm_at(from_us_since_boot(pulse.start_cmd_us), pulse_start_alarm, NULL, true) < 0) {
+        pulse.active = false;
+        pulse.failed = true;
+        return false;
+    }
+    return true;
+}
+
+static void jitter_reset(JitterStats *s) {
+    s->count = 0;
+    s->sum = 0;
+    s->min = INT32_MAX;
+    s->max = INT32_MIN;
+}
+
+static void jitter_add(JitterStats *s, int32_t v) {
+    s->count++;
+    s->sum += v;
+    if (v < s->min) s->min = v;
+    if (v > s->max) s->max = v;
+}
+
+static void jitter_print(const char *name, const JitterStats *s) {
+    if (s->count == 0)
+        return;
+    printf("%s: n=%lu, min %ld us, max %ld us, mittel %.2f us\n", name,
+           (unsigned long)s->count, (long)s->min, (long)s->max, (double)s->sum / s->count);
+}
+
+// -------------------------
+//  PULSFOLGE PER PIO
+// -------------------------
+// "seq <hoch_ns> <tief_ns> <anzahl> [<hoch_ns> <tief_ns> <anzahl> ...]"
+static void sequence_command(const char *args) {
+    pulse_seq_step_t steps[SEQ_MAX_STEPS];
+    size_t count = 0;
+    char *end;
+
+    while (count < SEQ_MAX_STEPS) {
+        unsigned long high = strtoul(args, &end, 10);
+        if (end == args)
+            break;
+        args = end;
+        unsigned long low = strtoul(args, &end, 10);
+        if (end == args)
+            break;
+        args = end;
+        unsigned long repeat = strtoul(args, &end, 10);
+        if (end == args)
+            repeat = 1;
+        args = end;
+        steps[count++] = (pulse_seq_step_t){ high, low, repeat };
+    }
+    if (count == 0) {
+        printf("Aufruf: seq <hoch_ns> <tief_ns> <anzahl> ...\n");
+        return;
+    }
+    if (pulse.active || seq_running) {
+        printf("Puls läuft noch.\n");
+        return;
+    }
+
+    uint32_t clk_hz = pulse_seq_clock_hz();
+    size_t words;
+    pulse_seq_status_t st = pulse_seq_encode(steps, count, clk_hz, seq_table, SEQ_MAX_WORDS, &words);
+    if (st == PULSE_SEQ_ERR_SHORT) {
+        printf("Zeit zu kurz (mindestens %lu Takte à %lu ns)\n",
+               (unsigned long)PULSE_SEQ_MIN_CYCLES, (unsigned long)(1000000000u / clk_hz));
+        return;
+    } else if (st != PULSE_SEQ_OK) {
+        printf("Folge zu lang (max. %d Pulse)\n", SEQ_MAX_WORDS / 2);
+        return;
+    }
+
+    uint64_t cycles = pulse_seq_table_cycles(seq_table, words);
+    seq_running = pulse_seq_start(seq_table, words);
+    printf("Pulsfolge gestartet! %u Pulse, %llu ns\n", (unsigned)(words / 2),
+           (unsigned long long)(cycles * 1000000000u / clk_hz));
+}
+
+// -------------------------
+//  SEGMENTIERTER SPEICHER
+// -------------------------
+// Zeit von Sample `seq` der Segment-Aufnahme in ns
+static uint64_t seg_time_ns(uint64_t seq) {
+    return seg_t0_ns + seq * adc_capture_sample_period_ps() / 1000u;
+}
+
+// "seg <anzahl> [<vorlauf> <nachlauf>]" | "seg aus"
+static void segment_command(const char *args) {
+    if (strcmp(args, " aus") == 0) {
+        if (seg_active) {
+            adc_capture_stop();
+            seg_active = false;
+            printf("Segment-Aufnahme abgebrochen, %lu Segmente\n", (unsigned long)segments.count);
+        }
+        return;
+    }
+    if (seg_active) {
+        printf("Segment-Aufnahme läuft noch (%lu von %lu)\n",
+               (unsigned long)segments.count, (unsigned long)segments.max_segments);
+        return;
+    }
+
+    unsigned count = 0, pre = SEG_DEFAULT_PRE, post = SEG_DEFAULT_POST;
+    int n = sscanf(args, "%u %u %u", &count, &pre, &post);
+    if (n == 2 || pre + post > SEG_MAX_WINDOW) {
+        printf("Aufruf: seg <anzahl> [<vorlauf> <nachlauf>], zusammen max. %d Samples\n",
+               SEG_MAX_WINDOW);
+        return;
+    }
+
+    const trigger_config_t cfg = {
+        .mode = TRIGGER_RISING,
+        .level = THRESHOLD,
+        .hysteresis = SEG_HYSTERESIS,
+        .pre = pre,
+        .post = post,
+    };
+    if (!segment_store_init(&segments, &cfg, seg_window, seg_memory, SEG_MEMORY_SAMPLES,
+                            seg_trigger_seq, SEG_MAX_SEGMENTS, count)) {
+        printf("Ungültige Segmentlänge\n");
+        return;
+    }
+
+    segment_store_arm(&segments);
+    seg_next_block = 0;
+    seg_gaps = 0;
+    adc_capture_start();
+    seg_t0_ns = adc_capture_sample_time_ns(0);
+    seg_active = true;
+    seg_valid = true;
+    printf("Segment-Aufnahme: %lu Segmente à %lu Samples (%lu Vorlauf)\n",
+           (unsigned long)segments.max_segments, (unsigned long)segments.segment_len,
+           (unsigned long)pre);
+}
+
+// Fertige DMA-Blöcke durch den Segment-Speicher schieben
+static void segment_poll(void) {
+    capture_ring_t *ring = adc_capture_ring();
+    const uint16_t *block;
+    uint32_t seq;
+
+    while ((block = capture_ring_peek(ring, &seq)) != NULL) {
+        // Übersprungene Blöcke: das offene Fenster wäre nicht lückenlos
+        if (seq != seg_next_block) {
+            segment_store_gap(&segments, 0);
+            seg_gaps++;
+        }
+        uint32_t done = segment_store_feed(&segments, block, (uint64_t)seq * SEG_BLOCK_LEN,
+                                           SEG_BLOCK_LEN);
+        // Block während des Lesens überschrieben: auch daraus fertige Segmente verwerfen
+        if (!capture_ring_release(ring, seq)) {
+            segment_store_gap(&segments, done);
+            seg_gaps++;
+        }
+        seg_next_block = seq + 1;
+        if (segment_store_full(&segments))
+            break;
+    }
+
+    if (segment_store_full(&segments)) {
+        adc_capture_stop();
+        seg_active = false;
+        uint64_t first = seg_time_ns(segment_store_first_seq(&segments, 0));
+        uint64_t last = seg_time_ns(segment_store_first_seq(&segments, segments.count - 1)
+                                    + segments.segment_len - 1);
+        printf("Segmente voll: %lu in %.3f ms, %lu Block-Überläufe, %lu Fenster verworfen\n",
+               (unsigned long)segments.count, (last - first) / 1e6,
+               (unsigned long)ring->overruns, (unsigned long)seg_gaps);
+    }
+}
+
+// "dump" (CSV) | "dump bin" (Trigger-Frames, ein Fenster pro Segment)
+static void segment_dump(bool binary) {
+    if (!seg_valid || seg_active) {
+        printf("Keine fertige Segment-Aufnahme\n");
+        return;
+    }
+
+    uint32_t len = segments.segment_len;
+    uint32_t pre = segments.trig.cfg.pre;
+    for (uint32_t k = 0; k < segments.count; k++) {
+        const uint16_t *samples = segment_store_samples(&segments, k);
+        uint64_t first = segment_store_first_seq(&segments, k);
+
+        if (binary) {
+            for (uint32_t i = 0; i < len; i += TELEMETRY_MAX_SAMPLES) {
+                uint32_t n = len - i < TELEMETRY_MAX_SAMPLES ? len - i : TELEMETRY_MAX_SAMPLES;
+                uint16_t aux = (uint16_t)pre | (i + n == len ? TELEMETRY_TRIGGER_LAST : 0);
+                telemetry_send(TELEMETRY_FRAME_TRIGGER, seg_frame_seq++, aux, seg_time_ns(first + i),
+                               adc_capture_sample_period_ps(), &samples[i], (uint16_t)n);
+            }
+            continue;
+        }
+
+        uint64_t t_ns = seg_time_ns(segments.trigger_seq[k]);
+        printf("Segment %lu: Trigger %llu.%03u us\n", (unsigned long)k,
+               (unsigned long long)(t_ns / 1000u), (unsigned)(t_ns % 1000u));
+        for (uint32_t i = 0; i < len; i++) {
+            t_ns = seg_time_ns(first + i);
+            printf("%llu.%03u, %.3f\n", (unsigned long long)(t_ns / 1000u), (unsigned)(t_ns % 1000u),
+                   (float)samples[i] * VperDev);
+        }
+    }
+    if (!binary)
+        printf("Ende der Segmente\n");
+}
+
+// Ist-Zeiten des beendeten Pulses ausgeben und in die Statistik aufnehmen
+static void pulse_report(void) {
+    int32_t start_err = (int32_t)(pulse.start_us - pulse.start_cmd_us);
+    uint32_t actual_us = (uint32_t)(pulse.end_us - pulse.start_us);
+    int32_t duration_err = (int32_t)(actual_us - pulse.duration_us);
+
+    jitter_add(&start_stats, start_err);
+    jitter_add(&duration_stats, duration_err);
+    pulse.done = false;
+
+    // Soll-Dauer, Ist-Dauer, Startzeit, Endzeit (us seit Boot), Startabweichung
+    printf("Puls beendet! %lu, %lu, %llu, %llu, %ld\n",
+           (unsigned long)pulse.duration_us, (unsigned long)actual_us,
+           (unsigned long long)pulse.start_us, (unsigned long long)pulse.end_us,
+           (long)start_err);
+}
+
 int main() {
     stdio_init_all();
 
@@ -28,20 +348,40 @@ int main() {
     gpio_init(PULSE_PIN);
     gpio_set_dir(PULSE_PIN, GPIO_OUT);
     gpio_put(PULSE_PIN, 0);
+    pulse_seq_init(PULSE_PIN);
 
     int pulse_ms = DEFAULT_PULSE_MS;
-    char input_buffer[32];
+    char input_buffer[64];
     int input_index = 0;
 
-    PulseState pulse = { .active = false, .start_us = 0, .duration_ms = 0 };
+    jitter_reset(&start_stats);
+    jitter_reset(&duration_stats);
+    int bench_left = 0;             // verbleibende Pulse des Benchmarks
+    uint64_t bench_next_us = 0;
 
     // --- ADC Setup ---
     adc_init();
     adc_gpio_init(26);
     adc_select_input(0);
 
+    // ADC im Free-Running-Modus per DMA auslesen (volle Rate, 500 kS/s)
+    // Ring nur für die Segment-Aufnahme, sonst Einzelerfassung
+    adc_capture_config_t capture_cfg = {
+        .input = 0,
+        .clkdiv = 0.0f,
+        .buffer = seg_ring,
+        .block_len = SEG_BLOCK_LEN,
+        .block_count = SEG_BLOCKS,
+    };
+    adc_capture_init(&capture_cfg);
+    printf("Abtastung: %.3f Hz (Periode %lu ps)\n",
+           1e12 / adc_capture_sample_period_ps(), adc_capture_sample_period_ps());
+
     printf("Bereit! Gib eine Pulsdauer in ms ein (z.B. 40) und drücke Enter.\n");
     printf("Nur Enter = Wiederhole letzten Puls (%d ms)\n", pulse_ms);
+    printf("'bench' = %d Pulse, danach Soll/Ist-Statistik; 'jitter' = Statistik\n", BENCH_PULSES);
+    printf("'seq <hoch_ns> <tief_ns> <anzahl> ...' = Pulsfolge per PIO\n");
+    printf("'seg <anzahl> [<vorlauf> <nachlauf>]' = Segment-Aufnahme, 'dump [bin]' = Ausgabe\n");
 
     while (true) {
         // --- Eingabe prüfen ---
@@ -49,7 +389,32 @@ int main() {
         if (c != PICO_ERROR_TIMEOUT) {
             if (c == '\r' || c == '\n') {
                 input_buffer[input_index] = '\0';
-                if (input_index > 0) {
+                if (strcmp(input_buffer, "bench") == 0) {
+                    jitter_reset(&start_stats);
+                    jitter_reset(&duration_stats);
+                    bench_left = BENCH_PULSES;
+                    bench_next_us = time_us_64();
+                    printf("Benchmark: %d Pulse à %d ms\n", BENCH_PULSES, pulse_ms);
+                    input_index = 0;
+                    continue;
+                } else if (strncmp(input_buffer, "seq", 3) == 0) {
+                    sequence_command(input_buffer + 3);
+                    input_index = 0;
+                    continue;
+                } else if (strncmp(input_buffer, "seg", 3) == 0) {
+                    segment_command(input_buffer + 3);
+                    input_index = 0;
+                    continue;
+                } else if (strncmp(input_buffer, "dump", 4) == 0) {
+                    segment_dump(strcmp(input_buffer + 4, " bin") == 0);
+                    input_index = 0;
+                    continue;
+                } else if (strcmp(input_buffer, "jitter") == 0) {
+                    jitter_print("Startabweichung", &start_stats);
+                    jitter_print("Dauerabweichung", &duration_stats);
+                    input_index = 0;
+                    continue;
+                } else if (input_index > 0) {
                     int new_value = atoi(input_buffer);
                     if (new_value > 0) {
                         pulse_ms = new_value;
@@ -62,34 +427,63 @@ int main() {
                     printf("Wiederhole letzten Puls (%d ms)\n", pulse_ms);
                 }
 
-                // Puls asynchron starten
-                pulse.active = true;
-                pulse.start_us = time_us_32();
-                pulse.duration_ms = pulse_ms;
-                gpio_put(PULSE_PIN, 1);
-                printf("Puls gestartet!\n");
-            } else if (c >= '0' && c <= '9' && input_index < (int)sizeof(input_buffer) - 1) {
+                // Puls asynchron per Alarm starten
+                if (pulse_schedule(pulse_ms))
+                    printf("Puls gestartet!\n");
+                else if (!pulse.failed)
+                    printf("Puls läuft noch.\n");
+            } else if (((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == ' ')
+                       && input_index < (int)sizeof(input_buffer) - 1) {
                 input_buffer[input_index++] = (char)c;
             } else if (c == '\b' && input_index > 0) {
                 input_index--;
             }
         }
 
-        // --- Puls beenden, falls Zeit abgelaufen ---
-        if (pulse.active && time_us_32() - pulse.start_us >= pulse.duration_ms * 1000) {
-            gpio_put(PULSE_PIN, 0);
-            pulse.active = false;
-            printf("Puls beendet!\n");
+        // --- Beendeten Puls melden (Flanken setzt der Alarm-IRQ) ---
+        if (pulse.done) {
+            pulse_report();
+            if (bench_left > 0) {
+                bench_left--;
+                bench_next_us = time_us_64() + BENCH_GAP_MS * 1000u;
+                if (bench_left == 0) {
+                    jitter_print("Startabweichung", &start_stats);
+                    jitter_print("Dauerabweichung", &duration_stats);
+                }
+            }
         }
 
-        // --- ADC-Messung ---
-        uint16_t samples[NUM_SAMPLES];
-        uint32_t timestamps[NUM_SAMPLES];
-        for (int i = 0; i < NUM_SAMPLES; i++) {
-            timestamps[i] = time_us_32();
-            samples[i] = adc_read();
+        // --- Puls mangels Alarm abgebrochen (beim Planen oder im Start-IRQ) ---
+        if (pulse.failed) {
+            pulse.failed = false;
+            printf("FEHLER: Kein Alarm frei, Puls abgebrochen.\n");
+            if (bench_left > 0) {
+                bench_left = 0;
+                printf("Benchmark abgebrochen.\n");
+            }
+        }
+
+        // --- Pulsfolge fertig: Pin zurück an den SIO ---
+        if (seq_running && !pulse_seq_busy()) {
+            pulse_seq_stop();
+            seq_running = false;
+            printf("Pulsfolge beendet!\n");
         }
 
+        // --- Benchmark: nächsten Puls planen ---
+        if (bench_left > 0 && !pulse.active && !pulse.done && time_us_64() >= bench_next_us)
+            pulse_schedule(pulse_ms);
+
+        // --- Segment-Aufnahme: ADC läuft frei, keine Einzelmessung ---
+        if (seg_active) {
+            segment_poll();
+            continue;
+        }
+
+        // --- ADC-Messung (DMA, feste Abtastrate) ---
+        static uint16_t samples[NUM_SAMPLES];
+        adc_capture_oneshot(samples, NUM_SAMPLES);
+
         // --- Pulsanalyse ---
         /* int pulse_start = -1, pulse_end = -1;
         for (int i = 1; i < NUM_SAMPLES; i++) {
@@ -116,9 +510,10 @@ int main() {
             for (int i = pulse_end; i < NUM_SAMPLES; i++) sum_aus += samples[i];
             float avg_aus = (float)sum_aus / (NUM_SAMPLES - pulse_end) * VperDev;
 
-            uint32_t pulse_time_us = timestamps[pulse_end] - timestamps[pulse_start];
+            float pulse_time_us = (adc_capture_sample_time_ns(pulse_end)
+                                   - adc_capture_sample_time_ns(pulse_start)) / 1000.0f;
 
-            printf("%d, %d, %d, %.2f, %.2f, %lu\n",
+            printf("%d, %d, %d, %.2f, %.2f, %.3f\n",
                    pulse_start, pulse_end, pulse_end - pulse_start,
                    avg_an, avg_aus, pulse_time_us);
         } else {
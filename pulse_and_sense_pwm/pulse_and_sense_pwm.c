@@ -5,6 +5,7 @@
 #include "hardware/adc.h"
 #include "hardware/pwm.h"
 #include "pico/time.h"
+#include "pwm_timing.h"
 
 #define PULSE_PIN 15
 #define PULSE_DURATION_MS 1000   // Fixe Pulsdauer
@@ -25,18 +26,14 @@ int main() {
     uint slice_num = pwm_gpio_to_slice_num(PULSE_PIN);
     uint channel = pwm_gpio_to_channel(PULSE_PIN);
 
-    // PWM-Frequenz einstellen
-    // Systemtakt normalerweise 125 MHz
-    const float sys_clk = 125000000;
-    float freq = 0.00001f;                 // Gewünschte Puls-Frequenz
-    // Clock divider: z.B. CLKDIV = 125, um Zählerfrequenz 1 MHz zu erhalten
-    float clkdiv = 125.0f;
+    // PWM-Frequenz einstellen: Teiler und wrap aus dem tatsächlichen
+    // Systemtakt, feinste Auflösung
+    float freq = 2000.0f;                  // PWM-Frequenz während des Pulses
+    pwm_timing_t timing = { 0 };
+    pwm_timing_status_t timing_status = pwm_timing_for_freq(freq, 100, 0, &timing);
+    uint16_t wrap = timing.wrap;
 
-    // Wrap Wert berechnen: Wrap = (PWM_Takt / freq) - 1
-    uint16_t wrap = (uint16_t)((sys_clk / clkdiv) / freq) - 1;
-
-    pwm_set_wrap(slice_num, wrap);
-    pwm_set_clkdiv(slice_num, 1.0f);
+    pwm_timing_apply(slice_num, &timing);
     pwm_set_enabled(slice_num, false);
 
     char input_buffer[32];
@@ -50,6 +47,7 @@ int main() {
     adc_gpio_init(26);
     adc_select_input(0);
 
+    pwm_timing_report(freq, timing_status, &timing);
     printf("Bereit! Gib PWM-Stärke in %% ein (z.B. 40) und drücke Enter.\n");
     printf("Pulsdauer ist fix: %d ms\n", PULSE_DURATION_MS);
 
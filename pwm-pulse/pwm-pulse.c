@@ -1,5 +1,5 @@
 // pwm-pulse.c
-// Asynchrone Pulssteuerung + möglichst schnelle ADC-Messung auf Core1.
+// Asynchrone Pulssteuerung + ADC-Messung mit fester Rate auf Core1.
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -8,35 +8,201 @@
 #include "pico/multicore.h"
 #include "hardware/adc.h"
 #include "hardware/pwm.h"
+#include "adc_clock.h"
+#include "pwm_timing.h"
+#include "spsc_ring.h"
+#include "telemetry.h"
+#include "trigger.h"
 
 #define PULSE_PIN 15           // GPIO-Pin für den Puls
 #define ADC_PIN 26             // GPIO26 -> ADC0
 #define DEFAULT_PULSE_MS 100   // Standard-Pulsdauer in ms
+#define ADC_CLKDIV 0.0f        // frei laufender ADC, 0 = volle Rate (500 kS/s)
 
 // ADC-Referenz und Skalierung (12-bit ADC auf RP2040 -> 0..4095)
 #define VREF 3300.0f
 #define ADC_MAX 4095.0f
 #define VperDev (VREF / ADC_MAX)
 
-// Core1: schnelle ADC-Schleife; sendet (timestamp_us, sample) per FIFO an Core0.
+// Core1 -> Core0: Batches von Samples im gemeinsamen SRAM (spsc_ring.h)
+#define BATCH_SAMPLES 64
+#define RING_BATCHES 32
+
+// Keine Zeitstempel pro Sample: die Zeit folgt aus der laufenden Nummer
+// (Start des ADC + Nummer * Abtastperiode, siehe adc_clock.h)
+typedef struct {
+    uint64_t first_seq;                 // laufende Nummer des ersten Samples
+    uint16_t sample[BATCH_SAMPLES];
+} sample_batch_t;
+
+static sample_batch_t ring_storage[RING_BATCHES];
+static sample_batch_t discard_batch;    // Ziel, solange der Ring voll ist
+static spsc_ring_t ring;
+
+static uint32_t adc_period_ps;          // exakte Abtastperiode aus ADC_CLKDIV
+static volatile uint64_t adc_t0_us;     // Start des ADC, von Core1 vor dem ersten Batch gesetzt
+
+// Zeitpunkt in ns, zu dem Sample `seq` fertig war
+static uint64_t sample_time_ns(uint64_t seq) {
+    return adc_clock_sample_time_ns(adc_t0_us, seq, adc_period_ps);
+}
+
+// Nummer des ersten Samples, das zum Zeitpunkt `t_us` oder später fertig wird
+static uint64_t sample_seq_at(uint64_t t_us) {
+    if (t_us <= adc_t0_us)
+        return 0;
+    uint64_t ps = (t_us - adc_t0_us) * 1000000u;
+    return (ps + adc_period_ps - 1) / adc_period_ps - 1;
+}
+
+// Ausgabeformat: CSV-Zeilen oder Binär-Frames (Befehle "csv" / "bin")
+static telemetry_mode_t telemetry_mode = TELEMETRY_CSV;
+static telemetry_batch_t batch;
+
+// Trigger auf dem Gerät (Befehl "trig"): statt des ganzen Stroms nur das
+// Fenster um das Ereignis senden
+#define TRIGGER_MAX_WINDOW 4096
+#define TRIGGER_DEFAULT_PRE 256
+#define TRIGGER_DEFAULT_POST 1792
+
+static trigger_t trig;
+static bool trigger_on = false;
+static trigger_config_t trig_cfg = {
+    .mode = TRIGGER_RISING,
+    .pre = TRIGGER_DEFAULT_PRE,
+    .post = TRIGGER_DEFAULT_POST,
+};
+static uint16_t trig_samples[TRIGGER_MAX_WINDOW];
+static uint16_t window_samples[TRIGGER_MAX_WINDOW];
+static uint16_t trigger_seq = 0;
+
+// Core1: ADC frei laufend mit fester Rate, Samples aus dem FIFO batchweise in den Ring.
+// Ist der Ring voll, wird ein ganzer Batch verworfen (Überlauf im Ring gezählt);
+// die Nummerierung läuft weiter, die Zeitbasis bleibt also gültig.
 void adc_core1() {
     // ADC initialisieren
     adc_init();
     adc_gpio_init(ADC_PIN); // GPIO26 -> ADC0
     adc_select_input(0);
+    // FIFO an, kein DREQ, keine Fehlerbits, keine Byte-Verschiebung
+    adc_fifo_setup(true, false, 1, false, false);
+    adc_set_clkdiv(ADC_CLKDIV);
+
+    uint64_t seq = 0;
+    adc_t0_us = time_us_64();
+    adc_run(true);
 
     while (true) {
-        uint32_t sample = adc_read(); // 12-bit (0..4095)
-        uint32_t t = time_us_32();
-
-        // Wenn FIFO write-ready ist, sende Timestamp und Sample.
-        // Falls FIFO voll ist, verwerfe das Sample (so bleibt Sampling maximal schnell).
-        if (multicore_fifo_wready()) {
-            multicore_fifo_push_blocking(t);
-            multicore_fifo_push_blocking(sample);
+        sample_batch_t *b = spsc_ring_claim(&ring);
+        bool keep = b != NULL;
+        if (!keep)
+            b = &discard_batch;
+
+        b->first_seq = seq;
+        for (int i = 0; i < BATCH_SAMPLES; i++)
+            b->sample[i] = adc_fifo_get_blocking(); // 12-bit (0..4095)
+        seq += BATCH_SAMPLES;
+
+        if (keep)
+            spsc_ring_publish(&ring);
+    }
+}
+
+// Fertiges Trigger-Fenster senden. Binär: Frames vom Typ
+// TELEMETRY_FRAME_TRIGGER, Zusatzwert = Vorlauf | TELEMETRY_TRIGGER_LAST.
+static void send_trigger_window(void) {
+    uint32_t len = trig_cfg.pre + trig_cfg.post;
+    uint64_t first = trigger_window_seq(&trig);
+    trigger_copy_window(&trig, window_samples);
+
+    if (telemetry_mode == TELEMETRY_BINARY) {
+        for (uint32_t i = 0; i < len; i += TELEMETRY_MAX_SAMPLES) {
+            uint32_t n = len - i < TELEMETRY_MAX_SAMPLES ? len - i : TELEMETRY_MAX_SAMPLES;
+            uint16_t aux = (uint16_t)trig_cfg.pre | (i + n == len ? TELEMETRY_TRIGGER_LAST : 0);
+            telemetry_send(TELEMETRY_FRAME_TRIGGER, trigger_seq++, aux, sample_time_ns(first + i),
+                           adc_period_ps, &window_samples[i], (uint16_t)n);
+        }
+    } else {
+        uint64_t t_ns = sample_time_ns(trig.trigger_seq);
+        printf("Trigger: %llu.%03u us, %lu Vorlauf, %lu Nachlauf\n",
+               (unsigned long long)(t_ns / 1000u), (unsigned)(t_ns % 1000u),
+               (unsigned long)trig_cfg.pre, (unsigned long)trig_cfg.post);
+        for (uint32_t i = 0; i < len; i++) {
+            t_ns = sample_time_ns(first + i);
+            printf("%llu.%03u, %.3f\n", (unsigned long long)(t_ns / 1000u), (unsigned)(t_ns % 1000u),
+                   (float)window_samples[i] * VperDev);
+        }
+    }
+}
+
+// "trig aus" | "trig puls" | "trig <steigend|fallend|hoch|tief> <mV> [hyst_mV] [holdoff_ms]"
+// "fenster <vorlauf> <nachlauf>"
+static void trigger_command(const char *cmd) {
+    char mode[16] = "";
+    int level_mv = 0, hyst_mv = 0, holdoff_ms = 0;
+    unsigned pre = 0, post = 0;
+
+    if (sscanf(cmd, "fenster %u %u", &pre, &post) == 2) {
+        // %u nimmt bis 2^32 - 1 (und "-1") an; die Summe liefe dann über
+        if (post == 0 || post > TRIGGER_MAX_WINDOW || pre > TRIGGER_MAX_WINDOW - post) {
+            printf("Fenster: Vorlauf + Nachlauf 1..%d Samples\n", TRIGGER_MAX_WINDOW);
+            return;
+        }
+        trig_cfg.pre = pre;
+        trig_cfg.post = post;
+        if (!trigger_on) {
+            printf("Fenster: %u + %u Samples\n", pre, post);
+            return;
+        }
+    } else {
+        int n = sscanf(cmd, "trig %15s %d %d %d", mode, &level_mv, &hyst_mv, &holdoff_ms);
+        // Negative Werte würden beim Umrechnen in uint16_t/uint32_t umlaufen
+        if (level_mv < 0 || level_mv > VREF || hyst_mv < 0 || hyst_mv > VREF || holdoff_ms < 0) {
+            printf("Trigger: Schwelle und Hysterese 0..%.0f mV, Holdoff >= 0 ms\n", VREF);
+            return;
+        }
+        uint64_t holdoff = (uint64_t)holdoff_ms * 1000000000u / adc_period_ps;
+        if (holdoff > UINT32_MAX) {
+            printf("Trigger: Holdoff zu lang (höchstens %llu ms)\n",
+                   (unsigned long long)((uint64_t)UINT32_MAX * adc_period_ps / 1000000000u));
+            return;
+        }
+        if (n >= 1 && strcmp(mode, "aus") == 0) {
+            trigger_on = false;
+            printf("Trigger aus, Ausgabe wieder fortlaufend\n");
+            return;
+        } else if (n >= 1 && strcmp(mode, "puls") == 0) {
+            trig_cfg.mode = TRIGGER_EXTERNAL;
+        } else if (n >= 2 && strcmp(mode, "steigend") == 0) {
+            trig_cfg.mode = TRIGGER_RISING;
+        } else if (n >= 2 && strcmp(mode, "fallend") == 0) {
+            trig_cfg.mode = TRIGGER_FALLING;
+        } else if (n >= 2 && strcmp(mode, "hoch") == 0) {
+            trig_cfg.mode = TRIGGER_ABOVE;
+        } else if (n >= 2 && strcmp(mode, "tief") == 0) {
+            trig_cfg.mode = TRIGGER_BELOW;
+        } else {
+            printf("Aufruf: trig <steigend|fallend|hoch|tief> <mV> [hyst_mV] [holdoff_ms] | trig puls | trig aus\n");
+            return;
+        }
+        if (trig_cfg.mode != TRIGGER_EXTERNAL) {
+            trig_cfg.level = (uint16_t)(level_mv / VperDev + 0.5f);
+            trig_cfg.hysteresis = (uint16_t)(hyst_mv / VperDev + 0.5f);
+            trig_cfg.holdoff = (uint32_t)holdoff;
         }
-        sleep_us(250); 
     }
+
+    telemetry_batch_flush(&batch);
+    if (!trigger_init(&trig, &trig_cfg, trig_samples, TRIGGER_MAX_WINDOW)) {
+        trigger_on = false;
+        printf("FEHLER: Trigger-Konfiguration ungültig, Ausgabe wieder fortlaufend\n");
+        return;
+    }
+    trigger_arm(&trig);
+    trigger_on = true;
+    printf("Trigger scharf: Modus %d, Schwelle %u, Hysterese %u, Holdoff %lu, Fenster %lu + %lu Samples\n",
+           trig_cfg.mode, trig_cfg.level, trig_cfg.hysteresis, (unsigned long)trig_cfg.holdoff,
+           (unsigned long)trig_cfg.pre, (unsigned long)trig_cfg.post);
 }
 
 int main() {
@@ -47,18 +213,13 @@ int main() {
     uint slice_num = pwm_gpio_to_slice_num(PULSE_PIN);
     uint channel = pwm_gpio_to_channel(PULSE_PIN);
 
-    // PWM-Frequenz einstellen
-    // Systemtakt normalerweise 125 MHz
-    const float sys_clk = 125000000;
+    // PWM-Frequenz einstellen: Teiler und wrap aus dem tatsächlichen
+    // Systemtakt, feinste Auflösung
     float freq = 100.0f;                 // Gewünschte Puls-Frequenz
-    // Clock divider: z.B. CLKDIV = 125, um Zählerfrequenz 1 MHz zu erhalten
-    float clkdiv = 125.0f;
-
-    // Wrap Wert berechnen: Wrap = (PWM_Takt / freq) - 1
-    uint16_t wrap = (uint16_t)((sys_clk / clkdiv) / freq) - 1;
+    pwm_timing_t timing = { 0 };
+    pwm_timing_status_t timing_status = pwm_timing_for_freq(freq, 100, 0, &timing);
 
-    pwm_set_wrap(slice_num, wrap);
-    pwm_set_clkdiv(slice_num, 1.0f);
+    pwm_timing_apply(slice_num, &timing);
     pwm_set_enabled(slice_num, false);
 
     // Pulse-Pin konfigurieren
@@ -67,26 +228,68 @@ int main() {
     gpio_put(PULSE_PIN, 0);
 
     // Starte ADC-Thread auf Core1
+    adc_period_ps = adc_clock_period_ps(ADC_CLKDIV);
+    spsc_ring_init(&ring, ring_storage, sizeof(sample_batch_t), RING_BATCHES);
     multicore_launch_core1(adc_core1);
 
+    // Verlustzählung anhand der laufenden Sample-Nummern
+    uint64_t next_seq = 0;
+    uint64_t received = 0;
+    uint64_t lost = 0;
+
     int pulse_ms = DEFAULT_PULSE_MS;
-    char input_buffer[32];
+    char input_buffer[64];
     int input_index = 0;
 
     // pulse_end_us == 0 -> kein aktiver Puls
-    uint32_t pulse_end_us = 0;
+    uint64_t pulse_end_us = 0;
 
+    telemetry_batch_init(&batch, TELEMETRY_FRAME_SAMPLES, adc_period_ps);
+
+    pwm_timing_report(freq, timing_status, &timing);
+    printf("Abtastung: %.3f Hz (Periode %lu ps)\n", 1e12 / adc_period_ps, (unsigned long)adc_period_ps);
     printf("Bereit! Gib eine Pulsdauer in ms ein (z.B. 40) und drücke Enter.\n");
     printf("Nur Enter = Wiederhole letzten Puls (%d ms)\n", pulse_ms);
+    printf("Ausgabeformat: 'csv' (Text) oder 'bin' (Binär-Frames)\n");
+    printf("'stat' = empfangene und verlorene Samples\n");
+    printf("'trig <steigend|fallend|hoch|tief> <mV> [hyst_mV] [holdoff_ms]', 'trig puls', 'trig aus', 'fenster <vor> <nach>'\n");
 
     while (true) {
-        // 1) ADC-Daten aus FIFO lesen und ausgeben (so oft wie Core0 hinterherkommt)
-        while (multicore_fifo_rvalid()) {
-            uint32_t t = multicore_fifo_pop_blocking();
-            uint32_t sample = multicore_fifo_pop_blocking();
-            float voltage = (float)sample * VperDev;
-            // Ausgabe: Zeitpunkt (us), Spannung (V)
-            printf("%llu, %.3f\n", (unsigned long long)t, voltage);
+        // 1) Alle fertigen Batches aus dem Ring lesen und ausgeben
+        const sample_batch_t *b;
+        while ((b = spsc_ring_peek(&ring)) != NULL) {
+            lost += b->first_seq - next_seq;
+            next_seq = b->first_seq + BATCH_SAMPLES;
+            received += BATCH_SAMPLES;
+
+            if (trigger_on) {
+                // Nur das Fenster um das Ereignis senden, danach neu scharf schalten
+                uint32_t done = 0;
+                while (done < BATCH_SAMPLES) {
+                    done += trigger_feed(&trig, &b->sample[done], b->first_seq + done, BATCH_SAMPLES - done);
+                    if (trigger_done(&trig)) {
+                        send_trigger_window();
+                        trigger_arm(&trig);
+                    }
+                }
+                spsc_ring_release(&ring);
+                continue;
+            }
+
+            // Zusatzwert: Pulszustand (1000 = Laser an)
+            batch.aux = pulse_end_us != 0 ? 1000 : 0;
+            if (telemetry_mode == TELEMETRY_BINARY) {
+                telemetry_batch_add_block(&batch, sample_time_ns(b->first_seq), b->sample, BATCH_SAMPLES);
+            } else {
+                for (int i = 0; i < BATCH_SAMPLES; i++) {
+                    float voltage = (float)b->sample[i] * VperDev;
+                    uint64_t t_ns = sample_time_ns(b->first_seq + i);
+                    // Ausgabe: Zeitpunkt (us, 1 ns Auflösung), Spannung (V)
+                    printf("%llu.%03u, %.3f\n", (unsigned long long)(t_ns / 1000u),
+                           (unsigned)(t_ns % 1000u), voltage);
+                }
+            }
+            spsc_ring_release(&ring);
         }
 
         // 2) Eingabe verarbeiten (nicht-blockierend)
@@ -95,25 +298,57 @@ int main() {
             if (c == '\r' || c == '\n') { // Enter
                 input_buffer[input_index] = '\0';
 
-                if (input_index > 0) {
-                    int new_value = atoi(input_buffer);
-                    if (new_value > 0) {
-                        pulse_ms = new_value;
-                        printf("Neue Pulsdauer: %d ms\n", pulse_ms);
-                    } else {
-                        printf("Ungültige Eingabe. Verwende letzten Wert: %d ms\n", pulse_ms);
-                    }
+                if (strcmp(input_buffer, "bin") == 0) {
+                    telemetry_mode = TELEMETRY_BINARY;
+                    printf("Ausgabe: Binär-Frames\n");
+                    input_index = 0;
+                } else if (strcmp(input_buffer, "stat") == 0) {
+                    printf("Samples: %llu empfangen, %llu verloren (%lu Ring-Überläufe)\n",
+                           (unsigned long long)received, (unsigned long long)lost,
+                           (unsigned long)spsc_ring_overflows(&ring));
+                    input_index = 0;
+                } else if (strncmp(input_buffer, "trig", 4) == 0
+                           || strncmp(input_buffer, "fenster", 7) == 0) {
+                    trigger_command(input_buffer);
+                    input_index = 0;
+                } else if (strcmp(input_buffer, "csv") == 0) {
+                    telemetry_batch_flush(&batch);
+                    telemetry_mode = TELEMETRY_CSV;
+                    printf("Ausgabe: CSV\n");
                     input_index = 0;
                 } else {
-                    printf("Wiederhole letzten Puls (%d ms)\n", pulse_ms);
-                }
+                    bool fire = true;
+                    if (input_index > 0) {
+                        // Nur eine reine Zahl ist eine Pulsdauer; Tippfehler
+                        // in Befehlen lösen keinen Puls aus
+                        char *end = NULL;
+                        long new_value = strtol(input_buffer, &end, 10);
+                        if (end != input_buffer && *end == '\0' && new_value > 0) {
+                            pulse_ms = (int)new_value;
+                            printf("Neue Pulsdauer: %d ms\n", pulse_ms);
+                        } else {
+                            printf("Unbekannter Befehl '%s', kein Puls. Pulsdauer bleibt %d ms\n",
+                                   input_buffer, pulse_ms);
+                            fire = false;
+                        }
+                        input_index = 0;
+                    } else {
+                        printf("Wiederhole letzten Puls (%d ms)\n", pulse_ms);
+                    }
 
-                // Asynchronen Puls starten: Pin setzen und Endzeit merken
-                printf("Puls (asynchron)!\n");
-                gpio_put(PULSE_PIN, 1);
-                pulse_end_us = time_us_32() + (uint32_t)pulse_ms * 1000u;
+                    // Asynchronen Puls starten: Pin setzen und Endzeit merken
+                    if (fire) {
+                        printf("Puls (asynchron)!\n");
+                        gpio_put(PULSE_PIN, 1);
+                        uint64_t pulse_start_us = time_us_64();
+                        pulse_end_us = pulse_start_us + (uint64_t)pulse_ms * 1000u;
+                        if (trigger_on && trig_cfg.mode == TRIGGER_EXTERNAL)
+                            trigger_external(&trig, sample_seq_at(pulse_start_us));
+                    }
+                }
 
-            } else if (c >= '0' && c <= '9' && input_index < (int)sizeof(input_buffer) - 1) {
+            } else if (((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == ' ')
+                       && input_index < (int)sizeof(input_buffer) - 1) {
                 input_buffer[input_index++] = (char)c;
             } else if ((c == '\b' || c == 127) && input_index > 0) {
                 // Backspace (127 auf manchen Terminals)
@@ -122,14 +357,11 @@ int main() {
         }
 
         // 3) Pulse ausschalten, wenn Zeit abgelaufen (asynchron, non-blocking)
-        if (pulse_end_us != 0 && (int32_t)(time_us_32() - pulse_end_us) >= 0) {
+        if (pulse_end_us != 0 && time_us_64() >= pulse_end_us) {
             gpio_put(PULSE_PIN, 0);
             pulse_end_us = 0;
             printf("Puls fertig.\n");
         }
-
-        // Kurze Pause, um Core0 nicht 100% zu belegen; ADC läuft auf Core1 weiterhin maximal schnell.
-        sleep_ms(1);
     }
 
     return 0;
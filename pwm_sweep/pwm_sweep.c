@@ -1,3 +1,4 @@
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -5,17 +6,38 @@
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "hardware/adc.h"
+#include "hardware/clocks.h"
 #include "hardware/pwm.h"
 #include "hardware/flash.h"
 #include "hardware/sync.h"
 #include "pico/time.h"
+#include "adc_capture.h"
+#include "adaptive_sweep.h"
+#include "cal_store.h"
+#include "goertzel.h"
+#include "pwm_timing.h"
 
 #define PULSE_PIN 15
 #define SAMPLES_PER_STEP 1500
 #define VperDev 0.806f
 #define MAX_DUTY_CYCLE 255
+#define PWM_FREQ_HZ 1000
+#define SETTLE_MS 20
 
-#define FLASH_TARGET_OFFSET (PICO_FLASH_SIZE_BYTES - 4096)
+// Adaptiver Sweep: Blöcke zu einer PWM-Periode (500 kS/s, 1 kHz)
+#define BLOCK_SAMPLES 500
+#define ADAPTIVE_COARSE_POINTS 17
+
+// Bode-Messung: Photodiode (ADC0) gegen Referenz am Treiber (ADC1)
+#define BODE_REF_INPUT 1
+#define BODE_F_MIN_HZ 200
+#define BODE_F_MAX_HZ 50000
+#define BODE_POINTS 20
+#define BODE_MAX_POINTS 64
+#define BODE_MIN_PERIOD 4           // Samples pro Periode und Kanal
+#define BODE_SETTLE_PERIODS 10
+#define BODE_SETTLE_MIN_MS 2
+#define BODE_REF_MIN_MV 20.0f       // Grundwelle der Referenz, darunter fehlt sie an ADC1
 
 // -------------------------
 //  SICHERER PWM-START
@@ -29,65 +51,283 @@ void init_safe_pwm_pin() {
 // -------------------------
 //  PWM-SWEEP AUSGELAGERT
 // -------------------------
-void run_pwm_sweep(float *result_array) {
-
-    const float sys_clk = 125000000;
-    float freq = 1000.0f;
-    float clkdiv = 125.0f;
-    uint16_t wrap = (uint16_t)((sys_clk / clkdiv) / freq) - 1;
+// Teiler und wrap für PWM_FREQ_HZ (in main aus dem Systemtakt bestimmt)
+static pwm_timing_t sweep_timing;
 
+// PWM für den Sweep aktivieren, Rückgabe: wrap
+static uint16_t sweep_pwm_start(void) {
     uint slice_num = pwm_gpio_to_slice_num(PULSE_PIN);
-    uint channel   = pwm_gpio_to_channel(PULSE_PIN);
 
     // Erst hier PWM aktivieren!
     gpio_set_function(PULSE_PIN, GPIO_FUNC_PWM);
-    pwm_set_wrap(slice_num, wrap);
-    pwm_set_clkdiv(slice_num, clkdiv);
+    pwm_timing_apply(slice_num, &sweep_timing);
     pwm_set_enabled(slice_num, true);
+    return sweep_timing.wrap;
+}
+
+// Nach Sweep PWM wieder komplett abschalten
+static void sweep_pwm_stop(void) {
+    pwm_set_enabled(pwm_gpio_to_slice_num(PULSE_PIN), false);
+    gpio_set_function(PULSE_PIN, GPIO_FUNC_SIO);
+    gpio_set_dir(PULSE_PIN, GPIO_OUT);
+    gpio_put(PULSE_PIN, 0);  // DEAD-SAFE
+}
+
+void run_pwm_sweep(float *result_array) {
+
+    uint16_t wrap = sweep_pwm_start();
+    uint slice_num = pwm_gpio_to_slice_num(PULSE_PIN);
+    uint channel   = pwm_gpio_to_channel(PULSE_PIN);
+
+    static uint16_t samples[SAMPLES_PER_STEP];
 
     for (int duty = 0; duty <= MAX_DUTY_CYCLE; duty++) {
 
         uint16_t level = (wrap * duty) / MAX_DUTY_CYCLE;
         pwm_set_chan_level(slice_num, channel, level);
 
-        sleep_ms(20);
+        sleep_ms(SETTLE_MS);
+
+        // Block per DMA mit fester Abtastrate erfassen
+        adc_capture_oneshot(samples, SAMPLES_PER_STEP);
 
         uint64_t sum = 0;
         for (int i = 0; i < SAMPLES_PER_STEP; i++)
-            sum += adc_read();
+            sum += samples[i];
 
         float avg_adc = (float)sum / SAMPLES_PER_STEP;
         result_array[duty] = avg_adc * VperDev;
     }
 
-    // Nach Sweep PWM wieder komplett abschalten
-    pwm_set_enabled(slice_num, false);
-    gpio_set_function(PULSE_PIN, GPIO_FUNC_SIO);
-    gpio_set_dir(PULSE_PIN, GPIO_OUT);
-    gpio_put(PULSE_PIN, 0);  // DEAD-SAFE
+    sweep_pwm_stop();
 }
 
 // -------------------------
-// FLASH-Speicher-Funktionen
+//  ADAPTIVER SWEEP
 // -------------------------
-void save_results_to_flash(float *values, size_t count) {
+static uint16_t sweep_wrap;
 
-    uint32_t ints = save_and_disable_interrupts();
+static q16_t sweep_set_duty(q16_t duty, void *ctx) {
+    (void)ctx;
+    uint16_t level = (uint16_t)q16_mul_int_round(duty, sweep_wrap);
+    pwm_set_chan_level(pwm_gpio_to_slice_num(PULSE_PIN), pwm_gpio_to_channel(PULSE_PIN), level);
+    return (q16_t)(((int64_t)level << Q16_SHIFT) / sweep_wrap);
+}
 
-    flash_range_erase(FLASH_TARGET_OFFSET, 4096);
+static q16_t sweep_measure_block(void *ctx) {
+    (void)ctx;
+    static uint16_t samples[BLOCK_SAMPLES];
 
-    flash_range_program(
-        FLASH_TARGET_OFFSET,
-        (const uint8_t*)values,
-        count * sizeof(float)
-    );
+    adc_capture_oneshot(samples, BLOCK_SAMPLES);
+    uint32_t sum = 0;
+    for (int i = 0; i < BLOCK_SAMPLES; i++)
+        sum += samples[i];
+    return adc_sum_to_mv_q16(sum, BLOCK_SAMPLES);
+}
 
-    restore_interrupts(ints);
+// Wartet pro Punkt nur bis zum Einschwingen und verfeinert das Raster
+// dort, wo die Kennlinie steil oder gekrümmt ist (adaptive_sweep.h).
+void run_adaptive_sweep(adaptive_table_t *table) {
+    const adaptive_sweep_config_t cfg = {
+        .duty_min = 0,
+        .duty_max = Q16_ONE,
+        .coarse_points = ADAPTIVE_COARSE_POINTS,
+        .min_step = Q16_ONE / MAX_DUTY_CYCLE,
+        .settle_tol_mv = Q16_CONST(0.5),
+        .settle_blocks = 3,
+        .max_blocks = 20,
+        .refine_tol_mv = Q16_CONST(0.25),
+        .max_delta_mv = Q16_CONST(50.0),
+        .set_duty = sweep_set_duty,
+        .measure_block = sweep_measure_block,
+        .ctx = NULL,
+    };
+
+    sweep_wrap = sweep_pwm_start();
+    adaptive_sweep_run(&cfg, table);
+    sweep_pwm_stop();
 }
 
-void load_results_from_flash(float *buffer, size_t count) {
-    const uint8_t *flash_ptr = (const uint8_t *)(XIP_BASE + FLASH_TARGET_OFFSET);
-    memcpy(buffer, flash_ptr, count * sizeof(float));
+// -------------------------
+//  BODE-MESSUNG
+// -------------------------
+// Frequenzgang von Lasertreiber und Photodiode: Rechteck mit 50 % Tastgrad
+// bei logarithmisch verteilten Frequenzen. Der ADC wandelt reihum Signal
+// und Referenz; die PWM-Periode ist ein ganzzahliges Vielfaches der
+// Abtastperiode pro Kanal, jeder Block enthält ganze Perioden. Pro Punkt
+// liefert der Goertzel-Filter die Grundwelle beider Kanäle, ausgegeben
+// werden nur Verstärkung und Phase des Verhältnisses.
+typedef struct {
+    float freq_hz;
+    float gain_db;
+    float phase_deg;
+} bode_point_t;
+
+static uint16_t bode_samples[2 * GOERTZEL_MAX_N];
+
+// Grundwelle eines Kanals im verschachtelten Block (n Samples pro Kanal)
+static goertzel_result_t bode_channel(const uint16_t *block, uint32_t n, uint32_t periods) {
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < n; i++)
+        sum += block[2 * i];
+
+    goertzel_t g;
+    goertzel_init(&g, periods, n);
+    goertzel_set_offset(&g, sum, n);
+    goertzel_feed(&g, block, 2 * n, 2);
+    return goertzel_result(&g);
+}
+
+// Rückgabe: Anzahl Punkte (doppelte Frequenzen entfallen), -1 ohne
+// Referenzsignal
+int run_bode(uint32_t f_min, uint32_t f_max, int points, bode_point_t *out) {
+    adc_capture_config_t capture_cfg = {
+        .input = 0,
+        .round_robin = 1u << BODE_REF_INPUT,
+        .clkdiv = 0.0f,
+    };
+    adc_capture_init(&capture_cfg);
+    uint32_t fs = adc_capture_sample_rate_hz() / 2;     // pro Kanal
+
+    uint slice_num = pwm_gpio_to_slice_num(PULSE_PIN);
+    uint channel   = pwm_gpio_to_channel(PULSE_PIN);
+    gpio_set_function(PULSE_PIN, GPIO_FUNC_PWM);
+
+    int count = 0;
+    int incoherent = 0;
+    uint32_t last_period = 0;
+    float last_phase = 0.0f;
+    for (int i = 0; i < points; i++) {
+        float f = points > 1 ? f_min * powf((float)f_max / f_min, (float)i / (points - 1)) : f_min;
+        uint32_t period = (uint32_t)lroundf(fs / f);
+        if (period < BODE_MIN_PERIOD)
+            period = BODE_MIN_PERIOD;
+        if (period > GOERTZEL_MAX_PERIOD)
+            period = GOERTZEL_MAX_PERIOD;
+        if (period == last_period)
+            continue;
+        last_period = period;
+
+        // Kohärent: PWM-Periode = period Abtastperioden pro Kanal. Beim
+        // Standardtakt immer exakt, sonst nur, wenn der Systemtakt passt
+        pwm_timing_t timing;
+        pwm_timing_status_t status = pwm_timing_for_freq((float)fs / period, 2, 0, &timing);
+        if (status > PWM_TIMING_INEXACT)
+            continue;
+        if (status == PWM_TIMING_INEXACT)
+            incoherent++;
+        pwm_timing_apply(slice_num, &timing);
+        pwm_set_chan_level(slice_num, channel, (uint16_t)(pwm_timing_steps(&timing) / 2));
+        pwm_set_enabled(slice_num, true);
+
+        uint32_t settle_ms = BODE_SETTLE_PERIODS * period * 1000 / fs;
+        sleep_ms(settle_ms > BODE_SETTLE_MIN_MS ? settle_ms : BODE_SETTLE_MIN_MS);
+
+        uint32_t periods = GOERTZEL_MAX_N / period;
+        uint32_t n = periods * period;
+        adc_capture_oneshot(bode_samples, 2 * n);
+
+        goertzel_result_t sig = bode_channel(bode_samples, n, periods);
+        goertzel_result_t ref = bode_channel(bode_samples + 1, n, periods);
+
+        // Offener oder konstanter Referenzeingang: das Verhältnis wäre nur
+        // Rauschen, also keine Tabelle ausgeben
+        if (ref.amplitude * VperDev < BODE_REF_MIN_MV) {
+            printf("FEHLER: Keine Referenz an ADC%d bei %.0f Hz (Grundwelle %.1f mV, mindestens %.0f mV)\n",
+                   BODE_REF_INPUT, pwm_timing_freq_hz(&timing), ref.amplitude * VperDev,
+                   BODE_REF_MIN_MV);
+            count = -1;
+            break;
+        }
+
+        // Die Referenz wird eine Wandlung (halbe Abtastperiode pro Kanal)
+        // später abgetastet als das Signal
+        float w = 2.0f * (float)M_PI / period;
+        float phase = (sig.phase - ref.phase + w / 2.0f) * 180.0f / (float)M_PI;
+        while (phase - last_phase > 180.0f)
+            phase -= 360.0f;
+        while (phase - last_phase < -180.0f)
+            phase += 360.0f;
+        last_phase = phase;
+
+        out[count].freq_hz = (float)pwm_timing_freq_hz(&timing);
+        out[count].gain_db = ref.amplitude > 0.0f
+            ? 20.0f * log10f(sig.amplitude / ref.amplitude) : -INFINITY;
+        out[count].phase_deg = phase;
+        count++;
+    }
+
+    sweep_pwm_stop();
+    if (incoherent > 0 && count >= 0)
+        printf("WARNUNG: %d Punkte nicht kohärent zum ADC (Systemtakt %lu Hz)\n",
+               incoherent, clock_get_hz(clk_sys));
+    capture_cfg.round_robin = 0;
+    adc_capture_init(&capture_cfg);
+    return count;
+}
+
+// -3-dB-Grenze bezogen auf den ersten Punkt (log. interpoliert), 0 wenn
+// nicht erreicht
+float bode_corner_hz(const bode_point_t *pts, int count) {
+    if (count < 2)
+        return 0.0f;
+    float limit = pts[0].gain_db - 3.0f;
+    for (int i = 1; i < count; i++) {
+        if (pts[i].gain_db > limit)
+            continue;
+        float a = (pts[i - 1].gain_db - limit) / (pts[i - 1].gain_db - pts[i].gain_db);
+        return pts[i - 1].freq_hz * powf(pts[i].freq_hz / pts[i - 1].freq_hz, a);
+    }
+    return 0.0f;
+}
+
+void print_bode(const bode_point_t *pts, int count) {
+    printf("f_Hz, Verstärkung_dB, Phase_Grad\n");
+    for (int i = 0; i < count; i++)
+        printf("%.1f, %.2f, %.1f\n", pts[i].freq_hz, pts[i].gain_db, pts[i].phase_deg);
+
+    float corner = bode_corner_hz(pts, count);
+    if (corner > 0.0f)
+        printf("-3 dB bei %.0f Hz\n", corner);
+    else
+        printf("-3 dB nicht erreicht\n");
+}
+
+// -------------------------
+// FLASH-Speicher-Funktionen
+// -------------------------
+// Reaktionstabelle als Kalibrierdatensatz speichern (cal_store.h),
+// laser_control liest ihn beim Start.
+bool save_results_to_flash(const float *values, size_t count) {
+    static uint16_t values_q4[MAX_DUTY_CYCLE + 1];
+
+    for (size_t i = 0; i < count; i++)
+        values_q4[i] = (uint16_t)(values[i] * CAL_MV_SCALE + 0.5f);
+
+    cal_header_t hdr = {
+        .timestamp_us = time_us_64(),
+        .points = (uint16_t)count,
+        .duty_max = MAX_DUTY_CYCLE,
+        .pwm_freq_hz = PWM_FREQ_HZ,
+        .pwm_wrap = sweep_timing.wrap,
+        .samples_per_step = SAMPLES_PER_STEP,
+        .settle_ms = SETTLE_MS,
+    };
+    bool ok = cal_store_save(&hdr, values_q4);
+    if (ok)
+        printf("Kalibrierung gespeichert (Datensatz %lu)\n", hdr.seq);
+    else
+        printf("FEHLER: Kalibrierung konnte nicht gespeichert werden\n");
+    return ok;
+}
+
+void print_stored_calibration(void) {
+    cal_header_t hdr;
+    if (cal_store_load(&hdr, NULL, 0))
+        printf("Gespeicherte Kalibrierung: Datensatz %lu, %u Punkte, %lu Hz\n",
+               hdr.seq, hdr.points, hdr.pwm_freq_hz);
+    else
+        printf("Keine gültige Kalibrierung im Flash.\n");
 }
 
 
@@ -103,26 +343,85 @@ int main() {
     // ADC Setup
     adc_init();
     adc_gpio_init(26);
+    adc_gpio_init(26 + BODE_REF_INPUT);
     adc_select_input(0);
 
+    adc_capture_config_t capture_cfg = { .input = 0, .clkdiv = 0.0f };
+    adc_capture_init(&capture_cfg);
+
+    // Exakt PWM_FREQ_HZ mit der feinsten Auflösung beim aktuellen Systemtakt
+    pwm_timing_status_t timing_status =
+        pwm_timing_for_freq(PWM_FREQ_HZ, MAX_DUTY_CYCLE + 1, 0, &sweep_timing);
+    pwm_timing_report(PWM_FREQ_HZ, timing_status, &sweep_timing);
+
     static float sweep_results[MAX_DUTY_CYCLE + 1];
+    static adaptive_table_t adaptive_table;
+    static bode_point_t bode_points[BODE_MAX_POINTS];
+    char cmd_buf[32];
+
+    print_stored_calibration();
 
     while (true) {
 
-        printf("Bereit. Drücke Enter, um PWM-Sweep zu starten...\n");
+        printf("Bereit. Enter startet den adaptiven Sweep, \"voll\" + Enter den vollen Sweep,\n"
+               "\"bode [f_min f_max n]\" + Enter den Frequenzgang...\n");
+        size_t cmd_idx = 0;
         while (true) {
             int c = getchar_timeout_us(0);
             if (c == '\r' || c == '\n') break;
+            if (c >= 0 && cmd_idx < sizeof(cmd_buf) - 1)
+                cmd_buf[cmd_idx++] = (char)c;
+        }
+        cmd_buf[cmd_idx] = '\0';
+
+        if (strncmp(cmd_buf, "bode", 4) == 0) {
+            unsigned long f_min = BODE_F_MIN_HZ, f_max = BODE_F_MAX_HZ;
+            int n = BODE_POINTS;
+            sscanf(cmd_buf + 4, "%lu %lu %d", &f_min, &f_max, &n);
+            if (f_min == 0 || f_max < f_min || n < 1 || n > BODE_MAX_POINTS) {
+                printf("Ungültig: bode f_min f_max n (n <= %d)\n", BODE_MAX_POINTS);
+                continue;
+            }
+            printf("Starte Bode-Messung %lu..%lu Hz, %d Punkte...\n", f_min, f_max, n);
+            uint64_t t0 = time_us_64();
+            int count = run_bode(f_min, f_max, n, bode_points);
+            if (count < 0) {
+                printf("Bode-Messung abgebrochen\n");
+                continue;
+            }
+            printf("Messung beendet! (%lu ms)\n", (uint32_t)((time_us_64() - t0) / 1000));
+            print_bode(bode_points, count);
+            continue;
         }
 
         printf("Starte Sweep...\n");
+        uint64_t t0 = time_us_64();
 
-        run_pwm_sweep(sweep_results);
-        save_results_to_flash(sweep_results, MAX_DUTY_CYCLE + 1);
+        if (strcmp(cmd_buf, "voll") == 0) {
+            run_pwm_sweep(sweep_results);
+            printf("Sweep beendet! (%lu ms)\n", (uint32_t)((time_us_64() - t0) / 1000));
 
-        printf("Sweep beendet! Werte gespeichert.\n");
+            for (int i = 0; i <= MAX_DUTY_CYCLE; i++)
+                printf("%d, %.3f\n", i, sweep_results[i]);
+        } else {
+            run_adaptive_sweep(&adaptive_table);
+            printf("Sweep beendet! (%lu ms, %u Punkte, %lu Blöcke, %u nicht eingeschwungen)\n",
+                   (uint32_t)((time_us_64() - t0) / 1000), adaptive_table.count,
+                   adaptive_table.blocks, adaptive_table.unsettled);
 
-        for (int i = 0; i <= MAX_DUTY_CYCLE; i++)
-            printf("%d, %.3f\n", i, sweep_results[i]);
+            // Nicht-äquidistante Stützstellen: Tastgrad in 1/MAX_DUTY_CYCLE, mV
+            for (int i = 0; i < adaptive_table.count; i++)
+                printf("%.2f, %.3f\n",
+                       adaptive_table.duty[i] * (float)MAX_DUTY_CYCLE / Q16_ONE,
+                       adaptive_table.mv[i] / (float)Q16_ONE);
+
+            // Für den Kalibrierdatensatz auf das feste Raster interpolieren
+            for (int i = 0; i <= MAX_DUTY_CYCLE; i++) {
+                q16_t duty = (q16_t)(((int64_t)i << Q16_SHIFT) / MAX_DUTY_CYCLE);
+                sweep_results[i] = adaptive_table_lookup(&adaptive_table, duty) / (float)Q16_ONE;
+            }
+        }
+
+        save_results_to_flash(sweep_results, MAX_DUTY_CYCLE + 1);
     }
 }
@@ -1,14 +1,24 @@
 #define timestamping true
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "hardware/adc.h"
 #include "hardware/pwm.h" // PWM-Header hinzufügen
 #include "pico/time.h" // Zeitfunktionen hinzufügen
+#include "adc_capture.h" // DMA-Erfassung mit fester Abtastrate
+#include "edge_analyzer.h" // Flanken- und Pulsanalyse in einem Durchlauf
+#include "baseline.h" // nachgeführter Dunkelpegel
+#include "latency_hist.h" // Latenz-Histogramm fester Größe
+#include "ensemble.h" // kohärente Mittelung
+#include "pwm_timing.h" // Teiler und wrap aus dem Systemtakt
 
 #define NUM_SAMPLES 400
-#define THRESHOLD 400 // Schwellwert für Flankenerkennung 4096 enspricht 3.3V
+#define THRESHOLD_OFFSET 340 // Schwelle über dem Dunkelpegel, 4096 enspricht 3.3V (ca. 275 mV)
+#define HYSTERESIS 25 // ± ADC-Schritte um die Schwelle (ca. 20 mV)
+#define MAX_PULSES 8  // Pulse pro Messpuffer
 // 600mV entsprechen 744 ADC-Wert bei 12 Bit Auflösung
 #define VperDev 0.806
 
@@ -17,8 +27,35 @@
 //#define PWM_LEVEL 480  // Duty Cycle (30/255)
 #define PWM_LEVEL 1606  // Duty Cycle (100/255)
 
+// Warten auf Dunkelheit statt fester Pause: Blöcke zu SETTLE_SAMPLES, bis
+// SETTLE_BLOCKS Blockmittel hintereinander innerhalb SETTLE_TOL am Dunkelpegel liegen
+#define SETTLE_SAMPLES 50       // 100 us bei 500 kS/s
+#define SETTLE_BLOCKS 2
+#define SETTLE_TOL 6            // ADC-Schritte (ca. 5 mV)
+#define SETTLE_MAX_BLOCKS 5000  // höchstens 0,5 s, danach Dunkelpegel neu setzen
+#define BASELINE_SHIFT 3        // Glättung des Dunkelpegels (Gewicht 1/8)
+
+// Ausgerichtete Pulse: Aufnahme beginnt PULS_VORLAUF_US vor dem Einschalten
+#define PULS_VORLAUF_US 32
+
+// Latenzmodus ("lat <n>"): n Pulse hintereinander, gemessen wird nur die
+// Zeit vom Einschalten der PWM bis zur steigenden Flanke an der Photodiode
+#define LAT_SAMPLES 128         // 256 us Aufnahme je Puls
+#define LAT_DEFAULT_PULSES 10000
+
+// Mittelung ("mittel <m>"): m Pulse Sample für Sample aufsummieren
+#define ENS_DEFAULT_PULSES 256
+
 // Funktionsprototyp einfügen
-void startmessung(void);
+void startmessung(baseline_t *baseline);
+void laser_aus(uint slice_num);
+void laser_an(uint slice_num);
+uint32_t warte_auf_dunkel(baseline_t *baseline);
+uint64_t ausgerichteter_puls(uint slice_num, uint16_t *samples, uint32_t n);
+bool latenz_messung(uint slice_num, baseline_t *baseline, edge_analyzer_t *analyzer,
+                    uint16_t *samples, latency_hist_t *hist);
+void latenz_ausgabe(const latency_hist_t *hist, uint32_t verfehlt);
+void mittel_ausgabe(const ensemble_t *ens);
 
 
 int main(void) {
@@ -28,118 +65,303 @@ int main(void) {
     gpio_set_pulls(26,0,1);  // input Pulldown
     adc_select_input(0);
 
-    // PWM initialisieren
-    gpio_set_function(PWM_GPIO, GPIO_FUNC_PWM);
+    // ADC im Free-Running-Modus per DMA auslesen (volle Rate, 500 kS/s)
+    adc_capture_config_t capture_cfg = { .input = 0, .clkdiv = 0.0f };
+    adc_capture_init(&capture_cfg);
+
+    // PWM initialisieren; der Pin bleibt bis laser_an() beim SIO (tief)
+    gpio_init(PWM_GPIO);
+    gpio_set_dir(PWM_GPIO, GPIO_OUT);
+    gpio_put(PWM_GPIO, 0);
     uint slice_num = pwm_gpio_to_slice_num(PWM_GPIO);
 
     // PWM konfigurieren neu
-    // Systemtakt normalerweise 125 MHz
-    const float sys_clk = 125000000;
     float freq = 4000.0f;       // Gewünschte Frequenz
     const float pwm = 0.3;     // Duty Cycle (15% = 0.15)
 
-    // Clock divider (CLKDIV)
-    // Wir wählen z.B. CLKDIV = 125, um Zählerfrequenz 1 MHz zu erhalten
-    float clkdiv = 125.0f;
+    // Teiler und wrap aus dem tatsächlichen Systemtakt, feinste Auflösung
+    pwm_timing_t timing = { 0 };
+    pwm_timing_status_t timing_status = pwm_timing_for_freq(freq, 100, 0, &timing);
+    uint16_t wrap = timing.wrap;
 
-    // Wrap Wert berechnen: Wrap = (PWM_Takt / freq) - 1
-    uint16_t wrap = (uint16_t)((sys_clk / clkdiv) / freq) - 1;
-
-    pwm_set_clkdiv(slice_num, clkdiv);
-    pwm_set_wrap(slice_num, wrap);
+    pwm_timing_apply(slice_num, &timing);
 
     // Duty Cycle einstellen (50%)
     pwm_set_gpio_level(PWM_GPIO, wrap * pwm);
     pwm_set_enabled(slice_num, false);
 
     sleep_ms(1000); // Warten bis USB-Serial bereit
+    pwm_timing_report(freq, timing_status, &timing);
+    printf("Abtastung: %.3f Hz (Periode %lu ps)\n",
+           1e12 / adc_capture_sample_period_ps(), adc_capture_sample_period_ps());
 
     uint16_t samples[NUM_SAMPLES];
-#if timestamping
-    uint32_t timestamps[NUM_SAMPLES];
-#endif
 
-    while (1) {   // Dauerschleife
-        pwm_set_enabled(slice_num, false);
-        sleep_ms(500); // Warten bis Laser sicher aus ist
+    static edge_pulse_t pulses[MAX_PULSES];
+    edge_analyzer_t analyzer;
+    const edge_analyzer_config_t analyzer_cfg = { .level = THRESHOLD_OFFSET, .hysteresis = HYSTERESIS };
+    edge_analyzer_init(&analyzer, &analyzer_cfg, pulses, MAX_PULSES);
 
-        startmessung();
-        pwm_set_enabled(slice_num, true);
+    // Dunkelpegel einmal messen, danach laufend aus den Dunkelphasen nachführen
+    baseline_t baseline;
+    baseline_init(&baseline, BASELINE_SHIFT);
+    startmessung(&baseline);
 
-        // Messungenen durchführen
-        for (int i = 0; i < NUM_SAMPLES; i++) {
-#if timestamping
-            timestamps[i] = time_us_32();
-#endif
-            samples[i] = adc_read();
-        }
+    uint32_t messungen = 0;
+    uint64_t status_us = time_us_64();
 
-        // PWM-Analyse: Puls suchen
-        int pulse_start = -1, pulse_end = -1;
-        uint16_t min_val = 4095, max_val = 0;
+    static latency_hist_t latenz;
+    latency_hist_reset(&latenz);
+    uint32_t latenz_rest = 0;       // noch ausstehende Pulse im Latenzmodus
+    uint32_t latenz_verfehlt = 0;   // Pulse ohne erkannte Flanke
 
-        // Suche steigende Flanke
-        for (int i = 1; i < NUM_SAMPLES; i++) {
-            if (samples[i-1] < THRESHOLD && samples[i] >= THRESHOLD) {
-                pulse_start = i;
-                break;
-            }
-        }
-        // Suche fallende Flanke nach steigender
-        if (pulse_start != -1) {
-            for (int i = pulse_start + 1; i < NUM_SAMPLES; i++) {
-                if (samples[i-1] >= THRESHOLD && samples[i] < THRESHOLD) {
-                    pulse_end = i;
-                    break;
+    static uint32_t ens_sum[NUM_SAMPLES];
+    static uint64_t ens_sum_sq[NUM_SAMPLES];
+    ensemble_t ensemble;
+    ensemble_init(&ensemble, ens_sum, ens_sum_sq, NUM_SAMPLES);
+    uint32_t mittel_rest = 0;       // noch ausstehende Pulse der Mittelung
+
+    char input_buffer[16];
+    int input_index = 0;
+
+    while (1) {   // Dauerschleife
+        // Eingabe verarbeiten (nicht-blockierend)
+        int c = getchar_timeout_us(0);
+        if (c == '\r' || c == '\n') {
+            input_buffer[input_index] = '\0';
+            if (strncmp(input_buffer, "lat", 3) == 0) {
+                int n = atoi(input_buffer + 3);
+                latenz_rest = n > 0 ? (uint32_t)n : LAT_DEFAULT_PULSES;
+                latenz_verfehlt = 0;
+                latency_hist_reset(&latenz);
+                mittel_rest = 0;
+                printf("Latenzmessung: %lu Pulse\n", (unsigned long)latenz_rest);
+            } else if (strncmp(input_buffer, "mittel", 6) == 0) {
+                int n = atoi(input_buffer + 6);
+                if (n > (int)ENSEMBLE_MAX_COUNT) {
+                    // Sonst läuft die 32-Bit-Summe über
+                    printf("Mittelung: höchstens %lu Pulse\n", (unsigned long)ENSEMBLE_MAX_COUNT);
+                } else {
+                    mittel_rest = n > 0 ? (uint32_t)n : ENS_DEFAULT_PULSES;
+                    ensemble_reset(&ensemble);
+                    latenz_rest = 0;
+                    printf("Mittelung: %lu Pulse\n", (unsigned long)mittel_rest);
                 }
+            } else if (strcmp(input_buffer, "stat") == 0) {
+                latenz_ausgabe(&latenz, latenz_verfehlt);
             }
+            input_index = 0;
+        } else if (c != PICO_ERROR_TIMEOUT && c >= ' ' && input_index < (int)sizeof(input_buffer) - 1) {
+            input_buffer[input_index++] = (char)c;
         }
-        // Average im Pulsbereich bestimmen
-        if (pulse_start != -1 && pulse_end != -1) {
-#if timestamping
-            // Zeitmessung: Pulsdauer in Mikrosekunden
-            uint32_t pulse_time_us = timestamps[pulse_end] - timestamps[pulse_start];
-#endif
 
-            // Durchschnitt im Pulse_an Bereich (High-Phase)
-            uint32_t sum_an = 0;
-            int count_an = pulse_end - pulse_start;
-            for (int i = pulse_start; i < pulse_end; i++) {
-                sum_an += samples[i];
+        if (latenz_rest > 0) {
+            if (!latenz_messung(slice_num, &baseline, &analyzer, samples, &latenz))
+                latenz_verfehlt++;
+            if (--latenz_rest == 0) {
+                latenz_ausgabe(&latenz, latenz_verfehlt);
+                messungen = 0;
+                status_us = time_us_64();
             }
-            float avg_an = count_an > 0 ? (float)sum_an / count_an * VperDev : 0.0f;
+            continue;
+        }
 
-            // Durchschnitt im Pulse_aus Bereich (Low-Phase)
-            uint32_t sum_aus = 0;
-            int count_aus = NUM_SAMPLES - pulse_end;
-            for (int i = pulse_end; i < NUM_SAMPLES; i++) {
-                sum_aus += samples[i];
+        if (mittel_rest > 0) {
+            laser_aus(slice_num);
+            warte_auf_dunkel(&baseline);
+            ausgerichteter_puls(slice_num, samples, NUM_SAMPLES);
+            ensemble_add(&ensemble, samples);
+            if (--mittel_rest == 0) {
+                mittel_ausgabe(&ensemble);
+                messungen = 0;
+                status_us = time_us_64();
             }
-            float avg_aus = count_aus > 0 ? (float)sum_aus / count_aus * VperDev : 0.0f;
+            continue;
+        }
+
+        laser_aus(slice_num);
+        warte_auf_dunkel(&baseline); // bis der Laser sicher aus ist, nur so lange wie nötig
 
+        laser_an(slice_num);
+
+        // Messungen per DMA durchführen (feste Abtastrate)
+        adc_capture_oneshot(samples, NUM_SAMPLES);
+
+        // PWM-Analyse in einem Durchlauf: Flanken mit Hysterese, Zeitpunkte
+        // zwischen den Samples interpoliert, Mittelwerte nebenbei.
+        // Schwelle relativ zum aktuellen Dunkelpegel.
+        analyzer.cfg.level = baseline_counts(&baseline) + THRESHOLD_OFFSET;
+        edge_analyzer_reset(&analyzer);
+        edge_analyzer_feed(&analyzer, samples, NUM_SAMPLES);
+        messungen++;
+
+        uint16_t complete = edge_analyzer_complete(&analyzer);
+        for (uint16_t k = 0; k < complete; k++) {
+            const edge_pulse_t *p = &pulses[k];
+            float pulse_start = p->rise_q16 / 65536.0f;
+            float pulse_end = p->fall_q16 / 65536.0f;
+            float avg_an = edge_phase_mean(&p->on) * VperDev;
+            float avg_aus = edge_phase_mean(&p->off) * VperDev;
 #if timestamping
-            printf("%d, %d, %d, %.2f, %.2f, %lu\n",
+            // Pulsdauer aus den interpolierten Flanken und der exakten Abtastperiode
+            float pulse_time_us = (float)(p->fall_q16 - p->rise_q16) / 65536.0f
+                                * adc_capture_sample_period_ps() / 1e6f;
+            printf("%.2f, %.2f, %.2f, %.2f, %.2f, %.3f\n",
                 pulse_start, pulse_end, pulse_end - pulse_start, avg_an, avg_aus, pulse_time_us);
 #else
-            printf("%d, %d, %d, %.2f, %.2f\n",
+            printf("%.2f, %.2f, %.2f, %.2f, %.2f\n",
                 pulse_start, pulse_end, pulse_end - pulse_start, avg_an, avg_aus);
 #endif
-        } else {
+        }
+        if (complete == 0) {
             printf("Kein Puls erkannt, 0, 0, 0, 0, 0\n");
         }
+
+        // Einmal pro Sekunde: Dunkelpegel, Schwelle und Messrate
+        uint64_t now_us = time_us_64();
+        if (now_us - status_us >= 1000000u) {
+            printf("Basislinie: %.2f mV, Schwelle: %.2f mV, %.1f Messungen/s\n",
+                   baseline.level / 65536.0f * VperDev, analyzer.cfg.level * VperDev,
+                   messungen * 1e6f / (float)(now_us - status_us));
+            messungen = 0;
+            status_us = now_us;
+        }
     }
 }
 
-void startmessung(void) {
-    printf("Startmessung %lu\n");
+// Laser aus: Pin an den SIO (tief). Eine angehaltene PWM hält ihren letzten
+// Ausgangspegel; mitten im Puls angehalten bliebe der Laser an.
+void laser_aus(uint slice_num) {
+    gpio_set_function(PWM_GPIO, GPIO_FUNC_SIO);
+    pwm_set_enabled(slice_num, false);
+}
+
+// Laser an: PWM ab Zählerstand 0 starten und den Pin wieder an die PWM
+// geben. Ohne das Zurücksetzen liefe der Zähler an der Stelle weiter, an
+// der er angehalten wurde, und die erste Flanke käme bis zu einer Periode
+// später; so beginnt der Puls beim Einschalten.
+void laser_an(uint slice_num) {
+    pwm_set_counter(slice_num, 0);
+    pwm_set_enabled(slice_num, true);
+    gpio_set_function(PWM_GPIO, GPIO_FUNC_PWM);
+}
+
+// Wartet, bis das Signal wieder am Dunkelpegel liegt (Abklingen der
+// Photodiode), und führt den Dunkelpegel mit diesen Blöcken nach.
+// Rückgabe: Anzahl gemessener Blöcke.
+uint32_t warte_auf_dunkel(baseline_t *baseline) {
+    static uint16_t block[SETTLE_SAMPLES];
+    uint32_t stabil = 0;
+    uint32_t sum = 0;
+
+    for (uint32_t n = 1; n <= SETTLE_MAX_BLOCKS; n++) {
+        adc_capture_oneshot(block, SETTLE_SAMPLES);
+        sum = 0;
+        for (int i = 0; i < SETTLE_SAMPLES; i++)
+            sum += block[i];
+
+        stabil = baseline_matches(baseline, sum, SETTLE_SAMPLES, SETTLE_TOL) ? stabil + 1 : 0;
+        if (stabil >= SETTLE_BLOCKS) {
+            baseline_update(baseline, sum, SETTLE_SAMPLES);
+            return n;
+        }
+    }
+
+    // Pegel hat sich sprunghaft geändert (z.B. Umgebungslicht): neu setzen
+    printf("Dunkelpegel nicht erreicht, setze neu\n");
+    baseline_init(baseline, baseline->shift);
+    baseline_update(baseline, sum, SETTLE_SAMPLES);
+    return SETTLE_MAX_BLOCKS;
+}
+
+// Wartet auf den Beginn der Mikrosekunde `ziel`. Direkt danach ausgelöste
+// Aktionen liegen bis auf eine konstante Laufzeit auf dieser Grenze, statt
+// irgendwo innerhalb von 1 us.
+static uint64_t warte_bis_us(uint64_t ziel) {
+    uint64_t now;
+    while ((now = time_us_64()) < ziel)
+        ;
+    return now;
+}
+
+// Ausgerichteter Puls: Aufnahme von `n` Samples auf einer Mikrosekunden-
+// grenze starten (ihr Start ist nur auf 1 us genau gestempelt), die PWM
+// genau PULS_VORLAUF_US später einschalten und das Ende abwarten. Die
+// kommandierte Flanke liegt so in jeder Aufnahme an derselben Stelle.
+// Rückgabe: Zeitpunkt des Einschaltens in us.
+uint64_t ausgerichteter_puls(uint slice_num, uint16_t *samples, uint32_t n) {
+    uint64_t start_us = warte_bis_us(time_us_64() + 1);
+    adc_capture_oneshot_start(samples, n);
+    uint64_t befehl_us = warte_bis_us(start_us + PULS_VORLAUF_US);
+    laser_an(slice_num);
+    adc_capture_oneshot_wait();
+    return befehl_us;
+}
+
+// Ein Puls im Latenzmodus: die Zeit vom Einschalten bis zur interpolierten
+// steigenden Flanke ins Histogramm eintragen.
+// Rückgabe: false, wenn keine Flanke nach dem Einschalten gefunden wurde.
+bool latenz_messung(uint slice_num, baseline_t *baseline, edge_analyzer_t *analyzer,
+                    uint16_t *samples, latency_hist_t *hist) {
+    laser_aus(slice_num);
+    warte_auf_dunkel(baseline);
+    uint64_t befehl_us = ausgerichteter_puls(slice_num, samples, LAT_SAMPLES);
+
+    analyzer->cfg.level = baseline_counts(baseline) + THRESHOLD_OFFSET;
+    edge_analyzer_reset(analyzer);
+    edge_analyzer_feed(analyzer, samples, LAT_SAMPLES);
+    if (analyzer->count == 0)
+        return false;
+
+    // Flankenzeit: Sample-Index (Q16) auf die Zeitbasis der Aufnahme
+    const int64_t period_ps = adc_capture_sample_period_ps();
+    int64_t flanke_ns = (int64_t)adc_capture_sample_time_ns(0)
+                      + ((analyzer->pulses[0].rise_q16 * period_ps) >> 16) / 1000;
+    int64_t latenz_ns = flanke_ns - (int64_t)(befehl_us * 1000u);
+    if (latenz_ns < 0)
+        return false;   // Flanke vor dem Einschalten: Störung, nicht werten
+
+    latency_hist_add(hist, (uint32_t)latenz_ns);
+    return true;
+}
+
+void latenz_ausgabe(const latency_hist_t *hist, uint32_t verfehlt) {
+    if (hist->count == 0) {
+        printf("Latenz: keine Messungen (%lu verfehlt)\n", (unsigned long)verfehlt);
+        return;
+    }
+    printf("Latenz: n=%lu, min %.3f, p50 %.3f, p90 %.3f, p99 %.3f, max %.3f us, "
+           "Jitter %.3f us, %lu verfehlt\n",
+           (unsigned long)hist->count, hist->min / 1000.0f,
+           latency_hist_percentile(hist, 500) / 1000.0f,
+           latency_hist_percentile(hist, 900) / 1000.0f,
+           latency_hist_percentile(hist, 990) / 1000.0f,
+           hist->max / 1000.0f, latency_hist_stddev(hist) / 1000.0f,
+           (unsigned long)verfehlt);
+}
+
+// Gemittelte Pulsantwort: Zeit relativ zur kommandierten Flanke (us),
+// Mittelwert (mV), Varianz über die Pulse (mV^2)
+void mittel_ausgabe(const ensemble_t *ens) {
+    const float period_us = adc_capture_sample_period_ps() / 1e6f;
+    printf("Mittelung: %lu Pulse, %lu Samples\n", (unsigned long)ens->count, (unsigned long)ens->len);
+    for (uint32_t k = 0; k < ens->len; k++) {
+        // Sample k ist bei (k + 1) Perioden nach dem Start fertig
+        float t_us = (k + 1) * period_us - PULS_VORLAUF_US;
+        printf("%.3f, %.3f, %.3f\n", t_us, ensemble_mean(ens, k) * VperDev,
+               ensemble_variance(ens, k) * (VperDev * VperDev));
+    }
+    printf("Ende der Mittelung\n");
+}
+
+void startmessung(baseline_t *baseline) {
+    printf("Startmessung\n");
 
     uint32_t start_time = time_us_32();
 
     uint16_t start_samples[NUM_SAMPLES];
-    // 100 Messungen durchführen
-    for (int i = 0; i < NUM_SAMPLES; i++) {
-        start_samples[i] = adc_read();
-    }
+    // Messungen per DMA durchführen
+    adc_capture_oneshot(start_samples, NUM_SAMPLES);
 
     // Durchschnitt der Startmessung berechnen
     uint32_t summe = 0;
@@ -147,6 +369,7 @@ void startmessung(void) {
         summe += start_samples[i];
     }
     float avg = summe / NUM_SAMPLES * VperDev;
+    baseline_update(baseline, summe, NUM_SAMPLES);
 
     printf("Durchschnitt: %.2f mV, Zeit: %lu us\n", avg, time_us_32()- start_time);
 }
\ No newline at end of file
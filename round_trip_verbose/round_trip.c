@@ -6,6 +6,8 @@
 #include "hardware/adc.h"
 #include "hardware/pwm.h" // PWM-Header hinzufügen
 #include "pico/time.h" // Zeitfunktionen hinzufügen
+#include "adc_capture.h" // DMA-Erfassung mit fester Abtastrate
+#include "pwm_timing.h" // Teiler und wrap aus dem Systemtakt
 
 #define NUM_SAMPLES 300
 #define THRESHOLD 200 // Schwellwert für Flankenerkennung 4096 enspricht 3.3V
@@ -35,37 +37,37 @@ int main(void) {
     gpio_set_pulls(26,0,1);  // input Pulldown
     adc_select_input(0);
 
+    // ADC im Free-Running-Modus per DMA auslesen (volle Rate, 500 kS/s);
+    // die Zeit eines Samples folgt aus seinem Index
+    adc_capture_config_t capture_cfg = { .input = 0, .clkdiv = 0.0f };
+    adc_capture_init(&capture_cfg);
+
     // PWM initialisieren
     gpio_set_function(PWM_GPIO, GPIO_FUNC_PWM);
     uint slice_num = pwm_gpio_to_slice_num(PWM_GPIO);
 
     // PWM konfigurieren neu
-    // Systemtakt normalerweise 125 MHz
-    const float sys_clk = 125000000;
     float freq = 4000.0f;       // Gewünschte Frequenz
     
     float pwm = 0.3f;                    // Start Duty Cycle (30%)
 
-    // Clock divider (CLKDIV)
-    // Wir wählen z.B. CLKDIV = 125, um Zählerfrequenz 1 MHz zu erhalten
-    float clkdiv = 125.0f;
-
-    // Wrap Wert berechnen: Wrap = (PWM_Takt / freq) - 1
-    uint16_t wrap = (uint16_t)((sys_clk / clkdiv) / freq) - 1;
+    // Teiler und wrap aus dem tatsächlichen Systemtakt, feinste Auflösung
+    pwm_timing_t timing = { 0 };
+    pwm_timing_status_t timing_status = pwm_timing_for_freq(freq, 100, 0, &timing);
+    uint16_t wrap = timing.wrap;
 
-    pwm_set_clkdiv(slice_num, clkdiv);
-    pwm_set_wrap(slice_num, wrap);
+    pwm_timing_apply(slice_num, &timing);
 
     // Duty Cycle einstellen (50%)
     pwm_set_gpio_level(PWM_GPIO, (uint16_t)(wrap * pwm));
     pwm_set_enabled(slice_num, false);
 
     sleep_ms(1000); // Warten bis USB-Serial bereit
+    pwm_timing_report(freq, timing_status, &timing);
+    printf("Abtastung: %.3f Hz (Periode %lu ps)\n",
+           1e12 / adc_capture_sample_period_ps(), adc_capture_sample_period_ps());
 
     uint16_t samples[NUM_SAMPLES];
-#if timestamping
-    uint32_t timestamps[NUM_SAMPLES];
-#endif
 
     pwm_set_enabled(slice_num, true);
     while (1) {   // Dauerschleife
@@ -75,13 +77,8 @@ int main(void) {
         //startmessung();
         //pwm_set_enabled(slice_num, true);
 
-        // Messungenen durchführen
-        for (int i = 0; i < NUM_SAMPLES; i++) {
-#if timestamping
-            timestamps[i] = time_us_32();
-#endif
-            samples[i] = adc_read();
-        }
+        // Messungen per DMA durchführen (feste Abtastrate)
+        adc_capture_oneshot(samples, NUM_SAMPLES);
 
         // PWM-Analyse: Puls suchen
         int pulse_start = -1, pulse_end = -1;
@@ -109,7 +106,9 @@ int main(void) {
         // Wenn Puls erkannt, Durchschnittswerte berechnen
         if (pulse_start != -1 && pulse_end != -1) {
         #if timestamping
-            uint32_t pulse_time_us = timestamps[pulse_end] - timestamps[pulse_start];
+            // Pulsdauer aus dem Sample-Index und der exakten Abtastperiode
+            float pulse_time_us = (adc_capture_sample_time_ns(pulse_end)
+                                   - adc_capture_sample_time_ns(pulse_start)) / 1000.0f;
         #endif
 
             // Berechnung der durchschnittlichen Amplitude
@@ -130,10 +129,7 @@ int main(void) {
 
             // Ausgabe der Ergebnisse
         #if timestamping
-            // printf("Berechnungszeit: %.2f us\n",
-            //     time_us_32() - timestamps[NUM_SAMPLES-1]);
-
-            printf("%.2f, %d, %d, %d, %.2f, %.2f, %lu\n",
+            printf("%.2f, %d, %d, %d, %.2f, %.2f, %.3f\n",
                 pwm, pulse_start, pulse_end, pulse_end - pulse_start, avg_an, avg_aus, pulse_time_us);
         #else
             printf("%.2f, %d, %d, %d, %.2f, %.2f\n",
@@ -174,10 +170,8 @@ void startmessung(void) {
     uint32_t start_time = time_us_32();
 
     uint16_t start_samples[NUM_SAMPLES];
-    // 100 Messungen durchführen
-    for (int i = 0; i < NUM_SAMPLES; i++) {
-        start_samples[i] = adc_read();
-    }
+    // Messungen per DMA durchführen
+    adc_capture_oneshot(start_samples, NUM_SAMPLES);
 
     // Durchschnitt der Startmessung berechnen
     uint32_t summe = 0;